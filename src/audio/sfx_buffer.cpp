@@ -21,7 +21,6 @@
 #include "config/user_config.hpp"
 #include "io/file_manager.hpp"
 #include "utils/constants.hpp"
-#include "utils/file_utils.hpp"
 #include "utils/log.hpp"
 
 #ifdef ENABLE_SOUND
@@ -36,6 +35,35 @@
 #  endif
 #endif
 
+#ifdef ENABLE_SOUND
+namespace
+{
+    // Callbacks to let vorbis read from an irrlicht read file, so that
+    // sound files can use the shared mapped files of the file manager.
+    size_t readCallback(void *ptr, size_t size, size_t nmemb, void *source)
+    {
+        if (size == 0)
+            return 0;
+        io::IReadFile *file = (io::IReadFile*)source;
+        return (size_t)file->read(ptr, (u32)(size * nmemb)) / size;
+    }   // readCallback
+    // ------------------------------------------------------------------------
+    int seekCallback(void *source, ogg_int64_t offset, int whence)
+    {
+        io::IReadFile *file = (io::IReadFile*)source;
+        if (whence == SEEK_END)
+            offset += file->getSize();
+        bool ok = file->seek((long)offset, whence == SEEK_CUR);
+        return ok ? 0 : -1;
+    }   // seekCallback
+    // ------------------------------------------------------------------------
+    long tellCallback(void *source)
+    {
+        return ((io::IReadFile*)source)->getPos();
+    }   // tellCallback
+}   // namespace
+#endif
+
 //----------------------------------------------------------------------------
 /** Creates a sfx. The parameter are taken from the parameters:
  *  \param file File name of the buffer.
@@ -162,7 +190,7 @@ bool SFXBuffer::loadVorbisBuffer(const std::string &name, ALuint buffer)
 
 
     bool success = false;
-    FILE *file;
+    io::IReadFile *file;
     vorbis_info *info;
     OggVorbis_File oggFile;
 
@@ -172,7 +200,7 @@ bool SFXBuffer::loadVorbisBuffer(const std::string &name, ALuint buffer)
         return false;
     }
 
-    file = FileUtils::fopenU8Path(name, "rb");
+    file = file_manager->createReadFile(name);
 
     if(!file)
     {
@@ -180,9 +208,11 @@ bool SFXBuffer::loadVorbisBuffer(const std::string &name, ALuint buffer)
         return false;
     }
 
-    if (ov_open_callbacks(file, &oggFile, NULL, 0,  OV_CALLBACKS_NOCLOSE) != 0)
+    ov_callbacks callbacks = { readCallback, seekCallback, NULL,
+                               tellCallback };
+    if (ov_open_callbacks(file, &oggFile, NULL, 0, callbacks) != 0)
     {
-        fclose(file);
+        file->drop();
         Log::error("SFXBuffer", "LoadVorbisBuffer() - ov_open_callbacks() failed, "
                                 "file isn't vorbis?");
         return false;
@@ -197,6 +227,7 @@ bool SFXBuffer::loadVorbisBuffer(const std::string &name, ALuint buffer)
     if(!data)
     {
         ov_clear(&oggFile);
+        file->drop();
         Log::error("SFXBuffer", "[SFXBuffer] Could not allocate decode buffer.");
         return false;
     }
@@ -220,7 +251,7 @@ bool SFXBuffer::loadVorbisBuffer(const std::string &name, ALuint buffer)
     free(data);
 
     ov_clear(&oggFile);
-    fclose(file);
+    file->drop();
 
     // Allow the xml data to overwrite the duration, but if there is no
     // duration (which is the norm), compute it:
@@ -378,6 +378,7 @@ void* SFXManager::mainLoop(void *obj)
         return NULL;
         
     VS::setThreadName("SFXManager");
+    profiler.setThreadName("SFXManager");
     SFXManager *me = (SFXManager*)obj;
 
     me->m_sfx_commands.lock();
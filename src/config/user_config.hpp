@@ -984,6 +984,29 @@ namespace UserConfigParams
           "Always show the login screen even if last player's session was saved."));
 
 
+    // ---- Physics
+
+    PARAM_PREFIX IntUserConfigParam         m_physics_threads
+            PARAM_DEFAULT(  IntUserConfigParam(0, "physics_threads",
+                            "Number of threads used to solve independent "
+                            "physics islands, 0 or 1 to solve them on the "
+                            "main thread only.") );
+
+    PARAM_PREFIX IntUserConfigParam         m_graph_threads
+            PARAM_DEFAULT(  IntUserConfigParam(4, "graph_threads",
+                            "Maximum number of threads used to compute the "
+                            "data derived from the drive graph or navmesh "
+                            "when loading a track, 0 to use all cores, 1 to "
+                            "compute it on the loading thread only.") );
+
+    // ---- Replay
+
+    PARAM_PREFIX BoolUserConfigParam        m_replay_text_format
+            PARAM_DEFAULT(  BoolUserConfigParam(false, "replay_text_format",
+                            "Save replays in the (larger and slower to load) "
+                            "text format, which can be read by older "
+                            "versions of STK.") );
+
     // ---- RPC player controller configuration
 
     PARAM_PREFIX BoolUserConfigParam        m_rpc_controller_enabled
@@ -1126,7 +1126,18 @@ scene::IAnimatedMesh *IrrDriver::getAnimatedMesh(const std::string &filename)
     }
     else
     {
-        m = m_scene_manager->getMesh(filename.c_str());
+        m = m_scene_manager->getMeshCache()->getMeshByName(filename.c_str());
+        if (!m)
+        {
+            // Read the mesh from the shared mapping of the file (the file
+            // name of the read file is used as key in the mesh cache)
+            io::IReadFile* file = file_manager->createReadFile(filename);
+            if (file)
+            {
+                m = m_scene_manager->getMesh(file);
+                file->drop();
+            }
+        }
     }
 
     if(!m) return NULL;
@@ -133,7 +133,7 @@ std::shared_ptr<video::IImage> SPTexture::getImageFromPath
         return NULL;
     }
 
-    io::IReadFile* file = irr::io::createReadFile(path.c_str());
+    io::IReadFile* file = file_manager->createReadFile(path);
     video::IImage* image = img_loader->loadImage(file);
     if (image == NULL || image->getDimension().Width == 0 ||
         image->getDimension().Height == 0)
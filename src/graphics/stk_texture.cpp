@@ -23,6 +23,7 @@
 #include "graphics/stk_tex_manager.hpp"
 #include "graphics/material.hpp"
 #include "graphics/material_manager.hpp"
+#include "io/file_manager.hpp"
 #include "modes/profile_world.hpp"
 #include "utils/log.hpp"
 #include "utils/string_utils.hpp"
@@ -111,8 +112,18 @@ void STKTexture::reload(bool no_upload, uint8_t* preload_data,
     uint8_t* data = preload_data;
     if (data == NULL)
     {
-        orig_img = preload_img ? preload_img :
-            irr_driver->getVideoDriver()->createImageFromFile(NamedPath);
+        orig_img = preload_img;
+        if (orig_img == NULL)
+        {
+            io::IReadFile* file =
+                file_manager->createReadFile(NamedPath.getPtr());
+            if (file)
+            {
+                orig_img =
+                    irr_driver->getVideoDriver()->createImageFromFile(file);
+                file->drop();
+            }
+        }
         if (orig_img == NULL)
         {
             return;
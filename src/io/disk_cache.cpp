@@ -0,0 +1,221 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "io/disk_cache.hpp"
+
+#include "io/file_manager.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <set>
+#include <vector>
+
+const uint64_t DiskCache::HASH_START;
+
+// ----------------------------------------------------------------------------
+/** Creates a cache for the given directory. The size of the existing files
+ *  is only determined by limitSize().
+ *  \param dir The directory (ending with '/'), or an empty string to
+ *         disable this cache.
+ *  \param extension Extension of the cache files (including the dot).
+ *  \param max_size Maximum total size of all cache files in bytes.
+ */
+DiskCache::DiskCache(const std::string &dir, const std::string &extension,
+                     uint64_t max_size)
+         : m_dir(dir), m_extension(extension), m_max_size(max_size),
+           m_size(0)
+{
+}   // DiskCache
+
+// ----------------------------------------------------------------------------
+/** Returns the full name of the cache file for a hash, or an empty string
+ *  if this cache is disabled.
+ *  \param hash Hash of the key or content of the cached data.
+ */
+std::string DiskCache::getFileName(uint64_t hash) const
+{
+    if (m_dir.empty())
+        return "";
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+    return m_dir + name + m_extension;
+}   // getFileName
+
+// ----------------------------------------------------------------------------
+/** Writes a cache file. The data is written to a temporary file first,
+ *  which is then renamed, so other threads or processes never read an
+ *  incomplete file. If the cache becomes too large, old files are removed.
+ *  \param file_name Name of the file (see getFileName).
+ *  \param data The content of the file.
+ *  \return True if the file was written.
+ */
+bool DiskCache::writeFile(const std::string &file_name,
+                          const std::string &data)
+{
+    if (file_name.empty())
+        return false;
+    const std::string tmp_file = FileUtils::getUniqueTmpPath(file_name);
+    FILE *f = FileUtils::fopenU8Path(tmp_file, "wb");
+    if (!f)
+        return false;
+    const bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    if (!ok || FileUtils::replaceU8Path(tmp_file, file_name) != 0)
+    {
+        file_manager->removeFile(tmp_file);
+        return false;
+    }
+    if (m_size.fetch_add(data.size()) + data.size() > m_max_size)
+        limitSize();
+    return true;
+}   // writeFile
+
+// ----------------------------------------------------------------------------
+/** Marks a cache file as used by setting its modification time to the
+ *  current time, so that limitSize removes the least recently used files
+ *  instead of the files that were written first.
+ *  \param file_name Name of the file (see getFileName).
+ */
+void DiskCache::touchFile(const std::string &file_name) const
+{
+    if (!file_name.empty())
+        FileUtils::touchU8Path(file_name);
+}   // touchFile
+
+// ----------------------------------------------------------------------------
+/** Determines the size of all cache files, and removes the least recently
+ *  used files (see touchFile) if the size is above the limit, until the
+ *  size is below 3/4 of the limit (so that not every new file triggers
+ *  another scan of the directory).
+ *  Temporary files left behind (e.g. by a crash) are removed after an hour.
+ */
+void DiskCache::limitSize()
+{
+    if (m_dir.empty())
+        return;
+    // If another thread is already doing this, there is no need to wait
+    std::unique_lock<std::mutex> lock(m_limit_lock, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+
+    std::set<std::string> names;
+    file_manager->listFiles(names, m_dir);
+    const time_t now = time(NULL);
+    std::vector<std::pair<time_t, std::string> > files;
+    std::vector<uint64_t> sizes;
+    uint64_t total = 0;
+    int num_removed = 0;
+    for (const std::string &name : names)
+    {
+        const size_t ext = name.rfind(m_extension);
+        struct stat st;
+        if (ext == std::string::npos ||
+            FileUtils::statU8Path(m_dir + name, &st) != 0 ||
+            !S_ISREG(st.st_mode))
+            continue;
+        if (ext + m_extension.size() != name.size())
+        {
+            // A temporary file, which might still be written
+            if (now - st.st_mtime > 3600 &&
+                file_manager->removeFile(m_dir + name))
+                num_removed++;
+            continue;
+        }
+        files.push_back(std::make_pair(st.st_mtime, name));
+        sizes.push_back((uint64_t)st.st_size);
+        total += (uint64_t)st.st_size;
+    }
+
+    if (total > m_max_size)
+    {
+        std::vector<unsigned int> order(files.size());
+        for (unsigned int i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(),
+                  [&files](unsigned int a, unsigned int b)
+                  {
+                      return files[a] < files[b];
+                  });
+        for (unsigned int i : order)
+        {
+            if (total <= m_max_size / 4 * 3)
+                break;
+            if (file_manager->removeFile(m_dir + files[i].second))
+            {
+                total -= sizes[i];
+                num_removed++;
+            }
+        }
+    }
+    m_size = total;
+    if (num_removed > 0)
+    {
+        Log::info("DiskCache", "Removed %d old files from '%s'.",
+                  num_removed, m_dir.c_str());
+    }
+}   // limitSize
+
+// ----------------------------------------------------------------------------
+/** 64 bit FNV-1a hash. The hash of data split into several parts can be
+ *  computed by passing the result for one part as start value for the
+ *  next part.
+ *  \param data The data.
+ *  \param size Size of the data.
+ *  \param hash Start value of the hash.
+ */
+uint64_t DiskCache::hash(const void *data, size_t size, uint64_t hash)
+{
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}   // hash
+
+// ----------------------------------------------------------------------------
+/** Appends a 32 bit value in little endian byte order.
+ *  \param out The string the value is appended to.
+ *  \param n The value.
+ */
+void DiskCache::addU32(std::string *out, uint32_t n)
+{
+    for (unsigned int i = 0; i < 4; i++)
+        out->push_back((char)((n >> (8 * i)) & 0xff));
+}   // addU32
+
+// ----------------------------------------------------------------------------
+/** Reads a 32 bit value written by addU32.
+ *  \param data Pointer to the data, which is advanced past the value.
+ *  \param end End of the data.
+ *  \param n On return the value.
+ *  \return False if there is not enough data left.
+ */
+bool DiskCache::getU32(const char **data, const char *end, uint32_t *n)
+{
+    if (end - *data < 4)
+        return false;
+    const unsigned char *p = (const unsigned char*)*data;
+    *n = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    *data += 4;
+    return true;
+}   // getU32
@@ -0,0 +1,84 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_DISK_CACHE_HPP
+#define HEADER_DISK_CACHE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+  * \ingroup io
+  * A directory of cache files, e.g. parsed XML files or the collision data
+  * of tracks. The files are named after a hash of their content or key,
+  * written to a temporary file first and then renamed, so concurrent
+  * readers (other threads or processes) never see an incomplete file.
+  *
+  * The total size of the files is limited: when a newly written file
+  * exceeds the limit, the least recently used files are removed (a file
+  * that is read must be marked as used with touchFile). A cache without a
+  * directory (e.g. because it could not be created) is disabled, and
+  * getFileName returns an empty string.
+  */
+class DiskCache : public NoCopy
+{
+private:
+    /** The directory with the cache files, empty if disabled. */
+    std::string m_dir;
+
+    /** Extension of the cache files (including the dot). */
+    std::string m_extension;
+
+    /** Maximum total size of all cache files in bytes. */
+    uint64_t m_max_size;
+
+    /** Estimated total size of all cache files (files written by another
+     *  process or overwritten files are only detected by limitSize). */
+    std::atomic<uint64_t> m_size;
+
+    /** Only one thread removes files at a time. */
+    std::mutex m_limit_lock;
+
+public:
+    /** Start value of hash(). */
+    static const uint64_t HASH_START = 0xcbf29ce484222325ULL;
+
+                DiskCache(const std::string &dir,
+                          const std::string &extension, uint64_t max_size);
+    std::string getFileName(uint64_t hash) const;
+    bool        writeFile(const std::string &file_name,
+                          const std::string &data);
+    void        touchFile(const std::string &file_name) const;
+    void        limitSize();
+    static uint64_t hash(const void *data, size_t size,
+                         uint64_t hash = HASH_START);
+    static void addU32(std::string *out, uint32_t n);
+    static bool getU32(const char **data, const char *end, uint32_t *n);
+    // ------------------------------------------------------------------------
+    /** Returns false if this cache is disabled. */
+    bool isEnabled() const                       { return !m_dir.empty(); }
+    // ------------------------------------------------------------------------
+    /** Returns the directory of this cache (empty if disabled). */
+    const std::string &getDirectory() const                { return m_dir; }
+};   // DiskCache
+
+#endif
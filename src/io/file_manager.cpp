@@ -25,12 +25,15 @@
 #include "graphics/material_manager.hpp"
 #include "guiengine/engine.hpp"
 #include "guiengine/skin.hpp"
+#include "io/disk_cache.hpp"
+#include "io/mapped_read_file.hpp"
 #include "karts/kart_properties_manager.hpp"
 #include "tracks/track_manager.hpp"
 #include "utils/command_line.hpp"
 #include "utils/extract_mobile_assets.hpp"
 #include "utils/file_utils.hpp"
 #include "utils/log.hpp"
+#include "utils/mapped_file.hpp"
 #include "utils/string_utils.hpp"
 
 #ifdef ANDROID
@@ -39,12 +42,15 @@
 
 #include <irrlicht.h>
 
+#include <algorithm>
+#include <atomic>
 #include <stdio.h>
 #include <stdexcept>
 #include <sstream>
 #include <sys/stat.h>
 #include <iostream>
 #include <string>
+#include <thread>
 
 namespace irr {
     namespace io
@@ -134,6 +140,7 @@ FileManager* file_manager = 0;
 FileManager::FileManager()
 {
     m_root_dirs.clear();
+    m_mapped_files_sweep_size = MIN_MAPPED_FILES_SWEEP;
     resetSubdir();
 #ifdef __APPLE__
     // irrLicht's createDevice method has a nasty habit of messing the CWD.
@@ -252,6 +259,18 @@ FileManager::FileManager()
     checkAndCreateScreenshotDir();
     checkAndCreateReplayDir();
     checkAndCreateCachedTexturesDir();
+    // The parsed XML files of the data directory need a few MB, the
+    // collision data of a track up to about 20 MB, the graph data of a
+    // track less than 1 MB.
+    m_xml_cache     = new DiskCache(checkAndCreateCacheDir("cached-xml/",
+                                                           "CachedXML/"),
+                                    ".xmlc", 64 * 1024 * 1024);
+    m_physics_cache = new DiskCache(checkAndCreateCacheDir("cached-physics/",
+                                                           "CachedPhysics/"),
+                                    ".physc", 512 * 1024 * 1024);
+    m_graph_cache   = new DiskCache(checkAndCreateCacheDir("cached-graphs/",
+                                                           "CachedGraphs/"),
+                                    ".graphc", 64 * 1024 * 1024);
     checkAndCreateGPDir();
 
     redirectOutput();
@@ -406,6 +425,10 @@ void FileManager::init()
 {
     discoverPaths();
     addAssetsSearchPath();
+    // Remove old cache files if the caches have become too large
+    m_xml_cache->limitSize();
+    m_physics_cache->limitSize();
+    m_graph_cache->limitSize();
     m_cert_bundle_location = m_file_system->getAbsolutePath(
         getAsset("cacert.pem").c_str()).c_str();
 }   // init
@@ -444,6 +467,10 @@ void FileManager::reinitAfterDownloadAssets()
     m_music_search_path.clear();
     discoverPaths();
     addAssetsSearchPath();
+    // Remove old cache files if the caches have become too large
+    m_xml_cache->limitSize();
+    m_physics_cache->limitSize();
+    m_graph_cache->limitSize();
     // Add back addons search path
     KartPropertiesManager::addKartSearchDir(
                  file_manager->getAddonsFile("karts/"));
@@ -505,6 +532,14 @@ FileManager::~FileManager()
     popModelSearchPath();
     popTextureSearchPath();
     popTextureSearchPath();
+    clearMappedFiles();
+    clearPreloadedXMLTrees();
+    delete m_xml_cache;
+    m_xml_cache = NULL;
+    delete m_physics_cache;
+    m_physics_cache = NULL;
+    delete m_graph_cache;
+    m_graph_cache = NULL;
     m_file_system->drop();
     m_file_system = NULL;
 }   // ~FileManager
@@ -544,10 +579,160 @@ void FileManager::addRootDirs(const std::string &roots)
     }
 }   // addRootDirs
 
+//-----------------------------------------------------------------------------
+/** Returns true if the file can be accessed through a memory mapping. This
+ *  is only done for the (read-only) data and addons directories: files in
+ *  the config directory are rewritten by STK itself, and truncating a file
+ *  that is mapped would crash the game when accessing the mapping.
+ *  \param filename Name of the file.
+ */
+bool FileManager::canMapFile(const std::string &filename) const
+{
+    for (const std::string &root : m_root_dirs)
+    {
+        if (!root.empty() && filename.compare(0, root.size(), root) == 0)
+            return true;
+    }
+    return !m_addons_dir.empty() &&
+           filename.compare(0, m_addons_dir.size(), m_addons_dir) == 0;
+}   // canMapFile
+
+//-----------------------------------------------------------------------------
+/** Returns a shared view of a file. If the file is still mapped (because
+ *  another load uses it, or it was used recently) and has not changed on
+ *  disk, the existing mapping is returned, otherwise the file is mapped.
+ *  \param filename Name of the file.
+ *  \param size Current size of the file.
+ *  \param mtime Current modification time of the file.
+ *  \return The mapped file, or an empty pointer if it can not be opened.
+ */
+std::shared_ptr<const MappedFile>
+    FileManager::getMappedFile(const std::string &filename, size_t size,
+                               time_t mtime)
+{
+    std::shared_ptr<const MappedFile> file;
+    {
+        std::lock_guard<std::mutex> lock(m_mapped_files_lock);
+        auto it = m_mapped_files.find(filename);
+        if (it != m_mapped_files.end() && it->second.m_size == size &&
+            it->second.m_mtime == mtime)
+            file = it->second.m_file.lock();
+    }
+
+    if (!file)
+    {
+        // Map the file without holding the lock, so that threads loading
+        // different files do not wait for each other.
+        std::shared_ptr<MappedFile> new_file = std::make_shared<MappedFile>();
+        if (!new_file->open(filename))
+            return file;
+        file = new_file;
+
+        std::lock_guard<std::mutex> lock(m_mapped_files_lock);
+        MappedFileInfo &info = m_mapped_files[filename];
+        std::shared_ptr<const MappedFile> other = info.m_file.lock();
+        if (other && info.m_size == size && info.m_mtime == mtime)
+        {
+            // Another thread mapped the same file in the meantime
+            file = other;
+        }
+        else
+        {
+            // Remove an outdated version from the hot files
+            if (other)
+                m_hot_files.remove(other);
+            info.m_file  = file;
+            info.m_size  = size;
+            info.m_mtime = mtime;
+        }
+
+        // Remove the entries of files that are not mapped anymore. This is
+        // only done when the number of entries has doubled, so the cost
+        // per mapped file stays constant.
+        if (m_mapped_files.size() >= m_mapped_files_sweep_size)
+        {
+            for (auto it = m_mapped_files.begin(); it != m_mapped_files.end();)
+            {
+                if (it->second.m_file.expired())
+                    it = m_mapped_files.erase(it);
+                else
+                    it++;
+            }
+            m_mapped_files_sweep_size =
+                std::max((size_t)MIN_MAPPED_FILES_SWEEP,
+                         2 * m_mapped_files.size());
+        }
+    }
+
+    // Only keep files that are actually mapped: copies of files that could
+    // not be mapped would just use memory. Addon files are not kept either:
+    // an open mapping would prevent removing or updating the addon on
+    // Windows, and overwriting a mapped file crashes the reader on Linux.
+    const bool is_addon = !m_addons_dir.empty() &&
+        filename.compare(0, m_addons_dir.size(), m_addons_dir) == 0;
+    if (file->isMapped() && !is_addon)
+    {
+        std::lock_guard<std::mutex> lock(m_mapped_files_lock);
+        m_hot_files.remove(file);
+        m_hot_files.push_front(file);
+        if (m_hot_files.size() > MAX_HOT_FILES)
+            m_hot_files.pop_back();
+    }
+    return file;
+}   // getMappedFile
+
+//-----------------------------------------------------------------------------
+/** Opens a file for reading. Files in the data or addons directories are
+ *  memory mapped, and all loads of the same file share one read-only view
+ *  of it. Other files (or if mapping fails) are opened using irrlicht's
+ *  file system (which also handles files in archives).
+ *  \param filename Name of the file.
+ *  \return The read file (which must be dropped by the caller), or NULL
+ *          if the file could not be opened.
+ */
+io::IReadFile *FileManager::createReadFile(const std::string &filename)
+{
+    std::shared_ptr<const MappedFile> file = mapFile(filename);
+    if (file)
+        return new MappedReadFile(file, filename.c_str());
+    return m_file_system->createAndOpenFile(filename.c_str());
+}   // createReadFile
+
+//-----------------------------------------------------------------------------
+/** Returns a shared read-only view of the content of a file in the data or
+ *  addons directories (see createReadFile).
+ *  \param filename Name of the file.
+ *  \return The mapped file, or an empty pointer if the file does not exist,
+ *          is not in a data directory, or can not be opened.
+ */
+std::shared_ptr<const MappedFile>
+    FileManager::mapFile(const std::string &filename)
+{
+    struct stat st;
+    if (canMapFile(filename) &&
+        FileUtils::statU8Path(filename, &st) == 0 && S_ISREG(st.st_mode))
+        return getMappedFile(filename, (size_t)st.st_size, st.st_mtime);
+    return std::shared_ptr<const MappedFile>();
+}   // mapFile
+
+//-----------------------------------------------------------------------------
+/** Releases all mappings that are not used by a read file anymore. */
+void FileManager::clearMappedFiles()
+{
+    std::lock_guard<std::mutex> lock(m_mapped_files_lock);
+    m_hot_files.clear();
+    m_mapped_files.clear();
+}   // clearMappedFiles
+
 //-----------------------------------------------------------------------------
 io::IXMLReader *FileManager::createXMLReader(const std::string &filename)
 {
-    return m_file_system->createXMLReader(filename.c_str());
+    io::IReadFile *file = createReadFile(filename);
+    if (!file)
+        return NULL;
+    io::IXMLReader *reader = m_file_system->createXMLReader(file);
+    file->drop();
+    return reader;
 }   // getXMLReader
 //-----------------------------------------------------------------------------
 /** Reads in a XML file and converts it into a XMLNode tree.
@@ -555,6 +740,9 @@ io::IXMLReader *FileManager::createXMLReader(const std::string &filename)
  */
 XMLNode *FileManager::createXMLTree(const std::string &filename)
 {
+    XMLNode *preloaded = takePreloadedXMLTree(filename);
+    if (preloaded)
+        return preloaded;
     try
     {
         XMLNode* node = new XMLNode(filename);
@@ -570,6 +758,89 @@ XMLNode *FileManager::createXMLTree(const std::string &filename)
     }
 }   // createXMLTree
 
+//-----------------------------------------------------------------------------
+/** Parses a list of XML files concurrently, so that the trees can later be
+ *  taken by createXMLTree (or takePreloadedXMLTree) without reading and
+ *  parsing the files again. This is used at startup to parse the files of
+ *  all karts and tracks in parallel, while the objects are still created
+ *  one after another in the usual order. Files that do not exist or can not
+ *  be parsed are ignored (the error is then reported when the file is
+ *  actually loaded).
+ *  \param files Full paths of the XML files to parse.
+ */
+void FileManager::preloadXMLTrees(const std::vector<std::string> &files)
+{
+    std::vector<XMLNode*> trees(files.size(), NULL);
+    std::atomic<unsigned int> next_file(0);
+    auto parse = [this, &files, &trees, &next_file]()
+    {
+        for (unsigned int i = next_file++; i < files.size(); i = next_file++)
+        {
+            if (!fileExists(files[i]))
+                continue;
+            try
+            {
+                trees[i] = new XMLNode(files[i]);
+            }
+            catch (std::exception &)
+            {
+                trees[i] = NULL;
+            }
+        }
+    };
+
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0)
+        num_threads = 2;
+    num_threads = std::min(num_threads, (unsigned int)files.size());
+    // The calling thread parses files as well
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < num_threads; i++)
+        threads.emplace_back(parse);
+    parse();
+    for (std::thread &t : threads)
+        t.join();
+
+    // Merge in the order of the list, so the result does not depend on
+    // which thread parsed which file.
+    std::lock_guard<std::mutex> lock(m_preloaded_xml_lock);
+    for (unsigned int i = 0; i < files.size(); i++)
+    {
+        if (!trees[i])
+            continue;
+        XMLNode *&tree = m_preloaded_xml_trees[files[i]];
+        delete tree;
+        tree = trees[i];
+    }
+}   // preloadXMLTrees
+
+//-----------------------------------------------------------------------------
+/** Returns the XML tree of a file parsed by preloadXMLTrees, or NULL if the
+ *  file was not preloaded. The caller takes ownership of the tree, so each
+ *  tree is only returned once.
+ *  \param filename Name of the XML file.
+ */
+XMLNode *FileManager::takePreloadedXMLTree(const std::string &filename)
+{
+    std::lock_guard<std::mutex> lock(m_preloaded_xml_lock);
+    auto it = m_preloaded_xml_trees.find(filename);
+    if (it == m_preloaded_xml_trees.end())
+        return NULL;
+    XMLNode *tree = it->second;
+    m_preloaded_xml_trees.erase(it);
+    return tree;
+}   // takePreloadedXMLTree
+
+//-----------------------------------------------------------------------------
+/** Frees all preloaded XML trees that were not used. */
+void FileManager::clearPreloadedXMLTrees()
+{
+    std::lock_guard<std::mutex> lock(m_preloaded_xml_lock);
+    for (auto &tree : m_preloaded_xml_trees)
+        delete tree.second;
+    m_preloaded_xml_trees.clear();
+}   // clearPreloadedXMLTrees
+
 //-----------------------------------------------------------------------------
 /** Reads in XML from a string and converts it into a XMLNode tree.
  *  \param content the string containing the XML content.
@@ -831,6 +1102,27 @@ std::string FileManager::getCachedTexturesDir() const
     return m_cached_textures_dir;
 }   // getCachedTexturesDir
 
+//-----------------------------------------------------------------------------
+/** Returns the cache of parsed XML files. */
+DiskCache *FileManager::getXMLCache() const
+{
+    return m_xml_cache;
+}   // getXMLCache
+
+//-----------------------------------------------------------------------------
+/** Returns the cache of the collision data of tracks. */
+DiskCache *FileManager::getPhysicsCache() const
+{
+    return m_physics_cache;
+}   // getPhysicsCache
+
+//-----------------------------------------------------------------------------
+/** Returns the cache of the derived data of drive graphs and navmeshes. */
+DiskCache *FileManager::getGraphCache() const
+{
+    return m_graph_cache;
+}   // getGraphCache
+
 //-----------------------------------------------------------------------------
 /** Returns the directory in which user-defined grand prix should be stored.
  */
@@ -1173,6 +1465,37 @@ void FileManager::checkAndCreateCachedTexturesDir()
 
 }   // checkAndCreateCachedTexturesDir
 
+// ----------------------------------------------------------------------------
+/** Creates a directory for cache files (see DiskCache), next to the cached
+ *  textures.
+ *  \param dir_name Name of the directory (ending with '/').
+ *  \param apple_name Name of the directory on macOS (ending with '/').
+ *  \return The full path of the directory, or an empty string if it can not
+ *          be created (which disables the cache).
+ */
+std::string FileManager::checkAndCreateCacheDir(const std::string &dir_name,
+                                                const std::string &apple_name)
+{
+#if defined(WIN32)
+    std::string dir = m_user_config_dir + dir_name;
+#elif defined(__APPLE__)
+    std::string dir = getenv("HOME");
+    dir += "/Library/Application Support/SuperTuxKart/" + apple_name;
+#else
+    std::string dir = checkAndCreateLinuxDir("XDG_CACHE_HOME", "supertuxkart",
+                                             ".cache/", ".");
+    dir += dir_name;
+#endif
+
+    if (!checkAndCreateDirectory(dir))
+    {
+        Log::warn("FileManager", "Can not create cache directory '%s', "
+                  "these files will not be cached.", dir.c_str());
+        return "";
+    }
+    return dir;
+}   // checkAndCreateCacheDir
+
 // ----------------------------------------------------------------------------
 /** Creates the directories for user-defined grand prix. This will set m_gp_dir
  *  with the appropriate path.
@@ -25,6 +25,10 @@
  * Contains generic utility classes for file I/O (especially XML handling).
  */
 
+#include <ctime>
+#include <list>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -38,6 +42,9 @@ using namespace irr;
 #include "io/xml_node.hpp"
 #include "utils/no_copy.hpp"
 
+class DiskCache;
+class MappedFile;
+
 struct TextureSearchPath
 {
     std::string m_texture_search_path;
@@ -68,6 +75,48 @@ public:
 private:
     mutable std::mutex m_file_system_lock;
 
+    /** A file mapped by createReadFile. */
+    struct MappedFileInfo
+    {
+        /** The mapped file, as long as any read file still uses it. */
+        std::weak_ptr<const MappedFile> m_file;
+        /** Size and modification time when the file was mapped, used to
+         *  detect if the file was changed on disk (e.g. addon updates). */
+        size_t m_size;
+        time_t m_mtime;
+    };
+
+    /** Maximum number of recently used files that are kept mapped even
+     *  if no read file uses them anymore. */
+    static const unsigned int MAX_HOT_FILES = 16;
+
+    /** All files mapped by createReadFile, indexed by file name. Entries
+     *  of files that are not mapped anymore are removed when the map
+     *  reaches m_mapped_files_sweep_size entries. */
+    std::map<std::string, MappedFileInfo> m_mapped_files;
+
+    /** Minimum value of m_mapped_files_sweep_size. */
+    static const size_t MIN_MAPPED_FILES_SWEEP = 64;
+
+    /** Size of m_mapped_files at which unused entries are removed. */
+    size_t m_mapped_files_sweep_size;
+
+    /** The most recently used mapped files (most recent first). Keeping
+     *  these alive avoids mapping e.g. a texture again that is loaded by
+     *  several karts or tracks. Files in the addons directory are never
+     *  kept here. */
+    std::list<std::shared_ptr<const MappedFile> > m_hot_files;
+
+    /** Protects m_mapped_files and m_hot_files. */
+    std::mutex m_mapped_files_lock;
+
+    /** XML trees parsed in advance by preloadXMLTrees, indexed by file
+     *  name. They are handed out (once) by createXMLTree. */
+    std::map<std::string, XMLNode*> m_preloaded_xml_trees;
+
+    /** Protects m_preloaded_xml_trees. */
+    std::mutex m_preloaded_xml_lock;
+
     /** The names of the various subdirectories of the asset types. */
     std::vector< std::string > m_subdir_name;
 
@@ -98,6 +147,16 @@ private:
     /** Directory where resized textures are cached. */
     std::string       m_cached_textures_dir;
 
+    /** Cache of parsed XML files (see XMLNode). */
+    DiskCache        *m_xml_cache;
+
+    /** Cache of the collision data of tracks (see CollisionCache). */
+    DiskCache        *m_physics_cache;
+
+    /** Cache of the derived data of drive graphs and navmeshes (see
+     *  GraphCache). */
+    DiskCache        *m_graph_cache;
+
     /** Directory where user-defined grand prix are stored. */
     std::string       m_gp_dir;
 
@@ -128,10 +187,16 @@ private:
     void              checkAndCreateScreenshotDir();
     void              checkAndCreateReplayDir();
     void              checkAndCreateCachedTexturesDir();
+    std::string       checkAndCreateCacheDir(const std::string &dir_name,
+                                             const std::string &apple_name);
     void              checkAndCreateGPDir();
     void              discoverPaths();
     void              addAssetsSearchPath();
     void              resetSubdir();
+    bool              canMapFile(const std::string &filename) const;
+    std::shared_ptr<const MappedFile>
+                      getMappedFile(const std::string &filename,
+                                    size_t size, time_t mtime);
 #if !defined(WIN32) && !defined(__APPLE__)
     std::string       checkAndCreateLinuxDir(const char *env_name,
                                              const char *dir_name,
@@ -147,13 +212,23 @@ public:
     static void       addRootDirs(const std::string &roots);
     static void       setStdoutName(const std::string &name);
     static void       setStdoutDir(const std::string &dir);
+    io::IReadFile    *createReadFile(const std::string &filename);
+    std::shared_ptr<const MappedFile>
+                      mapFile(const std::string &filename);
+    void              clearMappedFiles();
     io::IXMLReader   *createXMLReader(const std::string &filename);
     XMLNode          *createXMLTree(const std::string &filename);
+    void              preloadXMLTrees(const std::vector<std::string> &files);
+    XMLNode          *takePreloadedXMLTree(const std::string &filename);
+    void              clearPreloadedXMLTrees();
     XMLNode          *createXMLTreeFromString(const std::string & content);
 
     std::string       getScreenshotDir() const;
     std::string       getReplayDir() const;
     std::string       getCachedTexturesDir() const;
+    DiskCache        *getXMLCache() const;
+    DiskCache        *getPhysicsCache() const;
+    DiskCache        *getGraphCache() const;
     std::string       getGPDir() const;
     bool              checkAndCreateDirectory(const std::string &path);
     bool              checkAndCreateDirectoryP(const std::string &path);
@@ -0,0 +1,68 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "io/mapped_read_file.hpp"
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+/** Creates a read file for a mapped file.
+ *  \param file The mapped file, which must be open.
+ *  \param file_name The name returned by getFileName (irrlicht uses this
+ *         e.g. as key in its mesh cache, and to find the right loader).
+ */
+MappedReadFile::MappedReadFile(std::shared_ptr<const MappedFile> file,
+                               const io::path &file_name)
+              : m_file(file), m_file_name(file_name)
+{
+    m_pos = 0;
+}   // MappedReadFile
+
+// ----------------------------------------------------------------------------
+/** Copies up to size_to_read bytes from the current position into the
+ *  buffer.
+ *  \return Number of bytes actually read.
+ */
+s32 MappedReadFile::read(void *buffer, u32 size_to_read)
+{
+    const long size = getSize();
+    if (m_pos >= size)
+        return 0;
+    long amount = (long)size_to_read;
+    if (m_pos + amount > size)
+        amount = size - m_pos;
+    memcpy(buffer, m_file->getData() + m_pos, (size_t)amount);
+    m_pos += amount;
+    return (s32)amount;
+}   // read
+
+// ----------------------------------------------------------------------------
+/** Changes the read position.
+ *  \param final_pos New position, or offset if relative_movement is true.
+ *  \param relative_movement If true the position is relative to the current
+ *         position.
+ *  \return False if the new position would be outside of the file.
+ */
+bool MappedReadFile::seek(long final_pos, bool relative_movement)
+{
+    const long pos = relative_movement ? m_pos + final_pos : final_pos;
+    if (pos < 0 || pos > getSize())
+        return false;
+    m_pos = pos;
+    return true;
+}   // seek
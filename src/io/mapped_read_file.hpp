@@ -0,0 +1,63 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_MAPPED_READ_FILE_HPP
+#define HEADER_MAPPED_READ_FILE_HPP
+
+#include "utils/mapped_file.hpp"
+
+#include <IReadFile.h>
+
+#include <memory>
+
+using namespace irr;
+
+/**
+  * \ingroup io
+  * An irrlicht read file which reads from a (shared) memory mapped file.
+  * Several MappedReadFile objects can share the same MappedFile, each
+  * with its own read position, so loading the same file more than once
+  * neither reads it again from disk nor copies it. Objects of this class
+  * are created by FileManager::createReadFile.
+  */
+class MappedReadFile : public io::IReadFile
+{
+private:
+    /** The shared view of the file content. */
+    std::shared_ptr<const MappedFile> m_file;
+
+    /** Current read position. */
+    long m_pos;
+
+    /** Name of the file as requested by the caller. */
+    io::path m_file_name;
+
+public:
+    MappedReadFile(std::shared_ptr<const MappedFile> file,
+                   const io::path &file_name);
+    virtual s32  read(void *buffer, u32 size_to_read);
+    virtual bool seek(long final_pos, bool relative_movement = false);
+    // ------------------------------------------------------------------------
+    virtual long getSize() const             { return (long)m_file->getSize(); }
+    // ------------------------------------------------------------------------
+    virtual long getPos() const                              { return m_pos; }
+    // ------------------------------------------------------------------------
+    virtual const io::path& getFileName() const        { return m_file_name; }
+};   // MappedReadFile
+
+#endif
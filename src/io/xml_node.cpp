@@ -16,14 +16,209 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#include "io/disk_cache.hpp"
 #include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
 #include "utils/interpolation_array.hpp"
 #include "utils/log.hpp"
+#include "utils/mapped_file.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/vec3.hpp"
 
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    /** All element and attribute names used in any XML node, so that each
+     *  node only has to store a small id instead of the name. The names are
+     *  looked up for every parsed attribute (often on several threads) and
+     *  every get, so the table is lock free: names are only ever added,
+     *  and a slot of the open addressing hash table is set once (with a
+     *  compare and swap) to the id + 1 of a name. Since the table has twice
+     *  as many slots as names, it is never full. */
+    const uint32_t MAX_NAMES = 16384;
+    const uint32_t NUM_SLOTS = 2 * MAX_NAMES;
+    std::atomic<uint32_t>           g_slots[NUM_SLOTS];
+    std::atomic<const std::string*> g_names[MAX_NAMES];
+    std::atomic<uint32_t>           g_num_names(0);
+
+    /** Names beyond MAX_NAMES (which no data file comes close to) are
+     *  stored in a slower table protected by a lock. A deque is used, since
+     *  references to its elements stay valid. */
+    std::mutex                                g_overflow_lock;
+    std::unordered_map<std::string, uint32_t> g_overflow_ids;
+    std::deque<std::string>                   g_overflow_names;
+
+    /** Version of the format of cached XML files, must be increased
+     *  whenever the format changes. */
+    const uint32_t CACHE_VERSION = 1;
+    /** Maximum depth of nodes in a cached file (which protects against
+     *  running out of stack space with a corrupted file). */
+    const int MAX_CACHE_DEPTH = 256;
+
+    // ------------------------------------------------------------------------
+    /** Adds a string, as length and the characters. Wide strings are only
+     *  stored with 4 bytes per character if they contain characters that
+     *  do not fit into a byte (which is rare, see irrlicht's XML reader). */
+    void addString(std::string *out, const core::stringw &s)
+    {
+        DiskCache::addU32(out, s.size());
+        bool wide = false;
+        for (unsigned int i = 0; i < s.size(); i++)
+            wide |= (uint32_t)s[i] > 0xff;
+        out->push_back(wide ? 1 : 0);
+        for (unsigned int i = 0; i < s.size(); i++)
+        {
+            if (wide)
+                DiskCache::addU32(out, (uint32_t)s[i]);
+            else
+                out->push_back((char)s[i]);
+        }
+    }   // addString
+    // ------------------------------------------------------------------------
+    bool getString(const char **data, const char *end, core::stringw *s)
+    {
+        uint32_t len;
+        if (!DiskCache::getU32(data, end, &len) || *data == end)
+            return false;
+        const bool wide = **data != 0;
+        (*data)++;
+        if ((uint64_t)(end - *data) < (uint64_t)len * (wide ? 4 : 1))
+            return false;
+        s->reserve(len + 1);
+        for (uint32_t i = 0; i < len; i++)
+        {
+            uint32_t c = (unsigned char)**data;
+            if (wide)
+                DiskCache::getU32(data, end, &c);
+            else
+                (*data)++;
+            s->append((wchar_t)c);
+        }
+        return true;
+    }   // getString
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Returns the id of a name if it was used in any XML file.
+ *  \param name The element or attribute name.
+ *  \param id On return the id of the name (if found).
+ *  \return False if the name is not known (i.e. no node uses it).
+ */
+bool XMLNode::findNameID(const std::string &name, uint32_t *id)
+{
+    const size_t hash = std::hash<std::string>()(name);
+    for (uint32_t i = 0; i < NUM_SLOTS; i++)
+    {
+        const uint32_t slot =
+            g_slots[(hash + i) % NUM_SLOTS].load(std::memory_order_acquire);
+        if (slot == 0)
+            break;
+        if (*g_names[slot - 1].load(std::memory_order_acquire) == name)
+        {
+            *id = slot - 1;
+            return true;
+        }
+    }
+    if (g_num_names.load() < MAX_NAMES)
+        return false;
+
+    std::lock_guard<std::mutex> lock(g_overflow_lock);
+    auto it = g_overflow_ids.find(name);
+    if (it == g_overflow_ids.end())
+        return false;
+    *id = it->second;
+    return true;
+}   // findNameID
+
+// ----------------------------------------------------------------------------
+/** Returns the id of a name, adding the name if it is not known yet.
+ *  \param name The element or attribute name.
+ */
+uint32_t XMLNode::getNameID(const std::string &name)
+{
+    const size_t hash = std::hash<std::string>()(name);
+    // The id for the name if it has to be added. If another thread adds a
+    // different name to the same slot first, the id is used for the next
+    // free slot; if it adds the same name, the id is never used.
+    uint32_t new_id = MAX_NAMES;
+    for (uint32_t i = 0; i < NUM_SLOTS; i++)
+    {
+        std::atomic<uint32_t> &slot = g_slots[(hash + i) % NUM_SLOTS];
+        uint32_t value = slot.load(std::memory_order_acquire);
+        if (value == 0)
+        {
+            if (new_id == MAX_NAMES)
+            {
+                new_id = g_num_names.fetch_add(1);
+                if (new_id >= MAX_NAMES)
+                    break;
+                g_names[new_id].store(new std::string(name),
+                                      std::memory_order_release);
+            }
+            if (slot.compare_exchange_strong(value, new_id + 1,
+                                             std::memory_order_acq_rel))
+                return new_id;
+            // Another thread used this slot, value is its id + 1 now
+        }
+        if (*g_names[value - 1].load(std::memory_order_acquire) == name)
+            return value - 1;
+    }
+
+    std::lock_guard<std::mutex> lock(g_overflow_lock);
+    auto it = g_overflow_ids.find(name);
+    if (it != g_overflow_ids.end())
+        return it->second;
+    const uint32_t id = MAX_NAMES + (uint32_t)g_overflow_names.size();
+    g_overflow_names.push_back(name);
+    g_overflow_ids[name] = id;
+    return id;
+}   // getNameID
+
+// ----------------------------------------------------------------------------
+/** Returns the name for an id returned by getNameID. */
+const std::string &XMLNode::getInternedName(uint32_t id)
+{
+    if (id < MAX_NAMES)
+        return *g_names[id].load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(g_overflow_lock);
+    return g_overflow_names[id - MAX_NAMES];
+}   // getInternedName
+
+// ----------------------------------------------------------------------------
+/** Returns a pointer to the value of an attribute, or NULL if this node
+ *  does not have this attribute. Nodes have only a few attributes, so
+ *  comparing the ids of all attributes is faster than any map.
+ *  \param attribute Id of the attribute (see getNameID).
+ */
+const core::stringw *XMLNode::getAttribute(uint32_t attribute) const
+{
+    for (unsigned int i = 0; i < m_attributes.size(); i++)
+    {
+        if (m_attributes[i].first == attribute)
+            return &m_attributes[i].second;
+    }
+    return NULL;
+}   // getAttribute
+
+// ----------------------------------------------------------------------------
+/** Returns the id of an attribute if any node uses it, which is used by the
+ *  get functions that take the name of the attribute.
+ *  \param name Name of the attribute.
+ *  \param id On return the id of the attribute (if the name is known).
+ *  \return False if the name is not known or this node has no attributes.
+ */
+bool XMLNode::findAttributeID(const std::string &name, uint32_t *id) const
+{
+    return !m_attributes.empty() && findNameID(name, id);
+}   // findAttributeID
 
 XMLNode::XMLNode(io::IXMLReader *xml)
 {
@@ -41,6 +236,20 @@ XMLNode::XMLNode(const std::string &filename)
 {
     m_file_name = filename;
 
+    // Files in the data directories are cached in a binary format. The name
+    // of the cache file is the hash of the content, so a modified file is
+    // parsed again.
+    std::string cache_file;
+    size_t size = 0;
+    std::shared_ptr<const MappedFile> data = file_manager->mapFile(filename);
+    if (data)
+    {
+        size = data->getSize();
+        cache_file = getCacheFileName(data->getData(), size);
+        if (!cache_file.empty() && readCache(cache_file, size))
+            return;
+    }
+
     io::IXMLReader *xml = file_manager->createXMLReader(filename);
     
     if (xml == NULL)
@@ -73,6 +282,9 @@ XMLNode::XMLNode(const std::string &filename)
         }   // switch
     }   // while
     xml->drop();
+
+    if (!cache_file.empty())
+        writeCache(cache_file, size);
 }   // XMLNode
 
 // ----------------------------------------------------------------------------
@@ -98,7 +310,15 @@ void XMLNode::readXML(io::IXMLReader *xml)
     {
         std::string   name  = core::stringc(xml->getAttributeName(i)).c_str();
         core::stringw value = xml->getAttributeValue(i);
-        m_attributes[name] = value;
+        const uint32_t id   = getNameID(name);
+        // If an attribute is defined more than once, the last value is used
+        unsigned int j = 0;
+        while (j < m_attributes.size() && m_attributes[j].first != id)
+            j++;
+        if (j < m_attributes.size())
+            m_attributes[j].second = value;
+        else
+            m_attributes.push_back(std::make_pair(id, value));
     }   // for i
 
     // If no children, we are done
@@ -129,6 +349,191 @@ void XMLNode::readXML(io::IXMLReader *xml)
     }   // while
 }   // readXML
 
+// ----------------------------------------------------------------------------
+/** Appends this node and all its children in binary form to a string.
+ *  \param out The data is appended to this string.
+ *  \param ids Maps the ids of all names used to the index of the name in
+ *         the string table of the binary data. New names are added.
+ */
+void XMLNode::writeBinary(std::string *out,
+                          std::map<uint32_t, uint32_t> *ids) const
+{
+    auto local_id = [ids](uint32_t id)
+    {
+        return ids->insert(std::make_pair(id, (uint32_t)ids->size()))
+                  .first->second;
+    };
+    DiskCache::addU32(out, local_id(getNameID(m_name)));
+    DiskCache::addU32(out, (uint32_t)m_attributes.size());
+    for (unsigned int i = 0; i < m_attributes.size(); i++)
+    {
+        DiskCache::addU32(out, local_id(m_attributes[i].first));
+        addString(out, m_attributes[i].second);
+    }
+    DiskCache::addU32(out, (uint32_t)m_nodes.size());
+    for (unsigned int i = 0; i < m_nodes.size(); i++)
+        m_nodes[i]->writeBinary(out, ids);
+}   // writeBinary
+
+// ----------------------------------------------------------------------------
+/** Reads a node and all its children written by writeBinary.
+ *  \param data Pointer to the data, will be advanced to the end of the node.
+ *  \param end End of the data.
+ *  \param ids Maps the index in the string table to the name id.
+ *  \param depth Depth of this node in the tree.
+ *  \return False if the data is invalid.
+ */
+bool XMLNode::readBinary(const char **data, const char *end,
+                         const std::vector<uint32_t> &ids, int depth)
+{
+    if (depth > MAX_CACHE_DEPTH)
+        return false;
+    uint32_t name, count;
+    if (!DiskCache::getU32(data, end, &name) || name >= ids.size() ||
+        !DiskCache::getU32(data, end, &count) ||
+        count > (uint32_t)(end - *data))
+        return false;
+    m_name = getInternedName(ids[name]);
+    m_attributes.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        uint32_t id;
+        if (!DiskCache::getU32(data, end, &id) || id >= ids.size() ||
+            !getString(data, end, &m_attributes[i].second))
+            return false;
+        m_attributes[i].first = ids[id];
+    }
+    if (!DiskCache::getU32(data, end, &count) ||
+        count > (uint32_t)(end - *data))
+        return false;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        XMLNode *node = new XMLNode();
+        node->m_file_name = m_file_name;
+        m_nodes.push_back(node);
+        if (!node->readBinary(data, end, ids, depth + 1))
+            return false;
+    }
+    return true;
+}   // readBinary
+
+// ----------------------------------------------------------------------------
+/** Returns this tree in binary form: the table of all names used, followed
+ *  by the nodes.
+ */
+std::string XMLNode::toBinary() const
+{
+    std::map<uint32_t, uint32_t> ids;
+    std::string nodes;
+    writeBinary(&nodes, &ids);
+
+    std::vector<uint32_t> names(ids.size());
+    for (auto &id : ids)
+        names[id.second] = id.first;
+    std::string out;
+    DiskCache::addU32(&out, (uint32_t)names.size());
+    for (uint32_t id : names)
+    {
+        const std::string &name = getInternedName(id);
+        DiskCache::addU32(&out, (uint32_t)name.size());
+        out += name;
+    }
+    return out + nodes;
+}   // toBinary
+
+// ----------------------------------------------------------------------------
+/** Replaces the content of this (empty) node with a tree created by
+ *  toBinary.
+ *  \return False if the data is invalid (in which case the node is empty).
+ */
+bool XMLNode::fromBinary(const char *data, size_t size)
+{
+    const char *end = data + size;
+    uint32_t count;
+    bool ok = DiskCache::getU32(&data, end, &count) && count <= size;
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        uint32_t len;
+        ok = DiskCache::getU32(&data, end, &len) &&
+             len <= (uint32_t)(end - data);
+        if (ok)
+        {
+            ids.push_back(getNameID(std::string(data, len)));
+            data += len;
+        }
+    }
+    ok = ok && readBinary(&data, end, ids, 0) && data == end;
+    if (!ok)
+    {
+        for (unsigned int i = 0; i < m_nodes.size(); i++)
+            delete m_nodes[i];
+        m_nodes.clear();
+        m_attributes.clear();
+        m_name = "";
+    }
+    return ok;
+}   // fromBinary
+
+// ----------------------------------------------------------------------------
+/** Returns the name of the cache file for an XML file with the given
+ *  content, or an empty string if XML files can not be cached.
+ *  \param data The content of the XML file.
+ *  \param size Size of the content.
+ */
+std::string XMLNode::getCacheFileName(const char *data, size_t size)
+{
+    const DiskCache *cache = file_manager->getXMLCache();
+    if (!cache->isEnabled())
+        return "";
+    return cache->getFileName(DiskCache::hash(data, size));
+}   // getCacheFileName
+
+// ----------------------------------------------------------------------------
+/** Reads this tree from a cache file.
+ *  \param cache_file Name of the cache file.
+ *  \param size Size of the XML file, which is stored in the cache file as
+ *         an additional check.
+ *  \return False if the cache file does not exist or is invalid.
+ */
+bool XMLNode::readCache(const std::string &cache_file, size_t size)
+{
+    MappedFile file;
+    if (!file.open(cache_file))
+        return false;
+    const char *data = file.getData();
+    const char *end  = data + file.getSize();
+    uint32_t version, size_low, size_high;
+    if (end - data < 16 || memcmp(data, "STKX", 4) != 0)
+        return false;
+    data += 4;
+    DiskCache::getU32(&data, end, &version);
+    DiskCache::getU32(&data, end, &size_low);
+    DiskCache::getU32(&data, end, &size_high);
+    if (version != CACHE_VERSION ||
+        (((uint64_t)size_high << 32) | size_low) != (uint64_t)size)
+        return false;
+    if (!fromBinary(data, end - data))
+        return false;
+    file_manager->getXMLCache()->touchFile(cache_file);
+    return true;
+}   // readCache
+
+// ----------------------------------------------------------------------------
+/** Writes this tree to a cache file.
+ *  \param cache_file Name of the cache file.
+ *  \param size Size of the XML file.
+ */
+void XMLNode::writeCache(const std::string &cache_file, size_t size) const
+{
+    std::string data = "STKX";
+    DiskCache::addU32(&data, CACHE_VERSION);
+    DiskCache::addU32(&data, (uint32_t)((uint64_t)size & 0xffffffff));
+    DiskCache::addU32(&data, (uint32_t)((uint64_t)size >> 32));
+    data += toBinary();
+    file_manager->getXMLCache()->writeFile(cache_file, data);
+}   // writeCache
+
 // ----------------------------------------------------------------------------
 /** Returns the i.th node.
  *  \param i Number of node to return.
@@ -170,41 +575,42 @@ const void XMLNode::getNodes(const std::string &s, std::vector<XMLNode*>& out) c
 // ----------------------------------------------------------------------------
 /** If 'attribute' was defined, set 'value' to the value of the
 *   attribute and return 1, otherwise return 0 and do not change value.
-*  \param attribute Name of the attribute.
+*  \param attribute Id of the attribute (see getNameID).
 *  \param value Value of the attribute.
 */
-int XMLNode::get(const std::string &attribute, std::string *value) const
+int XMLNode::get(uint32_t attribute, std::string *value) const
 {
-    if(m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if(o==m_attributes.end()) return 0;
-    *value=core::stringc(o->second).c_str();
+    const core::stringw *o = getAttribute(attribute);
+    if(!o) return 0;
+    *value=core::stringc(*o).c_str();
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, core::stringw *value) const
+int XMLNode::get(uint32_t attribute, core::stringw *value) const
 {
-    if(m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if(o==m_attributes.end()) return 0;
-    *value = o->second;
+    const core::stringw *o = getAttribute(attribute);
+    if(!o) return 0;
+    *value = *o;
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
-int XMLNode::getAndDecode(const std::string &attribute, core::stringw *value) const
+int XMLNode::getAndDecode(uint32_t attribute, core::stringw *value) const
 {
-    if (m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if (o == m_attributes.end()) return 0;
-    std::string raw_value = core::stringc(o->second).c_str();
+    const core::stringw *o = getAttribute(attribute);
+    if (!o) return 0;
+    std::string raw_value = core::stringc(*o).c_str();
     *value = StringUtils::xmlDecode(raw_value);
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, core::vector2df *value) const
+int XMLNode::getAndDecode(const std::string &attribute,
+                          core::stringw *value) const
+{
+    uint32_t id;
+    return findAttributeID(attribute, &id) ? getAndDecode(id, value) : 0;
+}   // getAndDecode
+// ----------------------------------------------------------------------------
+int XMLNode::get(uint32_t attribute, core::vector2df *value) const
 {
     std::string s = "";
     if(!get(attribute, &s)) return 0;
@@ -217,7 +623,7 @@ int XMLNode::get(const std::string &attribute, core::vector2df *value) const
 }   // get(vector2df)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, core::vector3df *value) const
+int XMLNode::get(uint32_t attribute, core::vector3df *value) const
 {
     Vec3 xyz;
     if(!get(attribute, &xyz)) return 0;
@@ -227,7 +633,7 @@ int XMLNode::get(const std::string &attribute, core::vector3df *value) const
 }   // get(vector3df)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, Vec3 *value) const
+int XMLNode::get(uint32_t attribute, Vec3 *value) const
 {
     std::string s = "";
     if(!get(attribute, &s)) return 0;
@@ -261,7 +667,7 @@ int XMLNode::get(const std::string &attribute, Vec3 *value) const
 }   // get(Vec3)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, video::SColor *color) const
+int XMLNode::get(uint32_t attribute, video::SColor *color) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -285,7 +691,7 @@ int XMLNode::get(const std::string &attribute, video::SColor *color) const
 }   // get(SColor)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, video::SColorf *color) const
+int XMLNode::get(uint32_t attribute, video::SColorf *color) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -310,7 +716,7 @@ int XMLNode::get(const std::string &attribute, video::SColorf *color) const
     return 1;
 }   // get(SColor)
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, int32_t *value) const
+int XMLNode::get(uint32_t attribute, int32_t *value) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -318,7 +724,7 @@ int XMLNode::get(const std::string &attribute, int32_t *value) const
     if (!StringUtils::parseString<int>(s, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected int but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    s.c_str(), getInternedName(attribute).c_str(), m_name.c_str(), m_file_name.c_str());
         return 0;
     }
 
@@ -326,7 +732,7 @@ int XMLNode::get(const std::string &attribute, int32_t *value) const
 }   // get(int32_t)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, int64_t *value) const
+int XMLNode::get(uint32_t attribute, int64_t *value) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -334,7 +740,7 @@ int XMLNode::get(const std::string &attribute, int64_t *value) const
     if (!StringUtils::parseString<int64_t>(s, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected int but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    s.c_str(), getInternedName(attribute).c_str(), m_name.c_str(), m_file_name.c_str());
         return 0;
     }
 
@@ -343,7 +749,7 @@ int XMLNode::get(const std::string &attribute, int64_t *value) const
 
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, uint16_t *value) const
+int XMLNode::get(uint32_t attribute, uint16_t *value) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -351,7 +757,7 @@ int XMLNode::get(const std::string &attribute, uint16_t *value) const
     if (!StringUtils::parseString<uint16_t>(s, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected uint but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    s.c_str(), getInternedName(attribute).c_str(), m_name.c_str(), m_file_name.c_str());
         return 0;
     }
 
@@ -359,7 +765,7 @@ int XMLNode::get(const std::string &attribute, uint16_t *value) const
 }   // get(uint32_t)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, uint32_t *value) const
+int XMLNode::get(uint32_t attribute, uint32_t *value) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -367,7 +773,7 @@ int XMLNode::get(const std::string &attribute, uint32_t *value) const
     if (!StringUtils::parseString<unsigned int>(s, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected uint but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    s.c_str(), getInternedName(attribute).c_str(), m_name.c_str(), m_file_name.c_str());
         return 0;
     }
 
@@ -375,7 +781,7 @@ int XMLNode::get(const std::string &attribute, uint32_t *value) const
 }   // get(uint32_t)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, float *value) const
+int XMLNode::get(uint32_t attribute, float *value) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -383,7 +789,7 @@ int XMLNode::get(const std::string &attribute, float *value) const
     if (!StringUtils::parseString<float>(s, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected float but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    s.c_str(), getInternedName(attribute).c_str(), m_name.c_str(), m_file_name.c_str());
         return 0;
     }
 
@@ -391,7 +797,7 @@ int XMLNode::get(const std::string &attribute, float *value) const
 }   // get(int)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, double *value) const
+int XMLNode::get(uint32_t attribute, double *value) const
 {
     std::string s;
     if (!get(attribute, &s)) return 0;
@@ -400,7 +806,8 @@ int XMLNode::get(const std::string &attribute, double *value) const
     {
         Log::warn("[XMLNode]", "WARNING: Expected double but found '%s' for"
             " attribute '%s' of node '%s' in file %s", s.c_str(),
-            attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+            getInternedName(attribute).c_str(), m_name.c_str(),
+            m_file_name.c_str());
         return 0;
     }
 
@@ -408,7 +815,7 @@ int XMLNode::get(const std::string &attribute, double *value) const
 }   // get(int)
 
 // ----------------------------------------------------------------------------
-int XMLNode::get(const std::string &attribute, bool *value) const
+int XMLNode::get(uint32_t attribute, bool *value) const
 {
     std::string s;
 
@@ -423,10 +830,10 @@ int XMLNode::get(const std::string &attribute, bool *value) const
 /** If 'attribute' was defined, split the value of the attribute by spaces,
  *  set value to this vector array and return the number of elements. Otherwise
  *  return 0 and do not change value.
- *  \param attribute Name of the attribute.
+ *  \param attribute Id of the attribute (see getNameID).
  *  \param value Value of the attribute.
  */
-int XMLNode::get(const std::string &attribute,
+int XMLNode::get(uint32_t attribute,
                  std::vector<std::string> *value) const
 {
     std::string s;
@@ -440,10 +847,10 @@ int XMLNode::get(const std::string &attribute,
 /** If 'attribute' was defined, split the value of the attribute by spaces,
  *  set value to this vector array and return the number of elements. Otherwise
  *  return 0 and do not change value.
- *  \param attribute Name of the attribute.
+ *  \param attribute Id of the attribute (see getNameID).
  *  \param value Value of the attribute.
  */
-int XMLNode::get(const std::string &attribute,
+int XMLNode::get(uint32_t attribute,
                  std::vector<float> *value) const
 {
     std::string s;
@@ -459,7 +866,7 @@ int XMLNode::get(const std::string &attribute,
         if (!StringUtils::parseString<float>(v[i], &curr))
         {
             Log::warn("[XMLNode]", "WARNING: Expected float but found '%s' for attribute '%s' of node '%s' in file %s",
-                        v[i].c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                        v[i].c_str(), getInternedName(attribute).c_str(), m_name.c_str(), m_file_name.c_str());
             return 0;
         }
 
@@ -472,10 +879,10 @@ int XMLNode::get(const std::string &attribute,
 /** If 'attribute' was defined, split the value of the attribute by spaces,
  *  set value to this vector array and return the number of elements. Otherwise
  *  return 0 and do not change value.
- *  \param attribute Name of the attribute.
+ *  \param attribute Id of the attribute (see getNameID).
  *  \param value Value of the attribute.
  */
-int XMLNode::get(const std::string &attribute, std::vector<int> *value) const
+int XMLNode::get(uint32_t attribute, std::vector<int> *value) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -490,7 +897,7 @@ int XMLNode::get(const std::string &attribute, std::vector<int> *value) const
         if (!StringUtils::parseString<int>(v[i], &val))
         {
             Log::warn("[XMLNode]", "WARNING: Expected int but found '%s' for attribute '%s' of node '%s'",
-                        v[i].c_str(), attribute.c_str(), m_name.c_str());
+                        v[i].c_str(), getInternedName(attribute).c_str(), m_name.c_str());
             return 0;
         }
 
@@ -504,11 +911,11 @@ int XMLNode::get(const std::string &attribute, std::vector<int> *value) const
  *  x0:y0 x1:y1 x2:y2 ...
  *  and the X values must be sorted. The function will abort (exit) with
  *  an error message in case of incorrectly formed x:y pairs.
- *  \param attribute Name of the attribute.
+ *  \param attribute Id of the attribute (see getNameID).
  *  \param value The InterpolationArray.
  *  \returns 0 in case of an error, !=0 otherwise
  */
-int XMLNode::get(const std::string &attribute, InterpolationArray *value) const
+int XMLNode::get(uint32_t attribute, InterpolationArray *value) const
 {
     std::string s;
     if(!get(attribute, &s)) return 0;
@@ -520,7 +927,7 @@ int XMLNode::get(const std::string &attribute, InterpolationArray *value) const
         if(pair.size()!=2)
         {
             Log::fatal("[XMLNode]", "Incorrect interpolation pair '%s' in '%s'.",
-                        pairs[i].c_str(), attribute.c_str());
+                        pairs[i].c_str(), getInternedName(attribute).c_str());
             Log::fatal("[XMLNode]", "Must be x:y.");
             exit(-1);
         }
@@ -528,14 +935,14 @@ int XMLNode::get(const std::string &attribute, InterpolationArray *value) const
         if(!StringUtils::fromString(pair[0], x))
         {
             Log::fatal("[XMLNode]", "Incorrect x in pair '%s' of '%s'.",
-                   pairs[i].c_str(), attribute.c_str());
+                   pairs[i].c_str(), getInternedName(attribute).c_str());
             exit(-1);
         }
         float y;
         if(!StringUtils::fromString(pair[1], y))
         {
             Log::fatal("[XMLNode]", "Incorrect y in pair '%s' in '%s'.",
-                  pair[1].c_str(), attribute.c_str());
+                  pair[1].c_str(), getInternedName(attribute).c_str());
             exit(-1);
         }
         if(!value->push_back(x, y))
@@ -556,14 +963,18 @@ int XMLNode::get(const std::string &attribute, InterpolationArray *value) const
  */
 int XMLNode::get(core::vector3df *value) const
 {
+    // The ids never change, so they are only looked up once
+    static const uint32_t x = getNameID("x"), y = getNameID("y"),
+                          z = getNameID("z"), h = getNameID("h"),
+                          p = getNameID("p"), r = getNameID("r");
     float f;
     int bits=0;
-    if(get("x", &f)) { value->X = f; bits |= 1; }
-    if(get("h", &f)) { value->X = f; bits |= 1; }
-    if(get("y", &f)) { value->Y = f; bits |= 2; }
-    if(get("p", &f)) { value->Y = f; bits |= 2; }
-    if(get("z", &f)) { value->Z = f; bits |= 4; }
-    if(get("r", &f)) { value->Z = f; bits |= 4; }
+    if(get(x, &f)) { value->X = f; bits |= 1; }
+    if(get(h, &f)) { value->X = f; bits |= 1; }
+    if(get(y, &f)) { value->Y = f; bits |= 2; }
+    if(get(p, &f)) { value->Y = f; bits |= 2; }
+    if(get(z, &f)) { value->Z = f; bits |= 4; }
+    if(get(r, &f)) { value->Z = f; bits |= 4; }
     return bits;
 }   // core::vector3df
 
@@ -577,11 +988,13 @@ int XMLNode::get(core::vector3df *value) const
  */
 int XMLNode::getXYZ(core::vector3df *value) const
 {
+    static const uint32_t x = getNameID("x"), y = getNameID("y"),
+                          z = getNameID("z");
     float f;
     int bits=0;
-    if(get("x", &f)) { value->X = f; bits |= 1; }
-    if(get("y", &f)) { value->Y = f; bits |= 2; }
-    if(get("z", &f)) { value->Z = f; bits |= 4; }
+    if(get(x, &f)) { value->X = f; bits |= 1; }
+    if(get(y, &f)) { value->Y = f; bits |= 2; }
+    if(get(z, &f)) { value->Z = f; bits |= 4; }
     return bits;
 }   // getXYZ vector3df
 
@@ -595,11 +1008,13 @@ int XMLNode::getXYZ(core::vector3df *value) const
  */
 int XMLNode::getXYZ(Vec3 *value) const
 {
+    static const uint32_t x = getNameID("x"), y = getNameID("y"),
+                          z = getNameID("z");
     float f;
     int bits=0;
-    if(get("x", &f)) { value->setX(f); bits |= 1; }
-    if(get("y", &f)) { value->setY(f); bits |= 2; }
-    if(get("z", &f)) { value->setZ(f); bits |= 4; }
+    if(get(x, &f)) { value->setX(f); bits |= 1; }
+    if(get(y, &f)) { value->setY(f); bits |= 2; }
+    if(get(z, &f)) { value->setZ(f); bits |= 4; }
     return bits;
 }   // getXYZ Vec3
 
@@ -613,11 +1028,13 @@ int XMLNode::getXYZ(Vec3 *value) const
  */
 int XMLNode::getHPR(core::vector3df *value) const
 {
+    static const uint32_t h = getNameID("h"), p = getNameID("p"),
+                          r = getNameID("r");
     float f;
     int bits=0;
-    if(get("h", &f)) { value->X = f; bits |= 1; }
-    if(get("p", &f)) { value->Y = f; bits |= 2; }
-    if(get("r", &f)) { value->Z = f; bits |= 4; }
+    if(get(h, &f)) { value->X = f; bits |= 1; }
+    if(get(p, &f)) { value->Y = f; bits |= 2; }
+    if(get(r, &f)) { value->Z = f; bits |= 4; }
     return bits;
 }   // getHPR vector3df
 
@@ -631,11 +1048,13 @@ int XMLNode::getHPR(core::vector3df *value) const
  */
 int XMLNode::getHPR(Vec3 *value) const
 {
+    static const uint32_t h = getNameID("h"), p = getNameID("p"),
+                          r = getNameID("r");
     float f;
     int bits=0;
-    if(get("h", &f)) { value->setX(f); bits |= 1; }
-    if(get("p", &f)) { value->setY(f); bits |= 2; }
-    if(get("r", &f)) { value->setZ(f); bits |= 4; }
+    if(get(h, &f)) { value->setX(f); bits |= 1; }
+    if(get(p, &f)) { value->setY(f); bits |= 2; }
+    if(get(r, &f)) { value->setZ(f); bits |= 4; }
     return bits;
 }   // getHPR Vec3
 
@@ -649,3 +1068,102 @@ bool XMLNode::hasChildNamed(const char* name) const
     }
     return false;
 }
+
+// ----------------------------------------------------------------------------
+/** Tests that a tree converted to the binary cache format and back is
+ *  identical to the original tree, that invalid data is rejected, and that
+ *  names interned on several threads at the same time get the same ids.
+ */
+void XMLNode::unitTesting()
+{
+    const std::string xml =
+        "<root a=\"1\" b=\"text with spaces\" a=\"2\">\n"
+        "  <child x=\"1.5\" y=\"-2\" z=\"3e2\"/>\n"
+        "  <child name=\"second\"><grandchild/></child>\n"
+        "  <other empty=\"\"/>\n"
+        "</root>\n";
+    XMLNode *original = file_manager->createXMLTreeFromString(xml);
+    assert(original);
+    // The last value of a repeated attribute is used
+    int a = 0;
+    bool found = original->get("a", &a) == 1;
+    assert(found && a == 2);
+    (void)found;
+
+    // Add a value that needs more than one byte per character
+    core::stringw wide = L"wide";
+    wide.append((wchar_t)0x263a);
+    original->m_nodes[2]->m_attributes.push_back(
+        std::make_pair(getNameID("wide"), wide));
+
+    std::string data = original->toBinary();
+    XMLNode copy;
+    bool ok = copy.fromBinary(data.data(), data.size());
+    assert(ok);
+    (void)ok;
+
+    std::function<void(const XMLNode*, const XMLNode*)> compare =
+        [&compare](const XMLNode *n1, const XMLNode *n2)
+    {
+        assert(n1->getName() == n2->getName());
+        assert(n1->m_attributes == n2->m_attributes);
+        assert(n1->getNumNodes() == n2->getNumNodes());
+        for (unsigned int i = 0; i < n1->getNumNodes(); i++)
+            compare(n1->getNode(i), n2->getNode(i));
+    };
+    compare(original, &copy);
+
+    Vec3 xyz;
+    int bits = copy.getNode("child")->getXYZ(&xyz);
+    assert(bits == 7 && xyz == Vec3(1.5f, -2.0f, 300.0f));
+    (void)bits;
+    std::string s;
+    found = copy.get("b", &s) == 1;
+    assert(found && s == "text with spaces");
+    found = copy.get("undefined-attribute-name", &s) == 1;
+    assert(!found);
+    s = "";
+    found = copy.get(getNameID("b"), &s) == 1;
+    assert(found && s == "text with spaces");
+
+    // Truncated or modified data must be rejected
+    for (unsigned int i = 0; i < data.size(); i++)
+    {
+        XMLNode truncated;
+        ok = truncated.fromBinary(data.data(), i);
+        assert(!ok && truncated.getNumNodes() == 0);
+    }
+    std::string longer = data + "x";
+    XMLNode invalid;
+    ok = invalid.fromBinary(longer.data(), longer.size());
+    assert(!ok);
+
+    delete original;
+
+    // Intern the same new names on several threads at the same time
+    const unsigned int num_threads = 4, num_names = 500;
+    std::vector<std::vector<uint32_t> > ids(num_threads);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; t++)
+    {
+        threads.emplace_back([&ids, t, num_names]()
+        {
+            for (unsigned int i = 0; i < num_names; i++)
+            {
+                ids[t].push_back(getNameID("unit-test-name-" +
+                                           StringUtils::toString(i)));
+            }
+        });
+    }
+    for (std::thread &t : threads)
+        t.join();
+    for (unsigned int i = 0; i < num_names; i++)
+    {
+        const std::string name = "unit-test-name-" + StringUtils::toString(i);
+        uint32_t id = 0;
+        found = findNameID(name, &id);
+        assert(found && getInternedName(id) == name);
+        for (unsigned int t = 0; t < num_threads; t++)
+            assert(ids[t][i] == id);
+    }
+}   // unitTesting
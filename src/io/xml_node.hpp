@@ -49,8 +49,10 @@ class XMLNode : public NoCopy
 private:
     /** Name of this element. */
     std::string                          m_name;
-    /** List of all attributes. */
-    std::map<std::string, core::stringw> m_attributes;
+    /** List of all attributes, as pairs of the interned id of the attribute
+     *  name (see getNameID) and the value. Nodes have only a few
+     *  attributes, so a linear search is faster than a map. */
+    std::vector<std::pair<uint32_t, core::stringw> > m_attributes;
     /** List of all sub nodes. */
     std::vector<XMLNode *>               m_nodes;
 
@@ -58,6 +60,41 @@ private:
 
     std::string                          m_file_name;
 
+         XMLNode() {}
+    const core::stringw *getAttribute(uint32_t attribute) const;
+    int get(uint32_t attribute, std::string *value) const;
+    int get(uint32_t attribute, core::stringw *value) const;
+    int getAndDecode(uint32_t attribute, core::stringw *value) const;
+    int get(uint32_t attribute, int32_t  *value) const;
+    int get(uint32_t attribute, uint16_t *value) const;
+    int get(uint32_t attribute, uint32_t *value) const;
+    int get(uint32_t attribute, int64_t  *value) const;
+    int get(uint32_t attribute, float *value) const;
+    int get(uint32_t attribute, double *value) const;
+    int get(uint32_t attribute, bool *value) const;
+    int get(uint32_t attribute, Vec3 *value) const;
+    int get(uint32_t attribute, core::vector2df *value) const;
+    int get(uint32_t attribute, core::vector3df *value) const;
+    int get(uint32_t attribute, video::SColorf *value) const;
+    int get(uint32_t attribute, video::SColor *value) const;
+    int get(uint32_t attribute, std::vector<std::string> *value) const;
+    int get(uint32_t attribute, std::vector<float> *value) const;
+    int get(uint32_t attribute, std::vector<int> *value) const;
+    int get(uint32_t attribute, InterpolationArray *value) const;
+    bool findAttributeID(const std::string &name, uint32_t *id) const;
+    static bool findNameID(const std::string &name, uint32_t *id);
+    static uint32_t getNameID(const std::string &name);
+    static const std::string &getInternedName(uint32_t id);
+    void writeBinary(std::string *out,
+                     std::map<uint32_t, uint32_t> *ids) const;
+    bool readBinary(const char **data, const char *end,
+                    const std::vector<uint32_t> &ids, int depth);
+    std::string toBinary() const;
+    bool fromBinary(const char *data, size_t size);
+    static std::string getCacheFileName(const char *data, size_t size);
+    bool readCache(const std::string &cache_file, size_t size);
+    void writeCache(const std::string &cache_file, size_t size) const;
+
 public:
          LEAK_CHECK();
          XMLNode(io::IXMLReader *xml);
@@ -72,25 +109,21 @@ public:
     const void         getNodes(const std::string &s, std::vector<XMLNode*>& out) const;
     const XMLNode     *getNode(unsigned int i) const;
     unsigned int       getNumNodes() const {return (unsigned int) m_nodes.size(); }
-    int get(const std::string &attribute, std::string *value) const;
-    int get(const std::string &attribute, core::stringw *value) const;
-    int getAndDecode(const std::string &attribute, core::stringw *value) const;
-    int get(const std::string &attribute, int32_t  *value) const;
-    int get(const std::string &attribute, uint16_t *value) const;
-    int get(const std::string &attribute, uint32_t *value) const;
-    int get(const std::string &attribute, int64_t  *value) const;
-    int get(const std::string &attribute, float *value) const;
-    int get(const std::string &attribute, double *value) const;
-    int get(const std::string &attribute, bool *value) const;
-    int get(const std::string &attribute, Vec3 *value) const;
-    int get(const std::string &attribute, core::vector2df *value) const;
-    int get(const std::string &attribute, core::vector3df *value) const;
-    int get(const std::string &attribute, video::SColorf *value) const;
-    int get(const std::string &attribute, video::SColor *value) const;
-    int get(const std::string &attribute, std::vector<std::string> *value) const;
-    int get(const std::string &attribute, std::vector<float> *value) const;
-    int get(const std::string &attribute, std::vector<int> *value) const;
-    int get(const std::string &attribute, InterpolationArray *value) const;
+    int getAndDecode(const std::string &attribute,
+                     core::stringw *value) const;
+    // ------------------------------------------------------------------------
+    /** If 'attribute' was defined, sets value to the value of the attribute
+     *  and returns a non-zero value (see the get function for the type of
+     *  value), otherwise returns 0 and does not change value.
+     *  \param attribute Name of the attribute.
+     *  \param value Value of the attribute. */
+    template<typename T>
+    int get(const std::string &attribute, T *value) const
+    {
+        uint32_t id;
+        return findAttributeID(attribute, &id) ? get(id, value) : 0;
+    }   // get
+    // ------------------------------------------------------------------------
     int get(core::vector3df *value) const;
     int getXYZ(core::vector3df *value) const;
     int getXYZ(Vec3 *vaslue) const;
@@ -98,6 +131,7 @@ public:
     int getHPR(Vec3 *value) const;
 
     bool hasChildNamed(const char* name) const;
+    static void unitTesting();
 
     /** Handy functions to test the bit pattern returned by get(vector3df*).*/
     static bool hasX(int b) { return (b&1)==1; }
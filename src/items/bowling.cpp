@@ -32,6 +32,8 @@ float Bowling::m_st_max_distance;   // maximum distance for a bowling ball to be
 float Bowling::m_st_max_distance_squared;
 float Bowling::m_st_force_to_target;
 
+DEFINE_OBJECT_POOL(Bowling, 1)
+
 // -----------------------------------------------------------------------------
 Bowling::Bowling(AbstractKart *kart)
         : Flyable(kart, PowerupManager::POWERUP_BOWLING, 50.0f /* mass */)
@@ -220,7 +222,7 @@ void Bowling::onFireFlyable()
 
     const Vec3& normal = m_owner->getNormal();
     createPhysics(y_offset, btVector3(0.0f, 0.0f, m_speed*2),
-                  new btSphereShape(0.5f*m_extend.getY()),
+                  getSphereShape(),
                   0.4f /*restitution*/,
                   -70.0f*normal /*gravity*/,
                   true /*rotates*/);
@@ -27,6 +27,7 @@ namespace irr
 using namespace irr;
 
 #include "items/flyable.hpp"
+#include "utils/object_pool.hpp"
 
 class XMLNode;
 class SFXBase;
@@ -36,6 +37,7 @@ class SFXBase;
   */
 class Bowling : public Flyable
 {
+    DECLARE_OBJECT_POOL()
 private:
     static float m_st_max_distance;   // maximum distance for a bowling ball to be attracted
     static float m_st_max_distance_squared;
@@ -31,6 +31,8 @@
 float Cake::m_st_max_distance_squared;
 float Cake::m_gravity;
 
+DEFINE_OBJECT_POOL(Cake, 1)
+
 Cake::Cake (AbstractKart *kart) : Flyable(kart, PowerupManager::POWERUP_CAKE)
 {
     m_target = NULL;
@@ -143,7 +145,7 @@ void Cake::onFireFlyable()
         m_initial_velocity = Vec3(0.0f, up_velocity, m_speed);
 
         createPhysics(forward_offset, m_initial_velocity,
-                      new btCylinderShape(0.5f*m_extend),
+                      getCylinderShape(),
                       0.5f /* restitution */, gravity_vector,
                       true /* rotation */, false /* backwards */, &trans);
     }
@@ -157,7 +159,7 @@ void Cake::onFireFlyable()
         m_initial_velocity = Vec3(0.0f, up_velocity, m_speed);
 
         createPhysics(forward_offset, m_initial_velocity,
-                      new btCylinderShape(0.5f*m_extend),
+                      getCylinderShape(),
                       0.5f /* restitution */, gravity_vector,
                       true /* rotation */, backwards, &trans);
     }
@@ -29,6 +29,7 @@ namespace irr
 #include <irrString.h>
 
 #include "items/flyable.hpp"
+#include "utils/object_pool.hpp"
 
 class XMLNode;
 
@@ -37,6 +38,7 @@ class XMLNode;
   */
 class Cake : public Flyable
 {
+    DECLARE_OBJECT_POOL()
 private:
     /** Maximum distance for a missile to be attracted. */
     static float m_st_max_distance_squared;
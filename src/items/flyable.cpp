@@ -59,6 +59,7 @@ float         Flyable::m_st_min_height  [PowerupManager::POWERUP_MAX];
 float         Flyable::m_st_max_height  [PowerupManager::POWERUP_MAX];
 float         Flyable::m_st_force_updown[PowerupManager::POWERUP_MAX];
 Vec3          Flyable::m_st_extend      [PowerupManager::POWERUP_MAX];
+btCollisionShape* Flyable::m_st_shape   [PowerupManager::POWERUP_MAX];
 // ----------------------------------------------------------------------------
 
 Flyable::Flyable(AbstractKart *kart, PowerupManager::PowerupType type,
@@ -209,8 +210,35 @@ void Flyable::init(const XMLNode &node, scene::IMesh *model,
     MeshTools::minMax3D(model, &min, &max);
     m_st_extend[type] = btVector3(max-min);
     m_st_model[type]  = model;
+    // The shape depends on the size, so it is recreated on next use
+    delete m_st_shape[type];
+    m_st_shape[type]  = NULL;
 }   // init
 
+// ----------------------------------------------------------------------------
+/** Returns the sphere shape shared by all flyables of this type, creating it
+ *  if necessary. Its radius is half the height of the model.
+ */
+btCollisionShape* Flyable::getSphereShape()
+{
+    if (!m_st_shape[m_type])
+        m_st_shape[m_type] = new btSphereShape(0.5f*m_extend.getY());
+    assert(m_st_shape[m_type]->getShapeType() == SPHERE_SHAPE_PROXYTYPE);
+    return m_st_shape[m_type];
+}   // getSphereShape
+
+// ----------------------------------------------------------------------------
+/** Returns the cylinder shape shared by all flyables of this type, creating
+ *  it if necessary. Its size is the size of the model.
+ */
+btCollisionShape* Flyable::getCylinderShape()
+{
+    if (!m_st_shape[m_type])
+        m_st_shape[m_type] = new btCylinderShape(0.5f*m_extend);
+    assert(m_st_shape[m_type]->getShapeType() == CYLINDER_SHAPE_PROXYTYPE);
+    return m_st_shape[m_type];
+}   // getCylinderShape
+
 //-----------------------------------------------------------------------------
 Flyable::~Flyable()
 {
@@ -226,11 +254,8 @@ Flyable::~Flyable()
 /* Called when delete this flyable or re-firing during rewind. */
 void Flyable::removePhysics()
 {
-    if (m_shape)
-    {
-        delete m_shape;
-        m_shape = NULL;
-    }
+    // The shape is shared with other flyables of this type
+    m_shape = NULL;
     if (m_body.get())
     {
         Physics::getInstance()->removeBody(m_body.get());
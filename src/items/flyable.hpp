@@ -83,7 +83,8 @@ protected:
     PowerupManager::PowerupType
                       m_type;
 
-    /** Collision shape of this Flyable. */
+    /** Collision shape of this Flyable. It is shared by all flyables of
+     *  the same type (see m_st_shape), so it must not be deleted. */
     btCollisionShape *m_shape;
 
     /** Maximum height above terrain. */
@@ -152,6 +153,11 @@ protected:
     /** Size of the model. */
     static Vec3       m_st_extend[PowerupManager::POWERUP_MAX];
 
+    /** The collision shape of each type. It only depends on the size of
+     *  the model, so it is created once and shared by all flyables of a
+     *  type instead of being created each time a flyable is fired. */
+    static btCollisionShape *m_st_shape[PowerupManager::POWERUP_MAX];
+
     /** Set to something > -1 if this flyable should auto-destrcut after
      *  that may ticks. */
     int               m_max_lifespan;
@@ -182,6 +188,8 @@ protected:
                                     const bool turn_around=false,
                                     const btTransform* customDirection=NULL);
 
+    btCollisionShape* getSphereShape();
+    btCollisionShape* getCylinderShape();
     void              moveToInfinity(bool set_moveable_trans = true);
     void              removePhysics();
 public:
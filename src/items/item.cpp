@@ -38,6 +38,9 @@
 #include <IMeshSceneNode.h>
 #include <ISceneManager.h>
 
+// Only used for items dropped during a race (e.g. bubble gums)
+DEFINE_OBJECT_POOL(Item, 2)
+
 
 // ----------------------------------------------------------------------------
 /** Constructor.
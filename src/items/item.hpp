@@ -28,6 +28,7 @@
 #include "utils/leak_check.hpp"
 #include "utils/log.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/object_pool.hpp"
 #include "utils/vec3.hpp"
 
 #include <line3d.h>
@@ -322,6 +323,7 @@ public:
   */
 class Item : public ItemState, public NoCopy
 {
+    DECLARE_OBJECT_POOL()
 
 private:
     /** Scene node of this item. */
@@ -36,6 +36,8 @@
 #include "utils/constants.hpp"
 #include "utils/string_utils.hpp"
 
+DEFINE_OBJECT_POOL(Plunger, 1)
+
 // -----------------------------------------------------------------------------
 Plunger::Plunger(AbstractKart *kart)
        : Flyable(kart, PowerupManager::POWERUP_PLUNGER)
@@ -98,14 +100,14 @@ void Plunger::onFireFlyable()
         m_initial_velocity = btVector3(0.0f, up_velocity, plunger_speed);
 
         createPhysics(forward_offset, m_initial_velocity,
-                      new btCylinderShape(0.5f*m_extend),
+                      getCylinderShape(),
                       0.5f /* restitution */ , btVector3(.0f,gravity,.0f),
                       /* rotates */false , /*turn around*/false, &trans);
     }
     else
     {
         createPhysics(forward_offset, btVector3(pitch, 0.0f, plunger_speed),
-                      new btCylinderShape(0.5f*m_extend),
+                      getCylinderShape(),
                       0.5f /* restitution */, btVector3(.0f,gravity,.0f),
                       false /* rotates */, m_reverse_mode, &kart_transform);
     }
@@ -26,6 +26,7 @@
 using namespace irr;
 
 #include "items/flyable.hpp"
+#include "utils/object_pool.hpp"
 
 class AbstractKart;
 class PhysicalObject;
@@ -37,6 +38,7 @@ class XMLNode;
   */
 class Plunger : public Flyable
 {
+    DECLARE_OBJECT_POOL()
 private:
     /** The rubber band attached to a plunger. */
     RubberBand  *m_rubber_band;
@@ -204,6 +204,8 @@ void PowerupManager::WeightsData::reset()
 {
     m_weights_for_section.clear();
     m_summed_weights_for_rank.clear();
+    m_alias_table.clear();
+    m_weight_sum_for_rank.clear();
     m_num_karts = 0;
 }   // reset
 
@@ -370,12 +372,17 @@ void PowerupManager::WeightsData::convertRankToSection(int rank, int *prev,
 /** This function computes the item distribution for each possible rank in the
  *  race. It creates a list which sums for each item the weights of all
  *  previous items.  E.g. if the weight list starts with 20, 30, 0, 10,
- *  the summed array will contains 20, 50, 50, 60. This allows for a quick
- *  look up based on a single random number.
+ *  the summed array will contains 20, 50, 50, 60. The actual lookup during
+ *  a race is done with an alias table built from the same weights (see
+ *  buildAliasTable), the summed list is kept for debugging and testing.
  */
 void PowerupManager::WeightsData::precomputeWeights()
 {
     m_summed_weights_for_rank.clear();
+    m_alias_table.clear();
+    m_weight_sum_for_rank.clear();
+    m_alias_table.reserve(m_num_karts * getNumItemEntries());
+    std::vector<unsigned> weights(getNumItemEntries());
     for (unsigned int i = 0; i<m_num_karts; i++)
     {
         m_summed_weights_for_rank.emplace_back();
@@ -383,16 +390,88 @@ void PowerupManager::WeightsData::precomputeWeights()
         float weight;
         convertRankToSection(i + 1, &prev, &next, &weight);
         int sum = 0;
-        for (unsigned int j = 0;
-            j <= 2 * POWERUP_LAST - POWERUP_FIRST; j++)
+        for (unsigned int j = 0; j < getNumItemEntries(); j++)
         {
             float av = (1.0f - weight) * m_weights_for_section[prev][j]
                      +         weight  * m_weights_for_section[next][j];
-            sum += int(av + 0.5f);
+            weights[j] = int(av + 0.5f);
+            sum += weights[j];
             m_summed_weights_for_rank[i].push_back(sum);
         }
+        m_weight_sum_for_rank.push_back(sum);
+        buildAliasTable(weights);
     }
 }   // WeightsData::precomputeWeights
+
+//-----------------------------------------------------------------------------
+/** Appends the alias table for one rank to m_alias_table (Vose's alias
+ *  method). The table has one bucket per item entry, and each bucket covers
+ *  'sum of all weights' random numbers. Since all weights are integers, each
+ *  item is picked by exactly weight * getNumItemEntries() of the
+ *  getNumRandomOutcomes() possible random numbers, i.e. the distribution is
+ *  reproduced exactly and not only approximately.
+ *  \param weights The (integer) weight of each item entry for this rank.
+ */
+void PowerupManager::WeightsData::buildAliasTable(
+                                            const std::vector<unsigned> &weights)
+{
+    const unsigned int num_entries = getNumItemEntries();
+    unsigned int bucket_size = 0;
+    for (unsigned int w : weights)
+        bucket_size += w;
+
+    // Scale all weights so that the average weight is the bucket size
+    std::vector<unsigned int> scaled(num_entries);
+    std::vector<unsigned int> small, large;
+    for (unsigned int i = 0; i < num_entries; i++)
+    {
+        scaled[i] = weights[i] * num_entries;
+        if (scaled[i] < bucket_size)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    const size_t start = m_alias_table.size();
+    m_alias_table.resize(start + num_entries);
+    AliasEntry *table = &m_alias_table[start];
+    // Fill each underfull bucket with the rest of an overfull one
+    while (!small.empty() && !large.empty())
+    {
+        unsigned int s = small.back();
+        small.pop_back();
+        unsigned int l = large.back();
+        table[s].m_threshold = scaled[s];
+        table[s].m_item      = (unsigned short)s;
+        table[s].m_alias     = (unsigned short)l;
+        scaled[l] -= bucket_size - scaled[s];
+        if (scaled[l] < bucket_size)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // With integer weights all remaining buckets are exactly full
+    large.insert(large.end(), small.begin(), small.end());
+    for (unsigned int i : large)
+    {
+        assert(scaled[i] == bucket_size);
+        table[i].m_threshold = bucket_size;
+        table[i].m_item      = (unsigned short)i;
+        table[i].m_alias     = (unsigned short)i;
+    }
+}   // WeightsData::buildAliasTable
+
+//-----------------------------------------------------------------------------
+/** Returns the number of different random numbers (modulo this value) that
+ *  getRandomItem distinguishes for the given rank.
+ *  \param rank The rank (between 0 and number_of_karts-1).
+ */
+uint64_t PowerupManager::WeightsData::getNumRandomOutcomes(int rank) const
+{
+    return uint64_t(getNumItemEntries()) * m_weight_sum_for_rank[rank];
+}   // WeightsData::getNumRandomOutcomes
+
 //-----------------------------------------------------------------------------
 /** Computes a random item dependent on the rank of the kart and a given
  *  random number.
@@ -404,36 +483,32 @@ void PowerupManager::WeightsData::precomputeWeights()
  *  \param random_number A random number used to 'randomly' select the item
  *         that was picked.
  */
-int PowerupManager::WeightsData::getRandomItem(int rank, uint64_t random_number)
+int PowerupManager::WeightsData::getRandomItem(int rank,
+                                               uint64_t random_number) const
 {
     // E.g. for battle mode with only one entry
-    if(rank>(int)m_summed_weights_for_rank.size())
-        rank = (int)m_summed_weights_for_rank.size()-1;
+    if(rank>=(int)m_weight_sum_for_rank.size())
+        rank = (int)m_weight_sum_for_rank.size()-1;
     else if (rank<0) rank = 0;  // E.g. battle mode, which has rank -1
-    const std::vector<unsigned> &summed_weights = m_summed_weights_for_rank[rank];
-    // The last entry is the sum of all previous entries, i.e. the maximum
-    // value
 #undef ITEM_DISTRIBUTION_DEBUG
 #ifdef ITEM_DISTRIBUTION_DEBUG
     uint64_t original_random_number = random_number;
 #endif
-    random_number = random_number % summed_weights.back();
-    // Put the random number in range [1;max of summed weights],
-    // so for sum = N, there are N possible random numbers <= N.
-    random_number++;
-    int powerup = 0;
-    // Stop at the first inferior or equal sum, before incrementing
-    // So stop while powerup is such that
-    // summed_weights[powerup-1] < random_number <= summed_weights[powerup]
-    while ( random_number > summed_weights[powerup] )
-        powerup++;
+    // Select a bucket of the alias table, then use the offset inside the
+    // bucket to decide between the bucket's own item and its alias.
+    const uint64_t bucket_size = m_weight_sum_for_rank[rank];
+    random_number = random_number % getNumRandomOutcomes(rank);
+    const AliasEntry &entry =
+        m_alias_table[rank * getNumItemEntries() + random_number / bucket_size];
+    int powerup = random_number % bucket_size < entry.m_threshold
+                ? entry.m_item : entry.m_alias;
 
     // We align with the beginning of the enum and return
     // We don't do more, because it would need to be decoded from enum later
 #ifdef ITEM_DISTRIBUTION_DEBUG
-    Log::verbose("Powerup", "World %d rank %d random %d %" PRIu64 " item %d",
-                 World::getWorld()->getTicksSinceStart(), rank, random_number,
-                 original_random_number, powerup);
+    Log::verbose("Powerup", "World %d rank %d random %" PRIu64 " %" PRIu64
+                 " item %d", World::getWorld()->getTicksSinceStart(), rank,
+                 random_number, original_random_number, powerup);
 #endif
 
     return powerup + POWERUP_FIRST;
@@ -627,8 +702,8 @@ void PowerupManager::unitTesting()
     race_manager->setMinorMode(RaceManager::MINOR_MODE_TUTORIAL);
     powerup_manager->computeWeightsForRace(1);
     WeightsData wd = powerup_manager->m_current_item_weights;
-    int num_weights = wd.m_summed_weights_for_rank[0].back();
-    for(int i=0; i<num_weights; i++)
+    uint64_t num_outcomes = wd.getNumRandomOutcomes(0);
+    for(uint64_t i=0; i<num_outcomes; i++)
     {
 #ifdef DEBUG
         unsigned int n;
@@ -650,11 +725,11 @@ void PowerupManager::unitTesting()
     wd.convertRankToSection(position, &section, &next, &weight);
     assert(weight == 1.0f);
     assert(section == next);
-    // Get the sum of all weights, which determine the number
-    // of different random numbers we need to test.
-    num_weights = wd.m_summed_weights_for_rank[section].back();
+    // Get the number of different random numbers we need to test, which
+    // is the sum of all weights times the number of alias table buckets.
+    num_outcomes = wd.getNumRandomOutcomes(position-1);
     std::vector<int> count(2*POWERUP_LAST);
-    for (int i = 0; i<num_weights; i++)
+    for (uint64_t i = 0; i<num_outcomes; i++)
     {
         unsigned int n;
         int powerup = powerup_manager->getRandomPowerup(position, &n, i);
@@ -667,6 +742,32 @@ void PowerupManager::unitTesting()
     // Now make sure we reproduce the original weight distribution.
     for(unsigned int i=0; i<wd.m_weights_for_section[section].size(); i++)
     {
-        assert(count[i] == wd.m_weights_for_section[section][i]);
+        assert(count[i] == (int)WeightsData::getNumItemEntries()
+                           * wd.m_weights_for_section[section][i]);
+    }
+
+    // Test 3: Check that the alias tables of all ranks of an interpolated
+    // distribution reproduce the summed weights exactly
+    // ---------------------------------------------------------------
+    num_karts = 9;
+    powerup_manager->computeWeightsForRace(num_karts);
+    wd = powerup_manager->m_current_item_weights;
+    for (int rank = 0; rank < num_karts; rank++)
+    {
+        const std::vector<unsigned> &summed = wd.m_summed_weights_for_rank[rank];
+        std::vector<unsigned> hits(summed.size());
+        num_outcomes = wd.getNumRandomOutcomes(rank);
+        for (uint64_t i = 0; i < num_outcomes; i++)
+            hits[wd.getRandomItem(rank, i) - POWERUP_FIRST]++;
+        // Random numbers larger than the number of outcomes must wrap
+        int item = wd.getRandomItem(rank, num_outcomes + 1);
+        assert(item == wd.getRandomItem(rank, 1));
+        (void)item;
+        for (unsigned int i = 0; i < summed.size(); i++)
+        {
+            unsigned int weight = summed[i] - (i > 0 ? summed[i - 1] : 0);
+            assert(hits[i] == WeightsData::getNumItemEntries() * weight);
+            (void)weight;
+        }
     }
 }   // unitTesting
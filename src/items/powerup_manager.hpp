@@ -98,6 +98,34 @@ private:
          *  weights for easy lookup during a race. */
         std::vector < std::vector<unsigned> > m_summed_weights_for_rank;
 
+        /** One entry of the alias table: a random number falling into this
+         *  bucket picks m_item if its offset in the bucket is less than
+         *  m_threshold, and m_alias otherwise. */
+        struct AliasEntry
+        {
+            unsigned int   m_threshold;
+            unsigned short m_item;
+            unsigned short m_alias;
+        };
+
+        /** Alias tables for all ranks, flattened into one array: the entries
+         *  for rank r start at r * getNumItemEntries(). Each bucket covers
+         *  m_weight_sum_for_rank[r] random numbers, so sampling is O(1). */
+        std::vector<AliasEntry> m_alias_table;
+
+        /** The sum of all (rounded) weights for each rank, which is the
+         *  size of each bucket in the alias table of that rank. */
+        std::vector<unsigned int> m_weight_sum_for_rank;
+
+        void buildAliasTable(const std::vector<unsigned> &weights);
+        // --------------------------------------------------------------------
+        /** Returns the number of entries per rank: all single items followed
+         *  by all triple items. */
+        static unsigned int getNumItemEntries()
+        {
+            return 2 * POWERUP_LAST - POWERUP_FIRST + 1;
+        }   // getNumItemEntries
+
     public:
         // The friend declaration gives the PowerupManager access to the
         // internals, which is ONLY used for testing!!
@@ -109,7 +137,8 @@ private:
         void convertRankToSection(int rank, int *prev, int *next,
                                  float *weight);
         void precomputeWeights();
-        int getRandomItem(int rank, uint64_t random_number);
+        int getRandomItem(int rank, uint64_t random_number) const;
+        uint64_t getNumRandomOutcomes(int rank) const;
         // --------------------------------------------------------------------
         /** Sets the number of karts. */
         void setNumKarts(int num_karts) { m_num_karts = num_karts; }
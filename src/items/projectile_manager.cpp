@@ -54,6 +54,9 @@ void ProjectileManager::removeTextures()
 void ProjectileManager::cleanup()
 {
     m_active_projectiles.clear();
+    m_grid_flyables.clear();
+    m_proximity_grid.clear();
+    m_grid_dirty = true;
     for(HitEffects::iterator i  = m_active_hit_effects.begin();
         i != m_active_hit_effects.end(); ++i)
     {
@@ -79,6 +82,7 @@ void ProjectileManager::updateGraphics(float dt)
 void ProjectileManager::update(int ticks)
 {
     updateServer(ticks);
+    m_grid_dirty = true;
 
     if (RewindManager::get()->isRewinding())
         return;
@@ -152,20 +156,22 @@ std::shared_ptr<Flyable>
         return it->second;
     }
 
+    // Not using make_shared, so that the object pool of each flyable
+    // class is used (see ObjectPool)
     std::shared_ptr<Flyable> f;
     switch(type)
     {
         case PowerupManager::POWERUP_BOWLING:
-            f = std::make_shared<Bowling>(kart);
+            f.reset(new Bowling(kart));
             break;
         case PowerupManager::POWERUP_PLUNGER:
-            f = std::make_shared<Plunger>(kart);
+            f.reset(new Plunger(kart));
             break;
         case PowerupManager::POWERUP_CAKE:
-            f = std::make_shared<Cake>(kart);
+            f.reset(new Cake(kart));
             break;
         case PowerupManager::POWERUP_RUBBERBALL:
-            f = std::make_shared<RubberBall>(kart);
+            f.reset(new RubberBall(kart));
             break;
         default:
             return nullptr;
@@ -173,12 +179,60 @@ std::shared_ptr<Flyable>
     // This cannot be done in constructor because of virtual function
     f->onFireFlyable();
     m_active_projectiles[uid] = f;
+    m_grid_dirty = true;
     if (RewindManager::get()->isEnabled())
         f->addForRewind(uid);
 
     return f;
 }   // newProjectile
 
+// -----------------------------------------------------------------------------
+/** Rebuilds the proximity grid from the current position of all active
+ *  projectiles, if it was invalidated.
+ */
+void ProjectileManager::updateProximityGrid()
+{
+    if (!m_grid_dirty)
+        return;
+    m_proximity_grid.clear();
+    m_grid_flyables.clear();
+    for (auto& p : m_active_projectiles)
+    {
+        m_proximity_grid.add(p.second->getXYZ(), (int)m_grid_flyables.size());
+        m_grid_flyables.push_back(p.second.get());
+    }
+    m_proximity_grid.build();
+    m_grid_dirty = false;
+}   // updateProximityGrid
+
+// -----------------------------------------------------------------------------
+/** Counts the projectiles (that have a server state) within the given
+ *  distance of a point by their type, without allocating any memory.
+ *  \param xyz The point.
+ *  \param radius Distance within which the projectiles must be.
+ *  \param counts Array of PowerupManager::POWERUP_MAX counters, the
+ *         counter of the type of each projectile found is increased.
+ *  \return The number of projectiles found.
+ */
+int ProjectileManager::countProjectilesByType(const Vec3 &xyz, float radius,
+                                              int *counts)
+{
+    updateProximityGrid();
+    int projectile_count = 0;
+    m_proximity_grid.forEachWithinRadius(xyz, radius,
+        [&](int id)
+        {
+            const Flyable *f = m_grid_flyables[id];
+            if (f->hasServerState())
+            {
+                counts[f->getType()]++;
+                projectile_count++;
+            }
+            return true;
+        });
+    return projectile_count;
+}   // countProjectilesByType
+
 // -----------------------------------------------------------------------------
 /** Returns true if a projectile is within the given distance of the specified
  *  kart.
@@ -188,17 +242,13 @@ std::shared_ptr<Flyable>
 bool ProjectileManager::projectileIsClose(const AbstractKart * const kart,
                                          float radius)
 {
-    float r2 = radius * radius;
-    for (auto i = m_active_projectiles.begin(); i != m_active_projectiles.end();
-        i++)
-    {
-        if (!i->second->hasServerState())
-            continue;
-        float dist2 = i->second->getXYZ().distance2(kart->getXYZ());
-        if (dist2 < r2)
-            return true;
-    }
-    return false;
+    updateProximityGrid();
+    // The search is stopped as soon as one projectile was found
+    return !m_proximity_grid.forEachWithinRadius(kart->getXYZ(), radius,
+        [this](int id)
+        {
+            return !m_grid_flyables[id]->hasServerState();
+        });
 }   // projectileIsClose
 
 // -----------------------------------------------------------------------------
@@ -212,25 +262,17 @@ int ProjectileManager::getNearbyProjectileCount(const AbstractKart * const kart,
                                          float radius, PowerupManager::PowerupType type,
                                          bool exclude_owned)
 {
-    float r2 = radius * radius;
+    updateProximityGrid();
     int projectile_count = 0;
-    for (auto i = m_active_projectiles.begin(); i != m_active_projectiles.end();
-         i++)
-    {
-        if (!i->second->hasServerState())
-            continue;
-        if (i->second->getType() == type)
+    m_proximity_grid.forEachWithinRadius(kart->getXYZ(), radius,
+        [&](int id)
         {
-            if (exclude_owned && (i->second->getOwner() == kart))
-                continue;
-
-            float dist2 = i->second->getXYZ().distance2(kart->getXYZ());
-            if (dist2 < r2)
-            {
+            const Flyable *f = m_grid_flyables[id];
+            if (f->hasServerState() && f->getType() == type &&
+                !(exclude_owned && f->getOwner() == kart))
                 projectile_count++;
-            }
-        }
-    }
+            return true;
+        });
     return projectile_count;
 }   // getNearbyProjectileCount
 
@@ -292,22 +334,22 @@ std::shared_ptr<Rewinder>
     {
         case RN_BOWLING:
         {
-            f = std::make_shared<Bowling>(kart);
+            f.reset(new Bowling(kart));
             break;
         }
         case RN_PLUNGER:
         {
-            f = std::make_shared<Plunger>(kart);
+            f.reset(new Plunger(kart));
             break;
         }
         case RN_CAKE:
         {
-            f = std::make_shared<Cake>(kart);
+            f.reset(new Cake(kart));
             break;
         }
         case RN_RUBBERBALL:
         {
-            f = std::make_shared<RubberBall>(kart);
+            f.reset(new RubberBall(kart));
             break;
         }
         default:
@@ -327,6 +369,7 @@ std::shared_ptr<Rewinder>
         created_ticks);
 
     m_active_projectiles[uid] = f;
+    m_grid_dirty = true;
     return f;
 }   // addProjectileFromNetworkState
 
@@ -31,6 +31,7 @@ namespace irr
 
 #include "items/powerup_manager.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/spatial_hash.hpp"
 
 class AbstractKart;
 class Flyable;
@@ -55,11 +56,24 @@ private:
      *  being shown or have a sfx playing. */
     HitEffects       m_active_hit_effects;
 
+    /** A spatial hash of all active projectiles, used for the proximity
+     *  queries. It is rebuilt on demand after it was invalidated. */
+    SpatialHash      m_proximity_grid;
+
+    /** The projectiles in the proximity grid, the id stored in the grid
+     *  is the index into this vector. */
+    std::vector<Flyable*> m_grid_flyables;
+
+    /** True if the proximity grid must be rebuilt before the next query. */
+    bool             m_grid_dirty;
+
     std::string      getUniqueIdentity(AbstractKart* kart,
                                        PowerupManager::PowerupType type);
     void             updateServer(int ticks);
+    void             updateProximityGrid();
 public:
-                     ProjectileManager() {}
+                     ProjectileManager() : m_proximity_grid(10.0f)
+                                         { m_grid_dirty = true; }
                     ~ProjectileManager() {}
     void             loadData         ();
     void             cleanup          ();
@@ -72,6 +86,12 @@ public:
     int              getNearbyProjectileCount(const AbstractKart * const kart,
                                        float radius, PowerupManager::PowerupType type,
                                        bool exclude_owned=false);
+    int              countProjectilesByType(const Vec3 &xyz, float radius,
+                                            int *counts);
+    // ------------------------------------------------------------------------
+    /** Called when projectiles have moved (i.e. once per time step), or
+     *  were added or removed, so that the proximity grid is rebuilt. */
+    void             invalidateProximityGrid()       { m_grid_dirty = true; }
     // ------------------------------------------------------------------------
     /** Adds a special hit effect to be shown.
      *  \param hit_effect The hit effect to be added. */
@@ -85,10 +105,16 @@ public:
                                            PowerupManager::PowerupType type);
     // ------------------------------------------------------------------------
     void addByUID(const std::string& uid, std::shared_ptr<Flyable> f)
-                                             { m_active_projectiles[uid] = f; }
+    {
+        m_active_projectiles[uid] = f;
+        m_grid_dirty = true;
+    }   // addByUID
     // ------------------------------------------------------------------------
     void removeByUID(const std::string& uid)
-                                           { m_active_projectiles.erase(uid); }
+    {
+        m_active_projectiles.erase(uid);
+        m_grid_dirty = true;
+    }   // removeByUID
 };
 
 extern ProjectileManager *projectile_manager;
@@ -48,6 +48,8 @@ float RubberBall::m_st_target_distance;
 float RubberBall::m_st_target_max_angle;
 int16_t RubberBall::m_st_delete_ticks;
 float RubberBall::m_st_max_height_difference;
+
+DEFINE_OBJECT_POOL(RubberBall, 1)
 float RubberBall::m_st_fast_ping_distance;
 float RubberBall::m_st_early_target_factor;
 float RubberBall::m_st_min_speed_offset;
@@ -86,7 +88,7 @@ void RubberBall::onFireFlyable()
         0.5f * m_owner->getKartLength() + m_extend.getZ() * 0.5f + 5.0f;
 
     createPhysics(forw_offset, btVector3(0.0f, 0.0f, m_speed*2),
-                  new btSphereShape(0.5f*m_extend.getY()), -70.0f,
+                  getSphereShape(), -70.0f,
                   btVector3(.0f,.0f,.0f) /*gravity*/,
                   true /*rotates*/);
 
@@ -24,6 +24,7 @@
 #include "items/flyable.hpp"
 #include "tracks/track_sector.hpp"
 #include "utils/cpp2011.hpp"
+#include "utils/object_pool.hpp"
 
 class AbstractKart;
 class SFXBase;
@@ -33,6 +34,7 @@ class SFXBase;
   */
 class RubberBall: public Flyable, public TrackSector
 {
+    DECLARE_OBJECT_POOL()
 private:
     /** Used in case of flyable debugging so that each output line gets
      *  a unique number for each ball. */
@@ -58,6 +58,8 @@
 #include <cstdio>
 #include <iostream>
 
+bool SkiddingAI::m_use_racing_line_table = false;
+
 SkiddingAI::SkiddingAI(AbstractKart *kart)
                    : AIBaseLapController(kart)
 {
@@ -66,7 +68,8 @@ SkiddingAI::SkiddingAI(AbstractKart *kart)
     // for the final race challenge against nolok.
     m_superpower = race_manager->getAISuperPower();
 
-    m_point_selection_algorithm = PSA_DEFAULT;
+    m_point_selection_algorithm = m_use_racing_line_table ? PSA_TABLE
+                                                          : PSA_DEFAULT;
     setControllerName("Skidding");
 
     // Use this define in order to compare the different algorithms that
@@ -80,6 +83,7 @@ SkiddingAI::SkiddingAI(AbstractKart *kart)
     {
     case PSA_NEW     : name = "New";     break;
     case PSA_DEFAULT : name = "Default"; break;
+    case PSA_TABLE   : name = "Table";   break;
     }
     setControllerName(name);
 #endif
@@ -463,6 +467,8 @@ void SkiddingAI::handleSteering(float dt)
                          break;
         case PSA_DEFAULT:findNonCrashingPoint(&aim_point, &last_node);
                          break;
+        case PSA_TABLE:  findNonCrashingPointTable(&aim_point, &last_node);
+                         break;
         }
 #ifdef AI_DEBUG
         m_debug_sphere[m_point_selection_algorithm]->setPosition(aim_point.toIrrVector());
@@ -1287,14 +1293,16 @@ void SkiddingAI::handleBubblegum(int item_skill,
 {
     float shield_radius = m_ai_properties->m_shield_incoming_radius;
 
-    int projectile_types[4]; //[3] basket, [2] cakes, [1] plunger, [0] bowling
-    projectile_types[0] = projectile_manager->getNearbyProjectileCount(m_kart, shield_radius, PowerupManager::POWERUP_BOWLING);
-    projectile_types[1] = projectile_manager->getNearbyProjectileCount(m_kart, shield_radius, PowerupManager::POWERUP_PLUNGER);
-    projectile_types[2] = projectile_manager->getNearbyProjectileCount(m_kart, shield_radius, PowerupManager::POWERUP_CAKE);
-    projectile_types[3] = projectile_manager->getNearbyProjectileCount(m_kart, shield_radius, PowerupManager::POWERUP_RUBBERBALL);
-   
-    bool projectile_is_close = false;
-    projectile_is_close = projectile_manager->projectileIsClose(m_kart, shield_radius);
+    // Query all close projectiles once and count them by type
+    int counts[PowerupManager::POWERUP_MAX] = { 0 };
+    bool projectile_is_close =
+        projectile_manager->countProjectilesByType(m_kart->getXYZ(),
+                                                   shield_radius, counts) > 0;
+    //[3] basket, [2] cakes, [1] plunger, [0] bowling
+    int projectile_types[4] = { counts[PowerupManager::POWERUP_BOWLING],
+                                counts[PowerupManager::POWERUP_PLUNGER],
+                                counts[PowerupManager::POWERUP_CAKE],
+                                counts[PowerupManager::POWERUP_RUBBERBALL] };
 
     Attachment::AttachmentType type = m_kart->getAttachment()->getType();
     
@@ -1907,13 +1915,8 @@ void SkiddingAI::computeNearestKarts()
     std::sort(overall_distance.begin(), overall_distance.end(), std::greater<float>());
    
     // Get the AI's position (the position update may not be done, leading to crashes)
-    int curr_position = 1;
-    for(unsigned int i=0; i<m_world->getNumKarts(); i++)
-    {
-        if(   m_world->getOverallDistance(i) > own_overall_distance
-           && !m_world->getKart(i)->isEliminated())
-            curr_position++;
-    }
+    int curr_position = 1 + m_world->getKartStates()
+        .countKartsAhead(own_overall_distance, KartStates::KS_ELIMINATED);
 
     for(unsigned int i=0; i<n; i++)
     {
@@ -1981,8 +1984,18 @@ void SkiddingAI::handleAccelerationAndBraking(int ticks)
 
     // FIXME - requires fixing of the turn radius bugs
 
-    float max_turn_speed =
-        m_kart->getSpeedForTurnRadius(m_current_curve_radius)*1.5f;
+    float max_turn_speed;
+    if(m_point_selection_algorithm==PSA_TABLE)
+    {
+        // The precomputed radius only depends on the track, so it does not
+        // change with the heading of the kart.
+        const DriveNode *dn = DriveGraph::get()->getNode(m_track_node);
+        float radius = dn->getCurveRadius(m_successor_index[m_track_node]);
+        max_turn_speed = m_kart->getSpeedForTurnRadius(radius)*1.5f;
+    }
+    else
+        max_turn_speed =
+            m_kart->getSpeedForTurnRadius(m_current_curve_radius)*1.5f;
 
     // A kart will not brake when the speed is already slower than this
     // value. This prevents a kart from going too slow (or even backwards)
@@ -2748,6 +2761,26 @@ void SkiddingAI::findNonCrashingPointNew(Vec3 *result, int *last_node)
     *aim_position = DriveGraph::get()->getNode(*last_node)->getCenter();
 }   // findNonCrashingPoint
 
+//-----------------------------------------------------------------------------
+/** Selects the point to aim at using the furthest visible node that was
+ *  precomputed by the drive graph for the current node, the successor the
+ *  kart is going to take, and the lateral position of the kart. This is
+ *  a constant time lookup, but it can not take the exact position and the
+ *  randomly selected successors at later forks into account (the
+ *  precomputed data stops at forks).
+ *  \param aim_position On exit contains the point the AI should aim at.
+ *  \param last_node On exit contains the graph node the AI is aiming at.
+ */
+void SkiddingAI::findNonCrashingPointTable(Vec3 *aim_position, int *last_node)
+{
+    const DriveNode *dn = DriveGraph::get()->getNode(m_track_node);
+    float lateral = m_world->getDistanceToCenterForKart(
+                                                   m_kart->getWorldKartId());
+    *last_node = dn->getFurthestVisibleNode(m_successor_index[m_track_node],
+                                            lateral);
+    *aim_position = DriveGraph::get()->getNode(*last_node)->getCenter();
+}   // findNonCrashingPointTable
+
 //-----------------------------------------------------------------------------
 /** Determines the direction of the track ahead of the kart: 0 indicates
  *  straight, +1 right turn, -1 left turn.
@@ -229,11 +229,20 @@ private:
      *     faster than a fixed version of findNonCrashingPoint, but does not
      *     give as good results as the 'buggy' one.
      *
+     *  3. findNonCrashingPointTable() Uses the furthest visible node that
+     *     was precomputed by the drive graph, which makes it the cheapest
+     *     one (see --ai-racing-line-table).
+     *
      *  So far the default one has by far the best performance, even though
      *  it has bugs. */
-    enum {PSA_DEFAULT, PSA_NEW}
+    enum {PSA_DEFAULT, PSA_NEW, PSA_TABLE}
           m_point_selection_algorithm;
 
+    /** Set from the command line: if true, all skidding AIs use the
+     *  racing line data precomputed by the drive graph (PSA_TABLE and the
+     *  precomputed curve radius to determine the maximum speed). */
+    static bool m_use_racing_line_table;
+
 #ifdef AI_DEBUG
     /** For skidding debugging: shows the estimated turn shape. */
     ShowCurve **m_curve;
@@ -287,6 +296,7 @@ private:
     void  checkCrashes(const Vec3& pos);
     void  findNonCrashingPointNew(Vec3 *result, int *last_node);
     void  findNonCrashingPoint(Vec3 *result, int *last_node);
+    void  findNonCrashingPointTable(Vec3 *result, int *last_node);
 
     void  determineTrackDirection();
     virtual bool canSkid(float steer_fraction);
@@ -302,6 +312,8 @@ public:
     virtual void update      (int ticks);
     virtual void reset       ();
     virtual const irr::core::stringw& getNamePostfix() const;
+    /** Enables the precomputed racing line data for all skidding AIs. */
+    static  void useRacingLineTable(bool b) { m_use_racing_line_table = b; }
 };
 
 #endif
@@ -32,6 +32,8 @@
 
 #include <cstring>
 
+DEFINE_OBJECT_POOL(ExplosionAnimation, 1)
+
 /** A static create function that does only create an explosion if
  *  the explosion happens to be close enough to affect the kart.
  *  Otherwise, NULL is returned.
@@ -20,6 +20,7 @@
 #define HEADER_EXPLOSION_ANIMATION_HPP
 
 #include "karts/abstract_kart_animation.hpp"
+#include "utils/object_pool.hpp"
 #include "utils/vec3.hpp"
 
 /**
@@ -36,6 +37,7 @@
  */
 class ExplosionAnimation: public AbstractKartAnimation
 {
+    DECLARE_OBJECT_POOL()
 protected:
 friend class KartRewinder;
     /** The normal of kart when it started to explode. */
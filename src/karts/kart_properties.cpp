@@ -184,7 +184,10 @@ void KartProperties::load(const std::string &filename, const std::string &node)
     // Get the default values from STKConfig. This will also allocate any
     // pointers used in KartProperties
 
-    const XMLNode* root = new XMLNode(filename);
+    // The file might have been parsed already at startup
+    const XMLNode* root = file_manager->takePreloadedXMLTree(filename);
+    if (!root)
+        root = new XMLNode(filename);
     std::string kart_type;
 
     if (root->get("type", &kart_type))
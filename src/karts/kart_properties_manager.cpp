@@ -181,6 +181,36 @@ void KartPropertiesManager::loadAllKarts(bool loading_icon)
     }   // for i
 }   // loadAllKarts
 
+//-----------------------------------------------------------------------------
+/** Appends the names of the XML files read when loading all karts (using
+ *  the same directory search as loadAllKarts), so that they can be parsed
+ *  in advance, see FileManager::preloadXMLTrees.
+ *  \param files The file names are appended to this vector.
+ */
+void KartPropertiesManager::getXMLFiles(std::vector<std::string> *files) const
+{
+    for (const std::string &dir : m_kart_search_path)
+    {
+        std::vector<std::string> kart_files;
+        if (file_manager->fileExists(dir + "/kart.xml"))
+            kart_files.push_back(dir + "/kart.xml");
+        else
+        {
+            std::set<std::string> result;
+            file_manager->listFiles(result, dir);
+            for (const std::string &subdir : result)
+                kart_files.push_back(dir + subdir + "/kart.xml");
+        }
+        for (const std::string &kart_file : kart_files)
+        {
+            files->push_back(kart_file);
+            // Same name as used in KartProperties::load
+            files->push_back(StringUtils::getPath(kart_file) +
+                             "/materials.xml");
+        }
+    }
+}   // getXMLFiles
+
 //-----------------------------------------------------------------------------
 /** Loads the characteristics from the characteristics config file.
  *  \param root The xml node where the characteristics are stored.
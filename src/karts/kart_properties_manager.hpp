@@ -89,6 +89,7 @@ public:
     void                     loadCharacteristics    (const XMLNode *root);
     bool                     loadKart               (const std::string &dir);
     void                     loadAllKarts           (bool loading_icon = true);
+    void                     getXMLFiles(std::vector<std::string> *files) const;
     void                     unloadAllKarts         ();
     void                     removeKart(const std::string &id);
     const std::vector<int>   getKartsInGroup        (const std::string& g);
@@ -33,6 +33,8 @@
 #include <algorithm>
 #include <cmath>
 
+DEFINE_OBJECT_POOL(RescueAnimation, 1)
+
 RescueAnimation* RescueAnimation::create(AbstractKart* kart,
                                          bool is_auto_rescue)
 {
@@ -20,6 +20,7 @@
 #define HEADER_RESCUE_ANIMATION_HPP
 
 #include "karts/abstract_kart_animation.hpp"
+#include "utils/object_pool.hpp"
 #include "utils/vec3.hpp"
 
 class AbstractKart;
@@ -30,6 +31,7 @@ class Referee;
  */
 class RescueAnimation: public AbstractKartAnimation
 {
+    DECLARE_OBJECT_POOL()
 protected:
 friend class KartRewinder;
     /** The velocity with which the kart is moved. */
@@ -209,12 +209,14 @@
 #include "items/projectile_manager.hpp"
 #include "karts/combined_characteristic.hpp"
 #include "karts/controller/ai_base_controller.hpp"
+#include "karts/controller/skidding_ai.hpp"
 #include "karts/controller/network_ai_controller.hpp"
 #include "karts/kart_model.hpp"
 #include "karts/kart_properties.hpp"
 #include "karts/kart_properties_manager.hpp"
 #include "modes/cutscene_world.hpp"
 #include "modes/demo_world.hpp"
+#include "modes/kart_ranking.hpp"
 #include "modes/profile_world.hpp"
 #include "network/protocols/connect_to_server.hpp"
 #include "network/protocols/client_lobby.hpp"
@@ -246,6 +248,8 @@
 #include "states_screens/dialogs/init_android_dialog.hpp"
 #include "states_screens/dialogs/message_dialog.hpp"
 #include "tracks/arena_graph.hpp"
+#include "tracks/check_manager.hpp"
+#include "tracks/graph.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
 #include "utils/command_line.hpp"
@@ -254,9 +258,13 @@
 #include "utils/leak_check.hpp"
 #include "utils/log.hpp"
 #include "utils/mini_glm.hpp"
+#include "utils/object_pool.hpp"
 #include "utils/profiler.hpp"
 #include "utils/separate_process.hpp"
+#include "utils/spatial_hash.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/time.hpp"
+#include "utils/time_histogram.hpp"
 #include "utils/translation.hpp"
 
 static void cleanSuperTuxKart();
@@ -590,9 +598,19 @@ void cmdLineHelp()
                               "laps.\n"
     "       --profile-time=n   Enable automatic driven profile mode for n "
                               "seconds.\n"
+    "       --profiler         Enable the profiler at startup (also without\n"
+    "                          graphics).\n"
     "       --unlock-all       Permanently unlock all karts and tracks for testing.\n"
     "       --no-unlock-all    Disable unlock-all (i.e. base unlocking on player achievement).\n"
     "       --no-graphics      Do not display the actual race.\n"
+    "       --benchmark-replays=dir Measure how long it takes to load all\n"
+    "                          replay files in the given directory.\n"
+    "       --fast-simulation  Simulate the race as fast as possible (one\n"
+    "                          physics step per frame, no graphics or sound)\n"
+    "                          and print the number of simulated ticks/s.\n"
+    "       --physics-threads=n Solve independent physics islands on n threads.\n"
+    "       --ai-racing-line-table Let the AI use the racing line data that is\n"
+    "                          precomputed when loading the drive graph.\n"
     "       --sp-shader-debug  Enables debug in sp shader, it will print all unavailable uniforms.\n"
     "       --demo-mode=t      Enables demo mode after t seconds of idle time in "
                                "main menu.\n"
@@ -601,6 +619,12 @@ void cmdLineHelp()
     "       --demo-laps=n      Number of laps to use in a demo.\n"
     "       --demo-karts=n     Number of karts to use in a demo.\n"
     // "       --history          Replay history file 'history.dat'.\n"
+    "       --history=file     Replay the given history file.\n"
+    "       --record-history=file Write the history to the given file while\n"
+    "                          racing (in a compact binary format).\n"
+    "       --history-checksums Record a checksum of all kart positions in\n"
+    "                          each time step, and report the first time\n"
+    "                          step at which a replayed history differs.\n"
     // "       --test-ai=n        Use the test-ai for every n-th AI kart.\n"
     // "                          (so n=1 means all Ais will be the test ai)\n"
     // "
@@ -654,6 +678,10 @@ void cmdLineHelp()
     "       --log=N            Set the verbosity to a value between\n"
     "                          0 (Debug) and 5 (Only Fatal messages)\n"
     "       --logbuffer=N      Buffers up to N lines log lines before writing.\n"
+    "       --log-sync         Write log messages immediately in the thread\n"
+    "                          that logs them, instead of in a separate thread.\n"
+    "       --log-rate-limit=N Print at most N messages per second of each\n"
+    "                          component (below warnings), 0 for no limit.\n"
     "       --root=DIR         Path to add to the list of STK root directories.\n"
     "                          You can specify more than one by separating them\n"
     "                          with colons (:).\n"
@@ -743,6 +771,12 @@ int handleCmdLineOutputModifier()
     }
     if(CommandLine::has("--no-console-log"))
         Log::toggleConsoleLog(false);
+    if (CommandLine::has("--log-rate-limit", &n))
+        Log::setRateLimit(n);
+    // Write log messages in a separate thread, so that bursts of messages
+    // don't stall the main loop
+    if (!CommandLine::has("--log-sync"))
+        Log::startAsyncWriter();
 
     return 0;
 }
@@ -937,9 +971,12 @@ int handleCmdLinePreliminary()
     if(CommandLine::has("--dont-load-navmesh"))
         Track::m_dont_load_navmesh = true;
 
-    if (CommandLine::has("--no-sound"))
+    if (CommandLine::has("--no-sound") || CommandLine::has("--fast-simulation"))
         UserConfigParams::m_enable_sound = false;
 
+    if (CommandLine::has("--physics-threads", &n))
+        UserConfigParams::m_physics_threads = n;
+
     if (CommandLine::has("--seed", &n))
     {
         srand(n);
@@ -987,6 +1024,8 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
         AIBaseController::enableDebug();
     if(CommandLine::has("--test-ai", &n))
         AIBaseController::setTestAI(n);
+    if(CommandLine::has("--ai-racing-line-table"))
+        SkiddingAI::useRacingLineTable(true);
     if (CommandLine::has("--fps-debug"))
         UserConfigParams::m_fps_debug = true;
     if (CommandLine::has("--rewind") )
@@ -1654,7 +1693,14 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
         race_manager->setNumLaps(999999); // profile end depends on time
     }   // --profile-time
 
-    if(CommandLine::has("--history"))
+    if(CommandLine::has("--history", &s))
+    {
+        history->setFilename(s);
+        history->setReplayHistory(true);
+        if (!History::m_online_history_replay)
+            UserConfigParams::m_no_start_screen = true;
+    }   // --history=file
+    else if(CommandLine::has("--history"))
     {
         history->setReplayHistory(true);
         // Force the no-start screen flag, since this initialises
@@ -1663,6 +1709,11 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
             UserConfigParams::m_no_start_screen = true;
     }   // --history
 
+    if(CommandLine::has("--record-history", &s))
+        history->setFilename(s);
+    if(CommandLine::has("--history-checksums"))
+        history->enableChecksums(true);
+
     // Demo mode
     if(CommandLine::has("--demo-mode", &s))
     {
@@ -1758,6 +1809,20 @@ void clearGlobalVariables()
     GUIEngine::resetGlobalVariables();
 }   // clearGlobalVariables
 
+//=============================================================================
+/** Logs the time since the previous call (or since STK was started), to
+ *  show how long each part of the initialisation takes.
+ *  \param phase Name of the phase that was just finished.
+ */
+static void logStartupPhase(const char *phase)
+{
+    static uint64_t previous = 0;
+    const uint64_t now = StkTime::getMonoTimeMs();
+    Log::info("main", "Startup: %s took %d ms (%d ms since start).", phase,
+              (int)(now - previous), (int)now);
+    previous = now;
+}   // logStartupPhase
+
 //=============================================================================
 void initRest()
 {
@@ -1795,6 +1860,7 @@ void initRest()
     GUIEngine::init(device, driver, StateManager::get());
 
     GUIEngine::renderLoading(true, true);
+    logStartupPhase("device and GUI");
     input_manager = new InputManager();
     // Get into menu mode initially.
     input_manager->setMode(InputManager::MENU);
@@ -1852,6 +1918,20 @@ void initRest()
     track_manager->addTrackSearchDir(
                  file_manager->getAddonsFile("tracks/"));
 
+    logStartupPhase("managers");
+
+    // Parse the XML files of all tracks and karts (and the achievements)
+    // concurrently. The managers still create their objects one after
+    // another in the usual order, but take the already parsed trees.
+    {
+        std::vector<std::string> files;
+        track_manager->getXMLFiles(&files);
+        kart_properties_manager->getXMLFiles(&files);
+        files.push_back(file_manager->getAsset("achievements.xml"));
+        file_manager->preloadXMLTrees(files);
+        logStartupPhase("parsing XML files");
+    }
+
     {
         XMLNode characteristicsNode(file_manager->getAsset("kart_characteristics.xml"));
         kart_properties_manager->loadCharacteristics(&characteristicsNode);
@@ -1859,6 +1939,7 @@ void initRest()
 
     track_manager->loadTrackList();
     music_manager->addMusicToTracks();
+    logStartupPhase("tracks");
 
     GUIEngine::addLoadingIcon(irr_driver->getTexture(FileManager::GUI_ICON,
                                                      "notes.png"      ) );
@@ -1867,6 +1948,7 @@ void initRest()
     // Consistency check for challenges, and enable all challenges
     // that have all prerequisites fulfilled
     grand_prix_manager->checkConsistency();
+    logStartupPhase("grand prix");
     GUIEngine::addLoadingIcon( irr_driver->getTexture(FileManager::GUI_ICON,
                                                       "cup_gold.png"    ) );
 
@@ -2013,7 +2095,8 @@ int main(int argc, char *argv[])
             FileManager::setStdoutDir(s);
 
 #ifndef SERVER_ONLY
-        if(CommandLine::has("--no-graphics") || CommandLine::has("-l"))
+        if(CommandLine::has("--no-graphics") || CommandLine::has("-l") ||
+           CommandLine::has("--fast-simulation"))
 #endif
             ProfileWorld::disableGraphics();
 
@@ -2073,7 +2156,12 @@ int main(int argc, char *argv[])
             ServerConfig::m_validating_player = false;
         }
 
-        if (!ProfileWorld::isNoGraphics())
+        // The profiler can be enabled without graphics, e.g. to collect
+        // profiling data on a dedicated server.
+        if (CommandLine::has("--profiler"))
+            UserConfigParams::m_profiler_enabled = true;
+        if (!ProfileWorld::isNoGraphics() ||
+            UserConfigParams::m_profiler_enabled)
             profiler.init();
         // Create the story mode timer with empty setting first, it will
         // be reset later after story mode status and player manager is loaded
@@ -2093,7 +2181,10 @@ int main(int argc, char *argv[])
         }
         else
             main_loop = new MainLoop(0/*parent_pid*/);
+        if (CommandLine::has("--fast-simulation"))
+            main_loop->setFastSimulation(true);
         material_manager->loadMaterial();
+        logStartupPhase("materials");
 
         // Preload the explosion effects (explode.png)
         ParticleKindManager::get()->getParticles("explosion.xml");
@@ -2106,6 +2197,7 @@ int main(int argc, char *argv[])
         kart_properties_manager -> loadAllKarts    ();
         handleXmasMode();
         handleEasterEarMode();
+        logStartupPhase("karts");
 
         // Needs the kart and track directories to load potential challenges
         // in those dirs, so it can only be created after reading tracks
@@ -2117,6 +2209,7 @@ int main(int argc, char *argv[])
         // initialise the game slots of all players and the AchievementsManager
         // to initialise the AchievementsStatus, so it is done only now.
         PlayerManager::get()->initRemainingData();
+        logStartupPhase("achievements and players");
 
         GUIEngine::addLoadingIcon( irr_driver->getTexture(FileManager::GUI_ICON,
                                                           "gui_lock.png"  ) );
@@ -2146,6 +2239,9 @@ int main(int argc, char *argv[])
 
         attachment_manager->loadModels();
         file_manager->popTextureSearchPath();
+        // Free any parsed files that were not used
+        file_manager->clearPreloadedXMLTrees();
+        logStartupPhase("models");
 
         GUIEngine::addLoadingIcon( irr_driver->getTexture(FileManager::GUI_ICON,
                                                           "banana.png")    );
@@ -2187,6 +2283,13 @@ int main(int argc, char *argv[])
             exit(0);
         }
 
+        std::string replay_dir;
+        if (CommandLine::has("--benchmark-replays", &replay_dir))
+        {
+            ReplayPlay::get()->benchmarkLoading(replay_dir);
+            exit(0);
+        }
+
 #ifndef SERVER_ONLY
         // Start RPC server, if enabled
         if (UserConfigParams::m_rpc_controller_enabled)
@@ -2417,6 +2520,7 @@ int main(int argc, char *argv[])
     MemoryLeaks::checkForLeaks();
 #endif
 
+    Log::stopAsyncWriter();
     Log::flushBuffers();
 
 #ifndef WIN32
@@ -2631,6 +2735,30 @@ void runUnitTests()
     Log::info("UnitTest", "RewindQueue");
     RewindQueue::unitTesting();
 
+    Log::info("UnitTest", "SpatialHash");
+    SpatialHash::unitTesting();
+
+    Log::info("UnitTest", "Replay encoding");
+    ReplayBase::unitTesting();
+
+    Log::info("UnitTest", "TimeHistogram");
+    TimeHistogram::unitTesting();
+
+    Log::info("UnitTest", "XML cache");
+    XMLNode::unitTesting();
+
+    Log::info("UnitTest", "CheckManager");
+    CheckManager::unitTesting();
+
+    Log::info("UnitTest", "ObjectPool");
+    ObjectPool::unitTesting();
+
+    Log::info("UnitTest", "KartRanking");
+    KartRanking::unitTesting();
+
+    Log::info("UnitTest", "Graph sector grid");
+    Graph::unitTesting();
+
     Log::info("UnitTest", "=====================");
     Log::info("UnitTest", "Testing successful   ");
     Log::info("UnitTest", "=====================");
@@ -79,6 +79,10 @@ MainLoop::MainLoop(unsigned parent_pid, bool download_assets)
     m_allow_large_dt  = false;
     m_frame_before_loading_world = false;
     m_download_assets = download_assets;
+    m_fast_simulation = false;
+    m_simulated_ticks = 0;
+    m_simulation_start_time  = 0;
+    m_simulation_report_time = 0;
 #ifdef WIN32
     if (parent_pid != 0)
     {
@@ -142,6 +146,14 @@ float MainLoop::getLimitedDt()
 #endif
     float dt = 0;
 
+    // In fast simulation mode exactly one time step is done per frame,
+    // independent of how long the frame took
+    if (m_fast_simulation)
+    {
+        m_curr_time = StkTime::getMonoTimeMs();
+        return stk_config->ticks2Time(1);
+    }
+
     // In profile mode without graphics, run with a fixed dt of 1/60
     if ((ProfileWorld::isProfileMode() && ProfileWorld::isNoGraphics()) ||
         UserConfigParams::m_arena_ai_stats)
@@ -358,6 +370,9 @@ void MainLoop::run()
     // DT keeps track of the leftover time, since the race update
     // happens in fixed timesteps
     float left_over_time = 0;
+    m_simulation_start_time  = m_curr_time;
+    m_simulation_report_time = m_curr_time;
+    m_simulated_ticks        = 0;
 
 #ifdef WIN32
     HANDLE parent = 0;
@@ -407,6 +422,13 @@ void MainLoop::run()
         int num_steps   = stk_config->time2Ticks(left_over_time);
         float dt = stk_config->ticks2Time(1);
         left_over_time -= num_steps * dt ;
+        // Avoid rounding errors accumulating in left_over_time, which could
+        // result in a frame with no or two time steps
+        if (m_fast_simulation)
+        {
+            num_steps      = 1;
+            left_over_time = 0.0f;
+        }
 
         // Shutdown next frame if shutdown request is sent while loading the
         // world
@@ -557,6 +579,11 @@ void MainLoop::run()
                 if (World::getWorld())
                 {
                     updateRace(1, fast_forward);
+                    if (history->hasChecksums())
+                    {
+                        history->updateChecksum(
+                                       World::getWorld()->getTicksSinceStart());
+                    }
                 }
                 PROFILER_POP_CPU_MARKER();
 
@@ -586,9 +613,15 @@ void MainLoop::run()
                         break;
                     }
                     World::getWorld()->updateTime(1);
+                    if (m_fast_simulation)
+                        m_simulated_ticks++;
                 }
             }   // for i < num_steps
 
+            if (m_fast_simulation &&
+                m_curr_time - m_simulation_report_time > 10000)
+                reportSimulationSpeed(/*final_report*/false);
+
             // Handle controller the last to avoid slow PC sending actions too 
             // late
             if (!ProfileWorld::isNoGraphics())
@@ -624,8 +657,30 @@ void MainLoop::run()
         CloseHandle(parent);
 #endif
 
+    if (m_fast_simulation)
+        reportSimulationSpeed(/*final_report*/true);
 }   // run
 
+// ----------------------------------------------------------------------------
+/** Prints the number of ticks simulated per second of wall clock time in
+ *  fast simulation mode, and how much faster than real time this is.
+ *  \param final_report True if this is called at the end of the main loop.
+ */
+void MainLoop::reportSimulationSpeed(bool final_report)
+{
+    m_simulation_report_time = StkTime::getMonoTimeMs();
+    float wall_time =
+        (m_simulation_report_time - m_simulation_start_time) / 1000.0f;
+    if (wall_time <= 0.0f)
+        return;
+    float ticks_per_second = m_simulated_ticks / wall_time;
+    Log::info("MainLoop", "%s%llu ticks simulated in %.2f s: %.1f ticks/s, "
+              "%.2fx real time.", final_report ? "Total: " : "",
+              (unsigned long long)m_simulated_ticks, wall_time,
+              ticks_per_second,
+              ticks_per_second / stk_config->getPhysicsFPS());
+}   // reportSimulationSpeed
+
 // ----------------------------------------------------------------------------
 /** Renders the GUI. This function is used during loading a track to get a
  *  responsive GUI, and allow GUI animations (like a progress bar) to be
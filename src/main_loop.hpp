@@ -44,6 +44,19 @@ private:
 
     bool m_download_assets;
 
+    /** True if the simulation should run as fast as possible: exactly one
+     *  physics time step is done per main loop iteration, without any
+     *  sleeping or adjusting of dt to the wall clock. */
+    bool m_fast_simulation;
+
+    /** Number of ticks simulated in fast simulation mode. */
+    uint64_t m_simulated_ticks;
+
+    /** Wall clock time at which fast simulation started and at which the
+     *  last statistics were printed. */
+    uint64_t m_simulation_start_time;
+    uint64_t m_simulation_report_time;
+
     Synchronised<int> m_ticks_adjustment;
 
     uint64_t m_curr_time;
@@ -51,6 +64,7 @@ private:
     unsigned m_parent_pid;
     float    getLimitedDt();
     void     updateRace(int ticks, bool fast_forward);
+    void     reportSimulationSpeed(bool final_report);
 public:
          MainLoop(unsigned parent_pid, bool download_assets = false);
         ~MainLoop();
@@ -60,6 +74,10 @@ public:
     void requestAbort() { m_request_abort = true; }
     void setThrottleFPS(bool throttle) { m_throttle_fps = throttle; }
     void setAllowLargeDt(bool enable) { m_allow_large_dt = enable; }
+    void setFastSimulation(bool enable) { m_fast_simulation = enable; }
+    // ------------------------------------------------------------------------
+    /** Returns true if the simulation runs as fast as possible. */
+    bool isFastSimulation() const { return m_fast_simulation; }
     void renderGUI(int phase, int loop_index=-1, int loop_size=-1);
     // ------------------------------------------------------------------------
     /** Returns true if STK is to be stoppe. */
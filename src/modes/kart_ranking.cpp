@@ -0,0 +1,95 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "modes/kart_ranking.hpp"
+
+#include <assert.h>
+#include <random>
+
+// ----------------------------------------------------------------------------
+/** Simulates a race with many karts in which karts overtake each other,
+ *  finish and are re-added (like after a rewind), and compares the ranks
+ *  with the ones computed by comparing each kart with all other karts.
+ */
+void KartRanking::unitTesting()
+{
+    const unsigned int num_karts = 100;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> speed(20.0f, 30.0f);
+
+    std::vector<float> distance(num_karts);
+    std::vector<bool>  finished(num_karts, false);
+    for (unsigned int i = 0; i < num_karts; i++)
+        distance[i] = -(float)i;
+    // Two karts with the same distance, which must be ranked by their id
+    distance[7] = distance[8];
+
+    auto is_ranked = [&finished](int k) { return !finished[k]; };
+    auto is_ahead  = [&distance](int a, int b)
+    {
+        return distance[a] > distance[b] ||
+              (distance[a] == distance[b] && a < b);
+    };
+
+    KartRanking ranking;
+    std::vector<int> brute_force_rank(num_karts);
+    const int num_steps = 2000;
+    for (int step = 0; step < num_steps; step++)
+    {
+        if (step > 0)
+        {
+            for (unsigned int i = 0; i < num_karts; i++)
+                distance[i] += speed(random) / 120.0f;
+        }
+        if (step == num_steps / 2)
+        {
+            for (unsigned int i = 0; i < num_karts; i += 10)
+                finished[i] = true;
+        }
+        // Like a rewind: some finished karts race again
+        if (step == 3 * num_steps / 4)
+            finished[20] = finished[50] = false;
+
+        ranking.update(num_karts, is_ranked, is_ahead);
+
+        for (unsigned int i = 0; i < num_karts; i++)
+        {
+            if (finished[i])
+                continue;
+            int p = 0;
+            for (unsigned int j = 0; j < num_karts; j++)
+            {
+                if (j != i && !finished[j] && is_ahead(j, i))
+                    p++;
+            }
+            brute_force_rank[i] = p;
+        }
+
+        const std::vector<int> &order = ranking.getOrder();
+        unsigned int num_ranked = 0;
+        for (unsigned int i = 0; i < num_karts; i++)
+        {
+            if (!finished[i])
+                num_ranked++;
+        }
+        assert(order.size() == num_ranked);
+        for (unsigned int r = 0; r < order.size(); r++)
+            assert(brute_force_rank[order[r]] == (int)r);
+        (void)num_ranked;
+    }
+}   // unitTesting
@@ -0,0 +1,112 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_KART_RANKING_HPP
+#define HEADER_KART_RANKING_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <vector>
+
+/**
+  * \ingroup modes
+  * Keeps the karts that are still racing sorted by their rank. Between two
+  * time steps the order of the karts changes only in a few places, so
+  * instead of comparing each kart with all other karts (which is O(n^2)),
+  * the order of the previous time step is fixed with an insertion sort,
+  * which only swaps neighbouring karts whose order has changed. This is
+  * O(n) if no kart has overtaken another kart.
+  */
+class KartRanking : public NoCopy
+{
+private:
+    /** The ids of all karts that are ranked, best kart first. */
+    std::vector<int> m_order;
+
+    /** Used to detect karts that are ranked again (e.g. after a rewind). */
+    std::vector<bool> m_is_ranked;
+
+    /** Number of swaps done in the last update, for statistics. */
+    unsigned int m_num_swaps;
+
+public:
+    KartRanking() { m_num_swaps = 0; }
+    static void unitTesting();
+    // ------------------------------------------------------------------------
+    /** Removes all karts, so that the next update sorts all karts. */
+    void reset() { m_order.clear(); m_is_ranked.clear(); }
+    // ------------------------------------------------------------------------
+    /** Updates the order of all karts.
+     *  \param num_karts Number of karts.
+     *  \param is_ranked A function returning true if a kart (id) should be
+     *         ranked, e.g. because it has not finished the race.
+     *  \param is_ahead A function returning true if the first kart (id) is
+     *         ahead of the second one. It must be a strict total order.
+     */
+    template<typename IsRanked, typename IsAhead>
+    void update(unsigned int num_karts, IsRanked is_ranked, IsAhead is_ahead)
+    {
+        m_num_swaps = 0;
+        if (m_is_ranked.size() != num_karts)
+        {
+            m_order.clear();
+            m_is_ranked.assign(num_karts, false);
+        }
+        // Remove the karts that are not ranked anymore, keeping the order
+        unsigned int n = 0;
+        for (unsigned int i = 0; i < m_order.size(); i++)
+        {
+            if (is_ranked(m_order[i]))
+                m_order[n++] = m_order[i];
+            else
+                m_is_ranked[m_order[i]] = false;
+        }
+        m_order.resize(n);
+        // Karts that are ranked (again) are added at the end and sorted
+        // into place below
+        for (unsigned int k = 0; k < num_karts; k++)
+        {
+            if (!m_is_ranked[k] && is_ranked(k))
+            {
+                m_is_ranked[k] = true;
+                m_order.push_back(k);
+            }
+        }
+        // Insertion sort, which is linear for a (nearly) sorted array
+        for (unsigned int i = 1; i < m_order.size(); i++)
+        {
+            const int kart = m_order[i];
+            unsigned int j = i;
+            while (j > 0 && is_ahead(kart, m_order[j - 1]))
+            {
+                m_order[j] = m_order[j - 1];
+                j--;
+            }
+            m_order[j] = kart;
+            m_num_swaps += i - j;
+        }
+    }   // update
+    // ------------------------------------------------------------------------
+    /** Returns the ids of all ranked karts, best kart first. */
+    const std::vector<int>& getOrder() const { return m_order; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of swaps done in the last update. */
+    unsigned int getNumSwaps() const { return m_num_swaps; }
+};   // KartRanking
+
+#endif
@@ -0,0 +1,59 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "modes/kart_states.hpp"
+
+#include "karts/abstract_kart.hpp"
+
+// ----------------------------------------------------------------------------
+/** Sets the number of karts. All values are reset to 0.
+ *  \param num_karts Number of karts in the world.
+ */
+void KartStates::resize(unsigned int num_karts)
+{
+    m_distance.assign(num_karts, 0.0f);
+    m_flags.assign(num_karts, 0);
+}   // resize
+
+// ----------------------------------------------------------------------------
+/** Copies the current state of a kart into the arrays.
+ *  \param i World kart id of the kart.
+ *  \param kart The kart.
+ */
+void KartStates::setKart(unsigned int i, const AbstractKart *kart)
+{
+    m_flags[i] = kart->isEliminated() ? KS_ELIMINATED : 0;
+}   // setKart
+
+// ----------------------------------------------------------------------------
+/** Returns the number of karts that are further along the track than the
+ *  given distance.
+ *  \param distance The overall distance to compare with.
+ *  \param ignore_flags Karts with any of these flags set are not counted.
+ */
+int KartStates::countKartsAhead(float distance, int ignore_flags) const
+{
+    int count = 0;
+    const unsigned int n = getNumKarts();
+    for (unsigned int i = 0; i < n; i++)
+    {
+        count += (m_distance[i] > distance &&
+                  (m_flags[i] & ignore_flags) == 0) ? 1 : 0;
+    }
+    return count;
+}   // countKartsAhead
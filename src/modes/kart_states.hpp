@@ -0,0 +1,70 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_KART_STATES_HPP
+#define HEADER_KART_STATES_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <vector>
+
+class AbstractKart;
+
+/**
+  * \ingroup modes
+  * A snapshot of the state of all karts, stored as one array per value
+  * (structure of arrays). It is filled once per time step by the world
+  * (see World::updateKartStates), so that code which has to look at all
+  * karts in each time step (e.g. the AI counting the karts ahead of it)
+  * can use tight loops instead of calling virtual functions of each kart.
+  * Only the values that are used are stored. The index is the world kart
+  * id.
+  */
+class KartStates : public NoCopy
+{
+public:
+    /** Flags describing the state of a kart. */
+    enum { KS_ELIMINATED = 1 };
+
+private:
+    /** Overall distance driven along the track (only set in linear
+     *  worlds, otherwise 0). */
+    std::vector<float> m_distance;
+
+    /** A combination of the KS_* flags for each kart. */
+    std::vector<int>   m_flags;
+
+public:
+    void resize(unsigned int num_karts);
+    void setKart(unsigned int i, const AbstractKart *kart);
+    int  countKartsAhead(float distance, int ignore_flags) const;
+    // ------------------------------------------------------------------------
+    /** Returns the number of karts in this snapshot. */
+    unsigned int getNumKarts() const { return (unsigned int)m_flags.size(); }
+    // ------------------------------------------------------------------------
+    /** Sets the overall distance along the track of a kart. */
+    void setDistance(unsigned int i, float d)          { m_distance[i] = d; }
+    // ------------------------------------------------------------------------
+    /** Returns the overall distance along the track of kart i. */
+    float getDistance(unsigned int i) const        { return m_distance[i]; }
+    // ------------------------------------------------------------------------
+    /** Returns the KS_* flags of kart i. */
+    int getFlags(unsigned int i) const                { return m_flags[i]; }
+};   // KartStates
+
+#endif
@@ -110,6 +110,7 @@ void LinearWorld::reset(bool restart)
     m_last_lap_sfx_played  = false;
     m_last_lap_sfx_playing = false;
     m_fastest_lap_ticks    = INT_MAX;
+    m_ranking.reset();
 
     const unsigned int kart_amount = (unsigned int) m_karts.size();
     for(unsigned int i=0; i<kart_amount; i++)
@@ -263,6 +264,17 @@ void LinearWorld::update(int ticks)
 #endif
 }   // update
 
+//-----------------------------------------------------------------------------
+/** Adds the overall distance of each kart to the kart state snapshot.
+ */
+void LinearWorld::updateKartStates()
+{
+    WorldWithRank::updateKartStates();
+    const unsigned int n = (unsigned int)m_kart_info.size();
+    for (unsigned int i = 0; i < n && i < m_kart_states.getNumKarts(); i++)
+        m_kart_states.setDistance(i, getOverallDistance(i));
+}   // updateKartStates
+
 //-----------------------------------------------------------------------------
 void LinearWorld::updateTrackSectors()
 {
@@ -846,9 +858,9 @@ btTransform LinearWorld::getRescueTransform(unsigned int index) const
 }   // getRescueTransform
 
 //-----------------------------------------------------------------------------
-/** Find the position (rank) of every kart. ATM it uses a stable O(n^2)
- *  algorithm by counting for each kart how many other karts are ahead of
- *  it.
+/** Find the position (rank) of every kart. The karts that are still racing
+ *  are kept sorted in m_ranking, which only has to swap the karts that
+ *  overtook each other since the last call.
  */
 void LinearWorld::updateRacePosition()
 {
@@ -860,57 +872,60 @@ void LinearWorld::updateRacePosition()
     bool rank_changed = false;
 #endif
 
-    // NOTE: if you do any changes to this loop, the next loop (see
-    // DEBUG_KART_RANK below) needs to have the same changes applied
-    // so that debug output is still correct!!!!!!!!!!!
+    // Karts that are either eliminated or have finished the race already
+    // have their (final) position assigned. If these karts would get their
+    // rank updated, it could happen that a kart that finished first will be
+    // overtaken after crossing the finishing line and become second!
+    // All other karts are behind the karts that have finished (and are not
+    // eliminated), and are sorted by their overall distance. If two karts
+    // have the same distance (very unlikely) the kart that started earlier
+    // is ahead.
+    unsigned int num_finished = 0;
     for (unsigned int i=0; i<kart_amount; i++)
     {
         AbstractKart* kart = m_karts[i].get();
-        // Karts that are either eliminated or have finished the
-        // race already have their (final) position assigned. If
-        // these karts would get their rank updated, it could happen
-        // that a kart that finished first will be overtaken after
-        // crossing the finishing line and become second!
         if(kart->isEliminated() || kart->hasFinishedRace())
         {
+            if (!kart->isEliminated())
+                num_finished++;
             // This is only necessary to support debugging inconsistencies
             // in kart position parameters.
             setKartPosition(i, kart->getPosition());
-            continue;
         }
-        KartInfo& kart_info = m_kart_info[i];
-
-        int p = 1 ;
-
-        const unsigned int my_id = kart->getWorldKartId();
-        const float my_distance  = m_kart_info[my_id].m_overall_distance;
+    }
 
-        // Count karts ahead of the current kart, i.e. kart that are
-        // already finished or have covered a larger overall distance.
-        for (unsigned int j = 0 ; j < kart_amount ; j++)
+    // Only the karts whose order has changed since the last update are
+    // swapped, so this is linear in the number of karts most of the time.
+    // NOTE: if you do any changes to the order, the loop below (see
+    // DEBUG_KART_RANK) needs to have the same changes applied so that
+    // debug output is still correct!
+    m_ranking.update(kart_amount,
+        [this](int k)
         {
-            // don't compare a kart with itself and ignore eliminated karts
-            if(j == my_id || m_karts[j]->isEliminated())
-                continue;
-
-            // If the other kart has:
-            // - finished the race (but this kart hasn't)
-            // - or is ahead
-            // - or has the same distance (very unlikely) but started earlier
-            // it is ahead --> increase position
-            if((!kart->hasFinishedRace() && m_karts[j]->hasFinishedRace()) ||
-                m_kart_info[j].m_overall_distance > my_distance            ||
-               (m_kart_info[j].m_overall_distance == my_distance &&
-                m_karts[j]->getInitialPosition()<kart->getInitialPosition() ) )
-            {
-                p++;
-            }
-
-        } //next kart
+            return !m_karts[k]->isEliminated() &&
+                   !m_karts[k]->hasFinishedRace();
+        },
+        [this](int a, int b)
+        {
+            const float distance_a = m_kart_info[a].m_overall_distance;
+            const float distance_b = m_kart_info[b].m_overall_distance;
+            return distance_a > distance_b ||
+                   (distance_a == distance_b &&
+                    m_karts[a]->getInitialPosition() <
+                    m_karts[b]->getInitialPosition()     );
+        });
+
+    const std::vector<int> &order = m_ranking.getOrder();
+    for (unsigned int r = 0; r < order.size(); r++)
+    {
+        const unsigned int i = order[r];
+        KartInfo& kart_info = m_kart_info[i];
+        const int p = num_finished + r + 1;
 
 #ifndef DEBUG
         setKartPosition(i, p);
 #else
+        AbstractKart* kart = m_karts[i].get();
         rank_changed |= kart->getPosition()!=p;
         if (!setKartPosition(i,p))
         {
@@ -929,10 +944,11 @@ void LinearWorld::updateRacePosition()
             }
 
             Log::debug("[LinearWorld]", "Who has each ranking so far :");
-            for (unsigned int d=0; d<i; d++)
+            for (unsigned int d=0; d<r; d++)
             {
-                Log::debug("[LinearWorld]", "%s has rank %d", m_karts[d]->getIdent().c_str(),
-                            m_karts[d]->getPosition());
+                Log::debug("[LinearWorld]", "%s has rank %d",
+                           m_karts[order[d]]->getIdent().c_str(),
+                           m_karts[order[d]]->getPosition());
             }
 
             Log::debug("[LinearWorld]", "    --> And %s is being set at rank %d",
@@ -952,7 +968,7 @@ void LinearWorld::updateRacePosition()
             music_manager->switchToFastMusic();
             m_faster_music_active=true;
         }
-    }   // for i<kart_amount
+    }   // for r<order.size()
 
     // Define this to get a detailled analyses each time a race position
     // changes.
@@ -18,6 +18,7 @@
 #ifndef HEADER_LINEAR_WORLD_HPP
 #define HEADER_LINEAR_WORLD_HPP
 
+#include "modes/kart_ranking.hpp"
 #include "modes/world_with_rank.hpp"
 #include "utils/aligned_array.hpp"
 
@@ -71,6 +72,9 @@ private:
     /* if set then the game will auto end after this time for networking */
     float       m_finish_timeout;
 
+    /** The karts that have not finished the race, sorted by their rank. */
+    KartRanking m_ranking;
+
     /** This calculate the time difference between the second kart in the race
      *  (there must be at least two) and the first kart in the race
      *  (who must be a ghost).
@@ -144,6 +148,7 @@ public:
     virtual      ~LinearWorld();
 
     virtual void  update(int ticks) OVERRIDE;
+    virtual void  updateKartStates() OVERRIDE;
     virtual void  updateGraphics(float dt) OVERRIDE;
     float         getDistanceDownTrackForKart(const int kart_id,
                                             bool account_for_checklines) const;
@@ -78,7 +78,9 @@
 #include "tracks/track_object.hpp"
 #include "tracks/track_object_manager.hpp"
 #include "utils/constants.hpp"
+#include "utils/object_pool.hpp"
 #include "utils/profiler.hpp"
+#include "utils/tick_stats.hpp"
 #include "utils/translation.hpp"
 #include "utils/string_utils.hpp"
 
@@ -255,6 +257,9 @@ void World::init()
     m_race_gui->init();
 
     powerup_manager->computeWeightsForRace(race_manager->getNumberOfKarts());
+    // Pre-allocate flyables, dropped items and kart animations, so that
+    // they don't need heap allocations during the race
+    ObjectPool::reserveAll(race_manager->getNumberOfKarts());
     main_loop->renderGUI(7200);
     if (UserConfigParams::m_particles_effects > 1)
     {
@@ -324,6 +329,8 @@ void World::initTeamArrows(AbstractKart* k)
 void World::reset(bool restart)
 {
     RewindManager::get()->reset();
+    // The timing statistics are reported for the current race only
+    TickStats::reset();
 
     // If m_saved_race_gui is set, it means that the restart was done
     // when the race result gui was being shown. In this case restore the
@@ -607,6 +614,10 @@ World::~World()
     
     Weather::kill();
 
+    // Write the rest of a history that is recorded to a file
+    if (!history->replayHistory())
+        history->finishRecording();
+
     m_karts.clear();
     if(race_manager->hasGhostKarts() || race_manager->isRecordingRace())
     {
@@ -1095,6 +1106,7 @@ void World::update(int ticks)
 #endif
 
     PROFILER_PUSH_CPU_MARKER("World::update()", 0x00, 0x7F, 0x00);
+    TickStats::Timer world_timer(TickStats::TS_WORLD_UPDATE);
 
 #if MEASURE_FPS
     static int time = 0.0f;
@@ -1107,31 +1119,46 @@ void World::update(int ticks)
 #endif
 
     PROFILER_PUSH_CPU_MARKER("World::update (sub-updates)", 0x20, 0x7F, 0x00);
-    WorldStatus::update(ticks);
+    {
+        TickStats::Timer timer(TickStats::TS_WORLD_STATUS);
+        WorldStatus::update(ticks);
+    }
     PROFILER_POP_CPU_MARKER();
     PROFILER_PUSH_CPU_MARKER("World::update (RewindManager)", 0x20, 0x7F, 0x40);
-    RewindManager::get()->update(ticks);
+    {
+        TickStats::Timer timer(TickStats::TS_REWIND_MANAGER);
+        RewindManager::get()->update(ticks);
+    }
     PROFILER_POP_CPU_MARKER();
 
     PROFILER_PUSH_CPU_MARKER("World::update (Track object manager)", 0x20, 0x7F, 0x40);
-    Track::getCurrentTrack()->getTrackObjectManager()->update(stk_config->ticks2Time(ticks));
+    {
+        TickStats::Timer timer(TickStats::TS_TRACK_OBJECTS);
+        Track::getCurrentTrack()->getTrackObjectManager()
+                                ->update(stk_config->ticks2Time(ticks));
+    }
     PROFILER_POP_CPU_MARKER();
 
     PROFILER_PUSH_CPU_MARKER("World::update (Kart::upate)", 0x40, 0x7F, 0x00);
-
-    // Update all the karts. This in turn will also update the controller,
-    // which causes all AI steering commands set. So in the following 
-    // physics update the new steering is taken into account.
-    const int kart_amount = (int)m_karts.size();
-    for (int i = 0 ; i < kart_amount; ++i)
     {
-        SpareTireAI* sta =
-            dynamic_cast<SpareTireAI*>(m_karts[i]->getController());
-        // Update all karts that are not eliminated
-        if(!m_karts[i]->isEliminated() || (sta && sta->isMoving()))
-            m_karts[i]->update(ticks);
-        if (isStartPhase())
-            m_karts[i]->makeKartRest();
+        TickStats::Timer timer(TickStats::TS_KARTS);
+
+        updateKartStates();
+
+        // Update all the karts. This in turn will also update the controller,
+        // which causes all AI steering commands set. So in the following 
+        // physics update the new steering is taken into account.
+        const int kart_amount = (int)m_karts.size();
+        for (int i = 0 ; i < kart_amount; ++i)
+        {
+            SpareTireAI* sta =
+                dynamic_cast<SpareTireAI*>(m_karts[i]->getController());
+            // Update all karts that are not eliminated
+            if(!m_karts[i]->isEliminated() || (sta && sta->isMoving()))
+                m_karts[i]->update(ticks);
+            if (isStartPhase())
+                m_karts[i]->makeKartRest();
+        }
     }
     PROFILER_POP_CPU_MARKER();
     if(race_manager->isRecordingRace()) ReplayRecorder::get()->update(ticks);
@@ -1141,7 +1168,10 @@ void World::update(int ticks)
     PROFILER_POP_CPU_MARKER();
 
     PROFILER_PUSH_CPU_MARKER("World::update (physics)", 0xa0, 0x7F, 0x00);
-    Physics::getInstance()->update(ticks);
+    {
+        TickStats::Timer timer(TickStats::TS_PHYSICS);
+        Physics::getInstance()->update(ticks);
+    }
     PROFILER_POP_CPU_MARKER();
 
     PROFILER_POP_CPU_MARKER();
@@ -1151,6 +1181,18 @@ void World::update(int ticks)
 #endif
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Copies the state of all karts into the kart state snapshot.
+ */
+void World::updateKartStates()
+{
+    const unsigned int n = (unsigned int)m_karts.size();
+    if (m_kart_states.getNumKarts() != n)
+        m_kart_states.resize(n);
+    for (unsigned int i = 0; i < n; i++)
+        m_kart_states.setKart(i, m_karts[i].get());
+}   // updateKartStates
+
 // ----------------------------------------------------------------------------
 /** Only updates the track. The order in which the various parts of STK are
  *  updated is quite important (i.e. the track can't be updated as part of
@@ -32,6 +32,7 @@
 #include <stdexcept>
 
 #include "graphics/weather.hpp"
+#include "modes/kart_states.hpp"
 #include "modes/world_status.hpp"
 #include "race/highscores.hpp"
 #include "states_screens/race_gui_base.hpp"
@@ -113,6 +114,10 @@ protected:
     KartList                  m_karts;
     RandomGenerator           m_random;
 
+    /** A snapshot of the state of all karts, updated once per time step
+     *  before the karts are updated. */
+    KartStates                m_kart_states;
+
     AbstractKart* m_fastest_kart;
     /** Number of eliminated karts. */
     int         m_eliminated_karts;
@@ -184,6 +189,7 @@ protected:
     /** Returns true if the race is over. Must be defined by all modes. */
     virtual bool  isRaceOver() = 0;
     virtual void  update(int ticks) OVERRIDE;
+    virtual void  updateKartStates();
     virtual void  createRaceGUI();
             void  updateTrack(int ticks);
     // ------------------------------------------------------------------------
@@ -320,6 +326,10 @@ public:
     /** Returns all karts. */
     const KartList & getKarts() const { return m_karts; }
     // ------------------------------------------------------------------------
+    /** Returns the snapshot of all kart states taken at the beginning of
+     *  the current time step (i.e. after the previous physics update). */
+    const KartStates& getKartStates() const { return m_kart_states; }
+    // ------------------------------------------------------------------------
     /** Returns the number of currently active (i.e.non-elikminated) karts. */
     unsigned int    getCurrentNumKarts() const { return (int)m_karts.size() -
                                                          m_eliminated_karts; }
@@ -22,6 +22,9 @@
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
 #include "network/protocols/server_lobby.hpp"
+#include "config/user_config.hpp"
+#include "utils/profiler.hpp"
+#include "utils/tick_stats.hpp"
 #include "utils/time.hpp"
 #include "utils/vs.hpp"
 #include "main_loop.hpp"
@@ -43,6 +46,10 @@ void showHelp()
     std::cout << "listpeers, List all peers with host ID and IP." << std::endl;
     std::cout << "listban, List IP ban list of server." << std::endl;
     std::cout << "speedstats, Show upload and download speed." << std::endl;
+    std::cout << "stats, Show timing statistics of the main update phases."
+        << std::endl;
+    std::cout << "profiletrace, Write the recorded profiler markers as a "
+        "Chrome trace (needs --profiler)." << std::endl;
 }   // showHelp
 
 // ----------------------------------------------------------------------------
@@ -123,6 +130,21 @@ void mainLoop(STKHost* host)
                 "   Download speed (KBps): " <<
                 (float)host->getDownloadSpeed() / 1024.0f  << std::endl;
         }
+        else if (str == "stats")
+        {
+            std::cout << TickStats::getReport();
+        }
+        else if (str == "profiletrace")
+        {
+            if (!UserConfigParams::m_profiler_enabled)
+                std::cout << "The profiler is not enabled." << std::endl;
+            else
+            {
+                std::string filename = profiler.writeChromeTrace();
+                if (!filename.empty())
+                    std::cout << "Trace written to " << filename << std::endl;
+            }
+        }
         else
         {
             std::cout << "Unknown command: " << str << std::endl;
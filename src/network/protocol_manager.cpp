@@ -50,6 +50,7 @@ std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
     pm->m_asynchronous_update_thread = std::thread([pm]()
         {
             VS::setThreadName("ProtocolManager");
+            profiler.setThreadName("ProtocolManager");
             while(!pm->m_exit.load())
             {
                 pm->asynchronousUpdate();
@@ -63,6 +64,7 @@ std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
         pm->m_game_protocol_thread = std::thread([pm]()
             {
                 VS::setThreadName("CtrlEvents");
+                profiler.setThreadName("CtrlEvents");
                 while (true)
                 {
                     std::unique_lock<std::mutex> ul(pm->m_game_protocol_mutex);
@@ -37,8 +37,10 @@
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
 #include "utils/log.hpp"
+#include "utils/profiler.hpp"
 #include "utils/separate_process.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/tick_stats.hpp"
 #include "utils/time.hpp"
 #include "utils/vs.hpp"
 
@@ -846,6 +848,12 @@ void STKHost::startListening()
 {
     m_exit_timeout.store(std::numeric_limits<uint64_t>::max());
     m_listening_thread = std::thread(std::bind(&STKHost::mainLoop, this));
+    // Allows to compare the startup time of (esp. headless) servers
+    if (NetworkConfig::get()->isServer())
+    {
+        Log::info("STKHost", "Server listening %d ms after start.",
+                  (int)StkTime::getMonoTimeMs());
+    }
 }   // startListening
 
 // ----------------------------------------------------------------------------
@@ -870,6 +878,7 @@ void STKHost::stopListening()
 void STKHost::mainLoop()
 {
     VS::setThreadName("STKHost");
+    profiler.setThreadName("STKHost");
     Log::info("STKHost", "Listening has been started.");
     ENetEvent event;
     ENetHost* host = m_network->getENetHost();
@@ -1091,6 +1100,9 @@ void STKHost::mainLoop()
         std::unique_lock<std::mutex> lock(m_enet_cmd_mutex);
         std::swap(copied_list, m_enet_cmd);
         lock.unlock();
+        // Only measure if there is something to send
+        TickStats::Timer send_timer(TickStats::TS_NETWORK_SEND,
+                                    !copied_list.empty());
         for (auto& p : copied_list)
         {
             switch (std::get<3>(p))
@@ -1122,9 +1134,13 @@ void STKHost::mainLoop()
             }
         }
 
+        send_timer.stop();
+
         bool need_ping_update = false;
         while (enet_host_service(host, &event, 10) != 0)
         {
+            // Measures the handling of this event (not the waiting for it)
+            TickStats::Timer receive_timer(TickStats::TS_NETWORK_RECEIVE);
             auto lp = LobbyProtocol::get<LobbyProtocol>();
             if (!is_server &&
                 last_ping_time_update_for_client < StkTime::getMonoTimeMs())
@@ -0,0 +1,338 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "physics/collision_cache.hpp"
+
+#include "graphics/material.hpp"
+#include "graphics/material_manager.hpp"
+#include "io/disk_cache.hpp"
+#include "io/file_manager.hpp"
+#include "physics/triangle_mesh.hpp"
+#include "utils/constants.hpp"
+#include "utils/log.hpp"
+
+#include <cstring>
+#include <map>
+
+namespace
+{
+    /** Version of the format of cache files, must be increased whenever
+     *  the format changes. */
+    const uint32_t CACHE_VERSION = 2;
+
+    /** Material index stored for triangles without a material. */
+    const uint32_t NO_MATERIAL = 0xffffffff;
+
+    // ------------------------------------------------------------------------
+    void addString(std::string *out, const std::string &s)
+    {
+        DiskCache::addU32(out, (uint32_t)s.size());
+        out->append(s);
+    }   // addString
+    // ------------------------------------------------------------------------
+    /** Adds the x, y and z component of a vector (w is undefined). */
+    void addVector(std::string *out, const btVector3 &v)
+    {
+        out->append((const char*)v.m_floats, 3 * sizeof(btScalar));
+    }   // addVector
+    // ------------------------------------------------------------------------
+    bool getData(const char **data, const char *end, void *out, size_t size)
+    {
+        if ((size_t)(end - *data) < size)
+            return false;
+        memcpy(out, *data, size);
+        *data += size;
+        return true;
+    }   // getData
+    // ------------------------------------------------------------------------
+    bool getString(const char **data, const char *end, std::string *s)
+    {
+        uint32_t len;
+        if (!DiskCache::getU32(data, end, &len) ||
+            (size_t)(end - *data) < len)
+            return false;
+        s->assign(*data, len);
+        *data += len;
+        return true;
+    }   // getString
+    // ------------------------------------------------------------------------
+    bool getVector(const char **data, const char *end, btVector3 *v)
+    {
+        btScalar xyz[3];
+        if (!getData(data, end, xyz, sizeof(xyz)))
+            return false;
+        v->setValue(xyz[0], xyz[1], xyz[2]);
+        return true;
+    }   // getVector
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Creates a cache for the given key. Nothing is read or written yet.
+ *  \param key Description of everything the collision data depends on.
+ */
+CollisionCache::CollisionCache(const std::string &key)
+{
+    m_key       = key;
+    m_can_write = true;
+    m_file_name = file_manager->getPhysicsCache()->getFileName(
+                                   DiskCache::hash(key.data(), key.size()));
+}   // CollisionCache
+
+// ----------------------------------------------------------------------------
+/** Adds the cached triangles to the meshes, and makes the serialized BVHs
+ *  available (see getBvh). The meshes must contain exactly the triangles
+ *  they contained when the cache file was written, which is verified. If
+ *  anything does not match, the meshes are not modified.
+ *  \param meshes The meshes, in the same order as used in save().
+ *  \return True if the cache was loaded.
+ */
+bool CollisionCache::load(const std::vector<TriangleMesh*> &meshes)
+{
+    m_num_main_triangles.clear();
+    for (TriangleMesh *mesh : meshes)
+        m_num_main_triangles.push_back(mesh->getNumTriangles());
+    m_bvh.clear();
+    if (m_file_name.empty() || !m_file.open(m_file_name))
+        return false;
+
+    const char *data = m_file.getData();
+    const char *end  = data + m_file.getSize();
+    uint32_t version, scalar_size, bvh_size, little_endian;
+    std::string key;
+    if (end - data < 4 || memcmp(data, "STKP", 4) != 0)
+    {
+        m_file.close();
+        return false;
+    }
+    data += 4;
+    if (!DiskCache::getU32(&data, end, &version)       ||
+        version != CACHE_VERSION                       ||
+        !DiskCache::getU32(&data, end, &scalar_size)   ||
+        scalar_size != sizeof(btScalar)                ||
+        !DiskCache::getU32(&data, end, &bvh_size)      ||
+        bvh_size != sizeof(btOptimizedBvh)             ||
+        !DiskCache::getU32(&data, end, &little_endian) ||
+        little_endian != (IS_LITTLE_ENDIAN ? 1u : 0u)  ||
+        !getString(&data, end, &key)                   || key != m_key)
+    {
+        m_file.close();
+        return false;
+    }
+
+    // From here on the file was written by this version for this track,
+    // so any problem is caused by the current data, and writing a new
+    // cache file would not help.
+    m_can_write = false;
+
+    uint32_t num_materials;
+    if (!DiskCache::getU32(&data, end, &num_materials))
+    {
+        m_file.close();
+        return false;
+    }
+    std::vector<const Material*> materials;
+    for (unsigned int i = 0; i < num_materials; i++)
+    {
+        std::string full_path, name, uv_two;
+        if (!getString(&data, end, &full_path) ||
+            !getString(&data, end, &name)      ||
+            !getString(&data, end, &uv_two))
+        {
+            m_file.close();
+            return false;
+        }
+        const Material *m =
+            material_manager->getMaterialSPM(full_path.empty() ? name
+                                                               : full_path,
+                                             uv_two);
+        if (m->getTexFullPath() != full_path || m->getTexFname() != name ||
+            m->getUVTwoTexture() != uv_two)
+        {
+            Log::debug("CollisionCache", "Material '%s' not found.",
+                       name.c_str());
+            m_file.close();
+            return false;
+        }
+        materials.push_back(m);
+    }
+
+    // Read all meshes first, so that nothing is modified if the cache
+    // does not match.
+    uint32_t num_meshes;
+    if (!DiskCache::getU32(&data, end, &num_meshes) ||
+        num_meshes != meshes.size())
+    {
+        m_file.close();
+        return false;
+    }
+    std::vector<std::vector<btVector3> >       vertices(num_meshes);
+    std::vector<std::vector<btVector3> >       normals(num_meshes);
+    std::vector<std::vector<float> >           p1p2p3(num_meshes);
+    std::vector<std::vector<const Material*> > mesh_materials(num_meshes);
+    for (unsigned int i = 0; i < num_meshes; i++)
+    {
+        uint32_t num_main, num_triangles;
+        if (!DiskCache::getU32(&data, end, &num_main)      ||
+            num_main != m_num_main_triangles[i]            ||
+            !DiskCache::getU32(&data, end, &num_triangles) ||
+            num_triangles < num_main)
+        {
+            m_file.close();
+            m_bvh.clear();
+            return false;
+        }
+        for (unsigned int j = 0; j < num_triangles; j++)
+        {
+            btVector3 v[3], n[3];
+            float f;
+            uint32_t material;
+            bool ok = true;
+            for (unsigned int k = 0; k < 3; k++)
+                ok = ok && getVector(&data, end, &v[k]);
+            for (unsigned int k = 0; k < 3; k++)
+                ok = ok && getVector(&data, end, &n[k]);
+            ok = ok && getData(&data, end, &f, sizeof(f)) &&
+                 DiskCache::getU32(&data, end, &material) &&
+                 (material < num_materials || material == NO_MATERIAL);
+            const Material *m = (ok && material != NO_MATERIAL)
+                              ? materials[material] : NULL;
+            if (ok && j < num_main)
+            {
+                // The main track is converted before loading the cache,
+                // it must be identical to the cached data.
+                btVector3 p[3];
+                meshes[i]->getTriangle(j, &p[0], &p[1], &p[2]);
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    ok = ok && p[k].getX() == v[k].getX() &&
+                               p[k].getY() == v[k].getY() &&
+                               p[k].getZ() == v[k].getZ();
+                }
+                ok = ok && meshes[i]->getMaterial(j) == m;
+            }
+            if (!ok)
+            {
+                m_file.close();
+                m_bvh.clear();
+                return false;
+            }
+            if (j < num_main)
+                continue;
+            vertices[i].insert(vertices[i].end(), v, v + 3);
+            normals[i].insert(normals[i].end(), n, n + 3);
+            p1p2p3[i].push_back(f);
+            mesh_materials[i].push_back(m);
+        }   // for j < num_triangles
+
+        uint32_t size;
+        if (!DiskCache::getU32(&data, end, &size) ||
+            (size_t)(end - data) < size)
+        {
+            m_file.close();
+            m_bvh.clear();
+            return false;
+        }
+        m_bvh.push_back(std::make_pair(size > 0 ? data : NULL,
+                                       (size_t)size));
+        data += size;
+    }   // for i < num_meshes
+
+    for (unsigned int i = 0; i < num_meshes; i++)
+    {
+        if (p1p2p3[i].empty())
+            continue;
+        meshes[i]->addTriangles((unsigned int)p1p2p3[i].size(),
+                                vertices[i].data(), normals[i].data(),
+                                p1p2p3[i].data(), mesh_materials[i].data());
+    }
+    file_manager->getPhysicsCache()->touchFile(m_file_name);
+    Log::info("CollisionCache", "Loaded collision data from '%s'.",
+              m_file_name.c_str());
+    return true;
+}   // load
+
+// ----------------------------------------------------------------------------
+/** Writes the triangles and BVHs of all meshes to the cache file. The
+ *  collision shapes of the meshes must have been created. Nothing is
+ *  written if caching is disabled or load() indicated that a new file
+ *  would not be used either.
+ *  \param meshes The meshes, in the same order as used in load().
+ */
+void CollisionCache::save(const std::vector<TriangleMesh*> &meshes) const
+{
+    if (m_file_name.empty() || !m_can_write ||
+        m_num_main_triangles.size() != meshes.size())
+        return;
+
+    std::map<const Material*, uint32_t> material_ids;
+    material_ids[NULL] = NO_MATERIAL;
+    std::vector<const Material*> materials;
+    for (TriangleMesh *mesh : meshes)
+    {
+        for (unsigned int i = 0; i < mesh->getNumTriangles(); i++)
+        {
+            const Material *m = mesh->getMaterial(i);
+            if (material_ids.find(m) != material_ids.end())
+                continue;
+            material_ids[m] = (uint32_t)materials.size();
+            materials.push_back(m);
+        }
+    }
+
+    std::string data = "STKP";
+    DiskCache::addU32(&data, CACHE_VERSION);
+    DiskCache::addU32(&data, sizeof(btScalar));
+    DiskCache::addU32(&data, sizeof(btOptimizedBvh));
+    DiskCache::addU32(&data, IS_LITTLE_ENDIAN ? 1 : 0);
+    addString(&data, m_key);
+    DiskCache::addU32(&data, (uint32_t)materials.size());
+    for (const Material *m : materials)
+    {
+        addString(&data, m->getTexFullPath());
+        addString(&data, m->getTexFname());
+        addString(&data, m->getUVTwoTexture());
+    }
+
+    DiskCache::addU32(&data, (uint32_t)meshes.size());
+    for (unsigned int i = 0; i < meshes.size(); i++)
+    {
+        const TriangleMesh *mesh = meshes[i];
+        DiskCache::addU32(&data, m_num_main_triangles[i]);
+        DiskCache::addU32(&data, mesh->getNumTriangles());
+        for (unsigned int j = 0; j < mesh->getNumTriangles(); j++)
+        {
+            btVector3 v[3], n[3];
+            mesh->getTriangle(j, &v[0], &v[1], &v[2]);
+            mesh->getNormals(j, &n[0], &n[1], &n[2]);
+            for (unsigned int k = 0; k < 3; k++)
+                addVector(&data, v[k]);
+            for (unsigned int k = 0; k < 3; k++)
+                addVector(&data, n[k]);
+            const float f = mesh->getP1P2P3(j);
+            data.append((const char*)&f, sizeof(f));
+            DiskCache::addU32(&data, material_ids[mesh->getMaterial(j)]);
+        }
+        std::string bvh;
+        if (mesh->getNumTriangles() > 0 && !mesh->serializeBvh(&bvh))
+            return;
+        DiskCache::addU32(&data, (uint32_t)bvh.size());
+        data += bvh;
+    }   // for i < meshes.size()
+
+    file_manager->getPhysicsCache()->writeFile(m_file_name, data);
+}   // save
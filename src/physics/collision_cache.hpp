@@ -0,0 +1,84 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_COLLISION_CACHE_HPP
+#define HEADER_COLLISION_CACHE_HPP
+
+#include "utils/mapped_file.hpp"
+#include "utils/no_copy.hpp"
+
+#include <string>
+#include <vector>
+
+class TriangleMesh;
+
+/**
+  * \ingroup physics
+  * An on-disk cache of the collision data of a track: the triangles (with
+  * their smoothed normals and materials) and the BVH of each triangle mesh.
+  * Converting all track objects into triangles and building the BVH is one
+  * of the most expensive parts of loading a track, which is especially
+  * noticeable on servers that load a new track for each race.
+  *
+  * The cache file is identified by a key, which must contain everything the
+  * collision data depends on (e.g. names, sizes and modification times of
+  * the track files). When loading, the meshes must already contain the
+  * triangles of the main track (which are needed before the objects are
+  * loaded), and only the remaining triangles are read from the cache. The
+  * file is memory-mapped, so only the BVH has to be copied (since bullet
+  * modifies it when deserializing).
+  */
+class CollisionCache : public NoCopy
+{
+private:
+    /** Name of the cache file, or empty if caching is disabled. */
+    std::string m_file_name;
+
+    /** The key, which is stored in the file to detect hash collisions. */
+    std::string m_key;
+
+    /** The content of the cache file after a successful load. */
+    MappedFile m_file;
+
+    /** Number of triangles in each mesh when load() was called. */
+    std::vector<unsigned int> m_num_main_triangles;
+
+    /** The serialized BVH of each mesh (pointing into m_file). */
+    std::vector<std::pair<const char*, size_t> > m_bvh;
+
+    /** False if an existing cache file only failed to load because the
+     *  current data does not match (e.g. a material could not be found),
+     *  in which case a new file would not help. */
+    bool m_can_write;
+
+public:
+         CollisionCache(const std::string &key);
+    bool load(const std::vector<TriangleMesh*> &meshes);
+    void save(const std::vector<TriangleMesh*> &meshes) const;
+    // ------------------------------------------------------------------------
+    /** Returns the serialized BVH of mesh i after a successful load, or
+     *  NULL. */
+    const char *getBvh(unsigned int i) const
+              { return i < m_bvh.size() ? m_bvh[i].first : NULL; }
+    // ------------------------------------------------------------------------
+    /** Returns the size of the serialized BVH of mesh i. */
+    size_t getBvhSize(unsigned int i) const
+                { return i < m_bvh.size() ? m_bvh[i].second : 0; }
+};   // CollisionCache
+
+#endif
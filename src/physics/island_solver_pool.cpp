@@ -0,0 +1,164 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "physics/island_solver_pool.hpp"
+
+#include "btBulletDynamicsCommon.h"
+
+#include "utils/string_utils.hpp"
+#include "utils/vs.hpp"
+
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+/** Creates the solvers and starts the worker threads.
+ *  \param num_threads Total number of threads to use, including the thread
+ *         that calls solve(). Must be at least 1.
+ */
+IslandSolverPool::IslandSolverPool(unsigned int num_threads)
+{
+    assert(num_threads > 0);
+    m_generation   = 0;
+    m_busy_workers = 0;
+    m_exit         = false;
+    m_next_group.store(0);
+    m_groups       = NULL;
+    m_info         = NULL;
+    m_debug_drawer = NULL;
+    m_stack_alloc  = NULL;
+    m_dispatcher   = NULL;
+
+    for (unsigned int i = 0; i < num_threads; i++)
+        m_solvers.push_back(new btSequentialImpulseConstraintSolver());
+
+    for (unsigned int i = 1; i < num_threads; i++)
+    {
+        m_threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+}   // IslandSolverPool
+
+// ----------------------------------------------------------------------------
+IslandSolverPool::~IslandSolverPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_start_cv.notify_all();
+    for (std::thread &t : m_threads)
+        t.join();
+    for (btSequentialImpulseConstraintSolver *solver : m_solvers)
+        delete solver;
+}   // ~IslandSolverPool
+
+// ----------------------------------------------------------------------------
+/** The main loop of a worker thread: wait for a new batch of island groups,
+ *  help solving it, and report back once no group is left.
+ *  \param index Index of this worker, used to select its solver.
+ */
+void IslandSolverPool::workerLoop(unsigned int index)
+{
+    VS::setThreadName((StringUtils::toString(index) + "IslandSolver")
+                      .c_str());
+    unsigned int last_generation = 0;
+    while (true)
+    {
+        std::unique_lock<std::mutex> ul(m_mutex);
+        m_start_cv.wait(ul, [this, last_generation]
+            {
+                return m_exit || m_generation != last_generation;
+            });
+        if (m_exit)
+            return;
+        last_generation = m_generation;
+        ul.unlock();
+
+        solveGroups(m_solvers[index]);
+
+        ul.lock();
+        m_busy_workers--;
+        if (m_busy_workers == 0)
+            m_done_cv.notify_one();
+    }
+}   // workerLoop
+
+// ----------------------------------------------------------------------------
+/** Takes island groups from the shared list until all are solved.
+ *  \param solver The solver of the calling thread.
+ */
+void IslandSolverPool::solveGroups(btSequentialImpulseConstraintSolver *solver)
+{
+    const int num_groups = (int)m_groups->size();
+    while (true)
+    {
+        int n = m_next_group.fetch_add(1);
+        if (n >= num_groups)
+            return;
+        const IslandGroup &g = (*m_groups)[n];
+        // Only relevant for SOLVER_RANDMIZE_ORDER: make the result
+        // independent of which solver handled the previous groups.
+        solver->setRandSeed(0);
+        solver->solveGroup(g.m_bodies, g.m_num_bodies,
+                           g.m_manifolds, g.m_num_manifolds,
+                           g.m_constraints, g.m_num_constraints,
+                           *m_info, m_debug_drawer, m_stack_alloc,
+                           m_dispatcher);
+    }
+}   // solveGroups
+
+// ----------------------------------------------------------------------------
+/** Solves all island groups, and returns once all of them are done. The
+ *  calling thread solves groups as well.
+ *  \param groups The island groups to solve.
+ *  Other parameters: see bullet's btConstraintSolver::solveGroup.
+ */
+void IslandSolverPool::solve(const std::vector<IslandGroup> &groups,
+                             const btContactSolverInfo &info,
+                             btIDebugDraw *debug_drawer,
+                             btStackAlloc *stack_alloc,
+                             btDispatcher *dispatcher)
+{
+    if (groups.empty())
+        return;
+
+    m_groups       = &groups;
+    m_info         = &info;
+    m_debug_drawer = debug_drawer;
+    m_stack_alloc  = stack_alloc;
+    m_dispatcher   = dispatcher;
+    m_next_group.store(0);
+
+    // Waking up workers costs more than solving a single group
+    if (groups.size() == 1 || m_threads.empty())
+    {
+        solveGroups(m_solvers[0]);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy_workers = (unsigned int)m_threads.size();
+        m_generation++;
+    }
+    m_start_cv.notify_all();
+
+    solveGroups(m_solvers[0]);
+
+    std::unique_lock<std::mutex> ul(m_mutex);
+    m_done_cv.wait(ul, [this] { return m_busy_workers == 0; });
+}   // solve
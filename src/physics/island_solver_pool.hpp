@@ -0,0 +1,112 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_ISLAND_SOLVER_POOL_HPP
+#define HEADER_ISLAND_SOLVER_POOL_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class btCollisionObject;
+class btDispatcher;
+class btIDebugDraw;
+class btPersistentManifold;
+class btSequentialImpulseConstraintSolver;
+class btStackAlloc;
+class btTypedConstraint;
+struct btContactSolverInfo;
+
+/**
+  * \ingroup physics
+  * A small set of persistent worker threads, each with its own sequential
+  * impulse solver, which solves independent groups of simulation islands
+  * concurrently. Bullet's islands never share a dynamic body, so the
+  * result of solving them does not depend on which thread picks up which
+  * group, or in which order they are solved.
+  */
+class IslandSolverPool : public NoCopy
+{
+public:
+    /** A group of one or more consecutive simulation islands which is
+     *  solved with one call to solveGroup. The pointers refer to arrays
+     *  owned by the caller of solve(). */
+    struct IslandGroup
+    {
+        btCollisionObject    **m_bodies;
+        int                    m_num_bodies;
+        btPersistentManifold **m_manifolds;
+        int                    m_num_manifolds;
+        btTypedConstraint    **m_constraints;
+        int                    m_num_constraints;
+    };   // IslandGroup
+
+private:
+    /** The worker threads. The thread calling solve() takes part in the
+     *  work as well, so there is one thread less than solvers. */
+    std::vector<std::thread> m_threads;
+
+    /** One solver for each thread (index 0 is used by the calling thread),
+     *  since the solver keeps its temporary constraint pools as members. */
+    std::vector<btSequentialImpulseConstraintSolver*> m_solvers;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_start_cv;
+    std::condition_variable m_done_cv;
+
+    /** Incremented for each call to solve(), so that workers can detect
+     *  that new work is available. */
+    unsigned int            m_generation;
+
+    /** Number of workers that have not yet finished the current batch. */
+    unsigned int            m_busy_workers;
+
+    /** Set in the destructor to terminate all worker threads. */
+    bool                    m_exit;
+
+    /** Index of the next island group to be solved. */
+    std::atomic<int>        m_next_group;
+
+    /** The data of the current call to solve(). */
+    const std::vector<IslandGroup> *m_groups;
+    const btContactSolverInfo      *m_info;
+    btIDebugDraw                   *m_debug_drawer;
+    btStackAlloc                   *m_stack_alloc;
+    btDispatcher                   *m_dispatcher;
+
+    void workerLoop(unsigned int index);
+    void solveGroups(btSequentialImpulseConstraintSolver *solver);
+
+public:
+         IslandSolverPool(unsigned int num_threads);
+        ~IslandSolverPool();
+    void solve(const std::vector<IslandGroup> &groups,
+               const btContactSolverInfo &info, btIDebugDraw *debug_drawer,
+               btStackAlloc *stack_alloc, btDispatcher *dispatcher);
+    // ------------------------------------------------------------------------
+    /** Returns the number of threads (including the calling thread) which
+     *  are used to solve islands. */
+    unsigned int getNumThreads() const
+                                  { return (unsigned int)m_solvers.size(); }
+};   // IslandSolverPool
+
+#endif
@@ -32,6 +32,7 @@
 #include "network/compress_network_body.hpp"
 #include "network/network_config.hpp"
 #include "network/protocols/lobby_protocol.hpp"
+#include "scriptengine/script_engine.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_object.hpp"
 #include "utils/constants.hpp"
@@ -167,6 +168,9 @@ PhysicalObject::PhysicalObject(bool is_dynamic,
     m_reset_height       = settings.m_reset_height;
     m_on_kart_collision  = settings.m_on_kart_collision;
     m_on_item_collision  = settings.m_on_item_collision;
+    m_on_kart_collision_function = NULL;
+    m_on_item_collision_function = NULL;
+    m_script_functions_resolved  = false;
     m_current_transform.setOrigin(Vec3());
     m_current_transform.setRotation(
         btQuaternion(0.0f, 0.0f, 0.0f, 1.0f));
@@ -625,6 +629,30 @@ void PhysicalObject::updateGraphics(float dt)
                    /* isAbsoluteCoord */true);
 }   // updateGraphics
 
+// ----------------------------------------------------------------------------
+/** Looks up the script functions to call on collisions. This is done on
+ *  first use, since the scripts of a track are only compiled after all
+ *  objects are loaded.
+ */
+void PhysicalObject::resolveScriptFunctions()
+{
+    Scripting::ScriptEngine* script_engine =
+                                         Scripting::ScriptEngine::getInstance();
+    if (!m_on_kart_collision.empty())
+    {
+        m_on_kart_collision_function = script_engine->getFunction(
+            "void " + m_on_kart_collision + "(int, const string, const string)",
+            /*warn_if_not_found*/true);
+    }
+    if (!m_on_item_collision.empty())
+    {
+        m_on_item_collision_function = script_engine->getFunction(
+            "void " + m_on_item_collision + "(int, int, const string)",
+            /*warn_if_not_found*/true);
+    }
+    m_script_functions_resolved = true;
+}   // resolveScriptFunctions
+
 // ----------------------------------------------------------------------------
 /** Update, called once per physics time step.
  *  \param dt Timestep.
@@ -30,6 +30,7 @@
 #include "utils/leak_check.hpp"
 
 
+class asIScriptFunction;
 class Material;
 class TrackObject;
 class XMLNode;
@@ -180,6 +181,12 @@ private:
     * when a (flyable) item collides with this object
     */
     std::string           m_on_item_collision;
+    /** The script functions for m_on_kart_collision and m_on_item_collision,
+     *  or NULL. Only valid if m_script_functions_resolved is true. */
+    asIScriptFunction    *m_on_kart_collision_function;
+    asIScriptFunction    *m_on_item_collision_function;
+    /** True once the script functions were looked up. */
+    bool                  m_script_functions_resolved;
     /** If this body is a bullet dynamic body, i.e. affected by physics
      *  or not (static (not moving) or kinematic (animated outside
      *  of physics). */
@@ -252,6 +259,26 @@ public:
     // ------------------------------------------------------------------------
     const std::string& getOnItemCollisionFunction() const { return m_on_item_collision; }
     // ------------------------------------------------------------------------
+    void resolveScriptFunctions();
+    // ------------------------------------------------------------------------
+    /** Returns the script function to call when a kart hits this object,
+     *  or NULL if there is none. */
+    asIScriptFunction* getOnKartCollisionScript()
+    {
+        if (!m_script_functions_resolved)
+            resolveScriptFunctions();
+        return m_on_kart_collision_function;
+    }   // getOnKartCollisionScript
+    // ------------------------------------------------------------------------
+    /** Returns the script function to call when an item hits this object,
+     *  or NULL if there is none. */
+    asIScriptFunction* getOnItemCollisionScript()
+    {
+        if (!m_script_functions_resolved)
+            resolveScriptFunctions();
+        return m_on_item_collision_function;
+    }   // getOnItemCollisionScript
+    // ------------------------------------------------------------------------
     TrackObject* getTrackObject() { return m_object; }
 
     // Methods usable by scripts
@@ -44,6 +44,9 @@
 #include "tracks/track_object.hpp"
 #include "utils/profiler.hpp"
 
+#include <algorithm>
+#include <thread>
+
 // ----------------------------------------------------------------------------
 /** Initialise physics.
  *  Create the bullet dynamics world.
@@ -74,6 +77,15 @@ void Physics::init(const Vec3 &world_min, const Vec3 &world_max)
                   0.0f));
     m_debug_drawer = new IrrDebugDrawer();
     m_dynamics_world->setDebugDrawer(m_debug_drawer);
+    if(UserConfigParams::m_physics_threads > 1)
+    {
+        // More threads than cores would only wait for each other
+        unsigned int num_threads = UserConfigParams::m_physics_threads;
+        const unsigned int cores = std::thread::hardware_concurrency();
+        if (cores > 0)
+            num_threads = std::min(num_threads, cores);
+        m_dynamics_world->setNumSolverThreads(num_threads);
+    }
 
     // Get the solver settings from the config file
     btContactSolverInfo& info = m_dynamics_world->getSolverInfo();
@@ -194,13 +206,19 @@ void Physics::update(int ticks)
                               p->getContactPointCS(1)                );
             Scripting::ScriptEngine* script_engine =
                                             Scripting::ScriptEngine::getInstance();
-            int kartid1 = p->getUserPointer(0)->getPointerKart()->getWorldKartId();
-            int kartid2 = p->getUserPointer(1)->getPointerKart()->getWorldKartId();
-            script_engine->runFunction(false, "void onKartKartCollision(int, int)",
-                [=](asIScriptContext* ctx) {
-                    ctx->SetArgDWord(0, kartid1);
-                    ctx->SetArgDWord(1, kartid2);
-                });
+            asIScriptFunction* func =
+                script_engine->getHook(Scripting::SH_KART_KART_COLLISION);
+            asIScriptContext* ctx =
+                func ? script_engine->prepareContext(func) : NULL;
+            if (ctx)
+            {
+                ctx->SetArgDWord(0, p->getUserPointer(0)->getPointerKart()
+                                     ->getWorldKartId());
+                ctx->SetArgDWord(1, p->getUserPointer(1)->getPointerKart()
+                                     ->getWorldKartId());
+                script_engine->executeContext(ctx);
+                script_engine->releaseContext(ctx);
+            }
             continue;
         }  // if kart-kart collision
 
@@ -208,29 +226,29 @@ void Physics::update(int ticks)
         {
             // Kart hits physical object
             // -------------------------
-            Scripting::ScriptEngine* script_engine = Scripting::ScriptEngine::getInstance();
             AbstractKart *kart = p->getUserPointer(1)->getPointerKart();
-            int kartId = kart->getWorldKartId();
             PhysicalObject* obj = p->getUserPointer(0)->getPointerPhysicalObject();
-            std::string obj_id = obj->getID();
-            std::string scripting_function = obj->getOnKartCollisionFunction();
-
-            TrackObject* to = obj->getTrackObject();
-            TrackObject* library = to->getParentLibrary();
-            std::string lib_id;
-            std::string* lib_id_ptr = NULL;
-            if (library != NULL)
-                lib_id = library->getID();
-            lib_id_ptr = &lib_id;
-
-            if (scripting_function.size() > 0)
+            asIScriptFunction* func = obj->getOnKartCollisionScript();
+            if (func)
             {
-                script_engine->runFunction(true, "void " + scripting_function + "(int, const string, const string)",
-                    [&](asIScriptContext* ctx) {
-                        ctx->SetArgDWord(0, kartId);
-                        ctx->SetArgObject(1, lib_id_ptr);
-                        ctx->SetArgObject(2, &obj_id);
-                    });
+                Scripting::ScriptEngine* script_engine =
+                                         Scripting::ScriptEngine::getInstance();
+                std::string obj_id = obj->getID();
+                TrackObject* to = obj->getTrackObject();
+                TrackObject* library = to->getParentLibrary();
+                std::string lib_id;
+                if (library != NULL)
+                    lib_id = library->getID();
+
+                asIScriptContext* ctx = script_engine->prepareContext(func);
+                if (ctx)
+                {
+                    ctx->SetArgDWord(0, kart->getWorldKartId());
+                    ctx->SetArgObject(1, &lib_id);
+                    ctx->SetArgObject(2, &obj_id);
+                    script_engine->executeContext(ctx);
+                    script_engine->releaseContext(ctx);
+                }
             }
             if (obj->isCrashReset())
             {
@@ -259,7 +277,7 @@ void Physics::update(int ticks)
                     race_manager->getMinorMode() == RaceManager::MINOR_MODE_SOCCER)
             {
                 SoccerWorld* soccerWorld = (SoccerWorld*)World::getWorld();
-                soccerWorld->setBallHitter(kartId);
+                soccerWorld->setBallHitter(kart->getWorldKartId());
             }
             continue;
         }
@@ -311,19 +329,23 @@ void Physics::update(int ticks)
         {
             // Projectile hits physical object
             // -------------------------------
-            Scripting::ScriptEngine* script_engine = Scripting::ScriptEngine::getInstance();
             Flyable* flyable = p->getUserPointer(0)->getPointerFlyable();
             PhysicalObject* obj = p->getUserPointer(1)->getPointerPhysicalObject();
-            std::string obj_id = obj->getID();
-            std::string scripting_function = obj->getOnItemCollisionFunction();
-            if (scripting_function.size() > 0)
+            asIScriptFunction* func = obj->getOnItemCollisionScript();
+            if (func)
             {
-                script_engine->runFunction(true, "void " + scripting_function + "(int, int, const string)",
-                        [&](asIScriptContext* ctx) {
-                        ctx->SetArgDWord(0, (int)flyable->getType());
-                        ctx->SetArgDWord(1, flyable->getOwnerId());
-                        ctx->SetArgObject(2, &obj_id);
-                    });
+                Scripting::ScriptEngine* script_engine =
+                                         Scripting::ScriptEngine::getInstance();
+                std::string obj_id = obj->getID();
+                asIScriptContext* ctx = script_engine->prepareContext(func);
+                if (ctx)
+                {
+                    ctx->SetArgDWord(0, (int)flyable->getType());
+                    ctx->SetArgDWord(1, flyable->getOwnerId());
+                    ctx->SetArgObject(2, &obj_id);
+                    script_engine->executeContext(ctx);
+                    script_engine->releaseContext(ctx);
+                }
             }
             flyable->hit(NULL, obj);
 
@@ -554,6 +576,35 @@ btScalar Physics::solveGroup(btCollisionObject** bodies, int numBodies,
                                                         debugDrawer,
                                                         stackAlloc,
                                                         dispatcher);
+    collectCollisions();
+    return returnValue;
+}   // solveGroup
+
+//-----------------------------------------------------------------------------
+/** Called by bullet once all islands of a time step are solved. If the
+ *  islands are solved in parallel, solveGroup of this object is not called
+ *  (each thread uses its own solver), so the collisions are collected here
+ *  instead, once per step on the main thread (sequential solving collects
+ *  them after each island). The manifolds are visited in the order of the
+ *  dispatcher, so m_all_collisions is still deterministic, but a collision
+ *  is only added once per step (which is what the list does anyway).
+ *  Parameters: see bullet documentation for details.
+ */
+void Physics::allSolved(const btContactSolverInfo& info,
+                        btIDebugDraw* debugDrawer, btStackAlloc* stackAlloc)
+{
+    if(m_dynamics_world->solvesIslandsInParallel() &&
+       m_dynamics_world->getNumSolvedGroups() > 0)
+        collectCollisions();
+}   // allSolved
+
+//-----------------------------------------------------------------------------
+/** Stores all collisions reported by the dispatcher in m_all_collisions (or
+ *  handles them immediately if they only affect a single object, e.g. a kart
+ *  hitting the track).
+ */
+void Physics::collectCollisions()
+{
     int currentNumManifolds = m_dispatcher->getNumManifolds();
     // We can't explode a rocket in a loop, since a rocket might collide with
     // more than one object, and/or more than once with each object (if there
@@ -725,9 +776,7 @@ btScalar Physics::solveGroup(btCollisionObject** bodies, int numBodies,
         else
             assert("Unknown user pointer");           // 4) Should never happen
     }   // for i<numManifolds
-
-    return returnValue;
-}   // solveGroup
+}   // collectCollisions
 
 // ----------------------------------------------------------------------------
 /** A debug draw function to show the track and all karts.
@@ -158,6 +158,8 @@ private:
     // Give the singleton access to the constructor
     friend class AbstractSingleton<Physics>;
 
+    void  collectCollisions();
+
 public:
     void  init             (const Vec3 &min_world, const Vec3 &max_world);
     void  addKart          (const AbstractKart *k);
@@ -183,6 +185,8 @@ public:
                                 const btContactSolverInfo& info,
                                 btIDebugDraw* debugDrawer, btStackAlloc* stackAlloc,
                                 btDispatcher* dispatcher);
+    virtual void allSolved(const btContactSolverInfo& info,
+                           btIDebugDraw* debugDrawer, btStackAlloc* stackAlloc);
 };
 
 #endif // HEADER_PHYSICS_HPP
@@ -0,0 +1,212 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "physics/stk_dynamics_world.hpp"
+
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
+
+#include "utils/log.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    /** Same as bullet's btGetConstraintIslandId, which is local to
+     *  btDiscreteDynamicsWorld.cpp. */
+    int getConstraintIslandId(const btTypedConstraint *c)
+    {
+        const btCollisionObject &a = c->getRigidBodyA();
+        const btCollisionObject &b = c->getRigidBodyB();
+        return a.getIslandTag() >= 0 ? a.getIslandTag() : b.getIslandTag();
+    }   // getConstraintIslandId
+
+    // ------------------------------------------------------------------------
+    struct SortConstraintOnIsland
+    {
+        bool operator()(const btTypedConstraint *lhs,
+                        const btTypedConstraint *rhs) const
+        {
+            return getConstraintIslandId(lhs) < getConstraintIslandId(rhs);
+        }
+    };   // SortConstraintOnIsland
+
+    // ------------------------------------------------------------------------
+    /** Island callback that only records the islands (as offsets into
+     *  arrays owned by the world), so that they can be solved later. */
+    class IslandCollector : public btSimulationIslandManager::IslandCallback
+    {
+    public:
+        struct Island
+        {
+            int m_first_body, m_num_bodies;
+            int m_first_manifold, m_num_manifolds;
+            int m_first_constraint, m_num_constraints;
+        };
+        std::vector<Island>                 m_islands;
+        std::vector<btCollisionObject*>    *m_bodies;
+        std::vector<btPersistentManifold*> *m_manifolds;
+        std::vector<btTypedConstraint*>     m_constraints;
+        btTypedConstraint                 **m_sorted_constraints;
+        int                                 m_num_sorted_constraints;
+
+        virtual void ProcessIsland(btCollisionObject **bodies, int num_bodies,
+                                   btPersistentManifold **manifolds,
+                                   int num_manifolds, int island_id)
+        {
+            Island island;
+            island.m_first_constraint = (int)m_constraints.size();
+            for (int i = 0; i < m_num_sorted_constraints; i++)
+            {
+                // A negative island id means islands are not split, so
+                // all constraints belong to this 'island'.
+                if (island_id < 0 ||
+                    getConstraintIslandId(m_sorted_constraints[i])==island_id)
+                    m_constraints.push_back(m_sorted_constraints[i]);
+            }
+            island.m_num_constraints = (int)m_constraints.size()
+                                     - island.m_first_constraint;
+            // Like bullet: only solve if there is some work
+            if (num_manifolds + island.m_num_constraints == 0)
+                return;
+
+            island.m_first_body     = (int)m_bodies->size();
+            island.m_num_bodies     = num_bodies;
+            m_bodies->insert(m_bodies->end(), bodies, bodies + num_bodies);
+            island.m_first_manifold = (int)m_manifolds->size();
+            island.m_num_manifolds  = num_manifolds;
+            m_manifolds->insert(m_manifolds->end(), manifolds,
+                                manifolds + num_manifolds);
+            m_islands.push_back(island);
+        }   // ProcessIsland
+    };   // IslandCollector
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Sets the number of threads used to solve the simulation islands.
+ *  \param n Number of threads. 0 or 1 means that the islands are solved by
+ *         bullet one after another on the calling thread.
+ */
+void STKDynamicsWorld::setNumSolverThreads(unsigned int n)
+{
+    delete m_island_solver_pool;
+    m_island_solver_pool = NULL;
+    if (n > 1)
+    {
+        m_island_solver_pool = new IslandSolverPool(n);
+        Log::info("STKDynamicsWorld",
+                  "Solving simulation islands with %d threads.", n);
+    }
+}   // setNumSolverThreads
+
+// ----------------------------------------------------------------------------
+/** Solves all constraints. If no island solver pool is used, this is
+ *  bullet's normal sequential implementation.
+ */
+void STKDynamicsWorld::solveConstraints(btContactSolverInfo &solver_info)
+{
+    if (!m_island_solver_pool)
+    {
+        btDiscreteDynamicsWorld::solveConstraints(solver_info);
+        return;
+    }
+    solveConstraintsParallel(solver_info);
+}   // solveConstraints
+
+// ----------------------------------------------------------------------------
+/** Collects all simulation islands, combines small islands into groups
+ *  of similar size, and solves these groups on the island solver pool.
+ *  Afterwards the constraint solver of this world is informed with
+ *  allSolved(), so that it can handle the collisions of this step.
+ */
+void STKDynamicsWorld::solveConstraintsParallel(btContactSolverInfo
+                                                &solver_info)
+{
+    m_sorted_constraints.resize(m_constraints.size());
+    for (int i = 0; i < m_constraints.size(); i++)
+        m_sorted_constraints[i] = m_constraints[i];
+    m_sorted_constraints.quickSort(SortConstraintOnIsland());
+
+    m_island_bodies.clear();
+    m_island_manifolds.clear();
+    IslandCollector collector;
+    collector.m_bodies    = &m_island_bodies;
+    collector.m_manifolds = &m_island_manifolds;
+    collector.m_sorted_constraints = m_sorted_constraints.size()
+                                   ? &m_sorted_constraints[0] : NULL;
+    collector.m_num_sorted_constraints = m_sorted_constraints.size();
+
+    m_constraintSolver->prepareSolve(getNumCollisionObjects(),
+                                     getDispatcher()->getNumManifolds());
+    m_islandManager->buildAndProcessIslands(getDispatcher(), this,
+                                            &collector);
+
+    // Combine consecutive islands into groups, so that each thread gets
+    // a few groups of about the same amount of work, but never more work
+    // in one group than bullet would have combined anyway.
+    int total_work = 0;
+    for (const IslandCollector::Island &island : collector.m_islands)
+        total_work += island.m_num_manifolds + island.m_num_constraints;
+    const int num_threads = (int)m_island_solver_pool->getNumThreads();
+    const int batch_size = std::max(1,
+        std::min(solver_info.m_minimumSolverBatchSize,
+                 total_work / (2 * num_threads)));
+
+    m_island_groups.clear();
+    IslandSolverPool::IslandGroup group;
+    int group_work = 0;
+    for (unsigned int i = 0; i < collector.m_islands.size(); i++)
+    {
+        const IslandCollector::Island &island = collector.m_islands[i];
+        if (group_work == 0)
+        {
+            group.m_bodies          = &m_island_bodies[island.m_first_body];
+            group.m_num_bodies      = 0;
+            group.m_manifolds       = NULL;
+            group.m_num_manifolds   = 0;
+            group.m_constraints     = NULL;
+            group.m_num_constraints = 0;
+        }
+        // Islands are stored consecutively, so a group is just a range
+        if (!group.m_manifolds && island.m_num_manifolds)
+            group.m_manifolds = &m_island_manifolds[island.m_first_manifold];
+        if (!group.m_constraints && island.m_num_constraints)
+        {
+            group.m_constraints =
+                &collector.m_constraints[island.m_first_constraint];
+        }
+        group.m_num_bodies      += island.m_num_bodies;
+        group.m_num_manifolds   += island.m_num_manifolds;
+        group.m_num_constraints += island.m_num_constraints;
+        group_work += island.m_num_manifolds + island.m_num_constraints;
+        if (group_work >= batch_size || i + 1 == collector.m_islands.size())
+        {
+            m_island_groups.push_back(group);
+            group_work = 0;
+        }
+    }
+
+    m_island_solver_pool->solve(m_island_groups, solver_info,
+                                getDebugDrawer(), m_stackAlloc,
+                                getDispatcher());
+    m_num_solved_groups = (int)m_island_groups.size();
+
+    m_constraintSolver->allSolved(solver_info, getDebugDrawer(),
+                                  m_stackAlloc);
+}   // solveConstraintsParallel
+
+/* EOF */
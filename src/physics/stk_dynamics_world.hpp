@@ -21,12 +21,39 @@
 
 #include "btBulletDynamicsCommon.h"
 
+#include "physics/island_solver_pool.hpp"
+
+#include <vector>
+
 /** A thin wrapper around bullet's btDiscreteDynamicsWorld. Used to
  *  be able to query and set the 'left over' time from a previous
  *  time step, which is needed for more precise rewind/replays.
+ *  It can also solve the simulation islands on several threads (see
+ *  setNumSolverThreads).
  */
 class STKDynamicsWorld : public btDiscreteDynamicsWorld
 {
+private:
+    /** If not NULL, the simulation islands are solved by the threads of
+     *  this pool instead of the constraint solver of this world. */
+    IslandSolverPool *m_island_solver_pool;
+
+    /** Number of island groups solved in the last call to
+     *  solveConstraints. */
+    int m_num_solved_groups;
+
+    /** Temporary storage used to collect the islands in solveConstraints.
+     *  Kept as members to avoid reallocation in each physics step. */
+    std::vector<btCollisionObject*>          m_island_bodies;
+    std::vector<btPersistentManifold*>       m_island_manifolds;
+    btAlignedObjectArray<btTypedConstraint*> m_sorted_constraints;
+    std::vector<IslandSolverPool::IslandGroup> m_island_groups;
+
+    void solveConstraintsParallel(btContactSolverInfo &solver_info);
+
+protected:
+    virtual void solveConstraints(btContactSolverInfo &solver_info);
+
 public:
     /** The standard constructor which just created a btDiscreteDynamicsWorld. */
     STKDynamicsWorld(btDispatcher*             dispatcher,
@@ -38,8 +65,14 @@ public:
                                              constraintSolver,
                                              collisionConfiguration)
     {
+        m_island_solver_pool = NULL;
+        m_num_solved_groups  = 0;
     }
-
+    // ------------------------------------------------------------------------
+    virtual ~STKDynamicsWorld() { delete m_island_solver_pool; }
+    // ------------------------------------------------------------------------
+    void setNumSolverThreads(unsigned int n);
+    // ------------------------------------------------------------------------
     /** Resets m_localTime to 0. This allows more precise replay of
      *  physics, which is important for replaying histories. */
     void resetLocalTime() { m_localTime = 0; }
@@ -49,7 +82,14 @@ public:
     // ------------------------------------------------------------------------
     /** Gets the local time. */
     float getLocalTime() const { return m_localTime; }
+    // ------------------------------------------------------------------------
+    /** Returns true if simulation islands are solved on several threads. */
+    bool solvesIslandsInParallel() const
+                                     { return m_island_solver_pool != NULL; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of island groups that were solved in the last
+     *  physics step (only updated if islands are solved in parallel). */
+    int getNumSolvedGroups() const { return m_num_solved_groups; }
 };   // STKDynamicsWorld
 #endif
 /* EOF */
-
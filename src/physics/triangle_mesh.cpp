@@ -26,7 +26,7 @@
 
 #include "btBulletDynamicsCommon.h"
 
-#include <fstream>
+#include <cstring>
 
 // -----------------------------------------------------------------------------
 /** Constructor: Initialises all data structures with zero.
@@ -44,6 +44,7 @@ TriangleMesh::TriangleMesh(bool can_be_transformed) : m_mesh()
     // (and m_mesh->m_weldingThreshold at m_normals
     m_collision_shape  = NULL;
     m_collision_object = NULL;
+    m_bvh_buffer       = NULL;
     m_user_pointer.set(this);
 }   // TriangleMesh
 
@@ -86,13 +87,47 @@ void TriangleMesh::addTriangle(const btVector3 &t1, const btVector3 &t2,
     m_p1p2p3.push_back(edge1.cross(edge2).length2());
 }   // addTriangle
 
+// -----------------------------------------------------------------------------
+/** Adds triangles which were already processed by addTriangle before (e.g.
+ *  in a previous run, see CollisionCache), so the normals are not smoothed
+ *  again.
+ *  \param num_triangles Number of triangles to add.
+ *  \param vertices The three points of each triangle.
+ *  \param normals The three (smoothed) normals of each triangle.
+ *  \param p1p2p3 The pre-computed smoothing value of each triangle.
+ *  \param materials The material of each triangle.
+ */
+void TriangleMesh::addTriangles(unsigned int num_triangles,
+                                const btVector3 *vertices,
+                                const btVector3 *normals,
+                                const float *p1p2p3,
+                                const Material* const *materials)
+{
+    m_triangleIndex2Material.insert(m_triangleIndex2Material.end(),
+                                    materials, materials + num_triangles);
+    m_normals.reserve(m_normals.size() + 3 * num_triangles);
+    m_p1p2p3.reserve(m_p1p2p3.size() + num_triangles);
+    for (unsigned int i = 0; i < num_triangles; i++)
+    {
+        m_mesh.addTriangle(vertices[3*i], vertices[3*i+1], vertices[3*i+2]);
+        m_normals.push_back(normals[3*i  ]);
+        m_normals.push_back(normals[3*i+1]);
+        m_normals.push_back(normals[3*i+2]);
+        m_p1p2p3.push_back(p1p2p3[i]);
+    }
+}   // addTriangles
+
 // -----------------------------------------------------------------------------
 /** Creates a collision body only, which can be used for raycasting, but
  *  has no physical properties.
- *  @param serialized_bhv if non-null, load the serialized bhv from file instead
- *                        of builing it on the fly
+ *  \param serialized_bvh If not NULL, the BVH is deserialized from this
+ *         data (see serializeBvh) instead of being built on the fly. The
+ *         data is copied, so it does not need to stay valid.
+ *  \param serialized_bvh_size Size of the serialized data.
  */
-void TriangleMesh::createCollisionShape(bool create_collision_object, const char* serialized_bhv)
+void TriangleMesh::createCollisionShape(bool create_collision_object,
+                                        const char *serialized_bvh,
+                                        size_t serialized_bvh_size)
 {
     if(m_triangleIndex2Material.size()==0)
     {
@@ -103,58 +138,43 @@ void TriangleMesh::createCollisionShape(bool create_collision_object, const char
         return;
     }
     // Now convert the triangle mesh into a static rigid body
-    btBvhTriangleMeshShape* bhv_triangle_mesh;
+    btBvhTriangleMeshShape* bvh_triangle_mesh = NULL;
 
-    if (serialized_bhv != NULL)
+    if (serialized_bvh != NULL)
     {
-        FILE *f = fopen(serialized_bhv, "rb");
-        fseek(f, 0, SEEK_END);
-        long pos = ftell(f);
-        assert(pos != -1L);
-        fseek(f, 0, SEEK_SET);
-
-        void* bytes = btAlignedAlloc(pos, 16);
-        fread(bytes, pos, 1, f);
-        fclose(f);
-
-        btOptimizedBvh* bhv = btOptimizedBvh::deSerializeInPlace(bytes, pos, !IS_LITTLE_ENDIAN);
-        if (bhv == NULL)
+        // 'deSerializeInPlace' creates the btOptimizedBvh object directly
+        // in this (aligned and writable) memory, so it is only freed in
+        // removeAll.
+        assert(m_bvh_buffer == NULL);
+        m_bvh_buffer = btAlignedAlloc(serialized_bvh_size, 16);
+        memcpy(m_bvh_buffer, serialized_bvh, serialized_bvh_size);
+        btOptimizedBvh* bvh =
+            btOptimizedBvh::deSerializeInPlace(m_bvh_buffer,
+                                               (unsigned)serialized_bvh_size,
+                                               !IS_LITTLE_ENDIAN);
+        if (bvh == NULL)
         {
-            Log::warn("TriangleMesh", "Failed to load serialized BHV");
-            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
+            Log::warn("TriangleMesh", "Failed to load serialized BVH.");
+            btAlignedFree(m_bvh_buffer);
+            m_bvh_buffer = NULL;
         }
         else
         {
-            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */,
-                                                           false /* buildBvh */);
-            bhv_triangle_mesh->setOptimizedBvh( bhv );
+            bvh_triangle_mesh =
+                new btBvhTriangleMeshShape(&m_mesh,
+                                           false /* useQuantizedAabbCompression */,
+                                           false /* buildBvh */);
+            bvh_triangle_mesh->setOptimizedBvh(bvh);
         }
-        // Do *NOT* free the bytes, 'deSerializeInPlace' makes the btOptimizedBvh object
-        // directly at this memory location
-        //free(bytes);
-
     }
-    else
+    if (bvh_triangle_mesh == NULL)
     {
-        bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
-
-        /*
-         // code to serialize triangle mesh
-        btOptimizedBvh* bvh = bhv_triangle_mesh->getOptimizedBvh();
-        unsigned int ssize = bvh->calculateSerializeBufferSize();
-        char* buffer = (char*)btAlignedAlloc(ssize, 16);
-        bool success = bvh->serialize(buffer, ssize, !IS_LITTLE_ENDIAN);
-        printf("serialization success = %i\n", success);
-
-        std::ofstream fileout("/tmp/btOptimizedBvh");
-        fileout.write(buffer, ssize);
-        fileout.close();
-
-        btAlignedFree(buffer);
-         */
+        bvh_triangle_mesh =
+            new btBvhTriangleMeshShape(&m_mesh,
+                                       false /* useQuantizedAabbCompression */);
     }
 
-    m_collision_shape = bhv_triangle_mesh;
+    m_collision_shape = bvh_triangle_mesh;
     m_collision_shape->setUserPointer(&m_user_pointer);
     if(create_collision_object)
     {
@@ -167,6 +187,31 @@ void TriangleMesh::createCollisionShape(bool create_collision_object, const char
 
 }   // createCollisionShape
 
+// -----------------------------------------------------------------------------
+/** Serializes the BVH of the collision shape, so that it can be used in
+ *  createCollisionShape later. The data is only valid for the same
+ *  triangles (in the same order) and the same executable.
+ *  \param out The serialized data is appended to this string.
+ *  \return False if there is no collision shape or serialization failed.
+ */
+bool TriangleMesh::serializeBvh(std::string *out) const
+{
+    if (m_collision_shape == NULL)
+        return false;
+    const btOptimizedBvh *bvh =
+        ((btBvhTriangleMeshShape*)m_collision_shape)->getOptimizedBvh();
+    if (bvh == NULL)
+        return false;
+    const unsigned int size = bvh->calculateSerializeBufferSize();
+    void *buffer = btAlignedAlloc(size, 16);
+    const bool success = bvh->serializeInPlace(buffer, size,
+                                               !IS_LITTLE_ENDIAN);
+    if (success)
+        out->append((const char*)buffer, size);
+    btAlignedFree(buffer);
+    return success;
+}   // serializeBvh
+
 // -----------------------------------------------------------------------------
 /** Creates the physics body for this triangle mesh. If the body already
  *  exists (because it was created by a previous call to createBody)
@@ -178,16 +223,19 @@ void TriangleMesh::createCollisionShape(bool create_collision_object, const char
  *  for height of terrain detection).
  *  \param friction Friction to be used for this TriangleMesh.
  *  \param flags Additional collision flags (default 0).
- *  \param serializedBhv if non-NULL, the bhv is deserialized instead of
- *                       being calculated on the fly
+ *  \param serialized_bvh If not NULL, the BVH is deserialized instead of
+ *         being calculated on the fly (see createCollisionShape).
+ *  \param serialized_bvh_size Size of the serialized data.
  */
 void TriangleMesh::createPhysicalBody(float friction,
                                       btCollisionObject::CollisionFlags flags,
-                                      const char* serializedBhv)
+                                      const char *serialized_bvh,
+                                      size_t serialized_bvh_size)
 {
     // We need the collision shape, but not the collision object (since
     // this will be created when the dynamics body is anyway).
-    createCollisionShape(/*create_collision_object*/false, serializedBhv);
+    createCollisionShape(/*create_collision_object*/false, serialized_bvh,
+                         serialized_bvh_size);
     main_loop->renderGUI(5583);
 
     btTransform startTransform;
@@ -232,6 +280,12 @@ void TriangleMesh::removeAll()
     }
     delete m_collision_shape;
     m_collision_shape = NULL;
+    if (m_bvh_buffer)
+    {
+        ((btOptimizedBvh*)m_bvh_buffer)->~btOptimizedBvh();
+        btAlignedFree(m_bvh_buffer);
+        m_bvh_buffer = NULL;
+    }
 }   // removeAll
 
 // -----------------------------------------------------------------------------
@@ -19,6 +19,7 @@
 #ifndef HEADER_TRIANGLE_MESH_HPP
 #define HEADER_TRIANGLE_MESH_HPP
 
+#include <string>
 #include <vector>
 #include "btBulletDynamicsCommon.h"
 
@@ -46,6 +47,10 @@ private:
     btDefaultMotionState        *m_motion_state;
     btCollisionShape            *m_collision_shape;
 
+    /** If the BVH was deserialized, the memory in which it was created (it
+     *  must stay valid as long as the collision shape exists). */
+    void                        *m_bvh_buffer;
+
     /** The three normals for each triangle. */
     AlignedArray<btVector3>      m_normals;
 
@@ -76,11 +81,18 @@ public:
                      const btVector3 &t3, const btVector3 &n1,
                      const btVector3 &n2, const btVector3 &n3,
                      const Material* m);
-    void createCollisionShape(bool create_collision_object=true, const char* serialized_bhv=NULL);
+    void addTriangles(unsigned int num_triangles, const btVector3 *vertices,
+                      const btVector3 *normals, const float *p1p2p3,
+                      const Material* const *materials);
+    void createCollisionShape(bool create_collision_object=true,
+                              const char *serialized_bvh=NULL,
+                              size_t serialized_bvh_size=0);
     void createPhysicalBody(float friction,
                             btCollisionObject::CollisionFlags flags=
                                (btCollisionObject::CollisionFlags)0,
-                            const char* serializedBhv = NULL);
+                            const char *serialized_bvh=NULL,
+                            size_t serialized_bvh_size=0);
+    bool serializeBvh(std::string *out) const;
     void removeAll();
     void removeCollisionObject();
     btVector3 getInterpolatedNormal(unsigned int index,
@@ -104,6 +116,10 @@ public:
     const Material* getMaterial(int n) const
                                           {return m_triangleIndex2Material[n];}
     // ------------------------------------------------------------------------
+    /** Returns the number of triangles in this mesh. */
+    unsigned int getNumTriangles() const
+                    { return (unsigned int)m_triangleIndex2Material.size(); }
+    // ------------------------------------------------------------------------
     const btCollisionShape &getCollisionShape() const
                                           { return *m_collision_shape; }
     // ------------------------------------------------------------------------
@@ -19,12 +19,14 @@
 #include "race/history.hpp"
 
 #include <stdio.h>
+#include <string.h>
 
 #include "io/file_manager.hpp"
 #include "modes/world.hpp"
 #include "karts/abstract_kart.hpp"
 #include "karts/controller/controller.hpp"
 #include "network/network_config.hpp"
+#include "network/network_string.hpp"
 #include "network/rewind_manager.hpp"
 #include "physics/physics.hpp"
 #include "race/race_manager.hpp"
@@ -32,27 +34,89 @@
 #include "utils/constants.hpp"
 #include "utils/file_utils.hpp"
 
+#include <stdexcept>
+
 History* history = 0;
 bool History::m_online_history_replay = false;
+
+namespace
+{
+    /** The first bytes of a binary history file. */
+    const char HISTORY_MAGIC[4] = { 'S', 'T', 'K', 'H' };
+
+    /** Version of the binary history format (version 1 is the text
+     *  format). */
+    const int HISTORY_VERSION = 2;
+}   // anonymous namespace
+
 //-----------------------------------------------------------------------------
 /** Initialises the history object and sets the mode to none.
  */
 History::History()
 {
-    m_replay_history = false;
+    m_replay_history          = false;
+    m_checksums               = false;
+    m_checksum_error_reported = false;
+    m_checksum_index          = 0;
+    m_event_index             = 0;
+    m_stream                  = NULL;
+    m_first_block             = 0;
+    m_next_event_block        = 0;
+    m_next_checksum_block     = 0;
 }   // History
 
+//-----------------------------------------------------------------------------
+History::~History()
+{
+    finishRecording();
+}   // ~History
+
 //-----------------------------------------------------------------------------
 /** Initialise the history for a new recording. It especially allocates memory
- *  to store the history.
+ *  to store the history. If a history file is set, it is (re)created and
+ *  the history is written to it while racing.
  */
 void History::initRecording()
 {
+    finishRecording();
     allocateMemory();
     m_event_index = 0;
     m_all_input_events.clear();
+    m_all_checksums.clear();
+
+    if (!m_filename.empty())
+    {
+        m_stream = FileUtils::fopenU8Path(m_filename, "wb");
+        if (m_stream)
+        {
+            Log::info("History", "Recording history to '%s'.",
+                      m_filename.c_str());
+            writeHeader(m_stream);
+        }
+        else
+        {
+            Log::error("History", "Can't open '%s' for writing.",
+                       m_filename.c_str());
+        }
+    }
 }   // initRecording
 
+//-----------------------------------------------------------------------------
+/** Writes all events not yet written to the history file that is recorded
+ *  while racing, and closes it.
+ */
+void History::finishRecording()
+{
+    if (!m_stream)
+        return;
+    writeEvents(m_stream);
+    writeChecksums(m_stream);
+    fclose(m_stream);
+    m_stream = NULL;
+    m_all_input_events.clear();
+    m_all_checksums.clear();
+}   // finishRecording
+
 //-----------------------------------------------------------------------------
 /** Allocates memory for the history. This is used when recording as well
  *  as when replaying (since in replay the data is read into memory first).
@@ -85,8 +149,96 @@ void History::addEvent(int kart_id, PlayerAction pa, int value)
     ie.m_value       = value;
     ie.m_kart_index  = kart_id;
     m_all_input_events.emplace_back(ie);
+
+    if (m_stream && m_all_input_events.size() >= BLOCK_SIZE)
+    {
+        writeEvents(m_stream);
+        m_all_input_events.clear();
+    }
 }   // addEvent
 
+//-----------------------------------------------------------------------------
+/** Computes a checksum of the transforms of all karts. */
+uint32_t History::computeChecksum() const
+{
+    // FNV-1a hash of the bit patterns of all positions and rotations
+    World *world = World::getWorld();
+    uint32_t hash = 2166136261u;
+    for (unsigned int i = 0; i < world->getNumKarts(); i++)
+    {
+        const btTransform &t = world->getKart(i)->getTrans();
+        const btQuaternion q = t.getRotation();
+        const float values[7] = { t.getOrigin().getX(), t.getOrigin().getY(),
+                                  t.getOrigin().getZ(), q.getX(), q.getY(),
+                                  q.getZ(), q.getW() };
+        const uint8_t *bytes = (const uint8_t*)values;
+        for (unsigned int j = 0; j < sizeof(values); j++)
+        {
+            hash ^= bytes[j];
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}   // computeChecksum
+
+//-----------------------------------------------------------------------------
+/** Called after each time step if checksums are enabled. When recording,
+ *  the checksum of all kart transforms is stored. When replaying, it is
+ *  compared with the recorded checksum, and the first time step at which
+ *  they differ is reported.
+ *  \param world_ticks The time step that was just simulated.
+ */
+void History::updateChecksum(int world_ticks)
+{
+    // Without a stream all checksums stay in memory until the history is
+    // saved, so only the first ones are kept
+    if (!m_replay_history && !m_stream &&
+        m_all_checksums.size() >= MAX_CHECKSUMS)
+        return;
+
+    const uint32_t checksum = computeChecksum();
+    if (!m_replay_history)
+    {
+        TickChecksum tc;
+        tc.m_world_ticks = world_ticks;
+        tc.m_checksum    = checksum;
+        m_all_checksums.push_back(tc);
+        if (m_stream && m_all_checksums.size() >= BLOCK_SIZE)
+        {
+            writeChecksums(m_stream);
+            m_all_checksums.clear();
+        }
+        else if (!m_stream && m_all_checksums.size() == MAX_CHECKSUMS)
+        {
+            Log::warn("History", "Only the checksums of the first %d time "
+                      "steps are recorded.", MAX_CHECKSUMS);
+        }
+        return;
+    }
+
+    while (true)
+    {
+        if (m_checksum_index >= m_all_checksums.size() &&
+            !readNextChecksums())
+            return;
+        const TickChecksum &tc = m_all_checksums[m_checksum_index];
+        // No checksum was recorded for this time step
+        if (tc.m_world_ticks > world_ticks)
+            return;
+        m_checksum_index++;
+        if (tc.m_world_ticks < world_ticks)
+            continue;
+
+        if (tc.m_checksum != checksum && !m_checksum_error_reported)
+        {
+            Log::error("History", "Replay differs from the recorded history "
+                       "at tick %d.", world_ticks);
+            m_checksum_error_reported = true;
+        }
+        return;
+    }
+}   // updateChecksum
+
 //-----------------------------------------------------------------------------
 /** Sets the kart position and controls to the recorded history value.
  *  \param world_ticks WOrld time in ticks.
@@ -96,10 +248,14 @@ void History::updateReplay(int world_ticks)
 {
     World *world = World::getWorld();
 
-    while (m_event_index < m_all_input_events.size() &&
-        m_all_input_events[m_event_index].m_world_ticks <= world_ticks)
+    while (true)
     {
+        // Binary histories are decoded one block at a time
+        if (m_event_index >= m_all_input_events.size() && !readNextEvents())
+            break;
         const InputEvent &ie = m_all_input_events[m_event_index];
+        if (ie.m_world_ticks > world_ticks)
+            break;
         AbstractKart *kart = world->getKart(ie.m_kart_index);
         Log::verbose("history", "time %d event-time %d action %d %d",
             world->getTicksSinceStart(), ie.m_world_ticks, ie.m_action,
@@ -112,7 +268,7 @@ void History::updateReplay(int world_ticks)
     if(m_event_index >= m_all_input_events.size())
     {
         Log::info("History", "Replay finished");
-        m_event_index= 0;
+        restartReplay();
         // This is useful to use a reproducable rewind problem:
         // replay it with history, for debugging only
 #undef DO_REWIND_AT_END_OF_HISTORY
@@ -128,17 +284,28 @@ void History::updateReplay(int world_ticks)
 
 //-----------------------------------------------------------------------------
 /** Saves the history stored in the internal data structures into a file called
- *  history.dat.
+ *  history.dat. If the history is already written to a file while racing,
+ *  that file is only flushed.
  */
 void History::Save()
 {
-    FILE *fd = fopen("history.dat","w");
+    if (m_stream)
+    {
+        writeEvents(m_stream);
+        m_all_input_events.clear();
+        writeChecksums(m_stream);
+        m_all_checksums.clear();
+        Log::info("History", "Saved in '%s'.", m_filename.c_str());
+        return;
+    }
+
+    FILE *fd = fopen("history.dat","wb");
     if(fd)
         Log::info("History", "Saved in ./history.dat.");
     else
     {
         std::string fn = file_manager->getUserConfigFile("history.dat");
-        fd = FileUtils::fopenU8Path(fn, "w");
+        fd = FileUtils::fopenU8Path(fn, "wb");
         if(fd)
             Log::info("History", "Saved in '%s'.", fn.c_str());
     }
@@ -150,59 +317,303 @@ void History::Save()
         return;
     }
 
+    writeHeader(fd);
+    writeEvents(fd);
+    writeChecksums(fd);
+    fclose(fd);
+}   // Save
+
+//-----------------------------------------------------------------------------
+/** Writes a block of a binary history file: the type of the block, its size
+ *  and the data.
+ *  \param fd The file to write to.
+ *  \param type Type of the block ('H' header, 'E' events, 'C' checksums).
+ *  \param data The content of the block.
+ */
+void History::writeBlock(FILE *fd, char type, const BareNetworkString &data)
+{
+    BareNetworkString header(5);
+    header.addUInt8(type).addUInt32(data.getTotalSize());
+    fwrite(header.getData(), 1, header.getTotalSize(), fd);
+    fwrite(data.getData(), 1, data.getTotalSize(), fd);
+    // Make sure that the history is complete up to the last block even if
+    // STK is terminated
+    if (fd == m_stream)
+        fflush(fd);
+}   // writeBlock
+
+//-----------------------------------------------------------------------------
+/** Writes the identifier of a binary history file and the header block with
+ *  all information about the race.
+ */
+void History::writeHeader(FILE *fd)
+{
+    fwrite(HISTORY_MAGIC, 1, sizeof(HISTORY_MAGIC), fd);
+
     World *world   = World::getWorld();
     const int num_karts = world->getNumKarts();
-    fprintf(fd, "STK-version:      %s\n",   STK_VERSION);
-    fprintf(fd, "History-version:  %d\n",   1);
-    fprintf(fd, "numkarts:         %d\n",   num_karts);
-    fprintf(fd, "numplayers:       %d\n", race_manager->getNumPlayers());
-    fprintf(fd, "difficulty:       %d\n", race_manager->getDifficulty());
-    fprintf(fd, "reverse: %c\n", race_manager->getReverseTrack() ? 'y' : 'n');
+    assert(num_karts > 0);
 
-    fprintf(fd, "track: %s\n", Track::getCurrentTrack()->getIdent().c_str());
+    BareNetworkString data;
+    data.encodeString(std::string(STK_VERSION));
+    data.addUInt8(HISTORY_VERSION).addUInt8(num_karts)
+        .addUInt8(race_manager->getNumPlayers())
+        .addUInt8(race_manager->getDifficulty())
+        .addUInt8(race_manager->getReverseTrack() ? 1 : 0);
+    data.encodeString(Track::getCurrentTrack()->getIdent());
+    for (int k = 0; k < num_karts; k++)
+        data.encodeString(world->getKart(k)->getIdent());
+    data.addUInt8(m_checksums ? 1 : 0);
+    writeBlock(fd, 'H', data);
+}   // writeHeader
 
-    assert(num_karts > 0);
+//-----------------------------------------------------------------------------
+/** Writes all stored input events as one block. */
+void History::writeEvents(FILE *fd)
+{
+    if (m_all_input_events.empty())
+        return;
+    BareNetworkString data((int)m_all_input_events.size() * 10 + 4);
+    data.addUInt32((uint32_t)m_all_input_events.size());
+    for (const InputEvent &ie : m_all_input_events)
+    {
+        data.addUInt32(ie.m_world_ticks).addUInt8(ie.m_kart_index)
+            .addUInt8(ie.m_action).addUInt32(ie.m_value);
+    }
+    writeBlock(fd, 'E', data);
+}   // writeEvents
 
-    int k;
-    for(k=0; k<num_karts; k++)
+//-----------------------------------------------------------------------------
+/** Writes all stored checksums as one block. */
+void History::writeChecksums(FILE *fd)
+{
+    if (m_all_checksums.empty())
+        return;
+    BareNetworkString data((int)m_all_checksums.size() * 8 + 4);
+    data.addUInt32((uint32_t)m_all_checksums.size());
+    for (const TickChecksum &tc : m_all_checksums)
+        data.addUInt32(tc.m_world_ticks).addUInt32(tc.m_checksum);
+    writeBlock(fd, 'C', data);
+}   // writeChecksums
+
+//-----------------------------------------------------------------------------
+/** Finds the next block of a given type in the replayed history file.
+ *  \param type Type of the block.
+ *  \param offset Offset at which to start searching, on return the offset
+ *         after the block found.
+ *  \param data On return the content of the block.
+ *  \param size On return the size of the block.
+ *  \return False if there is no further block of this type.
+ */
+bool History::readNextBlock(char type, size_t *offset, const char **data,
+                            uint32_t *size)
+{
+    if (!m_replay_file.isOpen())
+        return false;
+    const size_t file_size = m_replay_file.getSize();
+    while (*offset + 5 <= file_size)
     {
-        fprintf(fd, "model %d: %s\n",k, world->getKart(k)->getIdent().c_str());
+        BareNetworkString header(m_replay_file.getData() + *offset, 5);
+        const char block_type = (char)header.getUInt8();
+        const uint32_t block_size = header.getUInt32();
+        if (*offset + 5 + block_size > file_size)
+        {
+            Log::warn("History", "History file is truncated.");
+            *offset = file_size;
+            return false;
+        }
+        const char *block = m_replay_file.getData() + *offset + 5;
+        *offset += 5 + block_size;
+        if (block_type == type)
+        {
+            *data = block;
+            *size = block_size;
+            return true;
+        }
     }
-    fprintf(fd, "count:     %zu\n", m_all_input_events.size());
+    return false;
+}   // readNextBlock
 
-    for (unsigned int i = 0; i < m_all_input_events.size(); i++)
+//-----------------------------------------------------------------------------
+/** Decodes the next block of input events of a binary history.
+ *  \return False if there are no more events.
+ */
+bool History::readNextEvents()
+{
+    const char *block;
+    uint32_t size;
+    if (!readNextBlock('E', &m_next_event_block, &block, &size))
+        return false;
+
+    BareNetworkString data(block, size);
+    try
     {
-        fprintf(fd, "%d %d %d %d\n",
-                m_all_input_events[i].m_world_ticks,
-                m_all_input_events[i].m_kart_index,
-                m_all_input_events[i].m_action,
-                m_all_input_events[i].m_value      );
-    }   // for i
+        const unsigned int count = data.getUInt32();
+        m_all_input_events.resize(count);
+        for (InputEvent &ie : m_all_input_events)
+        {
+            ie.m_world_ticks = data.getUInt32();
+            ie.m_kart_index  = data.getUInt8();
+            ie.m_action      = (PlayerAction)data.getUInt8();
+            ie.m_value       = (int)data.getUInt32();
+        }
+    }
+    catch (std::out_of_range &)
+    {
+        Log::warn("History", "Invalid event block in history file.");
+        m_all_input_events.clear();
+    }
+    m_event_index = 0;
+    return !m_all_input_events.empty();
+}   // readNextEvents
 
-    fprintf(fd, "History file end.\n");
-    fclose(fd);
-}   // Save
+//-----------------------------------------------------------------------------
+/** Decodes the next block of checksums of a binary history.
+ *  \return False if there are no more checksums.
+ */
+bool History::readNextChecksums()
+{
+    const char *block;
+    uint32_t size;
+    if (!readNextBlock('C', &m_next_checksum_block, &block, &size))
+        return false;
+
+    BareNetworkString data(block, size);
+    try
+    {
+        const unsigned int count = data.getUInt32();
+        m_all_checksums.resize(count);
+        for (TickChecksum &tc : m_all_checksums)
+        {
+            tc.m_world_ticks = data.getUInt32();
+            tc.m_checksum    = data.getUInt32();
+        }
+    }
+    catch (std::out_of_range &)
+    {
+        Log::warn("History", "Invalid checksum block in history file.");
+        m_all_checksums.clear();
+    }
+    m_checksum_index = 0;
+    return !m_all_checksums.empty();
+}   // readNextChecksums
 
 //-----------------------------------------------------------------------------
-/** Loads a history from history.dat in the current directory.
+/** Starts replaying the history from the beginning again. */
+void History::restartReplay()
+{
+    m_event_index             = 0;
+    m_checksum_index          = 0;
+    m_checksum_error_reported = false;
+    // Text histories keep all events in memory
+    if (m_replay_file.isOpen())
+    {
+        m_all_input_events.clear();
+        m_all_checksums.clear();
+        m_next_event_block    = m_first_block;
+        m_next_checksum_block = m_first_block;
+    }
+}   // restartReplay
+
+//-----------------------------------------------------------------------------
+/** Loads a history, by default from history.dat in the current directory
+ *  or the config directory.
  */
 void History::Load()
 {
-    char s[1024], s1[1024];
-    int  n;
+    std::string fn = m_filename;
+    struct stat st;
+    if (fn.empty())
+    {
+        fn = "history.dat";
+        if (FileUtils::statU8Path(fn, &st) != 0)
+            fn = file_manager->getUserConfigFile("history.dat");
+    }
 
-    FILE *fd = fopen("history.dat","r");
-    if(fd)
-        Log::info("History", "Reading ./history.dat");
-    else
+    if (!m_replay_file.open(fn))
+        Log::fatal("History", "Could not open '%s'.", fn.c_str());
+    Log::info("History", "Reading '%s'.", fn.c_str());
+
+    if (m_replay_file.getSize() >= sizeof(HISTORY_MAGIC) &&
+        memcmp(m_replay_file.getData(), HISTORY_MAGIC,
+               sizeof(HISTORY_MAGIC)) == 0)
     {
-        std::string fn = file_manager->getUserConfigFile("history.dat");
-        fd = FileUtils::fopenU8Path(fn, "r");
-        if(fd)
-            Log::info("History", "Reading '%s'.", fn.c_str());
+        loadBinary();
+        return;
     }
+
+    // Old text format
+    m_replay_file.close();
+    FILE *fd = FileUtils::fopenU8Path(fn, "r");
     if(!fd)
-        Log::fatal("History", "Could not open history.dat");
+        Log::fatal("History", "Could not open '%s'.", fn.c_str());
+    loadText(fd);
+}   // Load
+
+//-----------------------------------------------------------------------------
+/** Reads the header of a binary history. The events are decoded block by
+ *  block while replaying.
+ */
+void History::loadBinary()
+{
+    size_t offset = sizeof(HISTORY_MAGIC);
+    const char *block;
+    uint32_t size;
+    if (!readNextBlock('H', &offset, &block, &size))
+        Log::fatal("History", "No header found in history file.");
+
+    BareNetworkString data(block, size);
+    try
+    {
+        std::string s;
+        data.decodeString(&s);
+        if (s != STK_VERSION)
+            Log::warn("History", "History is version '%s', STK version is "
+                      "'%s'.", s.c_str(), STK_VERSION);
+        const int version = data.getUInt8();
+        if (version != HISTORY_VERSION)
+            Log::fatal("History", "Unsupported history version %d.",
+                       version);
+
+        const unsigned int num_karts = data.getUInt8();
+        race_manager->setNumKarts(num_karts);
+        const unsigned int num_players = data.getUInt8();
+        race_manager->setNumPlayers(num_players);
+        race_manager->setDifficulty((RaceManager::Difficulty)data.getUInt8());
+        race_manager->setReverseTrack(data.getUInt8() != 0);
+        data.decodeString(&s);
+        race_manager->setTrack(s);
+        // This value doesn't really matter, but should be defined, otherwise
+        // the racing phase can switch to 'ending'
+        race_manager->setNumLaps(100);
+
+        for (unsigned int i = 0; i < num_karts; i++)
+        {
+            data.decodeString(&s);
+            m_kart_ident.push_back(s);
+            if (i < num_players && !m_online_history_replay)
+                race_manager->setPlayerKart(i, s);
+        }
+        // Verify the checksums if they were recorded
+        if (data.getUInt8() != 0)
+            m_checksums = true;
+    }
+    catch (std::out_of_range &)
+    {
+        Log::fatal("History", "Invalid header in history file.");
+    }
+
+    m_first_block = offset;
+    restartReplay();
+}   // loadBinary
+
+//-----------------------------------------------------------------------------
+/** Loads a history in the old text format (version 1) from the given file.
+ */
+void History::loadText(FILE *fd)
+{
+    char s[1024], s1[1024];
+    int  n;
 
     if (fgets(s, 1023, fd) == NULL)
         Log::fatal("History", "Could not read history.dat.");
@@ -307,5 +718,5 @@ void History::Load()
     RewindManager::setEnable(rewind_manager_was_enabled);
 
     fclose(fd);
-}   // Load
+}   // loadText
 
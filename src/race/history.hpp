@@ -22,14 +22,28 @@
 
 #include "input/input.hpp"
 #include "karts/controller/kart_control.hpp"
+#include "utils/mapped_file.hpp"
 
+#include <stdint.h>
+#include <stdio.h>
 #include <string>
 #include <vector>
 
+class BareNetworkString;
 class Kart;
 
 /**
   * \ingroup race
+  * Records the input events of all karts, and replays them for an exact
+  * physics replay of a race. Histories are saved in a binary format which
+  * consists of a sequence of blocks: a header block, followed by blocks of
+  * input events and (optionally) blocks with a checksum of all kart
+  * transforms for each time step. If a history file is set for recording,
+  * the blocks are written while racing, so memory usage does not grow with
+  * the length of the race. When replaying, the file is memory mapped and
+  * decoded one block at a time, and the checksums (if present) are used to
+  * detect the first time step at which the replay differs from the
+  * recording.
   */
 class History
 {
@@ -56,18 +70,81 @@ private:
         int m_value;
     };   // InputEvent
     // ------------------------------------------------------------------------
+    struct TickChecksum
+    {
+        /** The time step. */
+        int      m_world_ticks;
+        /** Checksum of all kart transforms after this time step. */
+        uint32_t m_checksum;
+    };   // TickChecksum
+    // ------------------------------------------------------------------------
+
+    /** Number of events (or checksums) after which a block is written
+     *  when streaming a history. */
+    static const unsigned int BLOCK_SIZE = 4096;
+
+    /** Maximum number of checksums kept in memory if the history is not
+     *  streamed (30 minutes at 120 time steps per second), later checksums
+     *  are not recorded. */
+    static const unsigned int MAX_CHECKSUMS = 120 * 60 * 30;
 
-    /** All input events. */
+    /** All input events (when recording, only the events not yet written
+     *  to the history file; when replaying, the events of the current
+     *  block of a binary history). */
     std::vector<InputEvent> m_all_input_events;
 
+    /** Checksums recorded (and not yet written), or the checksums of the
+     *  current checksum block when replaying. */
+    std::vector<TickChecksum> m_all_checksums;
+
+    /** Index of the next checksum to compare with when replaying. */
+    unsigned int m_checksum_index;
+
+    /** True if checksums are recorded, or verified when replaying. */
+    bool m_checksums;
+
+    /** True if a difference to the recorded checksums was reported. */
+    bool m_checksum_error_reported;
+
+    /** Name of the file to stream the history to while recording, or to
+     *  read the history from. Empty for the default history.dat. */
+    std::string m_filename;
+
+    /** The file the history is streamed to while recording. */
+    FILE *m_stream;
+
+    /** The history file that is replayed (if it is a binary file). */
+    MappedFile m_replay_file;
+
+    /** Offset of the first block after the header in m_replay_file. */
+    size_t m_first_block;
+
+    /** Offsets of the next event and checksum block in m_replay_file. */
+    size_t m_next_event_block, m_next_checksum_block;
+
     void  allocateMemory(int size=-1);
+    void  writeHeader(FILE *fd);
+    void  writeEvents(FILE *fd);
+    void  writeChecksums(FILE *fd);
+    void  writeBlock(FILE *fd, char type, const BareNetworkString &data);
+    bool  readNextBlock(char type, size_t *offset, const char **data,
+                        uint32_t *size);
+    void  restartReplay();
+    bool  readNextEvents();
+    bool  readNextChecksums();
+    void  loadBinary();
+    void  loadText(FILE *fd);
+    uint32_t computeChecksum() const;
 public:
     static bool m_online_history_replay;
           History        ();
+         ~History        ();
     void  initRecording  ();
+    void  finishRecording();
     void  Save           ();
     void  Load           ();
     void  updateReplay(int world_ticks);
+    void  updateChecksum(int world_ticks);
     void  addEvent(int kart_id, PlayerAction pa, int value);
 
     // -------------------I-----------------------------------------------------
@@ -82,6 +159,16 @@ public:
     // ------------------------------------------------------------------------
     /** Set if replay is enabled or not. */
     void  setReplayHistory(bool b) { m_replay_history=b;  }
+    // ------------------------------------------------------------------------
+    /** Sets the file to which the history is written while racing, or
+     *  from which it is replayed. */
+    void  setFilename(const std::string &filename) { m_filename = filename; }
+    // ------------------------------------------------------------------------
+    /** Enables recording (or verifying) a checksum for each time step. */
+    void  enableChecksums(bool b) { m_checksums = b; }
+    // ------------------------------------------------------------------------
+    /** Returns true if checksums are recorded or verified. */
+    bool  hasChecksums() const { return m_checksums; }
 };
 
 extern History* history;
@@ -20,6 +20,33 @@
 #include "io/file_manager.hpp"
 #include "utils/file_utils.hpp"
 
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /** The first bytes of a binary replay file. Text replay files start
+     *  with "version:". */
+    const char BINARY_MAGIC[4] = { 'S', 'T', 'K', 'R' };
+
+    /** Scaling factors used to quantise the float values of an event. */
+    const float TIME_SCALE        = 1000.0f;   // 1 ms
+    const float POSITION_SCALE    = 1000.0f;   // 1 mm
+    const float ROTATION_SCALE    = 32767.0f;
+    const float SPEED_SCALE       = 100.0f;
+    const float STEER_SCALE       = 10000.0f;
+    const float SUSPENSION_SCALE  = 10000.0f;
+    const float NITRO_SCALE       = 100.0f;
+    const float DISTANCE_SCALE    = 100.0f;
+
+    // ------------------------------------------------------------------------
+    int64_t quantise(float f, float scale)
+    {
+        return (int64_t)llroundf(f * scale);
+    }   // quantise
+}   // anonymous namespace
+
 // -----------------------------------------------------------------------------
 ReplayBase::ReplayBase()
 {
@@ -34,7 +61,7 @@ FILE* ReplayBase::openReplayFile(bool writeable, bool full_path, int replay_file
 {
     FILE* fd = FileUtils::fopenU8Path(full_path ? getReplayFilename(replay_file_number) :
         file_manager->getReplayDir() + getReplayFilename(replay_file_number),
-        writeable ? "w" : "r");
+        writeable ? "wb" : "r");
     if (!fd)
     {
         return NULL;
@@ -42,3 +69,268 @@ FILE* ReplayBase::openReplayFile(bool writeable, bool full_path, int replay_file
     return fd;
 
 }   // openReplayFile
+
+// ----------------------------------------------------------------------------
+/** Returns true if the given file content is a binary replay file.
+ *  \param data Content of the file.
+ *  \param size Size of the content.
+ */
+bool ReplayBase::isBinaryReplay(const char *data, size_t size)
+{
+    return size >= sizeof(BINARY_MAGIC) &&
+           memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}   // isBinaryReplay
+
+// ----------------------------------------------------------------------------
+/** Appends the identifier of binary replay files. */
+void ReplayBase::writeBinaryMagic(std::string *out)
+{
+    out->append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+}   // writeBinaryMagic
+
+// ----------------------------------------------------------------------------
+/** Appends an unsigned integer using a variable length encoding (7 bits
+ *  per byte, the highest bit indicates that more bytes follow).
+ */
+void ReplayBase::writeVarUInt(std::string *out, uint64_t n)
+{
+    while (n >= 0x80)
+    {
+        out->push_back((char)((n & 0x7f) | 0x80));
+        n >>= 7;
+    }
+    out->push_back((char)n);
+}   // writeVarUInt
+
+// ----------------------------------------------------------------------------
+/** Appends a float as 4 bytes in little endian order. */
+void ReplayBase::writeFloat(std::string *out, float f)
+{
+    uint32_t n;
+    memcpy(&n, &f, sizeof(n));
+    for (unsigned int i = 0; i < 4; i++)
+        out->push_back((char)((n >> (8 * i)) & 0xff));
+}   // writeFloat
+
+// ----------------------------------------------------------------------------
+/** Appends a string, prefixed by its length. */
+void ReplayBase::writeString(std::string *out, const std::string &s)
+{
+    writeVarUInt(out, s.size());
+    out->append(s);
+}   // writeString
+
+// ----------------------------------------------------------------------------
+/** Reads an unsigned integer written by writeVarUInt.
+ *  \param data Pointer to the data, which is advanced past the integer.
+ *  \param end End of the data.
+ *  \param n On return the integer read.
+ *  \return False if the data ended before the integer.
+ */
+bool ReplayBase::readVarUInt(const char **data, const char *end, uint64_t *n)
+{
+    uint64_t result = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+        if (*data >= end)
+            return false;
+        const uint8_t byte = (uint8_t)*((*data)++);
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *n = result;
+            return true;
+        }
+    }
+    return false;
+}   // readVarUInt
+
+// ----------------------------------------------------------------------------
+/** Reads a float written by writeFloat. */
+bool ReplayBase::readFloat(const char **data, const char *end, float *f)
+{
+    if (end - *data < 4)
+        return false;
+    uint32_t n = 0;
+    for (unsigned int i = 0; i < 4; i++)
+        n |= (uint32_t)(uint8_t)(*data)[i] << (8 * i);
+    memcpy(f, &n, sizeof(n));
+    *data += 4;
+    return true;
+}   // readFloat
+
+// ----------------------------------------------------------------------------
+/** Reads a string written by writeString. */
+bool ReplayBase::readString(const char **data, const char *end,
+                            std::string *s)
+{
+    uint64_t size;
+    if (!readVarUInt(data, end, &size) || (uint64_t)(end - *data) < size)
+        return false;
+    s->assign(*data, (size_t)size);
+    *data += size;
+    return true;
+}   // readString
+
+// ----------------------------------------------------------------------------
+/** Appends one event to a binary replay. All values are quantised to
+ *  integers, and only the (zigzag encoded) difference to the previous
+ *  event is stored. Since most values change only slightly between two
+ *  events, most of them need a single byte.
+ *  \param previous The NUM_EVENT_VALUES quantised values of the previous
+ *         event, which are updated to the values of this event. All 0 for
+ *         the first event of a kart.
+ *  \param out The encoded event is appended to this string.
+ */
+void ReplayBase::encodeEvent(const TransformEvent &t, const PhysicInfo &p,
+                             const BonusInfo &b, const KartReplayEvent &k,
+                             int64_t *previous, std::string *out)
+{
+    const btVector3    &xyz = t.m_transform.getOrigin();
+    const btQuaternion  q   = t.m_transform.getRotation();
+    const int flags = (k.m_zipper_usage ? 1 : 0) |
+                      (k.m_red_skidding ? 2 : 0) |
+                      (k.m_jumping      ? 4 : 0);
+    const int64_t values[NUM_EVENT_VALUES] =
+    {
+        quantise(t.m_time, TIME_SCALE),
+        quantise(xyz.getX(), POSITION_SCALE),
+        quantise(xyz.getY(), POSITION_SCALE),
+        quantise(xyz.getZ(), POSITION_SCALE),
+        quantise(q.getX(), ROTATION_SCALE),
+        quantise(q.getY(), ROTATION_SCALE),
+        quantise(q.getZ(), ROTATION_SCALE),
+        quantise(q.getW(), ROTATION_SCALE),
+        quantise(p.m_speed, SPEED_SCALE),
+        quantise(p.m_steer, STEER_SCALE),
+        quantise(p.m_suspension_length[0], SUSPENSION_SCALE),
+        quantise(p.m_suspension_length[1], SUSPENSION_SCALE),
+        quantise(p.m_suspension_length[2], SUSPENSION_SCALE),
+        quantise(p.m_suspension_length[3], SUSPENSION_SCALE),
+        p.m_skidding_state,
+        b.m_attachment,
+        quantise(b.m_nitro_amount, NITRO_SCALE),
+        b.m_item_amount,
+        b.m_item_type,
+        b.m_special_value,
+        quantise(k.m_distance, DISTANCE_SCALE),
+        k.m_nitro_usage,
+        k.m_skidding_effect,
+        flags
+    };
+
+    for (unsigned int i = 0; i < NUM_EVENT_VALUES; i++)
+    {
+        const int64_t delta = values[i] - previous[i];
+        // Zigzag encoding maps small negative numbers to small numbers
+        writeVarUInt(out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        previous[i] = values[i];
+    }
+}   // encodeEvent
+
+// ----------------------------------------------------------------------------
+/** Decodes one event written by encodeEvent.
+ *  \param data Pointer to the data, which is advanced past the event.
+ *  \param end End of the data.
+ *  \param previous The quantised values of the previous event, see
+ *         encodeEvent.
+ *  \return False if the data is truncated.
+ */
+bool ReplayBase::decodeEvent(const char **data, const char *end,
+                             int64_t *previous, TransformEvent *t,
+                             PhysicInfo *p, BonusInfo *b, KartReplayEvent *k)
+{
+    for (unsigned int i = 0; i < NUM_EVENT_VALUES; i++)
+    {
+        uint64_t n;
+        if (!readVarUInt(data, end, &n))
+            return false;
+        previous[i] += (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+    }
+
+    const int64_t *v = previous;
+    t->m_time = v[0] / TIME_SCALE;
+    btQuaternion q(v[4] / ROTATION_SCALE, v[5] / ROTATION_SCALE,
+                   v[6] / ROTATION_SCALE, v[7] / ROTATION_SCALE);
+    if (q.length2() > 0)
+        q.normalize();
+    t->m_transform = btTransform(q, btVector3(v[1] / POSITION_SCALE,
+                                              v[2] / POSITION_SCALE,
+                                              v[3] / POSITION_SCALE));
+    p->m_speed                = v[8] / SPEED_SCALE;
+    p->m_steer                = v[9] / STEER_SCALE;
+    for (unsigned int i = 0; i < 4; i++)
+        p->m_suspension_length[i] = v[10 + i] / SUSPENSION_SCALE;
+    p->m_skidding_state       = (int)v[14];
+    b->m_attachment           = (int)v[15];
+    b->m_nitro_amount         = v[16] / NITRO_SCALE;
+    b->m_item_amount          = (int)v[17];
+    b->m_item_type            = (int)v[18];
+    b->m_special_value        = (int)v[19];
+    k->m_distance             = v[20] / DISTANCE_SCALE;
+    k->m_nitro_usage          = (int)v[21];
+    k->m_skidding_effect      = (int)v[22];
+    k->m_zipper_usage         = (v[23] & 1) != 0;
+    k->m_red_skidding         = (v[23] & 2) != 0;
+    k->m_jumping              = (v[23] & 4) != 0;
+    return true;
+}   // decodeEvent
+
+// ----------------------------------------------------------------------------
+/** Tests that events survive a round trip through the binary encoding
+ *  (within the quantisation precision).
+ */
+void ReplayBase::unitTesting()
+{
+    std::string data;
+    int64_t previous[NUM_EVENT_VALUES] = { 0 };
+    const unsigned int num_events = 10;
+    for (unsigned int i = 0; i < num_events; i++)
+    {
+        TransformEvent t;
+        t.m_time = i * 0.1f;
+        t.m_transform = btTransform(btQuaternion(btVector3(0, 1, 0), 0.3f * i),
+                                    btVector3(-100.0f + i, 2.5f, 33.3f * i));
+        PhysicInfo p      = { 20.0f + i, -0.5f, { 0.1f, 0.2f, 0.3f, 0.4f }, 2 };
+        BonusInfo b       = { 3, 12.5f, (int)i, 4, -1 };
+        KartReplayEvent k = { 50.0f * i, 1, i % 2 == 0, 2, false, true };
+        encodeEvent(t, p, b, k, previous, &data);
+        writeFloat(&data, 1.5f);
+    }
+    writeString(&data, "end");
+
+    const char *d   = data.data();
+    const char *end = d + data.size();
+    int64_t decoded[NUM_EVENT_VALUES] = { 0 };
+    bool ok;
+    for (unsigned int i = 0; i < num_events; i++)
+    {
+        TransformEvent t;
+        PhysicInfo p;
+        BonusInfo b;
+        KartReplayEvent k;
+        ok = decodeEvent(&d, end, decoded, &t, &p, &b, &k);
+        assert(ok);
+        assert(fabsf(t.m_time - i * 0.1f) < 0.001f);
+        btVector3 xyz(-100.0f + i, 2.5f, 33.3f * i);
+        assert((t.m_transform.getOrigin() - xyz).length() < 0.002f);
+        btQuaternion q(btVector3(0, 1, 0), 0.3f * i);
+        assert(fabsf(fabsf(t.m_transform.getRotation().dot(q)) - 1) < 0.001f);
+        assert(fabsf(p.m_speed - (20.0f + i)) < 0.01f);
+        assert(p.m_skidding_state == 2 && b.m_attachment == 3);
+        assert(b.m_item_amount == (int)i && b.m_special_value == -1);
+        assert(fabsf(k.m_distance - 50.0f * i) < 0.01f);
+        assert(k.m_zipper_usage == (i % 2 == 0) && k.m_jumping &&
+               !k.m_red_skidding);
+        float f;
+        ok = readFloat(&d, end, &f);
+        assert(ok && f == 1.5f);
+    }
+    std::string s;
+    ok = readString(&d, end, &s);
+    assert(ok && s == "end" && d == end);
+    uint64_t n;
+    ok = readVarUInt(&d, end, &n);
+    assert(!ok);
+    (void)ok;
+}   // unitTesting
@@ -22,6 +22,7 @@
 #include "LinearMath/btTransform.h"
 #include "utils/no_copy.hpp"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string>
 #include <vector>
@@ -97,15 +98,40 @@ protected:
         bool        m_jumping;
     };   // KartReplayEvent
 
+    // ------------------------------------------------------------------------
+    /** Number of quantised values stored for each event. */
+    static const unsigned int NUM_EVENT_VALUES = 24;
+
     // ------------------------------------------------------------------------
     FILE *openReplayFile(bool writeable, bool full_path = false, int replay_file_number=1);
     // ------------------------------------------------------------------------
+    static bool isBinaryReplay(const char *data, size_t size);
+    static void writeBinaryMagic(std::string *out);
+    static void encodeEvent(const TransformEvent &t, const PhysicInfo &p,
+                            const BonusInfo &b, const KartReplayEvent &k,
+                            int64_t *previous, std::string *out);
+    static bool decodeEvent(const char **data, const char *end,
+                            int64_t *previous, TransformEvent *t,
+                            PhysicInfo *p, BonusInfo *b, KartReplayEvent *k);
+    static void writeVarUInt(std::string *out, uint64_t n);
+    static void writeFloat(std::string *out, float f);
+    static void writeString(std::string *out, const std::string &s);
+    static bool readVarUInt(const char **data, const char *end, uint64_t *n);
+    static bool readFloat(const char **data, const char *end, float *f);
+    static bool readString(const char **data, const char *end,
+                           std::string *s);
+    // ------------------------------------------------------------------------
     /** Returns the filename that was opened. */
     virtual const std::string& getReplayFilename(int replay_file_number = 1) const = 0;
     // ------------------------------------------------------------------------
     /** Returns the version number of the replay file recorderd by this executable.
-     *  This is also used as a maximum supported version by this exexcutable. */
-    unsigned int getCurrentReplayVersion() const { return 4; }
+     *  This is also used as a maximum supported version by this exexcutable.
+     *  Version 5 is the binary format. */
+    unsigned int getCurrentReplayVersion() const { return 5; }
+
+    // ------------------------------------------------------------------------
+    /** Returns the version number used when exporting a replay as text. */
+    unsigned int getTextReplayVersion() const { return 4; }
 
     // ------------------------------------------------------------------------
     /** This is used to check that a loaded replay file can still
@@ -115,6 +141,7 @@ protected:
 public:
              ReplayBase();
     virtual ~ReplayBase() {};
+    static void unitTesting();
 };   // ReplayBase
 
 #endif
@@ -27,14 +27,18 @@
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
 #include "utils/file_utils.hpp"
+#include "utils/mapped_file.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/time.hpp"
 
 #include <irrlicht.h>
+#include <cstring>
 #include <stdio.h>
 #include <string>
 #include <cinttypes>
 
 ReplayPlay::SortOrder ReplayPlay::m_sort_order = ReplayPlay::SO_DEFAULT;
+const char ReplayPlay::INDEX_MAGIC[4] = { 'S', 'T', 'K', 'I' };
 ReplayPlay *ReplayPlay::m_replay_play = NULL;
 
 //-----------------------------------------------------------------------------
@@ -90,34 +94,323 @@ void ReplayPlay::loadAllReplayFile()
 
     int j=0;
 
+    // The headers of user replays are cached in an index file, so only
+    // new or modified replay files need to be read. The index is read
+    // again each time, since other instances of STK can add to it.
+    const unsigned int num_entries = loadIndex();
+    bool index_changed = false;
+    std::map<std::string, IndexEntry> new_index;
+
     for (std::set<std::string>::iterator i  = files.begin();
                                          i != files.end(); ++i)
     {
-        if (!addReplayFile(*i, false, j))
+        if (StringUtils::getExtension(*i) != "replay")
+            continue;
+        IndexEntry entry;
+        if (!getFileInfo(file_manager->getReplayDir() + *i, &entry.m_size,
+                         &entry.m_mtime))
+            continue;
+
+        std::map<std::string, IndexEntry>::const_iterator cached =
+            m_index.find(*i);
+        if (cached != m_index.end() &&
+            cached->second.m_size  == entry.m_size &&
+            cached->second.m_mtime == entry.m_mtime)
+        {
+            entry.m_data = cached->second.m_data;
+            // No UID in old replay format
+            if (entry.m_data.m_replay_version == 3)
+                entry.m_data.m_replay_uid = j;
+        }
+        else if (readReplayFile(*i, false, j, &entry.m_data))
+        {
+            index_changed = true;
+        }
+        else
         {
             // Skip invalid replay file
             continue;
         }
+        new_index[*i] = entry;
+
+        if (!findTrack(&entry.m_data))
+            continue;
+        addReplayData(entry.m_data);
         j++;
     }
 
+    // Also save the index if replay files were removed, or if replays
+    // were saved more than once (see addToIndex)
+    if (index_changed || new_index.size() != num_entries)
+    {
+        m_index.swap(new_index);
+        saveIndex();
+    }
 }   // loadAllReplayFile
 
+//-----------------------------------------------------------------------------
+/** Returns the name of the index file, which caches the headers of all
+ *  replays in the replay directory.
+ */
+std::string ReplayPlay::getIndexFilename() const
+{
+    return file_manager->getReplayDir() + "replays.index";
+}   // getIndexFilename
+
+//-----------------------------------------------------------------------------
+/** Returns the size and modification time of a file.
+ *  \return False if the file does not exist.
+ */
+bool ReplayPlay::getFileInfo(const std::string &path, uint64_t *size,
+                             uint64_t *mtime) const
+{
+    struct stat st;
+    if (FileUtils::statU8Path(path, &st) != 0)
+        return false;
+    *size  = (uint64_t)st.st_size;
+    *mtime = (uint64_t)st.st_mtime;
+    return true;
+}   // getFileInfo
+
+//-----------------------------------------------------------------------------
+/** Loads the replay index. The index file contains the magic and the
+ *  version, followed by any number of entries. A later entry for the same
+ *  replay replaces an earlier one, so new replays can be appended to the
+ *  index. A missing or invalid index results in an empty index, so all
+ *  replay files will be read again.
+ *  \return The number of entries in the index file.
+ */
+unsigned int ReplayPlay::loadIndex()
+{
+    m_index.clear();
+
+    MappedFile file;
+    if (!file.open(getIndexFilename()))
+        return 0;
+    const char *data = file.getData();
+    const char *end  = data + file.getSize();
+
+    uint64_t version = 0;
+    bool valid = file.getSize() >= sizeof(INDEX_MAGIC) &&
+                 memcmp(data, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0;
+    if (valid)
+    {
+        data += sizeof(INDEX_MAGIC);
+        valid = readVarUInt(&data, end, &version) &&
+                version == INDEX_VERSION;
+    }
+    if (!valid)
+    {
+        Log::warn("Replay", "Ignoring invalid replay index '%s'.",
+                  getIndexFilename().c_str());
+        return 0;
+    }
+
+    unsigned int num_entries = 0;
+    while (data < end)
+    {
+        std::string filename, s;
+        IndexEntry entry;
+        ReplayData &rd = entry.m_data;
+        uint64_t replay_version, num_karts;
+        if (!readString(&data, end, &filename)        ||
+            !readVarUInt(&data, end, &entry.m_size)   ||
+            !readVarUInt(&data, end, &entry.m_mtime)  ||
+            !readVarUInt(&data, end, &replay_version) ||
+            !readString(&data, end, &s)               ||
+            !readVarUInt(&data, end, &num_karts)        )
+            break;
+        rd.m_filename           = filename;
+        rd.m_custom_replay_file = false;
+        rd.m_replay_version     = (unsigned int)replay_version;
+        rd.m_stk_version        = StringUtils::utf8ToWide(s);
+
+        bool valid = true;
+        for (uint64_t k = 0; k < num_karts && valid; k++)
+        {
+            std::string ident, name;
+            float color;
+            valid = readString(&data, end, &ident) &&
+                    readString(&data, end, &name)  &&
+                    readFloat(&data, end, &color);
+            rd.m_kart_list.push_back(ident);
+            rd.m_name_list.push_back(StringUtils::utf8ToWide(name));
+            rd.m_kart_color.push_back(color);
+        }
+
+        uint64_t reverse, difficulty, laps;
+        if (!valid                                    ||
+            !readString (&data, end, &s)              ||
+            !readVarUInt(&data, end, &reverse)        ||
+            !readVarUInt(&data, end, &difficulty)     ||
+            !readString (&data, end, &rd.m_minor_mode)||
+            !readString (&data, end, &rd.m_track_name)||
+            !readVarUInt(&data, end, &laps)           ||
+            !readFloat  (&data, end, &rd.m_min_time)  ||
+            !readVarUInt(&data, end, &rd.m_replay_uid)  )
+            break;
+        rd.m_user_name  = StringUtils::utf8ToWide(s);
+        rd.m_reverse    = reverse != 0;
+        rd.m_difficulty = (unsigned int)difficulty;
+        rd.m_laps       = (unsigned int)laps;
+        rd.m_track      = NULL;
+        m_index[filename] = entry;
+        num_entries++;
+    }
+    return num_entries;
+}   // loadIndex
+
+//-----------------------------------------------------------------------------
+/** Appends one entry of the replay index to a string.
+ *  \param out The string to append to.
+ *  \param fn Name of the replay file.
+ *  \param entry The index entry.
+ */
+void ReplayPlay::writeIndexEntry(std::string *out, const std::string &fn,
+                                 const IndexEntry &entry)
+{
+    const ReplayData &rd = entry.m_data;
+    writeString(out, fn);
+    writeVarUInt(out, entry.m_size);
+    writeVarUInt(out, entry.m_mtime);
+    writeVarUInt(out, rd.m_replay_version);
+    writeString(out, StringUtils::wideToUtf8(rd.m_stk_version));
+    writeVarUInt(out, rd.m_kart_list.size());
+    for (unsigned int k = 0; k < rd.m_kart_list.size(); k++)
+    {
+        writeString(out, rd.m_kart_list[k]);
+        writeString(out, StringUtils::wideToUtf8(rd.m_name_list[k]));
+        writeFloat(out, rd.m_kart_color[k]);
+    }
+    writeString(out, StringUtils::wideToUtf8(rd.m_user_name));
+    writeVarUInt(out, rd.m_reverse ? 1 : 0);
+    writeVarUInt(out, rd.m_difficulty);
+    writeString(out, rd.m_minor_mode);
+    writeString(out, rd.m_track_name);
+    writeVarUInt(out, rd.m_laps);
+    writeFloat(out, rd.m_min_time);
+    writeVarUInt(out, rd.m_replay_uid);
+}   // writeIndexEntry
+
+//-----------------------------------------------------------------------------
+/** Saves the replay index, which removes entries of deleted replays and
+ *  older entries of replays that were saved more than once. The index is
+ *  written to a temporary file first, so that other instances of STK never
+ *  read a partially written index.
+ */
+void ReplayPlay::saveIndex() const
+{
+    std::string out;
+    out.append(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    writeVarUInt(&out, INDEX_VERSION);
+    for (std::map<std::string, IndexEntry>::const_iterator i = m_index.begin();
+         i != m_index.end(); ++i)
+        writeIndexEntry(&out, i->first, i->second);
+
+    const std::string filename = getIndexFilename();
+    const std::string tmp_filename = FileUtils::getUniqueTmpPath(filename);
+    FILE *fd = FileUtils::fopenU8Path(tmp_filename, "wb");
+    if (!fd)
+    {
+        Log::warn("Replay", "Can't write replay index '%s'.",
+                  filename.c_str());
+        return;
+    }
+    bool ok = fwrite(out.data(), 1, out.size(), fd) == out.size();
+    ok = fclose(fd) == 0 && ok;
+    if (!ok || FileUtils::replaceU8Path(tmp_filename, filename) != 0)
+    {
+        Log::warn("Replay", "Can't write replay index '%s'.",
+                  filename.c_str());
+        file_manager->removeFile(tmp_filename);
+    }
+}   // saveIndex
+
+//-----------------------------------------------------------------------------
+/** Adds a newly saved replay file to the index, so that it does not need to
+ *  be read when the list of replays is loaded the next time. The entry is
+ *  appended to the index file, so the existing entries are neither read
+ *  nor written again.
+ *  \param fn Name of the replay file (in the replay directory).
+ */
+void ReplayPlay::addToIndex(const std::string &fn)
+{
+    IndexEntry entry;
+    if (!getFileInfo(file_manager->getReplayDir() + fn, &entry.m_size,
+                     &entry.m_mtime) ||
+        !readReplayFile(fn, /*custom_replay*/false, 0, &entry.m_data))
+        return;
+
+    const std::string filename = getIndexFilename();
+    uint64_t index_size = 0, index_mtime;
+    std::string out;
+    if (!getFileInfo(filename, &index_size, &index_mtime) || index_size == 0)
+    {
+        out.append(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        writeVarUInt(&out, INDEX_VERSION);
+    }
+    writeIndexEntry(&out, fn, entry);
+
+    // A single write, so that entries appended by other instances of STK
+    // are not interleaved with this one
+    FILE *fd = FileUtils::fopenU8Path(filename, "ab");
+    bool ok = fd && fwrite(out.data(), 1, out.size(), fd) == out.size();
+    if (fd)
+        ok = fclose(fd) == 0 && ok;
+    if (!ok)
+    {
+        Log::warn("Replay", "Can't write replay index '%s'.",
+                  filename.c_str());
+    }
+}   // addToIndex
+
 //-----------------------------------------------------------------------------
 bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int call_index)
+{
+    ReplayData rd;
+    if (!readReplayFile(fn, custom_replay, call_index, &rd))
+        return false;
+    addReplayData(rd);
+    return true;
+}   // addReplayFile
+
+//-----------------------------------------------------------------------------
+/** Reads the header of a replay file.
+ *  \param fn Name of the replay file.
+ *  \param custom_replay True if fn is a full path, otherwise the file is
+ *         in the replay directory.
+ *  \param call_index Used as UID for old replays that have none.
+ *  \param out The replay data to fill in.
+ *  \return False if the file is not a valid replay.
+ */
+bool ReplayPlay::readReplayFile(const std::string& fn, bool custom_replay,
+                                int call_index, ReplayData *out)
 {
 
     char s[1024], s1[1024];
     if (StringUtils::getExtension(fn) != "replay") return false;
-    FILE* fd = FileUtils::fopenU8Path(custom_replay ? fn :
-        file_manager->getReplayDir() + fn, "r");
-    if (fd == NULL) return false;
-    ReplayData rd;
+    const std::string path = custom_replay ? fn
+                                           : file_manager->getReplayDir() + fn;
+    ReplayData &rd = *out;
 
     // custom_replay is true when full path of filename is given
     rd.m_custom_replay_file = custom_replay;
     rd.m_filename = fn;
 
+    // Binary replays are memory mapped, so only the header is read
+    {
+        MappedFile file;
+        if (!file.open(path)) return false;
+        if (isBinaryReplay(file.getData(), file.getSize()))
+        {
+            const char *data = file.getData();
+            return readBinaryHeader(&data, data + file.getSize(), &rd);
+        }
+    }
+
+    FILE* fd = FileUtils::fopenU8Path(path, "r");
+    if (fd == NULL) return false;
+
     fgets(s, 1023, fd);
     unsigned int version;
     if (sscanf(s,"version: %u", &version) != 1)
@@ -245,24 +538,12 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int ca
         return false;
     }
     rd.m_track_name = std::string(s1);
-
-    // If former official tracks are present as addons, show the matching replays.
-    if (rd.m_track_name.compare("greenvalley") == 0)
-        rd.m_track_name = std::string("addon_green-valley");
-    if (rd.m_track_name.compare("mansion") == 0)
-        rd.m_track_name = std::string("addon_blackhill-mansion");
-
-    Track* t = track_manager->getTrack(rd.m_track_name);
-    if (t == NULL)
+    if (!findTrack(&rd))
     {
-        Log::warn("Replay", "Track '%s' used in replay '%s' not found in STK!",
-        rd.m_track_name.c_str(), fn.c_str());
         fclose(fd);
         return false;
     }
 
-    rd.m_track = t;
-
     fgets(s, 1023, fd);
     if (sscanf(s, "laps: %u", &rd.m_laps) != 1)
     {
@@ -294,16 +575,129 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay, int ca
         rd.m_replay_uid = call_index;
 
     fclose(fd);
+    return true;
+
+}   // readReplayFile
+
+//-----------------------------------------------------------------------------
+/** Adds a replay to the list of replay files.
+ *  \param rd The data of the replay.
+ */
+void ReplayPlay::addReplayData(const ReplayData &rd)
+{
     m_replay_file_list.push_back(rd);
 
     assert(m_replay_file_list.size() > 0);
     // Force to use custom replay file immediately
-    if (custom_replay)
+    if (rd.m_custom_replay_file)
         m_current_replay_file = (unsigned int)m_replay_file_list.size() - 1;
+}   // addReplayData
+
+//-----------------------------------------------------------------------------
+/** Sets the track of a replay from its track name.
+ *  \param rd The replay data, m_track_name must be set.
+ *  \return False if the track is not available.
+ */
+bool ReplayPlay::findTrack(ReplayData *rd)
+{
+    // If former official tracks are present as addons, show the matching replays.
+    if (rd->m_track_name.compare("greenvalley") == 0)
+        rd->m_track_name = std::string("addon_green-valley");
+    if (rd->m_track_name.compare("mansion") == 0)
+        rd->m_track_name = std::string("addon_blackhill-mansion");
+
+    Track* t = track_manager->getTrack(rd->m_track_name);
+    if (t == NULL)
+    {
+        Log::warn("Replay", "Track '%s' used in replay '%s' not found in STK!",
+        rd->m_track_name.c_str(), rd->m_filename.c_str());
+        return false;
+    }
 
+    rd->m_track = t;
     return true;
+}   // findTrack
 
-}   // addReplayFile
+//-----------------------------------------------------------------------------
+/** Reads the header of a binary replay file (see
+ *  ReplayRecorder::saveBinary).
+ *  \param data Pointer to the start of the file, on return it points to the
+ *         data of the first kart.
+ *  \param end End of the file.
+ *  \param rd The replay data to fill in, m_filename must be set.
+ *  \return False if the header is invalid.
+ */
+bool ReplayPlay::readBinaryHeader(const char **data, const char *end,
+                                  ReplayData *rd)
+{
+    // Skip the identifier, which is tested by isBinaryReplay
+    *data += 4;
+
+    uint64_t version;
+    if (!readVarUInt(data, end, &version))
+    {
+        Log::warn("Replay", "No version found in replay file, '%s'.",
+                  rd->m_filename.c_str());
+        return false;
+    }
+    if (version > getCurrentReplayVersion() || version < 5)
+    {
+        Log::warn("Replay", "Replay is version '%d'", (int)version);
+        Log::warn("Replay", "STK replay version is '%d'", getCurrentReplayVersion());
+        Log::warn("Replay", "Skipped '%s'", rd->m_filename.c_str());
+        return false;
+    }
+    rd->m_replay_version = (unsigned int)version;
+
+    std::string s;
+    uint64_t num_karts;
+    if (!readString(data, end, &s) || !readVarUInt(data, end, &num_karts))
+    {
+        Log::warn("Replay", "Invalid replay file, '%s'.",
+                  rd->m_filename.c_str());
+        return false;
+    }
+    rd->m_stk_version = s.c_str();
+
+    for (uint64_t i = 0; i < num_karts; i++)
+    {
+        std::string ident, name;
+        float color;
+        if (!readString(data, end, &ident) || !readString(data, end, &name) ||
+            !readFloat(data, end, &color))
+        {
+            Log::warn("Replay", "Could not read ghost karts info!");
+            return false;
+        }
+        rd->m_kart_list.push_back(ident);
+        // An empty name will default to the kart name (see
+        // GhostController::getName)
+        rd->m_name_list.push_back(StringUtils::utf8ToWide(name));
+        // First user is the game master and the "owner" of this replay file
+        if (i == 0 && !name.empty())
+            rd->m_user_name = rd->m_name_list[0];
+        rd->m_kart_color.push_back(color);
+    }
+
+    uint64_t reverse, difficulty, laps;
+    if (!readVarUInt(data, end, &reverse)              ||
+        !readVarUInt(data, end, &difficulty)           ||
+        !readString (data, end, &rd->m_minor_mode)     ||
+        !readString (data, end, &rd->m_track_name)     ||
+        !readVarUInt(data, end, &laps)                 ||
+        !readFloat  (data, end, &rd->m_min_time)       ||
+        !readVarUInt(data, end, &rd->m_replay_uid)       )
+    {
+        Log::warn("Replay", "Invalid replay file, '%s'.",
+                  rd->m_filename.c_str());
+        return false;
+    }
+    rd->m_reverse    = reverse != 0;
+    rd->m_difficulty = (unsigned int)difficulty;
+    rd->m_laps       = (unsigned int)laps;
+
+    return findTrack(rd);
+}   // readBinaryHeader
 
 //-----------------------------------------------------------------------------
 void ReplayPlay::load()
@@ -326,6 +720,12 @@ void ReplayPlay::loadFile(bool second_replay)
     int replay_index = second_replay ? m_second_replay_file : m_current_replay_file;
     int replay_file_number = second_replay ? 2 : 1;
 
+    if (m_replay_file_list.at(replay_index).m_replay_version >= 5)
+    {
+        loadBinaryFile(second_replay);
+        return;
+    }
+
     FILE *fd = openReplayFile(/*writeable*/false,
             m_replay_file_list.at(replay_index).m_custom_replay_file, replay_file_number);
 
@@ -362,13 +762,99 @@ void ReplayPlay::loadFile(bool second_replay)
 }   // loadFile
 
 //-----------------------------------------------------------------------------
-/** Reads all data from a replay file for a specific kart.
- *  \param fd The file descriptor from which to read.
+/** Loads a binary replay file and creates its ghost karts.
+ *  \param second_replay True if the second replay file is loaded.
  */
-void ReplayPlay::readKartData(FILE *fd, char *next_line, bool second_replay)
+void ReplayPlay::loadBinaryFile(bool second_replay)
 {
-    char s[1024];
+    int replay_index = second_replay ? m_second_replay_file : m_current_replay_file;
+    int replay_file_number = second_replay ? 2 : 1;
+    const ReplayData &rd = m_replay_file_list.at(replay_index);
+
+    MappedFile file;
+    ReplayData header;
+    header.m_filename = rd.m_filename;
+    const char *data = NULL, *end = NULL;
+    if (file.open(rd.m_custom_replay_file ? rd.m_filename
+                            : file_manager->getReplayDir() + rd.m_filename))
+    {
+        data = file.getData();
+        end  = data + file.getSize();
+    }
+    if (!data || !isBinaryReplay(data, end - data) ||
+        !readBinaryHeader(&data, end, &header))
+    {
+        Log::error("Replay", "Can't read '%s', ghost replay disabled.",
+                    getReplayFilename(replay_file_number).c_str());
+        destroy();
+        return;
+    }
 
+    Log::info("Replay", "Reading replay file '%s'.",
+                    getReplayFilename(replay_file_number).c_str());
+
+    for (unsigned int i = 0; i < header.m_kart_list.size(); i++)
+    {
+        const unsigned int kart_num = createGhostKart(second_replay);
+        if (!readBinaryKartData(&data, end, m_ghost_karts[kart_num].get(),
+                                /*num_decoded*/NULL))
+        {
+            Log::warn("Replay", "Replay file '%s' is truncated.",
+                      getReplayFilename(replay_file_number).c_str());
+            break;
+        }
+    }
+}   // loadBinaryFile
+
+//-----------------------------------------------------------------------------
+/** Reads the events of one kart from a binary replay file.
+ *  \param data Pointer to the data of the kart, on return it points to the
+ *         data of the next kart.
+ *  \param end End of the file.
+ *  \param kart The ghost kart to which the events are added. If NULL, the
+ *         events are only decoded (used for benchmarking).
+ *  \param num_decoded If not NULL, the number of decoded events is added
+ *         to this counter.
+ *  \return False if the data is truncated.
+ */
+bool ReplayPlay::readBinaryKartData(const char **data, const char *end,
+                                    GhostKart *kart,
+                                    unsigned int *num_decoded)
+{
+    uint64_t num_events, size;
+    if (!readVarUInt(data, end, &num_events) ||
+        !readVarUInt(data, end, &size)       ||
+        (uint64_t)(end - *data) < size)
+        return false;
+
+    const char *events     = *data;
+    const char *events_end = *data + size;
+    *data = events_end;
+
+    int64_t previous[NUM_EVENT_VALUES] = { 0 };
+    for (uint64_t i = 0; i < num_events; i++)
+    {
+        TransformEvent  t;
+        PhysicInfo      pi;
+        BonusInfo       bi;
+        KartReplayEvent kre;
+        if (!decodeEvent(&events, events_end, previous, &t, &pi, &bi, &kre))
+            return false;
+        if (kart)
+            kart->addReplayEvent(t.m_time, t.m_transform, pi, bi, kre);
+        if (num_decoded)
+            (*num_decoded)++;
+    }
+    return true;
+}   // readBinaryKartData
+
+//-----------------------------------------------------------------------------
+/** Creates the next ghost kart of a replay file.
+ *  \param second_replay True if the kart belongs to the second replay.
+ *  \return The index of the new ghost kart.
+ */
+unsigned int ReplayPlay::createGhostKart(bool second_replay)
+{
     int replay_index = second_replay ? m_second_replay_file
                                      : m_current_replay_file;
 
@@ -387,6 +873,21 @@ void ReplayPlay::readKartData(FILE *fd, char *next_line, bool second_replay)
     Controller* controller = new GhostController(getGhostKart(kart_num).get(),
                                                  rd.m_name_list[kart_num-first_loaded_f_num]);
     getGhostKart(kart_num)->setController(controller);
+    return kart_num;
+}   // createGhostKart
+
+//-----------------------------------------------------------------------------
+/** Reads all data from a replay file for a specific kart.
+ *  \param fd The file descriptor from which to read.
+ */
+void ReplayPlay::readKartData(FILE *fd, char *next_line, bool second_replay)
+{
+    char s[1024];
+
+    int replay_index = second_replay ? m_second_replay_file
+                                     : m_current_replay_file;
+    const ReplayData &rd = m_replay_file_list[replay_index];
+    const unsigned int kart_num = createGhostKart(second_replay);
 
     unsigned int size;
     if(sscanf(next_line,"size: %u",&size)!=1)
@@ -396,112 +897,167 @@ void ReplayPlay::readKartData(FILE *fd, char *next_line, bool second_replay)
     for(unsigned int i=0; i<size; i++)
     {
         fgets(s, 1023, fd);
-        float x, y, z, rx, ry, rz, rw, time, speed, steer, w1, w2, w3, w4, nitro_amount, distance;
-        int skidding_state, attachment, item_amount, item_type, special_value,
-            nitro, zipper, skidding, red_skidding, jumping;
+        TransformEvent  t;
+        PhysicInfo      pi;
+        BonusInfo       bi;
+        KartReplayEvent kre;
+        if (parseTextEvent(s, rd.m_replay_version, &t, &pi, &bi, &kre))
+        {
+            m_ghost_karts[kart_num]->addReplayEvent(t.m_time,
+                t.m_transform, pi, bi, kre);
+        }
+        else
+        {
+            // Invalid record found
+            // ---------------------
+            Log::warn("Replay", "Can't read replay data line %d:", i);
+            Log::warn("Replay", "%s", s);
+            Log::warn("Replay", "Ignored.");
+        }
+    }   // for i
 
-        // Check for EV_TRANSFORM event:
-        // -----------------------------
+}   // readKartData
+
+//-----------------------------------------------------------------------------
+/** Parses one event line of a text replay file.
+ *  \param s The line.
+ *  \param version Version of the replay file.
+ *  \return False if the line could not be parsed.
+ */
+bool ReplayPlay::parseTextEvent(const char *s, unsigned int version,
+                                TransformEvent *t, PhysicInfo *pi,
+                                BonusInfo *bi, KartReplayEvent *kre)
+{
+    float x, y, z, rx, ry, rz, rw, time, speed, steer, w1, w2, w3, w4,
+          nitro_amount = 0, distance = 0;
+    int skidding_state = 0, attachment = 0, item_amount = 0, item_type = 0,
+        special_value = 0, nitro, zipper, skidding, red_skidding, jumping;
 
-        // Up to STK 0.9.3 replays
-        if (rd.m_replay_version == 3)
+    // Up to STK 0.9.3 replays
+    if (version == 3)
+    {
+        if(sscanf(s, "%f  %f %f %f  %f %f %f %f  %f  %f  %f %f %f %f  %d %d %d %d %d\n",
+            &time,
+            &x, &y, &z,
+            &rx, &ry, &rz, &rw,
+            &speed, &steer, &w1, &w2, &w3, &w4,
+            &nitro, &zipper, &skidding, &red_skidding, &jumping
+            )!=19)
+            return false;
+        // Skidding state, bonus info and distance are not saved in
+        // version 3 replays and are left at 0
+    }
+    //version 4 replays (STK 0.9.4 and higher)
+    else
+    {
+        if(sscanf(s, "%f  %f %f %f  %f %f %f %f  %f  %f  %f %f %f %f %d  %d %f %d %d %d  %f %d %d %d %d %d\n",
+            &time,
+            &x, &y, &z,
+            &rx, &ry, &rz, &rw,
+            &speed, &steer, &w1, &w2, &w3, &w4, &skidding_state,
+            &attachment, &nitro_amount, &item_amount, &item_type, &special_value,
+            &distance, &nitro, &zipper, &skidding, &red_skidding, &jumping
+            )!=26)
+            return false;
+    }
+
+    t->m_time                  = time;
+    t->m_transform             = btTransform(btQuaternion(rx, ry, rz, rw),
+                                             btVector3(x, y, z));
+    pi->m_speed                = speed;
+    pi->m_steer                = steer;
+    pi->m_suspension_length[0] = w1;
+    pi->m_suspension_length[1] = w2;
+    pi->m_suspension_length[2] = w3;
+    pi->m_suspension_length[3] = w4;
+    pi->m_skidding_state       = skidding_state;
+    bi->m_attachment           = attachment;
+    bi->m_nitro_amount         = nitro_amount;
+    bi->m_item_amount          = item_amount;
+    bi->m_item_type            = item_type;
+    bi->m_special_value        = special_value;
+    kre->m_distance            = distance;
+    kre->m_nitro_usage         = nitro;
+    kre->m_zipper_usage        = zipper!=0;
+    kre->m_skidding_effect     = skidding;
+    kre->m_red_skidding        = red_skidding!=0;
+    kre->m_jumping             = jumping != 0;
+    return true;
+}   // parseTextEvent
+
+//-----------------------------------------------------------------------------
+/** Measures how long it takes to read the headers of all replay files in
+ *  a directory (as done for the list of replays), and to decode all events
+ *  of these files. This allows to compare the text and binary formats.
+ *  \param dir The directory containing the replay files.
+ */
+void ReplayPlay::benchmarkLoading(const std::string &dir)
+{
+    std::set<std::string> files;
+    file_manager->listFiles(files, dir, /*is_full_path*/ true);
+
+    m_replay_file_list.clear();
+    double start = StkTime::getRealTime();
+    unsigned int num_files = 0;
+    for (const std::string &file : files)
+    {
+        if (StringUtils::getExtension(file) != "replay")
+            continue;
+        num_files++;
+        addReplayFile(file, /*custom_replay*/ true);
+    }
+    double header_time = StkTime::getRealTime() - start;
+
+    unsigned int num_events = 0;
+    start = StkTime::getRealTime();
+    for (const ReplayData &rd : m_replay_file_list)
+    {
+        MappedFile file;
+        if (!file.open(rd.m_filename))
+            continue;
+        const char *data = file.getData();
+        const char *end  = data + file.getSize();
+        if (isBinaryReplay(data, file.getSize()))
         {
-            if(sscanf(s, "%f  %f %f %f  %f %f %f %f  %f  %f  %f %f %f %f  %d %d %d %d %d\n",
-                &time,
-                &x, &y, &z,
-                &rx, &ry, &rz, &rw,
-                &speed, &steer, &w1, &w2, &w3, &w4,
-                &nitro, &zipper, &skidding, &red_skidding, &jumping
-                )==19)
-            {
-                btQuaternion q(rx, ry, rz, rw);
-                btVector3 xyz(x, y, z);
-                PhysicInfo pi             = {0};
-                BonusInfo bi              = {0};
-                KartReplayEvent kre       = {0};
-
-                pi.m_speed                = speed;
-                pi.m_steer                = steer;
-                pi.m_suspension_length[0] = w1;
-                pi.m_suspension_length[1] = w2;
-                pi.m_suspension_length[2] = w3;
-                pi.m_suspension_length[3] = w4;
-                pi.m_skidding_state       = 0;    //not saved in version 3 replays
-                bi.m_attachment           = 0;    //not saved in version 3 replays
-                bi.m_nitro_amount         = 0;    //not saved in version 3 replays
-                bi.m_item_amount          = 0;    //not saved in version 3 replays
-                bi.m_item_type            = 0;    //not saved in version 3 replays
-                bi.m_special_value        = 0;    //not saved in version 3 replays
-                kre.m_distance            = 0.0f; //not saved in version 3 replays
-                kre.m_nitro_usage         = nitro;
-                kre.m_zipper_usage        = zipper!=0;
-                kre.m_skidding_effect     = skidding;
-                kre.m_red_skidding        = red_skidding!=0;
-                kre.m_jumping             = jumping != 0;
-                m_ghost_karts[kart_num]->addReplayEvent(time,
-                    btTransform(q, xyz), pi, bi, kre);
-            }
-            else
+            ReplayData header;
+            header.m_filename = rd.m_filename;
+            if (!readBinaryHeader(&data, end, &header))
+                continue;
+            for (unsigned int k = 0; k < header.m_kart_list.size(); k++)
             {
-                // Invalid record found
-                // ---------------------
-                Log::warn("Replay", "Can't read replay data line %d:", i);
-                Log::warn("Replay", "%s", s);
-                Log::warn("Replay", "Ignored.");
+                if (!readBinaryKartData(&data, end, /*kart*/NULL,
+                                        &num_events))
+                    break;
             }
+            continue;
         }
 
-        //version 4 replays (STK 0.9.4 and higher)
-        else
+        // Text replay: parse all lines that contain events
+        std::string line;
+        while (data < end)
         {
-            if(sscanf(s, "%f  %f %f %f  %f %f %f %f  %f  %f  %f %f %f %f %d  %d %f %d %d %d  %f %d %d %d %d %d\n",
-                &time,
-                &x, &y, &z,
-                &rx, &ry, &rz, &rw,
-                &speed, &steer, &w1, &w2, &w3, &w4, &skidding_state,
-                &attachment, &nitro_amount, &item_amount, &item_type, &special_value,
-                &distance, &nitro, &zipper, &skidding, &red_skidding, &jumping
-                )==26)
-            {
-                btQuaternion q(rx, ry, rz, rw);
-                btVector3 xyz(x, y, z);
-                PhysicInfo pi             = {0};
-                BonusInfo bi              = {0};
-                KartReplayEvent kre       = {0};
-
-                pi.m_speed                = speed;
-                pi.m_steer                = steer;
-                pi.m_suspension_length[0] = w1;
-                pi.m_suspension_length[1] = w2;
-                pi.m_suspension_length[2] = w3;
-                pi.m_suspension_length[3] = w4;
-                pi.m_skidding_state       = skidding_state;
-                bi.m_attachment           = attachment;
-                bi.m_nitro_amount         = nitro_amount;
-                bi.m_item_amount          = item_amount;
-                bi.m_item_type            = item_type;
-                bi.m_special_value        = special_value;
-                kre.m_distance            = distance;
-                kre.m_nitro_usage         = nitro;
-                kre.m_zipper_usage        = zipper!=0;
-                kre.m_skidding_effect     = skidding;
-                kre.m_red_skidding        = red_skidding!=0;
-                kre.m_jumping             = jumping != 0;
-                m_ghost_karts[kart_num]->addReplayEvent(time,
-                    btTransform(q, xyz), pi, bi, kre);
-            }
-            else
-            {
-                // Invalid record found
-                // ---------------------
-                Log::warn("Replay", "Can't read replay data line %d:", i);
-                Log::warn("Replay", "%s", s);
-                Log::warn("Replay", "Ignored.");
-            }
+            const char *eol = std::find(data, end, '\n');
+            line.assign(data, eol);
+            data = eol + (eol < end ? 1 : 0);
+            TransformEvent  t;
+            PhysicInfo      pi;
+            BonusInfo       bi;
+            KartReplayEvent kre;
+            if (parseTextEvent(line.c_str(), rd.m_replay_version,
+                               &t, &pi, &bi, &kre))
+                num_events++;
         }
-    }   // for i
+    }
+    double event_time = StkTime::getRealTime() - start;
 
-}   // readKartData
+    Log::info("Replay", "%d files, %d valid replays: reading headers took "
+              "%.3f s, decoding all events took %.3f s.", num_files,
+              (int)m_replay_file_list.size(), header_time, event_time);
+    if (num_events > 0)
+        Log::info("Replay", "%d events decoded.", num_events);
+    m_replay_file_list.clear();
+    m_current_replay_file = 0;
+}   // benchmarkLoading
 
 //-----------------------------------------------------------------------------
 /** call getReplayIdByUID and set the current replay file to the first one
@@ -24,6 +24,7 @@
 
 #include "irrString.h"
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -107,6 +108,21 @@ public:
     };   // ReplayData
 
 private:
+    /** An entry of the replay index, which caches the header of a replay
+     *  file together with the size and modification time of the file. */
+    struct IndexEntry
+    {
+        uint64_t   m_size;
+        uint64_t   m_mtime;
+        ReplayData m_data;
+    };   // IndexEntry
+
+    /** The first bytes of the replay index file. */
+    static const char        INDEX_MAGIC[4];
+
+    /** Version of the replay index file. */
+    static const unsigned int INDEX_VERSION = 2;
+
     static ReplayPlay       *m_replay_play;
 
     static SortOrder         m_sort_order;
@@ -119,17 +135,43 @@ private:
 
     std::vector<ReplayData>  m_replay_file_list;
 
+    /** The cached headers of all replays in the replay directory, indexed
+     *  by file name. */
+    std::map<std::string, IndexEntry> m_index;
+
     /** All ghost karts. */
     std::vector<std::shared_ptr<GhostKart> > m_ghost_karts;
 
           ReplayPlay();
          ~ReplayPlay();
     void  readKartData(FILE *fd, char *next_line, bool second_replay);
+    bool  parseTextEvent(const char *s, unsigned int version,
+                         TransformEvent *t, PhysicInfo *pi, BonusInfo *bi,
+                         KartReplayEvent *kre);
+    bool  readReplayFile(const std::string& fn, bool custom_replay,
+                         int call_index, ReplayData *out);
+    void  addReplayData(const ReplayData &rd);
+    std::string getIndexFilename() const;
+    bool  getFileInfo(const std::string &path, uint64_t *size,
+                      uint64_t *mtime) const;
+    unsigned int loadIndex();
+    void  saveIndex() const;
+    static void writeIndexEntry(std::string *out, const std::string &fn,
+                                const IndexEntry &entry);
+    bool  findTrack(ReplayData *rd);
+    bool  readBinaryHeader(const char **data, const char *end,
+                           ReplayData *rd);
+    bool  readBinaryKartData(const char **data, const char *end,
+                             GhostKart *kart, unsigned int *num_decoded);
+    void  loadBinaryFile(bool second_replay);
+    unsigned int createGhostKart(bool second_replay);
 public:
     void  reset();
     void  load();
     void  loadFile(bool second_replay);
     void  loadAllReplayFile();
+    void  benchmarkLoading(const std::string &dir);
+    void  addToIndex(const std::string &fn);
     // ------------------------------------------------------------------------
     static void        setSortOrder(SortOrder so)       { m_sort_order = so; }
     // ------------------------------------------------------------------------
@@ -19,6 +19,7 @@
 #include "replay/replay_recorder.hpp"
 
 #include "config/stk_config.hpp"
+#include "config/user_config.hpp"
 #include "io/file_manager.hpp"
 #include "items/attachment.hpp"
 #include "items/powerup.hpp"
@@ -33,7 +34,9 @@
 #include "modes/world.hpp"
 #include "physics/btKart.hpp"
 #include "race/race_manager.hpp"
+#include "replay/replay_play.hpp"
 #include "tracks/track.hpp"
+#include "utils/file_utils.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/translation.hpp"
 
@@ -385,7 +388,13 @@ void ReplayRecorder::save()
         << "_" << num_karts << "_" << time << ".replay";
     m_filename = oss.str();
 
-    FILE *fd = openReplayFile(/*writeable*/true);
+    // The replay is written to a temporary file, which then replaces the
+    // replay file: a replay with the same name could be mapped into memory
+    // by ReplayPlay, and must not change while it is read.
+    const std::string filename = file_manager->getReplayDir() +
+                                 getReplayFilename();
+    const std::string tmp_filename = FileUtils::getUniqueTmpPath(filename);
+    FILE *fd = FileUtils::fopenU8Path(tmp_filename, "wb");
     if (!fd)
     {
         Log::error("ReplayRecorder", "Can't open '%s' for writing - "
@@ -393,11 +402,59 @@ void ReplayRecorder::save()
         return;
     }
 
+    m_last_uid = computeUID(min_time);
+
+    if (UserConfigParams::m_replay_text_format)
+        saveText(fd, min_time);
+    else
+        saveBinary(fd, min_time);
+    const bool ok = !ferror(fd);
+    if (fclose(fd) != 0 || !ok ||
+        FileUtils::replaceU8Path(tmp_filename, filename) != 0)
+    {
+        Log::error("ReplayRecorder", "Could not write replay file '%s'.",
+                   getReplayFilename().c_str());
+        file_manager->removeFile(tmp_filename);
+        return;
+    }
+
     core::stringw msg = _("Replay saved in \"%s\".",
-        StringUtils::utf8ToWide(file_manager->getReplayDir() + getReplayFilename()));
+        StringUtils::utf8ToWide(filename));
     MessageQueue::add(MessageQueue::MT_GENERIC, msg);
 
-    fprintf(fd, "version: %d\n", getCurrentReplayVersion());
+    if (ReplayPlay::get())
+        ReplayPlay::get()->addToIndex(getReplayFilename());
+}   // save
+
+//-----------------------------------------------------------------------------
+/** Returns the kart color to store for a kart.
+ *  \param kart The kart.
+ *  \param player_count Number of player karts stored so far, increased if
+ *         this kart is a player kart.
+ */
+float ReplayRecorder::getKartColor(const AbstractKart *kart,
+                                   unsigned int *player_count) const
+{
+    if (!kart->getController()->isPlayerController())
+        return 0.0f;
+    float color = StateManager::get()->getActivePlayer(*player_count)
+                                     ->getConstProfile()->getDefaultKartColor();
+    (*player_count)++;
+    return color;
+}   // getKartColor
+
+//-----------------------------------------------------------------------------
+/** Writes the replay as text (replay version 4), which can be read by older
+ *  versions of STK.
+ *  \param fd The file to write to.
+ *  \param min_time The finishing time of the fastest kart.
+ */
+void ReplayRecorder::saveText(FILE *fd, float min_time)
+{
+    const World *world           = World::getWorld();
+    const unsigned int num_karts = world->getNumKarts();
+
+    fprintf(fd, "version: %d\n", getTextReplayVersion());
     fprintf(fd, "stk_version: %s\n", STK_VERSION);
 
     unsigned int player_count = 0;
@@ -409,18 +466,9 @@ void ReplayRecorder::save()
         // XML encode the username to handle Unicode
         fprintf(fd, "kart: %s %s\n", kart->getIdent().c_str(),
                 StringUtils::xmlEncode(kart->getController()->getName()).c_str());
-
-        if (kart->getController()->isPlayerController())
-        {
-            fprintf(fd, "kart_color: %f\n", StateManager::get()->getActivePlayer(player_count)->getConstProfile()->getDefaultKartColor());
-            player_count++;
-        }
-        else
-            fprintf(fd, "kart_color: 0\n");
+        fprintf(fd, "kart_color: %f\n", getKartColor(kart, &player_count));
     }
 
-    m_last_uid = computeUID(min_time);
-
     int num_laps = race_manager->getNumLaps();
     if (num_laps == 9999) num_laps = 0; // no lap in that race mode
 
@@ -436,10 +484,10 @@ void ReplayRecorder::save()
     for (unsigned int k = 0; k < num_karts; k++)
     {
         if (world->getKart(k)->isGhostKart()) continue;
-        fprintf(fd, "size:     %d\n", m_count_transforms[k]);
-
         unsigned int num_transforms = std::min(m_max_frames,
                                                m_count_transforms[k]);
+        fprintf(fd, "size:     %d\n", num_transforms);
+
         for (unsigned int i = 0; i < num_transforms; i++)
         {
             const TransformEvent *p  = &(m_transform_events[k][i]);
@@ -476,8 +524,82 @@ void ReplayRecorder::save()
                 );
         }   // for i
     }
-    fclose(fd);
-}   // save
+}   // saveText
+
+//-----------------------------------------------------------------------------
+/** Writes the replay in the binary format. The file starts with a header
+ *  containing the same information as a text replay. Then for each kart
+ *  follow the number of events, the size of the encoded events (so that
+ *  the data of a kart can be skipped), and then the (delta encoded)
+ *  events themselves.
+ *  \param fd The file to write to.
+ *  \param min_time The finishing time of the fastest kart.
+ */
+void ReplayRecorder::saveBinary(FILE *fd, float min_time)
+{
+    const World *world           = World::getWorld();
+    const unsigned int num_karts = world->getNumKarts();
+
+    std::string out;
+    writeBinaryMagic(&out);
+    writeVarUInt(&out, getCurrentReplayVersion());
+    writeString(&out, STK_VERSION);
+
+    unsigned int num_real_karts = 0;
+    for (unsigned int k = 0; k < num_karts; k++)
+    {
+        if (!world->getKart(k)->isGhostKart())
+            num_real_karts++;
+    }
+    writeVarUInt(&out, num_real_karts);
+
+    unsigned int player_count = 0;
+    for (unsigned int k = 0; k < num_karts; k++)
+    {
+        const AbstractKart *kart = world->getKart(k);
+        if (kart->isGhostKart()) continue;
+        writeString(&out, kart->getIdent());
+        writeString(&out,
+                    StringUtils::wideToUtf8(kart->getController()->getName()));
+        writeFloat(&out, getKartColor(kart, &player_count));
+    }
+
+    int num_laps = race_manager->getNumLaps();
+    if (num_laps == 9999) num_laps = 0; // no lap in that race mode
+
+    writeVarUInt(&out, race_manager->getReverseTrack() ? 1 : 0);
+    writeVarUInt(&out, race_manager->getDifficulty());
+    writeString(&out, race_manager->getMinorModeName());
+    writeString(&out, Track::getCurrentTrack()->getIdent());
+    writeVarUInt(&out, num_laps);
+    writeFloat(&out, min_time);
+    writeVarUInt(&out, m_last_uid);
+
+    for (unsigned int k = 0; k < num_karts; k++)
+    {
+        if (world->getKart(k)->isGhostKart()) continue;
+        unsigned int num_transforms = std::min(m_max_frames,
+                                               m_count_transforms[k]);
+
+        // Encode the events first, since their size is written before them
+        std::string events;
+        int64_t previous[NUM_EVENT_VALUES] = { 0 };
+        for (unsigned int i = 0; i < num_transforms; i++)
+        {
+            encodeEvent(m_transform_events[k][i], m_physic_info[k][i],
+                        m_bonus_info[k][i], m_kart_replay_event[k][i],
+                        previous, &events);
+        }
+
+        writeVarUInt(&out, num_transforms);
+        writeVarUInt(&out, events.size());
+        out.append(events);
+    }
+
+    // A write error sets the error indicator of fd, which is checked in save()
+    size_t written = fwrite(out.data(), 1, out.size(), fd);
+    (void)written;
+}   // saveBinary
 
 /* Returns an encoding value for a given attachment type.
  * The internal values of the enum for attachments may change if attachments
@@ -26,6 +26,8 @@
 
 #include <vector>
 
+class AbstractKart;
+
 /**
   * \ingroup replay
   */
@@ -85,6 +87,11 @@ private:
     /** Compute the replay's UID ; partly based on race data ; partly randomly */
     uint64_t computeUID(float min_time);
 
+    float getKartColor(const AbstractKart *kart,
+                       unsigned int *player_count) const;
+    void  saveText(FILE *fd, float min_time);
+    void  saveBinary(FILE *fd, float min_time);
+
 
           ReplayRecorder();
          ~ReplayRecorder();
@@ -18,8 +18,11 @@
 #include <karts/controller/kart_control.hpp>
 #include "rpc/server.hpp"
 
+#include "config/user_config.hpp"
 #include "rpc/rpc_controller_manager.hpp"
 #include "utils/log.hpp"
+#include "utils/profiler.hpp"
+#include "utils/tick_stats.hpp"
 
 namespace rpc {
 
@@ -64,9 +67,11 @@ void Server::register_methods(class rpc::server& rpc_server)
     rpc_server.bind("hello", hello);
     rpc_server.bind("disable_player_controls", disable_player_controls);
     rpc_server.bind("player_count", player_count);
+    rpc_server.bind("profiler_trace", profiler_trace);
     rpc_server.bind("set_firing", set_firing);
     rpc_server.bind("start_drifting", start_drifting);
     rpc_server.bind("stop_drifting", stop_drifting);
+    rpc_server.bind("tick_stats", tick_stats);
     rpc_server.bind("use_nitrous", use_nitrous);
 
     /* Example instance binding (we don't have any instance methods currently)
@@ -110,6 +115,16 @@ Server::player_id_t Server::player_count()
     return rpc_controller_manager->getNumberOfControllers();
 }
 
+//------------------------------------------------------------------------------
+/** Returns the markers recorded by the profiler as a Chrome trace (JSON), or
+ *  an empty string if the profiler is not enabled (see --profiler). */
+std::string Server::profiler_trace()
+{
+    if (!UserConfigParams::m_profiler_enabled)
+        return "";
+    return profiler.getChromeTrace();
+}
+
 //------------------------------------------------------------------------------
 void Server::set_firing(player_id_t pid, bool firing)
 {
@@ -145,6 +160,24 @@ void Server::stop_drifting(player_id_t pid)
     controller->set_skid_direction(KartControl::SC_NONE);
 }
 
+//------------------------------------------------------------------------------
+/** Returns the timing statistics of the main update phases. For each phase
+ *  the number of measurements, the median, the 99th percentile and the
+ *  maximum (in milliseconds) are returned. */
+std::map<std::string, std::vector<double> > Server::tick_stats()
+{
+    std::map<std::string, std::vector<double> > stats;
+    for (int i = 0; i < TickStats::TS_COUNT; i++)
+    {
+        const TickStats::Phase phase = (TickStats::Phase)i;
+        const TimeHistogram &h = TickStats::getHistogram(phase);
+        stats[TickStats::getName(phase)] =
+            { (double)h.getCount(), h.getPercentile(50.0f) / 1000.0,
+              h.getPercentile(99.0f) / 1000.0, h.getMax() / 1000.0 };
+    }
+    return stats;
+}
+
 //------------------------------------------------------------------------------
 void Server::use_nitrous(player_id_t pid, bool enable)
 {
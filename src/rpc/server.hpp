@@ -18,8 +18,10 @@
 #ifndef HEADER_RPC_SERVER_HPP
 #define HEADER_RPC_SERVER_HPP
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <rpc/server.h>
 
@@ -50,9 +52,11 @@ public:
     static bool        game_running();
     static std::string hello(const std::string& echo);
     static player_id_t player_count();
+    static std::string profiler_trace();
     static void        set_firing(player_id_t pid, bool firing);
     static void        start_drifting(player_id_t pid, DriftDirection direction);
     static void        stop_drifting(player_id_t pid);
+    static std::map<std::string, std::vector<double> > tick_stats();
     static void        use_nitrous(player_id_t pid, bool enable);
 };
 
@@ -62,4 +66,7 @@ extern std::unique_ptr<Server> server;
 
 }
 
+// Allows the enum to be used as a parameter of bound functions
+MSGPACK_ADD_ENUM(rpc::Server::DriftDirection);
+
 #endif // HEADER_RPC_SERVER_HPP
@@ -75,10 +75,17 @@ namespace Scripting
         // Configure the script engine with all the functions, 
         // and variables that the script should be able to use.
         configureEngine(m_engine);
+
+        for (int i = 0; i < SH_COUNT; i++)
+            m_hooks[i] = NULL;
     }
 
     ScriptEngine::~ScriptEngine()
     {
+        for (asIScriptContext *ctx : m_context_pool)
+            ctx->Release();
+        m_context_pool.clear();
+
         // Release the engine
         m_pending_timeouts.clearAndDeleteAll();
         m_engine->DiscardModule(MODULE_ID_MAIN_SCRIPT_FILE);
@@ -291,72 +298,84 @@ namespace Scripting
 
     //-----------------------------------------------------------------------------
 
-    /** runs the specified script
-    *  \param string scriptName = name of script to run
-    */
-    void ScriptEngine::runFunction(bool warn_if_not_found, std::string function_name,
-        std::function<void(asIScriptContext*)> callback,
-        std::function<void(asIScriptContext*)> get_return_value)
+    /** Returns the script function with the specified declaration. The result
+     *  (including a function that does not exist) is cached until the next
+     *  call to cleanupCache.
+     *  \param declaration The declaration of the function, e.g.
+     *         "void onStart()".
+     *  \param warn_if_not_found Print a warning if the function does not
+     *         exist, otherwise only a debug message.
+     *  \return The function, or NULL if it does not exist.
+     */
+    asIScriptFunction* ScriptEngine::getFunction(const std::string &declaration,
+                                                 bool warn_if_not_found)
     {
-        int r; //int for error checking
-
-        asIScriptFunction *func;
-
-        // TODO: allow splitting in multiple files
-        std::string script_filename = "scripting.as";
-        auto cached_function = m_functions_cache.find(function_name);
-        if (cached_function == m_functions_cache.end())
+        auto cached_function = m_functions_cache.find(declaration);
+        if (cached_function != m_functions_cache.end())
         {
-            // Find the function for the function we want to execute.
-            //      This is how you call a normal function with arguments
-            //      asIScriptFunction *func = engine->GetModule(0)->GetFunctionByDecl("void func(arg1Type, arg2Type)");
-            asIScriptModule* module = m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE);
-
-            if (module == NULL)
-            {
-                if (warn_if_not_found)
-                    Log::warn("Scripting", "Scripting function was not found : %s (module not found)", function_name.c_str());
-                else
-                    Log::debug("Scripting", "Scripting function was not found : %s (module not found)", function_name.c_str());
-                m_functions_cache[function_name] = NULL; // remember that this function is unavailable
-                return;
-            }
+            // Script present in cache
+            if (cached_function->second == NULL && warn_if_not_found)
+                Log::warn("Scripting", "Scripting function was not found : %s", declaration.c_str());
+            return cached_function->second;
+        }
 
-            func = module->GetFunctionByDecl(function_name.c_str());
-            
-            if (func == NULL)
-            {
-                if (warn_if_not_found)
-                    Log::warn("Scripting", "Scripting function was not found : %s", function_name.c_str());
-                else
-                    Log::debug("Scripting", "Scripting function was not found : %s", function_name.c_str());
-                m_functions_cache[function_name] = NULL; // remember that this function is unavailable
-                return;
-            }
+        // Find the function for the function we want to execute.
+        //      This is how you call a normal function with arguments
+        //      asIScriptFunction *func = engine->GetModule(0)->GetFunctionByDecl("void func(arg1Type, arg2Type)");
+        asIScriptModule* module = m_engine->GetModule(MODULE_ID_MAIN_SCRIPT_FILE);
 
-            m_functions_cache[function_name] = func;
-            func->AddRef();
-        }
-        else
+        if (module == NULL)
         {
-            // Script present in cache
-            func = cached_function->second;
+            if (warn_if_not_found)
+                Log::warn("Scripting", "Scripting function was not found : %s (module not found)", declaration.c_str());
+            else
+                Log::debug("Scripting", "Scripting function was not found : %s (module not found)", declaration.c_str());
+            m_functions_cache[declaration] = NULL; // remember that this function is unavailable
+            return NULL;
         }
 
+        asIScriptFunction *func = module->GetFunctionByDecl(declaration.c_str());
+
         if (func == NULL)
         {
             if (warn_if_not_found)
-                Log::warn("Scripting", "Scripting function was not found : %s", function_name.c_str());
-            return; // function unavailable
+                Log::warn("Scripting", "Scripting function was not found : %s", declaration.c_str());
+            else
+                Log::debug("Scripting", "Scripting function was not found : %s", declaration.c_str());
+            m_functions_cache[declaration] = NULL; // remember that this function is unavailable
+            return NULL;
         }
 
-        // Create a context that will execute the script.
-        asIScriptContext *ctx = m_engine->CreateContext();
-        if (ctx == NULL)
+        m_functions_cache[declaration] = func;
+        func->AddRef();
+        return func;
+    }   // getFunction
+
+    //-----------------------------------------------------------------------------
+    /** Returns a context prepared to execute the specified function. The
+     *  arguments can then be set on the context before calling
+     *  executeContext, and the context must be given back with
+     *  releaseContext.
+     *  \return The context, or NULL if an error occurred.
+     */
+    asIScriptContext* ScriptEngine::prepareContext(asIScriptFunction *func)
+    {
+        // Reuse a context if possible, a script can call C++ code which
+        // runs another function, so more than one can be in use.
+        asIScriptContext *ctx;
+        if (m_context_pool.empty())
         {
-            Log::error("Scripting", "Failed to create the context.");
-            //m_engine->Release();
-            return;
+            ctx = m_engine->CreateContext();
+            if (ctx == NULL)
+            {
+                Log::error("Scripting", "Failed to create the context.");
+                return NULL;
+            }
+        }
+        else
+        {
+            ctx = m_context_pool.back();
+            m_context_pool.pop_back();
         }
 
         // Prepare the script context with the function we wish to execute. Prepare()
@@ -364,14 +383,77 @@ namespace Scripting
         // executed. Note, that if because we intend to execute the same function 
         // several times, we will store the function returned by 
         // GetFunctionByDecl(), so that this relatively slow call can be skipped.
-        r = ctx->Prepare(func);
+        int r = ctx->Prepare(func);
         if (r < 0)
         {
             Log::error("Scripting", "Failed to prepare the context.");
             ctx->Release();
-            //m_engine->Release();
-            return;
+            return NULL;
+        }
+        return ctx;
+    }   // prepareContext
+
+    //-----------------------------------------------------------------------------
+    /** Executes the function a context was prepared for, and reports any
+     *  error.
+     *  \return True if the function finished, i.e. its return value can be
+     *          read from the context.
+     */
+    bool ScriptEngine::executeContext(asIScriptContext *ctx)
+    {
+        int r = ctx->Execute();
+        if (r == asEXECUTION_FINISHED)
+            return true;
+
+        // The execution didn't finish as we had planned. Determine why.
+        if (r == asEXECUTION_ABORTED)
+        {
+            Log::error("Scripting", "The script was aborted before it could finish. Probably it timed out.");
         }
+        else if (r == asEXECUTION_EXCEPTION)
+        {
+            Log::error("Scripting", "The script ended with an exception.");
+
+            // Write some information about the script exception
+            //asIScriptFunction *func = ctx->GetExceptionFunction();
+            //std::cout << "func: " << func->GetDeclaration() << std::endl;
+            //std::cout << "modl: " << func->GetModuleName() << std::endl;
+            //std::cout << "sect: " << func->GetScriptSectionName() << std::endl;
+            //std::cout << "line: " << ctx->GetExceptionLineNumber() << std::endl;
+            //std::cout << "desc: " << ctx->GetExceptionString() << std::endl;
+        }
+        else
+        {
+            Log::error("Scripting", "The script ended for some unforeseen reason (%i)", r);
+        }
+        return false;
+    }   // executeContext
+
+    //-----------------------------------------------------------------------------
+    /** Gives a context obtained from prepareContext back to the pool. */
+    void ScriptEngine::releaseContext(asIScriptContext *ctx)
+    {
+        ctx->Unprepare();
+        m_context_pool.push_back(ctx);
+    }   // releaseContext
+
+    //-----------------------------------------------------------------------------
+
+    /** runs the specified script
+    *  \param string scriptName = name of script to run
+    */
+    void ScriptEngine::runFunction(bool warn_if_not_found, std::string function_name,
+        std::function<void(asIScriptContext*)> callback,
+        std::function<void(asIScriptContext*)> get_return_value)
+    {
+        // TODO: allow splitting in multiple files
+        asIScriptFunction *func = getFunction(function_name, warn_if_not_found);
+        if (func == NULL)
+            return; // function unavailable
+
+        asIScriptContext *ctx = prepareContext(func);
+        if (ctx == NULL)
+            return;
 
         // Here, we can pass parameters to the script functions. 
         //ctx->setArgType(index, value);
@@ -380,50 +462,20 @@ namespace Scripting
         if (callback)
             callback(ctx);
 
-        // Execute the function
-        r = ctx->Execute();
-        if (r != asEXECUTION_FINISHED)
-        {
-            // The execution didn't finish as we had planned. Determine why.
-            if (r == asEXECUTION_ABORTED)
-            {
-                Log::error("Scripting", "The script was aborted before it could finish. Probably it timed out.");
-            }
-            else if (r == asEXECUTION_EXCEPTION)
-            {
-                Log::error("Scripting", "The script ended with an exception.");
-
-                // Write some information about the script exception
-                //asIScriptFunction *func = ctx->GetExceptionFunction();
-                //std::cout << "func: " << func->GetDeclaration() << std::endl;
-                //std::cout << "modl: " << func->GetModuleName() << std::endl;
-                //std::cout << "sect: " << func->GetScriptSectionName() << std::endl;
-                //std::cout << "line: " << ctx->GetExceptionLineNumber() << std::endl;
-                //std::cout << "desc: " << ctx->GetExceptionString() << std::endl;
-            }
-            else
-            {
-                Log::error("Scripting", "The script ended for some unforeseen reason (%i)", r);
-            }
-        }
-        else
-        {
-            // Retrieve the return value from the context here (for scripts that return values)
-            // <type> returnValue = ctx->getReturnType(); for example
-            //float returnValue = ctx->GetReturnFloat();
-
-            if (get_return_value)
-                get_return_value(ctx);
-        }
+        // Execute the function. Retrieve the return value from the context
+        // here (for scripts that return values)
+        if (executeContext(ctx) && get_return_value)
+            get_return_value(ctx);
 
-        // We must release the contexts when no longer using them
-        ctx->Release();
+        releaseContext(ctx);
     }
 
     //-----------------------------------------------------------------------------
 
     void ScriptEngine::cleanupCache()
     {
+        for (int i = 0; i < SH_COUNT; i++)
+            m_hooks[i] = NULL;
         for (auto curr : m_functions_cache)
         {
             if (curr.second != NULL)
@@ -510,6 +562,14 @@ namespace Scripting
             return false;
         }
 
+        // Resolve all hooks now, they are called without any further lookup
+        const char* hook_declarations[SH_COUNT] =
+        {
+            "void onKartKartCollision(int, int)"
+        };
+        for (int i = 0; i < SH_COUNT; i++)
+            m_hooks[i] = getFunction(hook_declarations[i], false);
+
         // The engine doesn't keep a copy of the script sections after Build() has
         // returned. So if the script needs to be recompiled, then all the script
         // sections must be added again.
@@ -28,6 +28,7 @@
 #include <functional>
 #include <map>
 #include <string>
+#include <vector>
 
 class TrackObjectPresentation;
 
@@ -56,6 +57,16 @@ namespace Scripting
         ~PendingTimeout();
     };
 
+    /** Script functions with a fixed name that are called from C++ for
+     *  frequent events. They are resolved once after the scripts of a track
+     *  are compiled, so calling them needs no string building or lookup,
+     *  and a missing function costs nothing. */
+    enum ScriptHook
+    {
+        SH_KART_KART_COLLISION,   //!< void onKartKartCollision(int, int)
+        SH_COUNT
+    };
+
     class ScriptEngine : public AbstractSingleton<ScriptEngine>
     {
          ScriptEngine();
@@ -74,6 +85,11 @@ namespace Scripting
             std::function<void(asIScriptContext*)> callback,
             std::function<void(asIScriptContext*)> get_return_value);
         void runDelegate(asIScriptFunction* delegate_fn);
+        asIScriptFunction* getFunction(const std::string &declaration,
+                                       bool warn_if_not_found);
+        asIScriptContext* prepareContext(asIScriptFunction *func);
+        bool executeContext(asIScriptContext *ctx);
+        void releaseContext(asIScriptContext *ctx);
         void evalScript(std::string script_fragment);
         void cleanupCache();
 
@@ -85,12 +101,26 @@ namespace Scripting
         void update(float dt);
 
         asIScriptEngine* getEngine() { return m_engine; }
+        // --------------------------------------------------------------------
+        /** Returns the script function for a hook, or NULL if the scripts of
+         *  the current track do not define it. */
+        asIScriptFunction* getHook(ScriptHook hook) const
+        {
+            return m_hooks[hook];
+        }   // getHook
 
     private:
         asIScriptEngine *m_engine;
         std::map<std::string, asIScriptFunction*> m_functions_cache;
         PtrVector<PendingTimeout> m_pending_timeouts;
 
+        /** The resolved functions of all hooks (owned by the cache). */
+        asIScriptFunction* m_hooks[SH_COUNT];
+
+        /** Contexts that can be reused, to avoid creating a new one for
+         *  each call. */
+        std::vector<asIScriptContext*> m_context_pool;
+
         void configureEngine(asIScriptEngine *engine);
     };   // class ScriptEngine
 
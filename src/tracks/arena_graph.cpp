@@ -23,9 +23,11 @@
 #include "io/xml_node.hpp"
 #include "race/race_manager.hpp"
 #include "tracks/arena_node.hpp"
+#include "tracks/graph_cache.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
 #include "utils/log.hpp"
+#include "utils/time.hpp"
 
 #include <algorithm>
 #include <queue>
@@ -35,12 +37,26 @@ ArenaGraph::ArenaGraph(const std::string &navmesh, const XMLNode *node)
           : Graph()
 {
     loadNavmesh(navmesh);
-    buildGraph();
-    // Compute shortest distance from all nodes
-    for (unsigned int i = 0; i < getNumNodes(); i++)
-        computeDijkstra(i);
+    buildSectorGrid();
+
+    // The shortest paths only depend on the navmesh, so they are cached
+    GraphCache cache("arena", { navmesh });
+    if (!loadDerivedData(&cache))
+    {
+        const uint64_t start = StkTime::getMonoTimeMs();
+        buildGraph();
+        // Compute shortest distance from all nodes
+        runInParallel(getNumNodes(), [this](unsigned int i)
+            {
+                computeDijkstra(i);
+                setNearbyNodes(i);
+            });
+        Log::info("ArenaGraph", "Computed shortest paths of %d nodes in "
+                  "%d ms.", getNumNodes(),
+                  (int)(StkTime::getMonoTimeMs() - start));
+        saveDerivedData(&cache);
+    }
 
-    setNearbyNodesOfAllNodes();
     if (node && race_manager->getMinorMode() == RaceManager::MINOR_MODE_SOCCER)
         loadGoalNodes(node);
 
@@ -216,6 +232,9 @@ void ArenaGraph::buildGraph()
  *  source to j and m_parent_node[source][j] stores the last vertex visited on
  *  the shortest path from i to j before visiting j. Suppose the shortest path
  *  from i to j is i->......->k->j  then m_parent_node[i][j] = k
+ *  Only the row of 'source' is modified (the edge lengths are computed from
+ *  the node centers), so this can be called for different sources in
+ *  parallel.
  */
 void ArenaGraph::computeDijkstra(int source)
 {
@@ -251,8 +270,10 @@ void ArenaGraph::computeDijkstra(int source)
             // Distance already computed, can be ignored
             if (visited[adjacent]) continue;
 
-            float new_dist =
-                current.second + m_distance_matrix[cur_index][adjacent];
+            // Same edge length as set up in buildGraph
+            Vec3 diff = getNode(adjacent)->getCenter() -
+                        getNode(cur_index)->getCenter();
+            float new_dist = current.second + diff.length();
             if (new_dist < m_distance_matrix[source][adjacent])
             {
                 m_distance_matrix[source][adjacent] = new_dist;
@@ -332,31 +353,99 @@ void ArenaGraph::loadGoalNodes(const XMLNode *node)
 }   // loadGoalNodes
 
 // ----------------------------------------------------------------------------
-void ArenaGraph::setNearbyNodesOfAllNodes()
+/** Sets the nodes closest to node i, which requires that the shortest paths
+ *  from i are computed.
+ */
+void ArenaGraph::setNearbyNodes(unsigned int i)
 {
     // Only save the nearby 8 nodes
     const unsigned int try_count = 8;
-    for (unsigned int i = 0; i < getNumNodes(); i++)
+
+    // Get the distance to all nodes at i
+    ArenaNode* cur_node = getNode(i);
+    std::vector<int> nearby_nodes;
+    std::vector<float> dist = m_distance_matrix[i];
+
+    // Skip the same node
+    dist[i] = 999999.0f;
+    for (unsigned int j = 0; j < try_count; j++)
     {
-        // Get the distance to all nodes at i
-        ArenaNode* cur_node = getNode(i);
-        std::vector<int> nearby_nodes;
-        std::vector<float> dist = m_distance_matrix[i];
+        std::vector<float>::iterator it =
+            std::min_element(dist.begin(), dist.end());
+        const int pos = int(it - dist.begin());
+        nearby_nodes.push_back(pos);
+        dist[pos] = 999999.0f;
+    }
+    cur_node->setNearbyNodes(nearby_nodes);
+
+}   // setNearbyNodes
+
+// ----------------------------------------------------------------------------
+/** Reads the shortest paths and the nearby nodes of all nodes from the graph
+ *  cache. Nothing is modified if the cache can not be used.
+ *  \param cache The graph cache for the navmesh.
+ *  \return True if the data was loaded.
+ */
+bool ArenaGraph::loadDerivedData(GraphCache *cache)
+{
+    if (!cache->load())
+        return false;
 
-        // Skip the same node
-        dist[i] = 999999.0f;
-        for (unsigned int j = 0; j < try_count; j++)
+    const unsigned int n = getNumNodes();
+    uint32_t num_nodes;
+    if (!cache->read(&num_nodes) || num_nodes != n)
+        return false;
+    std::vector<std::vector<float> >   distance_matrix(n);
+    std::vector<std::vector<int16_t> > parent_node(n);
+    std::vector<std::vector<int> >     nearby_nodes(n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        if (!cache->readVector(&distance_matrix[i]) ||
+            distance_matrix[i].size() != n            ||
+            !cache->readVector(&parent_node[i])     ||
+            parent_node[i].size() != n                ||
+            !cache->readVector(&nearby_nodes[i]))
+            return false;
+        for (int16_t parent : parent_node[i])
+        {
+            if (parent < -1 || parent >= (int)n)
+                return false;
+        }
+        for (int node : nearby_nodes[i])
         {
-            std::vector<float>::iterator it =
-                std::min_element(dist.begin(), dist.end());
-            const int pos = int(it - dist.begin());
-            nearby_nodes.push_back(pos);
-            dist[pos] = 999999.0f;
+            if (node < 0 || node >= (int)n)
+                return false;
         }
-        cur_node->setNearbyNodes(nearby_nodes);
     }
+    if (!cache->isAtEnd())
+        return false;
+
+    m_distance_matrix.swap(distance_matrix);
+    m_parent_node.swap(parent_node);
+    for (unsigned int i = 0; i < n; i++)
+        getNode(i)->setNearbyNodes(nearby_nodes[i]);
+    Log::info("ArenaGraph", "Loaded shortest paths of %d nodes from the "
+              "graph cache.", n);
+    return true;
+}   // loadDerivedData
 
-}   // setNearbyNodesOfAllNodes
+// ----------------------------------------------------------------------------
+/** Writes the shortest paths and the nearby nodes of all nodes to the graph
+ *  cache.
+ *  \param cache The graph cache for the navmesh.
+ */
+void ArenaGraph::saveDerivedData(GraphCache *cache) const
+{
+    const unsigned int n = getNumNodes();
+    cache->write((uint32_t)n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        cache->writeVector(m_distance_matrix[i]);
+        cache->writeVector(m_parent_node[i]);
+        cache->writeVector(*getNode(i)->getNearbyNodes());
+    }
+    cache->save();
+}   // saveDerivedData
 
 // ----------------------------------------------------------------------------
 /** Determines the full path from 'from' to 'to' and returns it in a
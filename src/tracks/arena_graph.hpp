@@ -25,6 +25,7 @@
 #include <set>
 
 class ArenaNode;
+class GraphCache;
 class XMLNode;
 
 /**
@@ -52,12 +53,16 @@ private:
     // ------------------------------------------------------------------------
     void buildGraph();
     // ------------------------------------------------------------------------
-    void setNearbyNodesOfAllNodes();
+    void setNearbyNodes(unsigned int n);
     // ------------------------------------------------------------------------
     void computeDijkstra(int n);
     // ------------------------------------------------------------------------
     void computeFloydWarshall();
     // ------------------------------------------------------------------------
+    bool loadDerivedData(GraphCache *cache);
+    // ------------------------------------------------------------------------
+    void saveDerivedData(GraphCache *cache) const;
+    // ------------------------------------------------------------------------
     static std::vector<int16_t> getPathFromTo(int from, int to,
                      const std::vector< std::vector< int16_t > >& parent_node);
     // ------------------------------------------------------------------------
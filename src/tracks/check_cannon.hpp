@@ -73,6 +73,10 @@ public:
     // ------------------------------------------------------------------------
     virtual void update(float dt) OVERRIDE;
     // ------------------------------------------------------------------------
+    /** Cannons also test flyables, so they are never culled. */
+    virtual bool getBoundingBox(Vec3 *min, Vec3 *max) const OVERRIDE
+                                                            { return false; }
+    // ------------------------------------------------------------------------
     virtual bool triggeringCheckline() const OVERRIDE         { return false; }
     // ------------------------------------------------------------------------
     /** Adds a flyable to be tested for crossing a cannon checkline.
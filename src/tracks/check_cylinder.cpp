@@ -80,3 +80,15 @@ bool CheckCylinder::isTriggered(const Vec3 &old_pos, const Vec3 &new_pos,
 
     return triggered;
 }   // isTriggered
+
+// ----------------------------------------------------------------------------
+/** The cylinder has no height limit, so only the X and Z values of the
+ *  bounding box are meaningful.
+ */
+bool CheckCylinder::getBoundingBox(Vec3 *min, Vec3 *max) const
+{
+    const float radius = sqrtf(m_radius2);
+    *min = m_center_point - Vec3(radius, 0, radius);
+    *max = m_center_point + Vec3(radius, 0, radius);
+    return true;
+}   // getBoundingBox
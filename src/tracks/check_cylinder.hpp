@@ -55,8 +55,10 @@ public:
     virtual     ~CheckCylinder() {};
     virtual bool isTriggered(const Vec3 &old_pos, const Vec3 &new_pos,
                              int kart_id);
+    virtual bool getBoundingBox(Vec3 *min, Vec3 *max) const;
     // ------------------------------------------------------------------------
-    /** Returns if kart indx is currently inside of the sphere. */
+    /** Returns if kart indx is currently inside of the sphere. Only up to
+     *  date for karts close enough to be tested by the CheckManager. */
     bool isInside(int index) const            { return m_is_inside[index]; }
     // -------------------------------------------------------------------------
     /** Returns the squared distance of kart index from the enter of
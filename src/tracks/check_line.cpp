@@ -133,6 +133,37 @@ void CheckLine::resetAfterKartMove(unsigned int kart_index)
     m_previous_position[kart_index] = kart->getXYZ();
 }   // resetAfterKartMove
 
+// ----------------------------------------------------------------------------
+/** Updates the previous position and side of the line of a kart for
+ *  which this line was not tested in the previous time steps. If the kart
+ *  was moved, resetAfterKartMove has already set the previous position.
+ */
+void CheckLine::catchUp(unsigned int kart_index, const Vec3 &xyz,
+                        bool kart_moved)
+{
+    if (!kart_moved)
+        CheckStructure::catchUp(kart_index, xyz, kart_moved);
+    // The sign is only updated in isTriggered, i.e. while this line is active
+    if (m_is_active[kart_index])
+    {
+        core::vector2df p = xyz.toIrrVector2d();
+        m_previous_sign[kart_index] = m_line.getPointOrientation(p) >= 0;
+    }
+}   // catchUp
+
+// ----------------------------------------------------------------------------
+/** A line can only be triggered by a movement that crosses it, so its
+ *  bounding box is spanned by its two end points.
+ */
+bool CheckLine::getBoundingBox(Vec3 *min, Vec3 *max) const
+{
+    *min = m_left_point;
+    min->min(m_right_point);
+    *max = m_left_point;
+    max->max(m_right_point);
+    return true;
+}   // getBoundingBox
+
 // ----------------------------------------------------------------------------
 void CheckLine::changeDebugColor(bool is_active)
 {
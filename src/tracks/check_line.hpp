@@ -89,6 +89,9 @@ public:
                              int indx) OVERRIDE;
     virtual void reset(const Track &track) OVERRIDE;
     virtual void resetAfterKartMove(unsigned int kart_index) OVERRIDE;
+    virtual void catchUp(unsigned int kart_index, const Vec3 &xyz,
+                         bool kart_moved) OVERRIDE;
+    virtual bool getBoundingBox(Vec3 *min, Vec3 *max) const OVERRIDE;
     virtual void resetAfterRewind(unsigned int kart_index) OVERRIDE
                                             { resetAfterKartMove(kart_index); }
     virtual void changeDebugColor(bool is_active) OVERRIDE;
@@ -33,8 +33,20 @@
 #include "tracks/drive_graph.hpp"
 #include "utils/log.hpp"
 
+#include <cmath>
+
 CheckManager *CheckManager::m_check_manager = NULL;
 
+/** Size of a cell of the grid used to find the check structures close to
+ *  a kart (the grid uses larger cells on very big tracks). */
+static const float CHECK_GRID_CELL_SIZE = 20.0f;
+/** Maximum number of cells of the grid in X and Z direction. */
+static const int   CHECK_GRID_MAX_CELLS = 256;
+/** Distance by which the area covered by a kart is extended. It must be at
+ *  least the distance between the front of a kart (used for most tests)
+ *  and its center (used by CheckTrigger). */
+static const float CHECK_CULL_MARGIN    = 5.0f;
+
 /** Loads all check structure informaiton from the specified xml file.
  */
 void CheckManager::load(const XMLNode &node)
@@ -106,7 +118,9 @@ CheckManager::~CheckManager()
     {
         delete m_all_checks[i];
     }
-    m_check_manager = NULL;
+    // The unit test uses a local instance
+    if (m_check_manager == this)
+        m_check_manager = NULL;
 }   // ~CheckManager
 
 // ----------------------------------------------------------------------------
@@ -114,9 +128,22 @@ CheckManager::~CheckManager()
 /** Resets all checks. */
 void CheckManager::reset(const Track &track)
 {
+    m_last_xyz.clear();
+    m_update_count.clear();
+    m_kart_moved.clear();
+    World *world = World::getWorld();
+    for (unsigned int i = 0; i < world->getNumKarts(); i++)
+    {
+        // Same as the previous position set in CheckStructure::reset
+        m_last_xyz.push_back(world->getKart(i)->getXYZ());
+        m_update_count.push_back(0);
+        m_kart_moved.push_back(false);
+    }
+
     std::vector<CheckStructure*>::iterator i;
     for(i=m_all_checks.begin(); i!=m_all_checks.end(); i++)
         (*i)->reset(track);
+    m_index_dirty = true;
 }   // reset
 
 // ----------------------------------------------------------------------------
@@ -130,6 +157,8 @@ void CheckManager::resetAfterKartMove(AbstractKart *kart)
     std::vector<CheckStructure*>::iterator i;
     for (i = m_all_checks.begin(); i != m_all_checks.end(); i++)
         (*i)->resetAfterKartMove(kart->getWorldKartId());
+    if (kart->getWorldKartId() < m_kart_moved.size())
+        m_kart_moved[kart->getWorldKartId()] = true;
 }   // resetAfterKartMove
 
 // ----------------------------------------------------------------------------
@@ -141,8 +170,19 @@ void CheckManager::resetAfterRewind()
     World* w = World::getWorld();
     for (unsigned i = 0; i < w->getNumKarts(); i++)
     {
+        const unsigned int kart_id = w->getKart(i)->getWorldKartId();
+        // The data of all check structures is now considered current, so
+        // structures culled before the rewind are not updated again
         for (unsigned j = 0; j < m_all_checks.size(); j++)
-            m_all_checks[j]->resetAfterRewind(w->getKart(i)->getWorldKartId());
+        {
+            m_all_checks[j]->resetAfterRewind(kart_id);
+            m_all_checks[j]->setUpToDate(kart_id);
+        }
+        if (kart_id < m_last_xyz.size())
+        {
+            m_last_xyz[kart_id] = w->getKart(i)->getXYZ();
+            m_kart_moved[kart_id] = false;
+        }
     }
 }   // resetAfterRewind
 
@@ -178,16 +218,195 @@ void CheckManager::removeFlyableFromCannons(Flyable *flyable)
 }   // addFlyable
 
 // ----------------------------------------------------------------------------
-/** Updates all animations. Called one per time step.
+/** Sorts all check structures with a bounding box into a uniform grid, so
+ *  that each kart only needs to test the structures close to it.
+ */
+void CheckManager::buildIndex()
+{
+    m_always_update.resize(m_all_checks.size());
+    m_all_boxes.clear();
+    for (unsigned int i = 0; i < m_all_checks.size(); i++)
+    {
+        Vec3 min, max;
+        m_always_update[i] = !m_all_checks[i]->getBoundingBox(&min, &max);
+        if (m_always_update[i])
+            continue;
+        CheckBox box;
+        box.m_min_x = min.getX();
+        box.m_min_z = min.getZ();
+        box.m_max_x = max.getX();
+        box.m_max_z = max.getZ();
+        box.m_index = i;
+        m_all_boxes.push_back(box);
+    }
+    buildGrid();
+    m_index_dirty = false;
+}   // buildIndex
+
+// ----------------------------------------------------------------------------
+/** Creates the grid from the boxes in m_all_boxes.
+ */
+void CheckManager::buildGrid()
+{
+    m_grid.clear();
+    m_grid_nx = m_grid_nz = 0;
+    if (m_all_boxes.empty())
+        return;
+
+    float max_x = m_all_boxes[0].m_max_x, max_z = m_all_boxes[0].m_max_z;
+    m_grid_min_x = m_all_boxes[0].m_min_x;
+    m_grid_min_z = m_all_boxes[0].m_min_z;
+    for (const CheckBox &box : m_all_boxes)
+    {
+        m_grid_min_x = std::min(m_grid_min_x, box.m_min_x);
+        m_grid_min_z = std::min(m_grid_min_z, box.m_min_z);
+        max_x        = std::max(max_x,        box.m_max_x);
+        max_z        = std::max(max_z,        box.m_max_z);
+    }
+    m_cell_size = std::max(CHECK_GRID_CELL_SIZE,
+                           std::max(max_x - m_grid_min_x,
+                                    max_z - m_grid_min_z)
+                           / CHECK_GRID_MAX_CELLS);
+    m_grid_nx = (int)((max_x - m_grid_min_x) / m_cell_size) + 1;
+    m_grid_nz = (int)((max_z - m_grid_min_z) / m_cell_size) + 1;
+    m_grid.resize(m_grid_nx * m_grid_nz);
+
+    for (unsigned int i = 0; i < m_all_boxes.size(); i++)
+    {
+        const CheckBox &box = m_all_boxes[i];
+        int x0 = (int)((box.m_min_x - m_grid_min_x) / m_cell_size);
+        int x1 = std::min((int)((box.m_max_x - m_grid_min_x) / m_cell_size),
+                          m_grid_nx - 1);
+        int z0 = (int)((box.m_min_z - m_grid_min_z) / m_cell_size);
+        int z1 = std::min((int)((box.m_max_z - m_grid_min_z) / m_cell_size),
+                          m_grid_nz - 1);
+        for (int z = z0; z <= z1; z++)
+        {
+            for (int x = x0; x <= x1; x++)
+                m_grid[z * m_grid_nx + x].push_back(i);
+        }
+    }
+}   // buildGrid
+
+// ----------------------------------------------------------------------------
+/** Finds all boxes overlapping the specified rectangle in the XZ plane.
+ *  Each box is reported once.
+ *  \param result On return the indices (in m_all_boxes) of all boxes found.
+ */
+void CheckManager::findCandidates(float min_x, float min_z,
+                                  float max_x, float max_z,
+                                  std::vector<unsigned int> *result) const
+{
+    result->clear();
+    if (m_grid.empty())
+        return;
+
+    // Cells are computed with floor, so that a rectangle outside of the
+    // grid results in an empty range after clamping.
+    int x0 = std::max((int)floorf((min_x - m_grid_min_x) / m_cell_size), 0);
+    int x1 = std::min((int)floorf((max_x - m_grid_min_x) / m_cell_size),
+                      m_grid_nx - 1);
+    int z0 = std::max((int)floorf((min_z - m_grid_min_z) / m_cell_size), 0);
+    int z1 = std::min((int)floorf((max_z - m_grid_min_z) / m_cell_size),
+                      m_grid_nz - 1);
+    for (int z = z0; z <= z1; z++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            for (unsigned int i : m_grid[z * m_grid_nx + x])
+            {
+                const CheckBox &box = m_all_boxes[i];
+                if (box.m_min_x > max_x || box.m_max_x < min_x ||
+                    box.m_min_z > max_z || box.m_max_z < min_z)
+                    continue;
+                // A box spanning several cells is only reported from the
+                // first cell in which it overlaps the rectangle.
+                int bx = (int)((box.m_min_x - m_grid_min_x) / m_cell_size);
+                int bz = (int)((box.m_min_z - m_grid_min_z) / m_cell_size);
+                if (x == std::max(x0, bx) && z == std::max(z0, bz))
+                    result->push_back(i);
+            }
+        }
+    }
+}   // findCandidates
+
+// ----------------------------------------------------------------------------
+/** Updates all check structures. Called one per time step. Structures with
+ *  a bounding box are only tested for karts whose movement in this time
+ *  step came close to that box: no other kart can trigger it. The
+ *  structures are tested in the same order as if all were tested, and a
+ *  structure that was skipped for a kart updates its data for that kart
+ *  before it is tested again (see CheckStructure::syncKart).
  *  \param dt Time since last call.
  */
 void CheckManager::update(float dt)
 {
-    std::vector<CheckStructure*>::iterator i;
-    for(i=m_all_checks.begin(); i!=m_all_checks.end(); i++)
-        (*i)->update(dt);
+    World *world = World::getWorld();
+    m_tested_karts.clear();
+    m_kart_xyz.resize(world->getNumKarts());
+    for (unsigned int k = 0; k < world->getNumKarts(); k++)
+    {
+        const AbstractKart *kart = world->getKart(k);
+        if (kart->getKartAnimation())
+            continue;
+        m_tested_karts.push_back(k);
+        m_kart_xyz[k] = kart->getFrontXYZ();
+    }
+    updateKarts(dt);
+
+    // A triggered structure can move a kart, so store its current position
+    for (unsigned int k : m_tested_karts)
+        m_last_xyz[k] = world->getKart(k)->getFrontXYZ();
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Tests the karts in m_tested_karts (at their positions in m_kart_xyz)
+ *  against the check structures close to them, see update().
+ *  \param dt Time since last call.
+ */
+void CheckManager::updateKarts(float dt)
+{
+    if (m_index_dirty)
+        buildIndex();
+
+    m_pending.clear();
+    for (unsigned int k : m_tested_karts)
+    {
+        m_update_count[k]++;
+        const Vec3 &xyz  = m_kart_xyz[k];
+        const Vec3 &last = m_last_xyz[k];
+        findCandidates(std::min(last.getX(), xyz.getX()) - CHECK_CULL_MARGIN,
+                       std::min(last.getZ(), xyz.getZ()) - CHECK_CULL_MARGIN,
+                       std::max(last.getX(), xyz.getX()) + CHECK_CULL_MARGIN,
+                       std::max(last.getZ(), xyz.getZ()) + CHECK_CULL_MARGIN,
+                       &m_candidates);
+        for (unsigned int c : m_candidates)
+            m_pending.push_back(((uint64_t)m_all_boxes[c].m_index << 32) | k);
+    }
+    std::sort(m_pending.begin(), m_pending.end());
+
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < m_all_checks.size(); i++)
+    {
+        if (m_always_update[i])
+        {
+            m_all_checks[i]->update(dt);
+            continue;
+        }
+        for (; next < m_pending.size() && (m_pending[next] >> 32) == i; next++)
+        {
+            const unsigned int k = (unsigned int)m_pending[next];
+            m_all_checks[i]->updateKart(k, m_kart_xyz[k]);
+        }
+    }
+
+    for (unsigned int k : m_tested_karts)
+    {
+        m_last_xyz[k]   = m_kart_xyz[k];
+        m_kart_moved[k] = false;
+    }
+}   // updateKarts
+
 // ----------------------------------------------------------------------------
 /** Returns the index of the first check structures that triggers a new
  *  lap to be counted. It aborts if no lap structure is defined.
@@ -234,3 +453,213 @@ int CheckManager::getChecklineTriggering(const Vec3 &from,
     }
     return -1;
 }   // getChecklineTriggering
+
+// ----------------------------------------------------------------------------
+namespace
+{
+    /** A check line used by the unit test: it is parallel to the Z axis at
+     *  m_x from m_min_z to m_max_z, it is triggered when a kart crosses it
+     *  in positive X direction, and it only logs the triggers. */
+    class TestCheckLine : public CheckStructure
+    {
+    private:
+        float m_x, m_min_z, m_max_z;
+        std::vector<std::pair<int, unsigned int> > *m_log;
+    public:
+        TestCheckLine(unsigned int index, float x, float min_z, float max_z,
+                      const std::vector<Vec3> &start,
+                      std::vector<std::pair<int, unsigned int> > *log)
+            : CheckStructure(index), m_x(x), m_min_z(min_z),
+              m_max_z(max_z), m_log(log)
+        {
+            for (const Vec3 &xyz : start)
+            {
+                m_previous_position.push_back(xyz);
+                m_is_active.push_back(true);
+                m_last_update.push_back(0);
+            }
+        }   // TestCheckLine
+        // --------------------------------------------------------------------
+        virtual bool isTriggered(const Vec3 &old_pos, const Vec3 &new_pos,
+                                 int indx) OVERRIDE
+        {
+            if (old_pos.getX() >= m_x || new_pos.getX() < m_x)
+                return false;
+            const float t = (m_x - old_pos.getX()) /
+                            (new_pos.getX() - old_pos.getX());
+            const float z = old_pos.getZ() +
+                            t * (new_pos.getZ() - old_pos.getZ());
+            return z >= m_min_z && z <= m_max_z;
+        }   // isTriggered
+        // --------------------------------------------------------------------
+        virtual void trigger(unsigned int kart_index) OVERRIDE
+        {
+            m_log->push_back(std::make_pair(getIndex(), kart_index));
+        }   // trigger
+        // --------------------------------------------------------------------
+        virtual bool getBoundingBox(Vec3 *min, Vec3 *max) const OVERRIDE
+        {
+            *min = Vec3(m_x, 0, m_min_z);
+            *max = Vec3(m_x, 0, m_max_z);
+            return true;
+        }   // getBoundingBox
+    };   // TestCheckLine
+
+    // ------------------------------------------------------------------------
+    /** Returns the front position of a kart of the unit test at a time step.
+     *  \param kart Index of the kart.
+     *  \param step The time step.
+     */
+    Vec3 getTestKartXYZ(unsigned int kart, unsigned int step)
+    {
+        const float s = (float)step;
+        switch (kart)
+        {
+        case 0:   // Back and forth along the X axis
+            return Vec3(fmodf(s * 1.3f, 500.0f) - 250.0f, 0, 0.5f);
+        case 1:   // A circle around the origin
+            return Vec3(150.0f * cosf(s * 0.01f), 0,
+                        150.0f * sinf(s * 0.01f));
+        case 2:   // Zig-zag across the lines close to the origin
+            return Vec3(30.0f * sinf(s * 0.05f), 0, 3.0f * cosf(s * 0.11f));
+        default:
+            break;
+        }
+        // A kart that is far away from all lines for a long time, and then
+        // comes back from the other side of a line. If the line did not
+        // catch up with the skipped time steps, it would use the position
+        // before the kart left (on the other side) and trigger.
+        if (step <  50) return Vec3(-50.0f, 0, s * 6.0f);
+        if (step < 100) return Vec3(-50.0f + (s - 50.0f) * 1.4f, 0, 300.0f);
+        if (step < 150) return Vec3(20.0f, 0, 300.0f - (s - 100.0f) * 6.0f);
+        if (step < 160) return Vec3(20.0f - (s - 150.0f) * 1.5f, 0, 0);
+        // Jump far away, then jump back close to a line
+        if (step < 200) return Vec3(-190.0f, 0, 300.0f);
+        if (step == 200) return Vec3(5.0f, 0, 0);
+        return Vec3(5.0f - (float)((step / 20) % 2) * 15.0f, 0, 0);
+    }   // getTestKartXYZ
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Tests the grid used for culling against a brute force search on a
+ *  synthetic track with a large number of check structures. Then karts
+ *  are driven across check lines, and the triggers must be the same as
+ *  if all check lines were tested for all karts in each time step.
+ */
+void CheckManager::unitTesting()
+{
+    CheckManager cm;
+    // A ring shaped track with a radius of 400, and 12 m wide checklines
+    // every 2 degrees, plus a small sphere in between each pair.
+    const float pi = 3.14159265f;
+    for (unsigned int i = 0; i < 360; i++)
+    {
+        const float angle = i * pi / 180.0f;
+        const float c = cosf(angle), s = sinf(angle);
+        CheckBox box;
+        if (i % 2 == 0)
+        {
+            box.m_min_x = std::min(394.0f * c, 406.0f * c);
+            box.m_max_x = std::max(394.0f * c, 406.0f * c);
+            box.m_min_z = std::min(394.0f * s, 406.0f * s);
+            box.m_max_z = std::max(394.0f * s, 406.0f * s);
+        }
+        else
+        {
+            box.m_min_x = 400.0f * c - 2.0f;
+            box.m_max_x = 400.0f * c + 2.0f;
+            box.m_min_z = 400.0f * s - 2.0f;
+            box.m_max_z = 400.0f * s + 2.0f;
+        }
+        box.m_index = i;
+        cm.m_all_boxes.push_back(box);
+    }
+    cm.buildGrid();
+
+    // Kart movements along the track, and a few long jumps across it
+    std::vector<float> queries;
+    for (unsigned int i = 0; i < 2000; i++)
+    {
+        const float a0 = (i * 0.37f) * pi / 180.0f;
+        const float step = (i % 100 == 0) ? 2.0f : 0.01f;
+        const float r = 390.0f + (i % 21);
+        const float x0 = r * cosf(a0),        z0 = r * sinf(a0);
+        const float x1 = r * cosf(a0 + step), z1 = r * sinf(a0 + step);
+        queries.push_back(std::min(x0, x1) - CHECK_CULL_MARGIN);
+        queries.push_back(std::min(z0, z1) - CHECK_CULL_MARGIN);
+        queries.push_back(std::max(x0, x1) + CHECK_CULL_MARGIN);
+        queries.push_back(std::max(z0, z1) + CHECK_CULL_MARGIN);
+    }
+
+    std::vector<unsigned int> found, expected;
+    for (unsigned int q = 0; q < queries.size(); q += 4)
+    {
+        cm.findCandidates(queries[q], queries[q+1], queries[q+2],
+                          queries[q+3], &found);
+        std::sort(found.begin(), found.end());
+        expected.clear();
+        for (unsigned int i = 0; i < cm.m_all_boxes.size(); i++)
+        {
+            const CheckBox &box = cm.m_all_boxes[i];
+            if (box.m_min_x <= queries[q+2] && box.m_max_x >= queries[q] &&
+                box.m_min_z <= queries[q+3] && box.m_max_z >= queries[q+1])
+                expected.push_back(i);
+        }
+        assert(found == expected);
+    }
+    cm.findCandidates(1000.0f, 1000.0f, 1010.0f, 1010.0f, &found);
+    assert(found.empty());
+
+    // Check lines every 10 units along the X axis, half of them crossing
+    // the X axis, half of them far away from it
+    const unsigned int num_karts = 4, num_lines = 40, num_steps = 1000;
+    CheckManager culled;
+    CheckManager *previous_manager = m_check_manager;
+    m_check_manager = &culled;
+    std::vector<Vec3> start;
+    for (unsigned int k = 0; k < num_karts; k++)
+    {
+        start.push_back(getTestKartXYZ(k, 0));
+        culled.m_last_xyz.push_back(start.back());
+        culled.m_update_count.push_back(0);
+        culled.m_kart_moved.push_back(false);
+        culled.m_tested_karts.push_back(k);
+    }
+    culled.m_kart_xyz.resize(num_karts);
+    std::vector<std::pair<int, unsigned int> > culled_log, all_log;
+    std::vector<TestCheckLine*> all_lines;
+    for (unsigned int i = 0; i < num_lines; i++)
+    {
+        const float x     = -200.0f + 10.0f * i;
+        const float min_z = (i % 2 == 0) ? -6.0f : 100.0f;
+        culled.add(new TestCheckLine(i, x, min_z, min_z + 12.0f, start,
+                                     &culled_log));
+        all_lines.push_back(new TestCheckLine(i, x, min_z, min_z + 12.0f,
+                                              start, &all_log));
+    }
+
+    unsigned int num_tests = 0;
+    for (unsigned int step = 1; step < num_steps; step++)
+    {
+        for (unsigned int k = 0; k < num_karts; k++)
+            culled.m_kart_xyz[k] = getTestKartXYZ(k, step);
+        culled.updateKarts(1.0f / 120.0f);
+        num_tests += (unsigned int)culled.m_pending.size();
+
+        // Test all lines for all karts, in the same order
+        for (unsigned int i = 0; i < num_lines; i++)
+        {
+            for (unsigned int k = 0; k < num_karts; k++)
+                all_lines[i]->updateKart(k, culled.m_kart_xyz[k]);
+        }
+        assert(culled_log == all_log);
+    }
+    // Make sure that the test does something
+    assert(all_log.size() > 20);
+    assert(num_tests < num_karts * num_lines * num_steps / 4);
+    (void)num_tests;
+
+    for (TestCheckLine *line : all_lines)
+        delete line;
+    m_check_manager = previous_manager;
+}   // unitTesting
@@ -19,7 +19,10 @@
 #ifndef HEADER_CHECK_MANAGER_HPP
 #define HEADER_CHECK_MANAGER_HPP
 
+#include "utils/aligned_array.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+#include "utils/vec3.hpp"
 
 #include <assert.h>
 #include <string>
@@ -30,7 +33,6 @@ class CheckStructure;
 class Flyable;
 class Track;
 class XMLNode;
-class Vec3;
 
 /**
   * \brief Controls all checks structures of a track.
@@ -39,14 +41,76 @@ class Vec3;
 class CheckManager : public NoCopy
 {
 private:
+    /** Bounding box in the XZ plane of a check structure that is only
+     *  tested for karts close to it. */
+    struct CheckBox
+    {
+        float        m_min_x, m_min_z, m_max_x, m_max_z;
+        unsigned int m_index;
+    };   // CheckBox
+
     std::vector<CheckStructure*> m_all_checks;
     static CheckManager         *m_check_manager;
+
+    /** True for each check structure that has no bounding box, and is
+     *  therefore tested for all karts in every time step. */
+    std::vector<bool>            m_always_update;
+
+    /** The bounding boxes of all other check structures. */
+    std::vector<CheckBox>        m_all_boxes;
+
+    /** A uniform grid in the XZ plane over all boxes, storing for each cell
+     *  the indices (in m_all_boxes) of all boxes overlapping it. */
+    std::vector<std::vector<unsigned int> > m_grid;
+
+    /** Minimum corner, cell size and number of cells of the grid. */
+    float                        m_grid_min_x, m_grid_min_z, m_cell_size;
+    int                          m_grid_nx, m_grid_nz;
+
+    /** Set when a check structure is added, so the grid is rebuilt at the
+     *  next update. */
+    bool                         m_index_dirty;
+
+    /** For each kart its front position in its previous time step. */
+    AlignedArray<Vec3>           m_last_xyz;
+
+    /** For each kart the number of time steps in which it was tested
+     *  (karts with an animation are not tested). */
+    std::vector<unsigned int>    m_update_count;
+
+    /** For each kart if it was moved (resetAfterKartMove) since its
+     *  previous time step. */
+    std::vector<bool>            m_kart_moved;
+
+    /** The (check structure index, kart index) pairs to test in the current
+     *  time step, sorted so that the original testing order is kept. */
+    std::vector<uint64_t>        m_pending;
+
+    /** The karts tested in the current time step. */
+    std::vector<unsigned int>    m_tested_karts;
+
+    /** For each kart its front position in the current time step (only
+     *  set for the karts in m_tested_karts). */
+    AlignedArray<Vec3>           m_kart_xyz;
+
+    /** Temporary storage for the results of findCandidates. */
+    std::vector<unsigned int>    m_candidates;
+
            /** Private constructor, to make sure it is only called via
             *  the static create function. */
-           CheckManager()       {m_all_checks.clear();};
+           CheckManager() : m_index_dirty(true) {m_all_checks.clear();};
           ~CheckManager();
+    void   buildIndex();
+    void   buildGrid();
+    void   findCandidates(float min_x, float min_z, float max_x, float max_z,
+                          std::vector<unsigned int> *result) const;
+    void   updateKarts(float dt);
 public:
-    void   add(CheckStructure* strct) { m_all_checks.push_back(strct); }
+    void   add(CheckStructure* strct)
+    {
+        m_all_checks.push_back(strct);
+        m_index_dirty = true;
+    }   // add
     void   addFlyableToCannons(Flyable *flyable);
     void   removeFlyableFromCannons(Flyable *flyable);
     void   load(const XMLNode &node);
@@ -56,6 +120,7 @@ public:
     void   resetAfterRewind();
     unsigned int getLapLineIndex() const;
     int    getChecklineTriggering(const Vec3 &from, const Vec3 &to) const;
+    static void unitTesting();
     // ------------------------------------------------------------------------
     /** Creates an instance of the check manager. */
     static void create()
@@ -79,6 +144,28 @@ public:
         assert(n < m_all_checks.size());
         return m_all_checks[n];
     }
+    // ------------------------------------------------------------------------
+    /** Returns the number of time steps in which the specified kart was
+     *  tested against the check structures. */
+    unsigned int getUpdateCount(unsigned int kart_index) const
+    {
+        return kart_index < m_update_count.size()
+             ? m_update_count[kart_index] : 0;
+    }   // getUpdateCount
+    // ------------------------------------------------------------------------
+    /** Returns the front position of a kart in its previous time step. */
+    const Vec3 &getLastXYZ(unsigned int kart_index) const
+    {
+        assert(kart_index < m_last_xyz.size());
+        return m_last_xyz[kart_index];
+    }   // getLastXYZ
+    // ------------------------------------------------------------------------
+    /** Returns if the kart was moved since its previous time step. */
+    bool hasKartMoved(unsigned int kart_index) const
+    {
+        assert(kart_index < m_kart_moved.size());
+        return m_kart_moved[kart_index];
+    }   // hasKartMoved
 };   // CheckManager
 
 #endif
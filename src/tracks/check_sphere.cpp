@@ -71,3 +71,12 @@ bool CheckSphere::isTriggered(const Vec3 &old_pos, const Vec3 &new_pos,
     return (old_dist2>=m_radius2 && new_dist2 < m_radius2) ||
            (old_dist2< m_radius2 && new_dist2 >=m_radius2);
 }   // isTriggered
+
+// ----------------------------------------------------------------------------
+bool CheckSphere::getBoundingBox(Vec3 *min, Vec3 *max) const
+{
+    const float radius = sqrtf(m_radius2);
+    *min = m_center_point - Vec3(radius, radius, radius);
+    *max = m_center_point + Vec3(radius, radius, radius);
+    return true;
+}   // getBoundingBox
@@ -82,6 +82,7 @@ void CheckStructure::reset(const Track &track)
 {
     m_previous_position.clear();
     m_is_active.clear();
+    m_last_update.clear();
 
     World *world = World::getWorld();
     for(unsigned int i=0; i<world->getNumKarts(); i++)
@@ -91,37 +92,99 @@ void CheckStructure::reset(const Track &track)
 
         // Activate all checkline
         m_is_active.push_back(m_active_at_reset);
+        m_last_update.push_back(0);
     }   // for i<getNumKarts
 }   // reset
 
 // ----------------------------------------------------------------------------
-/** Updates all check structures. Called one per time step.
+/** Updates this check structure for all karts. Called one per time step
+ *  for structures that are not spatially culled by the CheckManager.
  *  \param dt Time since last call.
  */
 void CheckStructure::update(float dt)
 {
     World *world = World::getWorld();
-    LinearWorld* lw = dynamic_cast<LinearWorld*>(World::getWorld());
     for(unsigned int i=0; i<world->getNumKarts(); i++)
     {
-        const Vec3 &xyz = world->getKart(i)->getFrontXYZ();
-        if(world->getKart(i)->getKartAnimation()) continue;
-        // Only check active checklines.
-        if(m_is_active[i] && isTriggered(m_previous_position[i], xyz, i))
-        {
-            if(UserConfigParams::m_check_debug)
-                Log::info("CheckStructure",
-                          "Check structure %d triggered for kart %s at %f.",
-                          m_index, world->getKart(i)->getIdent().c_str(),
-                          World::getWorld()->getTime());
-            trigger(i);
-            if (triggeringCheckline() && lw)
-                lw->updateCheckLinesServer(getIndex(), i);
-        }
-        m_previous_position[i] = xyz;
-    }   // for i<getNumKarts
+        const AbstractKart *kart = world->getKart(i);
+        if (!kart->getKartAnimation())
+            updateKart(i, kart->getFrontXYZ());
+    }
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Tests if the specified kart triggers this check structure in this time
+ *  step, and triggers it if so.
+ *  \param kart_index Index of the kart to test.
+ *  \param xyz Front position of the kart in this time step.
+ */
+void CheckStructure::updateKart(unsigned int kart_index, const Vec3 &xyz)
+{
+    syncKart(kart_index);
+    // Only check active checklines.
+    if(m_is_active[kart_index] &&
+       isTriggered(m_previous_position[kart_index], xyz, kart_index))
+    {
+        World *world = World::getWorld();
+        if(UserConfigParams::m_check_debug)
+            Log::info("CheckStructure",
+                      "Check structure %d triggered for kart %s at %f.",
+                      m_index, world->getKart(kart_index)->getIdent().c_str(),
+                      world->getTime());
+        trigger(kart_index);
+        LinearWorld* lw = dynamic_cast<LinearWorld*>(world);
+        if (triggeringCheckline() && lw)
+            lw->updateCheckLinesServer(getIndex(), kart_index);
+    }
+    m_previous_position[kart_index] = xyz;
+    m_last_update[kart_index] =
+        CheckManager::get()->getUpdateCount(kart_index);
+}   // updateKart
+
+// ----------------------------------------------------------------------------
+/** Brings the data of a kart up to date if this structure was skipped for
+ *  this kart in previous time steps (because the kart was too far away to
+ *  trigger it). The data is set as if this structure had been updated at
+ *  the previous time step of the kart.
+ *  \param kart_index Index of the kart.
+ */
+void CheckStructure::syncKart(unsigned int kart_index)
+{
+    const CheckManager *cm = CheckManager::get();
+    unsigned int count = cm->getUpdateCount(kart_index);
+    // Already updated in this or the previous time step
+    if (m_last_update[kart_index] + 1 >= count) return;
+
+    catchUp(kart_index, cm->getLastXYZ(kart_index),
+            cm->hasKartMoved(kart_index));
+    m_last_update[kart_index] = count - 1;
+}   // syncKart
+
+// ----------------------------------------------------------------------------
+/** Marks the data of a kart as up to date, e.g. after it was restored
+ *  by a rewind.
+ *  \param kart_index Index of the kart.
+ */
+void CheckStructure::setUpToDate(unsigned int kart_index)
+{
+    m_last_update[kart_index] =
+        CheckManager::get()->getUpdateCount(kart_index);
+}   // setUpToDate
+
+// ----------------------------------------------------------------------------
+/** Sets the per-kart data to what it would be if the kart had been tested
+ *  at xyz (without triggering this structure).
+ *  \param kart_index Index of the kart.
+ *  \param xyz Front position of the kart in its previous time step.
+ *  \param kart_moved True if the kart was moved (e.g. rescued) since then,
+ *         and resetAfterKartMove was called.
+ */
+void CheckStructure::catchUp(unsigned int kart_index, const Vec3 &xyz,
+                             bool kart_moved)
+{
+    m_previous_position[kart_index] = xyz;
+}   // catchUp
+
 // ----------------------------------------------------------------------------
 /** Changes the status (active/inactive) of all check structures contained
  *  in the index list indices.
@@ -144,6 +207,9 @@ void CheckStructure::changeStatus(const std::vector<int> &indices,
             CheckManager::get()->getCheckStructure(indices[i]);
         if (cs == NULL) continue;
 
+        // The per-kart data of a culled structure must reflect the kart
+        // position at the time its state changes.
+        cs->syncKart(kart_index);
         switch(change_state)
         {
         case CS_DEACTIVATE:
@@ -246,6 +312,7 @@ void CheckStructure::restoreCompleteState(const BareNetworkString& b)
 {
     m_previous_position.clear();
     m_is_active.clear();
+    m_last_update.clear();
     World* world = World::getWorld();
     for (unsigned int i = 0; i < world->getNumKarts(); i++)
     {
@@ -253,6 +320,7 @@ void CheckStructure::restoreCompleteState(const BareNetworkString& b)
         bool is_active = b.getUInt8() == 1;
         m_previous_position.push_back(xyz);
         m_is_active.push_back(is_active);
+        m_last_update.push_back(CheckManager::get()->getUpdateCount(i));
     }
 }   // restoreCompleteState
 
@@ -76,6 +76,12 @@ protected:
     /** Stores if this check structure is active (for a given kart). */
     std::vector<bool> m_is_active;
 
+    /** For each kart the CheckManager update count at which the data of
+     *  this kart (e.g. m_previous_position) was last brought up to date.
+     *  If the check manager skipped this structure for a kart because it
+     *  was too far away, the data is updated in syncKart. */
+    std::vector<unsigned int> m_last_update;
+
     /** True if this check structure should be activated at a reset. */
     bool              m_active_at_reset;
 
@@ -110,6 +116,11 @@ public:
                 CheckStructure(const XMLNode &node, unsigned int index);
     virtual    ~CheckStructure() {};
     virtual void update(float dt);
+    void         updateKart(unsigned int kart_index, const Vec3 &xyz);
+    void         syncKart(unsigned int kart_index);
+    void         setUpToDate(unsigned int kart_index);
+    virtual void catchUp(unsigned int kart_index, const Vec3 &xyz,
+                         bool kart_moved);
     virtual void resetAfterKartMove(unsigned int kart_index) {}
     virtual void resetAfterRewind(unsigned int kart_index) {}
     virtual void changeDebugColor(bool is_active) {}
@@ -138,6 +149,12 @@ public:
     // ------------------------------------------------------------------------
     virtual bool triggeringCheckline() const { return false; }
     // ------------------------------------------------------------------------
+    /** Returns the bounding box (only X and Z are used) of all points at
+     *  which this check structure can be triggered. Structures that return
+     *  false (the default) are not spatially culled by the CheckManager and
+     *  are updated for all karts every time step. */
+    virtual bool getBoundingBox(Vec3 *min, Vec3 *max) const { return false; }
+    // ------------------------------------------------------------------------
     virtual void saveCompleteState(BareNetworkString* bns);
     // ------------------------------------------------------------------------
     virtual void restoreCompleteState(const BareNetworkString& b);
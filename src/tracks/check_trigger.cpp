@@ -54,3 +54,15 @@ bool CheckTrigger::isTriggered(const Vec3 &old_pos, const Vec3 &new_pos,
     }
     return false;
 }   // isTriggered
+
+// ----------------------------------------------------------------------------
+/** Note that the trigger distance is tested against the kart position, not
+ *  the front of the kart; the CheckManager adds a margin to cover this.
+ */
+bool CheckTrigger::getBoundingBox(Vec3 *min, Vec3 *max) const
+{
+    const float distance = sqrtf(m_distance2);
+    *min = m_center - Vec3(distance, distance, distance);
+    *max = m_center + Vec3(distance, distance, distance);
+    return true;
+}   // getBoundingBox
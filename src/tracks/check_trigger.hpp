@@ -53,6 +53,8 @@ public:
     virtual bool isTriggered(const Vec3 &old_pos, const Vec3 &new_pos,
                              int kart_id) OVERRIDE;
     // ------------------------------------------------------------------------
+    virtual bool getBoundingBox(Vec3 *min, Vec3 *max) const OVERRIDE;
+    // ------------------------------------------------------------------------
     virtual void trigger(unsigned int kart_index) OVERRIDE
     {
         m_triggering_function(kart_index);
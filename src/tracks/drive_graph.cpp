@@ -28,8 +28,11 @@
 #include "tracks/check_line.hpp"
 #include "tracks/check_manager.hpp"
 #include "tracks/drive_node.hpp"
+#include "tracks/graph_cache.hpp"
 #include "tracks/track.hpp"
+#include "utils/log.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/time.hpp"
 
 // ----------------------------------------------------------------------------
 /** Constructor, loads the graph information for a given set of quads
@@ -160,6 +163,7 @@ void DriveGraph::load(const std::string &quad_file_name,
             max_height_testing);
     }
     delete quad;
+    buildSectorGrid();
 
     const XMLNode *xml = file_manager->createXMLTree(filename);
 
@@ -168,7 +172,8 @@ void DriveGraph::load(const std::string &quad_file_name,
         // No graph file exist, assume a default loop X -> X+1
         // Set the default loop:
         setDefaultSuccessors();
-        computeDirectionData();
+        computeDerivedData(quad_file_name, filename,
+                           /*compute_distances*/false);
 
         if (m_all_nodes.size() > 0)
         {
@@ -246,8 +251,7 @@ void DriveGraph::load(const std::string &quad_file_name,
     delete xml;
 
     setDefaultSuccessors();
-    computeDistanceFromStart(getStartNode(), 0.0f);
-    computeDirectionData();
+    computeDerivedData(quad_file_name, filename, /*compute_distances*/true);
 
     // Define the track length as the maximum at the end of a quad
     // (i.e. distance_from_start + length till successor 0).
@@ -264,6 +268,82 @@ void DriveGraph::load(const std::string &quad_file_name,
 
 }   // load
 
+// ----------------------------------------------------------------------------
+/** Computes the data derived from the structure of the graph: the distance
+ *  from start of all nodes, the direction and racing line data, and the
+ *  paths to all nodes for nodes with more than one successor. This data only
+ *  depends on the graph files, so it is loaded from the graph cache if
+ *  possible, and otherwise computed (partly in parallel) and saved.
+ *  \param quad_file_name Name of the quad file.
+ *  \param graph_file_name Name of the graph file (which might not exist).
+ *  \param compute_distances If the distance from start is computed.
+ */
+void DriveGraph::computeDerivedData(const std::string &quad_file_name,
+                                    const std::string &graph_file_name,
+                                    bool compute_distances)
+{
+    GraphCache cache(m_reverse ? "drive-reverse" : "drive",
+                     { quad_file_name, graph_file_name });
+    if (loadDerivedData(&cache))
+        return;
+
+    const uint64_t start = StkTime::getMonoTimeMs();
+    if (compute_distances)
+        computeDistanceFromStart(getStartNode(), 0.0f);
+    computeDirectionData();
+    computeRacingLineData();
+    setupPaths();
+    Log::info("DriveGraph", "Computed graph data of %d nodes in %d ms.",
+              getNumNodes(), (int)(StkTime::getMonoTimeMs() - start));
+    saveDerivedData(&cache);
+}   // computeDerivedData
+
+// ----------------------------------------------------------------------------
+/** Reads the derived data of all nodes from the graph cache.
+ *  \param cache The graph cache for this graph.
+ *  \return True if the data was loaded.
+ */
+bool DriveGraph::loadDerivedData(GraphCache *cache)
+{
+    if (!cache->load())
+        return false;
+    uint32_t num_nodes;
+    if (!cache->read(&num_nodes) || num_nodes != getNumNodes())
+        return false;
+    for (unsigned int i = 0; i < num_nodes; i++)
+    {
+        if (!getNode(i)->loadDerivedData(cache, num_nodes))
+        {
+            // The distance from start is only computed for nodes that do
+            // not have one yet, so undo loading it.
+            for (unsigned int j = 0; j < i; j++)
+                getNode(j)->setDistanceFromStart(-1.0f);
+            return false;
+        }
+    }
+    if (!cache->isAtEnd())
+    {
+        for (unsigned int i = 0; i < num_nodes; i++)
+            getNode(i)->setDistanceFromStart(-1.0f);
+        return false;
+    }
+    Log::info("DriveGraph", "Loaded graph data of %d nodes from the graph "
+              "cache.", num_nodes);
+    return true;
+}   // loadDerivedData
+
+// ----------------------------------------------------------------------------
+/** Writes the derived data of all nodes to the graph cache.
+ *  \param cache The graph cache for this graph.
+ */
+void DriveGraph::saveDerivedData(GraphCache *cache) const
+{
+    cache->write((uint32_t)getNumNodes());
+    for (unsigned int i = 0; i < getNumNodes(); i++)
+        getNode(i)->saveDerivedData(cache);
+    cache->save();
+}   // saveDerivedData
+
 // ----------------------------------------------------------------------------
 /** Returns the index of the first graph node (i.e. the graph node which
  *  will trigger a new lap when a kart first enters it). This is always
@@ -340,10 +420,11 @@ void DriveGraph::computeChecklineRequirements(DriveNode* node,
  */
 void DriveGraph::setupPaths()
 {
-    for(unsigned int i=0; i<getNumNodes(); i++)
-    {
-        getNode(i)->setupPathsToNode();
-    }
+    // Each node only modifies its own path data
+    runInParallel(getNumNodes(), [this](unsigned int i)
+        {
+            getNode(i)->setupPathsToNode();
+        });
 }   // setupPaths
 
 // -----------------------------------------------------------------------------
@@ -577,16 +658,16 @@ void DriveGraph::updateDistancesForAllSuccessors(unsigned int indx, float delta,
  */
 void DriveGraph::computeDirectionData()
 {
-    for(unsigned int i=0; i<m_all_nodes.size(); i++)
-    {
-        for(unsigned int succ_index=0;
-            succ_index<getNode(i)->getNumberOfSuccessors();
-            succ_index++)
+    // Each node only modifies its own direction data
+    runInParallel(getNumNodes(), [this](unsigned int i)
         {
-            determineDirection(i, succ_index);
-        }   // for next < getNumberOfSuccessor
-
-    }   // for i < m_all_nodes.size()
+            for(unsigned int succ_index=0;
+                succ_index<getNode(i)->getNumberOfSuccessors();
+                succ_index++)
+            {
+                determineDirection(i, succ_index);
+            }   // for next < getNumberOfSuccessor
+        });
 }   // computeDirectionData
 
 //-----------------------------------------------------------------------------
@@ -663,6 +744,135 @@ void DriveGraph::determineDirection(unsigned int current,
     getNode(current)->setDirectionData(succ_index, dir, next);
 }   // determineDirection
 
+//-----------------------------------------------------------------------------
+/** Precomputes for each node and successor the data the AI needs to select
+ *  the point to aim at: the radius of the curve ahead (based on the
+ *  direction data, so computeDirectionData() must have been called before),
+ *  and for a few lateral offsets across the node the furthest node that can
+ *  be reached in a straight line (see findFurthestVisibleNode). Since the
+ *  drive graph is static, this replaces a search along the graph done by
+ *  each AI in each frame with a table lookup.
+ */
+void DriveGraph::computeRacingLineData()
+{
+    // Radius used for straight sections (and nearly collinear centers)
+    const float max_radius = 1000.0f;
+    const unsigned int num_bins = DriveNode::NUM_LATERAL_BINS;
+
+    // Each node only modifies its own racing line data
+    runInParallel(getNumNodes(), [this, max_radius, num_bins](unsigned int i)
+        {
+            unsigned int furthest[DriveNode::NUM_LATERAL_BINS];
+            const DriveNode *node = getNode(i);
+            for(unsigned int succ_index=0;
+                succ_index<node->getNumberOfSuccessors();
+                succ_index++)
+            {
+                const unsigned int succ = node->getSuccessor(succ_index);
+
+                DriveNode::DirectionType dir;
+                unsigned int last;
+                node->getDirectionData(succ_index, &dir, &last);
+                if(last==succ)
+                    last = getNode(succ)->getSuccessor(0);
+
+                // Radius of the circle through the three centers (in 2d):
+                // r = |ab| * |bc| * |ca| / (2 * |cross(b-a, c-a)|)
+                float radius = max_radius;
+                if(dir==DriveNode::DIR_LEFT || dir==DriveNode::DIR_RIGHT)
+                {
+                    const Vec3 &a = node->getCenter();
+                    const Vec3 &b = getNode(succ)->getCenter();
+                    const Vec3 &c = getNode(last)->getCenter();
+                    Vec3 ab = b-a, bc = c-b, ca = a-c;
+                    ab.setY(0); bc.setY(0); ca.setY(0);
+                    float cross = fabsf(ab.getX()*(-ca.getZ())
+                                      - ab.getZ()*(-ca.getX()));
+                    if(cross > 0.0001f)
+                    {
+                        radius = ab.length()*bc.length()*ca.length()
+                               / (2.0f*cross);
+                    }
+                    if(radius > max_radius)
+                        radius = max_radius;
+                }
+
+                for(unsigned int bin=0; bin<num_bins; bin++)
+                {
+                    float offset = ((bin+0.5f)/num_bins - 0.5f)
+                                 * node->getPathWidth();
+                    Vec3 start = node->getCenter()
+                               + node->getRightUnitVector()*offset;
+                    furthest[bin] = findFurthestVisibleNode(start, succ);
+                }
+                getNode(i)->setRacingLineData(succ_index, radius, furthest);
+            }   // for succ_index
+        });
+}   // computeRacingLineData
+
+//-----------------------------------------------------------------------------
+/** Determines the furthest node whose lower edge can be completely seen
+ *  from the start point. This is the same algorithm that is used in
+ *  SkiddingAI::findNonCrashingPointNew: the left and right line from the
+ *  start point to the ends of the lower edge of each node are narrowed down
+ *  node by node, until the area between them would become empty. The
+ *  search stops at nodes with more than one successor, since which way an
+ *  AI takes there is only known at runtime.
+ *  \param start The point (on the start node) to start from.
+ *  \param target The first node to test.
+ *  \return Index of the furthest visible node.
+ */
+unsigned int DriveGraph::findFurthestVisibleNode(const Vec3 &start,
+                                                 unsigned int target) const
+{
+    // Returns the left or right end of the lower edge of a node
+    struct EdgePoints
+    {
+        core::vector2df m_left, m_right;
+        EdgePoints(const DriveNode *n)
+        {
+            Vec3 r = n->getRightUnitVector() * (0.5f*n->getPathWidth());
+            m_left  = Vec3(n->getLowerCenter() - r).toIrrVector2d();
+            m_right = Vec3(n->getLowerCenter() + r).toIrrVector2d();
+        }
+    };   // EdgePoints
+
+    // Determine which sign of getPointOrientation means 'to the right'.
+    const DriveNode *target_node = getNode(target);
+    const core::vector2df s = start.toIrrVector2d();
+    core::line2df forward(s, s + Vec3(target_node->getUpperCenter()
+                                     -target_node->getLowerCenter())
+                                     .toIrrVector2d());
+    const float right_sign =
+        forward.getPointOrientation(s + target_node->getRightUnitVector()
+                                        .toIrrVector2d()) > 0 ? 1.0f : -1.0f;
+
+    EdgePoints ep(target_node);
+    core::line2df left (s, ep.m_left );
+    core::line2df right(s, ep.m_right);
+    unsigned int last = target;
+    int max_step = (int)m_all_nodes.size();
+    while(max_step-- > 0 && getNode(last)->getNumberOfSuccessors()==1)
+    {
+        unsigned int next = getNode(last)->getSuccessor(0);
+        EdgePoints next_ep(getNode(next));
+        // The new left point must be right of the left line, but not
+        // right of the right line.
+        if(left.getPointOrientation(next_ep.m_left)*right_sign <= 0 ||
+           right.getPointOrientation(next_ep.m_left)*right_sign > 0)
+            break;
+        left.end = next_ep.m_left;
+        // Similarly the new right point must be left of the right line,
+        // but not left of the left line.
+        if(right.getPointOrientation(next_ep.m_right)*right_sign >= 0 ||
+           left.getPointOrientation(next_ep.m_right)*right_sign < 0)
+            break;
+        right.end = next_ep.m_right;
+        last = next;
+    }
+    return last;
+}   // findFurthestVisibleNode
+
 
 //-----------------------------------------------------------------------------
 /** This function takes absolute coordinates (coordinates in OpenGL
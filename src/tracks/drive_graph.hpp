@@ -29,6 +29,7 @@
 #include "LinearMath/btTransform.h"
 
 class DriveNode;
+class GraphCache;
 class XMLNode;
 
 /**
@@ -56,6 +57,11 @@ private:
     // ------------------------------------------------------------------------
     void determineDirection(unsigned int current, unsigned int succ_index);
     // ------------------------------------------------------------------------
+    void computeRacingLineData();
+    // ------------------------------------------------------------------------
+    unsigned int findFurthestVisibleNode(const Vec3 &start,
+                                         unsigned int target) const;
+    // ------------------------------------------------------------------------
     float normalizeAngle(float f);
     // ------------------------------------------------------------------------
     void addSuccessor(unsigned int from, unsigned int to);
@@ -67,6 +73,14 @@ private:
     // ------------------------------------------------------------------------
     void computeDistanceFromStart(unsigned int start_node, float distance);
     // ------------------------------------------------------------------------
+    void computeDerivedData(const std::string &quad_file_name,
+                            const std::string &graph_file_name,
+                            bool compute_distances);
+    // ------------------------------------------------------------------------
+    bool loadDerivedData(GraphCache *cache);
+    // ------------------------------------------------------------------------
+    void saveDerivedData(GraphCache *cache) const;
+    // ------------------------------------------------------------------------
     unsigned int getStartNode() const;
     // ------------------------------------------------------------------------
     virtual bool hasLapLine() const OVERRIDE;
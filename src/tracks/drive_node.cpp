@@ -21,6 +21,7 @@
 #include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
 #include "tracks/drive_graph.hpp"
+#include "tracks/graph_cache.hpp"
 #include "utils/log.hpp"
 
 // ----------------------------------------------------------------------------
@@ -162,6 +163,122 @@ void DriveNode::setDirectionData(unsigned int successor, DirectionType dir,
     m_last_index_same_direction[successor] = last_node_index;
 }   // setDirectionData
 
+// ----------------------------------------------------------------------------
+/** Stores the precomputed racing line data for one successor.
+ *  \param successor Index of the successor.
+ *  \param radius Curve radius when driving to this successor.
+ *  \param furthest_visible Array of NUM_LATERAL_BINS node indices, the
+ *         furthest visible node for each lateral bin (left to right).
+ */
+void DriveNode::setRacingLineData(unsigned int successor, float radius,
+                                  const unsigned int *furthest_visible)
+{
+    if(m_curve_radius.size()<successor+1)
+    {
+        m_curve_radius.resize(successor+1);
+        m_furthest_visible_node.resize((successor+1)*NUM_LATERAL_BINS);
+    }
+    m_curve_radius[successor] = radius;
+    for(unsigned int i=0; i<NUM_LATERAL_BINS; i++)
+    {
+        m_furthest_visible_node[successor*NUM_LATERAL_BINS+i] =
+            furthest_visible[i];
+    }
+}   // setRacingLineData
+
+// ----------------------------------------------------------------------------
+/** Reads the data derived from the graph (see DriveGraph::
+ *  computeDerivedData) from the graph cache. Nothing is modified if the data
+ *  is invalid.
+ *  \param cache The graph cache.
+ *  \param num_nodes Number of nodes in the graph.
+ *  \return True if the data was loaded.
+ */
+bool DriveNode::loadDerivedData(GraphCache *cache, unsigned int num_nodes)
+{
+    const unsigned int num_successors = getNumberOfSuccessors();
+    float distance_from_start;
+    std::vector<uint32_t> direction;
+    std::vector<unsigned int> last_index, furthest_visible;
+    std::vector<float> curve_radius;
+    PathToNodeVector path_to_node;
+    if (!cache->read(&distance_from_start)                  ||
+        !cache->readVector(&direction)                      ||
+        direction.size() != num_successors                  ||
+        !cache->readVector(&last_index)                     ||
+        last_index.size() != num_successors                 ||
+        !cache->readVector(&curve_radius)                   ||
+        curve_radius.size() != num_successors               ||
+        !cache->readVector(&furthest_visible)               ||
+        furthest_visible.size() != num_successors*NUM_LATERAL_BINS ||
+        !cache->readVector(&path_to_node)                   ||
+        (!path_to_node.empty() && path_to_node.size() != num_nodes))
+        return false;
+
+    for (unsigned int i = 0; i < num_successors; i++)
+    {
+        if (direction[i] > DIR_UNDEFINED || last_index[i] >= num_nodes)
+            return false;
+    }
+    for (unsigned int node : furthest_visible)
+    {
+        if (node >= num_nodes)
+            return false;
+    }
+    for (int successor : path_to_node)
+    {
+        if (successor < -1 || successor >= (int)num_successors)
+            return false;
+    }
+
+    m_distance_from_start = distance_from_start;
+    m_direction.resize(num_successors);
+    for (unsigned int i = 0; i < num_successors; i++)
+        m_direction[i] = (DirectionType)direction[i];
+    m_last_index_same_direction.swap(last_index);
+    m_curve_radius.swap(curve_radius);
+    m_furthest_visible_node.swap(furthest_visible);
+    m_path_to_node.swap(path_to_node);
+    return true;
+}   // loadDerivedData
+
+// ----------------------------------------------------------------------------
+/** Writes the data derived from the graph to the graph cache, in the format
+ *  read by loadDerivedData.
+ *  \param cache The graph cache.
+ */
+void DriveNode::saveDerivedData(GraphCache *cache) const
+{
+    cache->write(m_distance_from_start);
+    std::vector<uint32_t> direction(m_direction.begin(), m_direction.end());
+    cache->writeVector(direction);
+    cache->writeVector(m_last_index_same_direction);
+    cache->writeVector(m_curve_radius);
+    cache->writeVector(m_furthest_visible_node);
+    cache->writeVector(m_path_to_node);
+}   // saveDerivedData
+
+// ----------------------------------------------------------------------------
+/** Returns the furthest drive node that can be reached in a straight line
+ *  from the given lateral offset on this node when driving towards the
+ *  given successor.
+ *  \param succ Index of the successor.
+ *  \param lateral_offset Distance from the center line, positive values
+ *         are to the right (see getDistances).
+ */
+unsigned int DriveNode::getFurthestVisibleNode(unsigned int succ,
+                                               float lateral_offset) const
+{
+    int bin = NUM_LATERAL_BINS/2;
+    if(m_width > 0)
+        bin = (int)floorf((lateral_offset/m_width + 0.5f) * NUM_LATERAL_BINS);
+    if(bin < 0)
+        bin = 0;
+    else if(bin >= (int)NUM_LATERAL_BINS)
+        bin = NUM_LATERAL_BINS - 1;
+    return m_furthest_visible_node[succ*NUM_LATERAL_BINS + bin];
+}   // getFurthestVisibleNode
+
 // ----------------------------------------------------------------------------
 void DriveNode::setChecklineRequirements(int latest_checkline)
 {
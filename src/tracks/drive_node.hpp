@@ -23,6 +23,8 @@
 
 #include "tracks/quad.hpp"
 
+class GraphCache;
+
 /**
   * \brief This class stores a node of the drive graph, i.e. a list of
   *  successor edges, it can either be 2d or 3d.
@@ -36,6 +38,11 @@ public:
      *  AI only. */
     enum         DirectionType {DIR_STRAIGHT, DIR_LEFT, DIR_RIGHT,
                                 DIR_UNDEFINED};
+
+    /** Number of lateral bins across the width of a node for which the
+     *  furthest visible node is precomputed (see DriveGraph::
+     *  computeRacingLineData). */
+    static const unsigned int NUM_LATERAL_BINS = 5;
 protected:
     /** Lower center point of the drive node. */
     Vec3 m_lower_center;
@@ -85,6 +92,17 @@ private:
      *  left. */
     std::vector<unsigned int> m_last_index_same_direction;
 
+    /** Stores for each successor the radius of the circle through the
+     *  center of this node, the successor and the last node with the same
+     *  direction. Straight sections get a very large radius. */
+    std::vector<float> m_curve_radius;
+
+    /** Stores for each successor and each lateral bin the index of the
+     *  furthest drive node whose center can be reached in a straight line
+     *  without leaving the track, starting at that lateral offset of this
+     *  node. Index is successor * NUM_LATERAL_BINS + bin. */
+    std::vector<unsigned int> m_furthest_visible_node;
+
     /** A unit vector pointing from the center to the right side, orthogonal
      *  to the driving direction. */
     Vec3 m_right_unit_vector;
@@ -118,6 +136,16 @@ public:
     void         setDirectionData(unsigned int successor, DirectionType dir,
                                   unsigned int last_node_index);
     // ------------------------------------------------------------------------
+    void         setRacingLineData(unsigned int successor, float radius,
+                                   const unsigned int *furthest_visible);
+    // ------------------------------------------------------------------------
+    unsigned int getFurthestVisibleNode(unsigned int succ,
+                                        float lateral_offset) const;
+    // ------------------------------------------------------------------------
+    bool         loadDerivedData(GraphCache *cache, unsigned int num_nodes);
+    // ------------------------------------------------------------------------
+    void         saveDerivedData(GraphCache *cache) const;
+    // ------------------------------------------------------------------------
     /** Returns the number of successors. */
     unsigned int getNumberOfSuccessors() const
                              { return (unsigned int)m_successor_nodes.size(); }
@@ -187,6 +215,11 @@ public:
         *dir = m_direction[succ];  *last = m_last_index_same_direction[succ];
     }
     // ------------------------------------------------------------------------
+    /** Returns the precomputed radius of the curve when driving to the
+     *  given successor. */
+    float getCurveRadius(unsigned int succ) const
+                                                { return m_curve_radius[succ]; }
+    // ------------------------------------------------------------------------
     /** Returns a unit vector pointing to the right side of the quad. */
     const Vec3 &getRightUnitVector() const      { return m_right_unit_vector; }
     // ------------------------------------------------------------------------
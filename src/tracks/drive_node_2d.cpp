@@ -18,6 +18,8 @@
 
 #include "tracks/drive_node_2d.hpp"
 
+#include <cmath>
+
 // ----------------------------------------------------------------------------
 DriveNode2D::DriveNode2D(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2,
                          const Vec3 &p3, const Vec3 &normal,
@@ -29,9 +31,10 @@ DriveNode2D::DriveNode2D(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2,
     m_line = core::line2df(m_upper_center.getX(), m_upper_center.getZ(),
         m_lower_center.getX(), m_lower_center.getZ());
 
-    // Only this 2d point is needed later
-    m_lower_center_2d = core::vector2df(m_lower_center.getX(),
-        m_lower_center.getZ());
+    m_line_direction = m_line.end - m_line.start;
+    m_line_length    = m_line_direction.getLength();
+    if (m_line_length > 0)
+        m_line_direction /= m_line_length;
 }   // DriveNode2D
 
 // ----------------------------------------------------------------------------
@@ -45,15 +48,34 @@ DriveNode2D::DriveNode2D(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2,
  */
 void DriveNode2D::getDistances(const Vec3 &xyz, Vec3 *result) const
 {
-    core::vector2df xyz2d(xyz.getX(), xyz.getZ());
-    core::vector2df closest = m_line.getClosestPoint(xyz2d);
-    if (m_line.getPointOrientation(xyz2d) > 0)
-        result->setX( (closest-xyz2d).getLength());   // to the right
+    core::vector2df c(xyz.getX() - m_line.start.X,
+                      xyz.getZ() - m_line.start.Y);
+    // Position along the line, and (signed) distance to the infinite line.
+    // The latter has the same sign as m_line.getPointOrientation().
+    float t           = m_line_direction.dotProduct(c);
+    float orientation = m_line_direction.X * c.Y - c.X * m_line_direction.Y;
+    float side;
+    if (t <= 0)
+    {
+        t    = 0;
+        side = c.getLength();
+    }
+    else if (t > m_line_length)
+    {
+        t    = m_line_length;
+        side = core::vector2df(xyz.getX() - m_line.end.X,
+                               xyz.getZ() - m_line.end.Y).getLength();
+    }
+    else
+        side = fabsf(orientation);
+
+    if (orientation > 0)
+        result->setX( side);   // to the right
     else
-        result->setX(-(closest-xyz2d).getLength());   // to the left
+        result->setX(-side);   // to the left
 
-    result->setZ(m_distance_from_start +
-        (closest-m_lower_center_2d).getLength());
+    // The end of the line is the lower center
+    result->setZ(m_distance_from_start + (m_line_length - t));
 }   // getDistances
 
 // ----------------------------------------------------------------------------
@@ -65,7 +87,16 @@ void DriveNode2D::getDistances(const Vec3 &xyz, Vec3 *result) const
  */
 float DriveNode2D::getDistance2FromPoint(const Vec3 &xyz) const
 {
-    core::vector2df xyz2d(xyz.getX(), xyz.getZ());
-    core::vector2df closest = m_line.getClosestPoint(xyz2d);
-    return (closest-xyz2d).getLengthSQ();
+    core::vector2df c(xyz.getX() - m_line.start.X,
+                      xyz.getZ() - m_line.start.Y);
+    float t = m_line_direction.dotProduct(c);
+    if (t <= 0)
+        return c.getLengthSQ();
+    if (t > m_line_length)
+    {
+        return core::vector2df(xyz.getX() - m_line.end.X,
+                               xyz.getZ() - m_line.end.Y).getLengthSQ();
+    }
+    float orientation = m_line_direction.X * c.Y - c.X * m_line_direction.Y;
+    return orientation * orientation;
 }   // getDistance2FromPoint
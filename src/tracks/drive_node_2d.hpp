@@ -30,11 +30,6 @@
 class DriveNode2D : public DriveNode
 {
 private:
-    /** The center point of the lower two points (e.g. points 0 and 1).
-     *  This saves some computations in getDistances later. Only the
-     *  start point is needed, and only in 2d. */
-    core::vector2df m_lower_center_2d;
-
     /** Line between lower and upper center, saves computation in
      *  getDistance() later. The line is 2d only since otherwise taller karts
      *  would have a larger distance from the center. It also saves
@@ -42,6 +37,13 @@ private:
      *  center of the drivelines anyway. */
     core::line2df m_line;
 
+    /** Unit direction of m_line (from its start to its end) and its length.
+     *  Precomputed so that getDistances() and getDistance2FromPoint(), which
+     *  are called for every kart each frame, only need a dot and a cross
+     *  product instead of square roots. */
+    core::vector2df m_line_direction;
+    float           m_line_length;
+
 public:
     DriveNode2D(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2, const Vec3 &p3,
                 const Vec3 &normal, unsigned int node_index, bool invisible,
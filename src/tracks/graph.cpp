@@ -31,8 +31,14 @@
 #include "tracks/drive_node_2d.hpp"
 #include "tracks/drive_node_3d.hpp"
 #include "tracks/track.hpp"
+#include "utils/cpp2011.hpp"
 #include "utils/log.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
 const int Graph::UNKNOWN_SECTOR = -1;
 const float Graph::MIN_HEIGHT_TESTING = -1.0f;
 const float Graph::MAX_HEIGHT_TESTING = 5.0f;
@@ -48,6 +54,12 @@ Graph::Graph()
     m_bb_min      = Vec3( 99999,  99999,  99999);
     m_bb_max      = Vec3(-99999, -99999, -99999);
     memset(m_bb_nodes, 0, 4 * sizeof(int));
+    m_grid_min_x  = 0;
+    m_grid_min_z  = 0;
+    m_grid_cell_size     = 1.0f;
+    m_grid_inv_cell_size = 1.0f;
+    m_grid_nx     = 0;
+    m_grid_nz     = 0;
 }  // Graph
 
 // -----------------------------------------------------------------------------
@@ -591,6 +603,167 @@ void Graph::createQuad(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2,
 
 }   // createQuad
 
+//-----------------------------------------------------------------------------
+/** Builds the uniform XZ grid used by findRoadSector() and
+ *  findOutOfRoadSector(), so that they only need to test the few nodes close
+ *  to a point instead of all nodes of the graph. Must be called once all
+ *  nodes are created.
+ */
+void Graph::buildSectorGrid()
+{
+    m_grid_cell_start.clear();
+    m_grid_nodes.clear();
+    m_grid_nx = m_grid_nz = 0;
+    if (m_all_nodes.empty())
+        return;
+
+    // Small tolerance so that rounding errors in pointInside can not find a
+    // point on the border of a node that is not registered in its cell.
+    const float EPSILON = 0.01f;
+
+    // The 2d bounding box of each node (min x, min z, max x, max z). A 3d
+    // node uses a box volume along its normal in pointInside (see
+    // BoundingBox3D), which must be covered, too.
+    std::vector<float> boxes(4 * m_all_nodes.size());
+    float min_x =  99999.0f, min_z =  99999.0f;
+    float max_x = -99999.0f, max_z = -99999.0f;
+    for (unsigned int i = 0; i < m_all_nodes.size(); i++)
+    {
+        const Quad *q = m_all_nodes[i];
+        float *box = &boxes[4 * i];
+        box[0] = box[1] =  99999.0f;
+        box[2] = box[3] = -99999.0f;
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            Vec3 points[3] = { (*q)[j], (*q)[j], (*q)[j] };
+            unsigned int num_points = 1;
+            if (q->is3DQuad())
+            {
+                points[1] += 5.0f * q->getNormal();
+                points[2] -= 5.0f * q->getNormal();
+                num_points = 3;
+            }
+            for (unsigned int k = 0; k < num_points; k++)
+            {
+                box[0] = std::min(box[0], points[k].getX() - EPSILON);
+                box[1] = std::min(box[1], points[k].getZ() - EPSILON);
+                box[2] = std::max(box[2], points[k].getX() + EPSILON);
+                box[3] = std::max(box[3], points[k].getZ() + EPSILON);
+            }
+        }
+        min_x = std::min(min_x, box[0]);
+        min_z = std::min(min_z, box[1]);
+        max_x = std::max(max_x, box[2]);
+        max_z = std::max(max_z, box[3]);
+    }
+
+    // Cells should be about the size of a node, but avoid huge grids on
+    // large tracks.
+    const float extent = std::max(max_x - min_x, max_z - min_z);
+    m_grid_cell_size     = std::max(5.0f, extent / 256.0f);
+    m_grid_inv_cell_size = 1.0f / m_grid_cell_size;
+    m_grid_min_x = min_x;
+    m_grid_min_z = min_z;
+    m_grid_nx    = (int)((max_x - min_x) * m_grid_inv_cell_size) + 1;
+    m_grid_nz    = (int)((max_z - min_z) * m_grid_inv_cell_size) + 1;
+
+    // First count the nodes per cell, then fill in the node indices.
+    const unsigned int num_cells = m_grid_nx * m_grid_nz;
+    m_grid_cell_start.resize(num_cells + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        std::vector<unsigned int> next;
+        if (pass == 1)
+        {
+            for (unsigned int c = 0; c < num_cells; c++)
+                m_grid_cell_start[c + 1] += m_grid_cell_start[c];
+            m_grid_nodes.resize(m_grid_cell_start[num_cells]);
+            next.assign(m_grid_cell_start.begin(),
+                        m_grid_cell_start.end() - 1);
+        }
+        for (unsigned int i = 0; i < m_all_nodes.size(); i++)
+        {
+            const float *box = &boxes[4 * i];
+            const int x0 = (int)((box[0] - min_x) * m_grid_inv_cell_size);
+            const int z0 = (int)((box[1] - min_z) * m_grid_inv_cell_size);
+            const int x1 = std::min(m_grid_nx - 1,
+                (int)((box[2] - min_x) * m_grid_inv_cell_size));
+            const int z1 = std::min(m_grid_nz - 1,
+                (int)((box[3] - min_z) * m_grid_inv_cell_size));
+            for (int z = z0; z <= z1; z++)
+            {
+                for (int x = x0; x <= x1; x++)
+                {
+                    const unsigned int cell = z * m_grid_nx + x;
+                    if (pass == 0)
+                        m_grid_cell_start[cell + 1]++;
+                    else
+                        m_grid_nodes[next[cell]++] = i;
+                }
+            }
+        }   // for i < m_all_nodes.size()
+    }   // for pass
+
+    Log::debug("Graph", "Sector grid: %dx%d cells of %f, %d entries.",
+               m_grid_nx, m_grid_nz, m_grid_cell_size,
+               (int)m_grid_nodes.size());
+}   // buildSectorGrid
+
+//-----------------------------------------------------------------------------
+/** Calls f(i) for all i < count, distributed over a set of short-lived
+ *  threads (the calling thread is used as well). The number of threads is
+ *  limited by UserConfigParams::m_graph_threads. Used to compute derived
+ *  graph data when loading a graph, so f must only modify data that belongs
+ *  to index i.
+ *  \param count Number of indices.
+ *  \param f The function to call for each index.
+ */
+void Graph::runInParallel(unsigned int count,
+                          const std::function<void(unsigned int)> &f)
+{
+    std::atomic<unsigned int> next(0);
+    auto run = [&f, &next, count]()
+    {
+        for (unsigned int i = next++; i < count; i = next++)
+            f(i);
+    };
+
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0)
+        num_threads = 2;
+    if (UserConfigParams::m_graph_threads > 0)
+    {
+        num_threads = std::min(num_threads,
+                          (unsigned int)UserConfigParams::m_graph_threads);
+    }
+    num_threads = std::min(num_threads, count);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < num_threads; i++)
+        threads.emplace_back(run);
+    run();
+    for (std::thread &t : threads)
+        t.join();
+}   // runInParallel
+
+//-----------------------------------------------------------------------------
+/** Determines the grid cell a point is in.
+ *  \param xyz The point.
+ *  \param cx, cz On return the cell coordinates.
+ *  \return False if the point is outside of the grid (or no grid exists).
+ */
+bool Graph::getGridCell(const Vec3 &xyz, int *cx, int *cz) const
+{
+    const float fx = (xyz.getX() - m_grid_min_x) * m_grid_inv_cell_size;
+    const float fz = (xyz.getZ() - m_grid_min_z) * m_grid_inv_cell_size;
+    // Written this way to also reject NAN
+    if (!(fx >= 0.0f && fx < (float)m_grid_nx &&
+          fz >= 0.0f && fz < (float)m_grid_nz))
+        return false;
+    *cx = std::min((int)fx, m_grid_nx - 1);
+    *cz = std::min((int)fz, m_grid_nz - 1);
+    return true;
+}   // getGridCell
+
 //-----------------------------------------------------------------------------
 /** findRoadSector returns in which sector on the road the position
  *  xyz is. If xyz is not on top of the road, it sets UNKNOWN_SECTOR as sector.
@@ -615,6 +788,36 @@ void Graph::findRoadSector(const Vec3& xyz, int *sector,
         return;
     }   // if still on same quad
 
+    // Without a list of sectors only the nodes in the grid cell of the point
+    // need to be tested. To get exactly the same result as the linear
+    // search below, the node that would have been found first, i.e. the one
+    // closest after the current sector, is used.
+    if (all_sectors == NULL && !m_grid_cell_start.empty())
+    {
+        const int num_nodes = (int)m_all_nodes.size();
+        const int first     = *sector + 1 < num_nodes ? *sector + 1 : 0;
+        *sector = UNKNOWN_SECTOR;
+        int cx, cz;
+        if (!getGridCell(xyz, &cx, &cz))
+            return;
+        const unsigned int cell = cz * m_grid_nx + cx;
+        int min_offset = num_nodes;
+        for (unsigned int k = m_grid_cell_start[cell];
+             k < m_grid_cell_start[cell + 1]; k++)
+        {
+            const int indx = m_grid_nodes[k];
+            int offset = indx - first;
+            if (offset < 0) offset += num_nodes;
+            if (offset < min_offset &&
+                m_all_nodes[indx]->pointInside(xyz, ignore_vertical))
+            {
+                min_offset = offset;
+                *sector    = indx;
+            }
+        }
+        return;
+    }   // if grid
+
     // Now we search through all quads, starting with
     // the current one
     int indx       = *sector;
@@ -705,6 +908,29 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
         if(current_sector<0) current_sector += getNumNodes();
     }
 
+    // Use the grid if possible. It gives the same result as testing all
+    // nodes; if the point is too far away from any node, the search falls
+    // back to testing all nodes.
+    if (!all_sectors && !m_grid_cell_start.empty())
+    {
+        const int first = current_sector + 1 < (int)getNumNodes()
+                        ? current_sector + 1 : 0;
+        bool resolved   = true;
+        for (int phase = 0; phase < 2 && resolved; phase++)
+        {
+            int sector = findClosestSectorInGrid(xyz, first,
+                                                 /*height_test*/phase == 0,
+                                                 ignore_vertical, &resolved);
+            if (resolved && sector != UNKNOWN_SECTOR)
+                return sector;
+        }
+        if (resolved)
+        {
+            Log::warn("Graph", "unknown sector found.");
+            return 0;
+        }
+    }   // if grid
+
     int   min_sector = UNKNOWN_SECTOR;
     float min_dist_2 = 999999.0f*999999.0f;
 
@@ -760,6 +986,90 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
     return 0;
 }   // findOutOfRoadSector
 
+//-----------------------------------------------------------------------------
+/** Searches the grid cells in rings around the point for the closest node,
+ *  as used by findOutOfRoadSector(). Ties are broken in favour of the node
+ *  that comes first when counting from first_sector, which is the node the
+ *  linear search would pick.
+ *  \param xyz The point.
+ *  \param first_sector The first node the linear search would test.
+ *  \param height_test If the vertical distance of 2d nodes is tested.
+ *  \param ignore_vertical Disables the height test.
+ *  \param resolved On return false if the closest node could not be
+ *         determined using the grid (the caller then tests all nodes).
+ */
+int Graph::findClosestSectorInGrid(const Vec3 &xyz, int first_sector,
+                                   bool height_test, bool ignore_vertical,
+                                   bool *resolved) const
+{
+    // Number of rings of cells searched before falling back to testing all
+    // nodes, which is then faster.
+    const int MAX_RINGS = 8;
+
+    *resolved = false;
+    int cx, cz;
+    if (!getGridCell(xyz, &cx, &cz))
+        return UNKNOWN_SECTOR;
+
+    const int num_nodes = (int)m_all_nodes.size();
+    int   min_sector = UNKNOWN_SECTOR;
+    int   min_offset = num_nodes;
+    float min_dist_2 = 999999.0f*999999.0f;
+    for (int ring = 0; ring <= MAX_RINGS; ring++)
+    {
+        for (int z = cz - ring; z <= cz + ring; z++)
+        {
+            if (z < 0 || z >= m_grid_nz) continue;
+            // Only the border of the ring needs to be tested
+            const int step = (z == cz - ring || z == cz + ring) ? 1 : 2 * ring;
+            for (int x = cx - ring; x <= cx + ring; x += step)
+            {
+                if (x < 0 || x >= m_grid_nx) continue;
+                const unsigned int cell = z * m_grid_nx + x;
+                for (unsigned int k = m_grid_cell_start[cell];
+                     k < m_grid_cell_start[cell + 1]; k++)
+                {
+                    const int indx = m_grid_nodes[k];
+                    const Quad *q  = m_all_nodes[indx];
+                    if (q->isIgnored()) continue;
+                    if (height_test && !q->is3DQuad() && !ignore_vertical)
+                    {
+                        float dist = xyz.getY() - q->getMinHeight();
+                        if (!(dist < 5.0f && dist > -1.0f)) continue;
+                    }
+                    float dist_2 = q->getDistance2FromPoint(xyz);
+                    int offset   = indx - first_sector;
+                    if (offset < 0) offset += num_nodes;
+                    if (dist_2 < min_dist_2 ||
+                        (dist_2 == min_dist_2 && offset < min_offset))
+                    {
+                        min_dist_2 = dist_2;
+                        min_offset = offset;
+                        min_sector = indx;
+                    }
+                }   // for k
+            }   // for x
+        }   // for z
+
+        // All nodes not tested yet are at least this far away (in 2d, which
+        // is a lower bound for the 3d distance, too).
+        const float bound = ring * m_grid_cell_size;
+        if (min_sector != UNKNOWN_SECTOR && min_dist_2 < bound * bound)
+        {
+            *resolved = true;
+            return min_sector;
+        }
+        // If the whole grid was searched, the result is final
+        if (cx - ring <= 0 && cz - ring <= 0 &&
+            cx + ring >= m_grid_nx - 1 && cz + ring >= m_grid_nz - 1)
+        {
+            *resolved = true;
+            return min_sector;
+        }
+    }   // for ring
+    return UNKNOWN_SECTOR;
+}   // findClosestSectorInGrid
+
 //-----------------------------------------------------------------------------
 void Graph::loadBoundingBoxNodes()
 {
@@ -772,3 +1082,105 @@ void Graph::loadBoundingBoxNodes()
     m_bb_nodes[3] = findOutOfRoadSector(Vec3(m_bb_max.x(), 0, m_bb_max.z()),
         -1/*curr_sector*/, NULL/*all_sectors*/, true/*ignore_vertical*/);
 }   // loadBoundingBoxNodes
+
+// ============================================================================
+namespace GraphTest
+{
+    /** A graph without a track, only used in the unit tests. */
+    class TestGraph : public Graph
+    {
+    private:
+        virtual bool hasLapLine() const OVERRIDE { return false; }
+        // --------------------------------------------------------------------
+        virtual void differentNodeColor(int n, video::SColor* c) const
+            OVERRIDE {}
+    public:
+        // --------------------------------------------------------------------
+        void addNode(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2,
+                     const Vec3 &p3)
+        {
+            createQuad(p0, p1, p2, p3, getNumNodes(), /*invisible*/false,
+                       /*ai_ignore*/false, /*is_arena*/true,
+                       /*ignored*/false);
+        }   // addNode
+        // --------------------------------------------------------------------
+        void buildGrid() { buildSectorGrid(); }
+    };   // TestGraph
+}   // namespace GraphTest
+
+// ----------------------------------------------------------------------------
+/** Tests that findRoadSector and findOutOfRoadSector give the same results
+ *  with and without the sector grid.
+ */
+void Graph::unitTesting()
+{
+    GraphTest::TestGraph linear, grid;
+    GraphTest::TestGraph *graphs[2] = { &linear, &grid };
+    for (unsigned int g = 0; g < 2; g++)
+    {
+        // A ring shaped road with a radius of 80 and a width of 8, partly
+        // banked (which creates 3d nodes) ...
+        const float pi = 3.14159265f;
+        for (unsigned int i = 0; i < 120; i++)
+        {
+            const float a0 = i * 2.0f * pi / 120.0f;
+            const float a1 = (i + 1) * 2.0f * pi / 120.0f;
+            const float bank = (i >= 40 && i < 50) ? 6.0f : 0.0f;
+            const Vec3 r0(cosf(a0), 0, sinf(a0)), r1(cosf(a1), 0, sinf(a1));
+            const Vec3 center(100, 0, 100), up(0, bank, 0);
+            graphs[g]->addNode(center + 76 * r0, center + 84 * r0 + up,
+                               center + 84 * r1 + up, center + 76 * r1);
+        }
+        // ... and a bridge crossing it.
+        for (unsigned int i = 0; i < 40; i++)
+        {
+            const float x0 = i * 5.0f, x1 = x0 + 5.0f;
+            graphs[g]->addNode(Vec3(x0, 8, 104), Vec3(x0, 8,  96),
+                               Vec3(x1, 8,  96), Vec3(x1, 8, 104));
+        }
+    }
+    grid.buildGrid();
+
+    const int num_nodes = (int)grid.getNumNodes();
+    const float heights[] = { -3.0f, 0.0f, 0.5f, 3.0f, 8.0f, 8.5f, 12.0f };
+    const unsigned int num_heights = sizeof(heights) / sizeof(heights[0]);
+    std::vector<Vec3> points;
+    std::vector<int>  sectors;
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        const float x = -20.0f + (seed >> 8) % 24000 * 0.01f;
+        seed = seed * 1103515245 + 12345;
+        const float z = -20.0f + (seed >> 8) % 24000 * 0.01f;
+        seed = seed * 1103515245 + 12345;
+        points.push_back(Vec3(x, heights[(seed >> 8) % num_heights], z));
+        seed = seed * 1103515245 + 12345;
+        sectors.push_back((int)((seed >> 8) % (num_nodes + 1)) - 1);
+    }
+
+    unsigned int on_road = 0;
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        for (int ignore_vertical = 0; ignore_vertical < 2; ignore_vertical++)
+        {
+            int linear_sector = sectors[i], grid_sector = sectors[i];
+            linear.findRoadSector(points[i], &linear_sector, NULL,
+                                  ignore_vertical == 1);
+            grid.findRoadSector(points[i], &grid_sector, NULL,
+                                ignore_vertical == 1);
+            assert(linear_sector == grid_sector);
+            if (grid_sector != UNKNOWN_SECTOR) on_road++;
+
+            linear_sector = linear.findOutOfRoadSector(points[i], sectors[i],
+                NULL, ignore_vertical == 1);
+            grid_sector = grid.findOutOfRoadSector(points[i], sectors[i],
+                NULL, ignore_vertical == 1);
+            assert(linear_sector == grid_sector);
+            (void)linear_sector; (void)grid_sector;
+        }
+    }
+    // Make sure that a reasonable number of points was actually on the road
+    assert(on_road > points.size() / 20);
+    (void)on_road;
+}   // unitTesting
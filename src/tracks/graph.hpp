@@ -24,6 +24,7 @@
 
 #include <dimension2d.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -66,6 +67,11 @@ protected:
     // ------------------------------------------------------------------------
     /** Map 4 bounding box points to 4 closest graph nodes. */
     void loadBoundingBoxNodes();
+    // ------------------------------------------------------------------------
+    void buildSectorGrid();
+    // ------------------------------------------------------------------------
+    static void runInParallel(unsigned int count,
+                              const std::function<void(unsigned int)> &f);
 
 private:
     /** The 2d bounding box, used for hashing. */
@@ -75,6 +81,23 @@ private:
     /** The 4 closest graph nodes to the bounding box. */
     int m_bb_nodes[4];
 
+    /** A uniform grid in the XZ plane over all nodes, used to speed up
+     *  findRoadSector() and findOutOfRoadSector(). For each cell the nodes
+     *  whose (2d) bounding box overlaps the cell are stored in m_grid_nodes,
+     *  starting at index m_grid_cell_start[cell]. Empty if no grid was
+     *  built, in which case all nodes are tested. */
+    std::vector<unsigned int> m_grid_cell_start;
+    std::vector<unsigned int> m_grid_nodes;
+
+    /** Minimum X and Z coordinate of the grid. */
+    float m_grid_min_x, m_grid_min_z;
+
+    /** Size of a (square) grid cell, and its inverse. */
+    float m_grid_cell_size, m_grid_inv_cell_size;
+
+    /** Number of cells in X and Z direction. */
+    int m_grid_nx, m_grid_nz;
+
     /** The node of the graph mesh. */
     scene::ISceneNode *m_node;
 
@@ -106,6 +129,12 @@ private:
     virtual bool hasLapLine() const = 0;
     // ------------------------------------------------------------------------
     virtual void differentNodeColor(int n, video::SColor* c) const = 0;
+    // ------------------------------------------------------------------------
+    bool getGridCell(const Vec3 &xyz, int *cx, int *cz) const;
+    // ------------------------------------------------------------------------
+    int findClosestSectorInGrid(const Vec3 &xyz, int first_sector,
+                                bool height_test, bool ignore_vertical,
+                                bool *resolved) const;
 
 public:
     static const int UNKNOWN_SECTOR;
@@ -172,6 +201,8 @@ public:
     const Vec3& getBBMax() const                           { return m_bb_max; }
     // ------------------------------------------------------------------------
     const int* getBBNodes() const                        { return m_bb_nodes; }
+    // ------------------------------------------------------------------------
+    static void unitTesting();
 
 };   // Graph
 
@@ -0,0 +1,140 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "tracks/graph_cache.hpp"
+
+#include "io/disk_cache.hpp"
+#include "io/file_manager.hpp"
+#include "utils/constants.hpp"
+#include "utils/string_utils.hpp"
+
+#include <cstring>
+
+namespace
+{
+    /** Version of the format of cache files, must be increased whenever
+     *  the format (or the data written by any graph) changes. */
+    const uint32_t CACHE_VERSION = 1;
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Creates a cache for a graph loaded from the given files. The files are
+ *  hashed, but nothing is read from or written to the cache yet.
+ *  \param type Type of the graph and any setting the derived data depends
+ *         on (e.g. reverse mode).
+ *  \param files The files the graph is loaded from. Missing files are
+ *         allowed (e.g. a drive graph without graph.xml).
+ */
+GraphCache::GraphCache(const std::string &type,
+                       const std::vector<std::string> &files)
+{
+    m_read = m_end = NULL;
+    DiskCache *disk_cache = file_manager->getGraphCache();
+    if (!disk_cache->isEnabled())
+        return;
+
+    m_key = std::string(STK_VERSION) + "\n" + type + "\n";
+    for (const std::string &file : files)
+    {
+        MappedFile content;
+        char hash[32] = "missing";
+        if (content.open(file))
+        {
+            snprintf(hash, sizeof(hash), "%016llx",
+                     (unsigned long long)DiskCache::hash(content.getData(),
+                                                         content.getSize()));
+        }
+        m_key += StringUtils::getBasename(file) + " " + hash + "\n";
+    }
+    m_file_name = disk_cache->getFileName(DiskCache::hash(m_key.data(),
+                                                          m_key.size()));
+}   // GraphCache
+
+// ----------------------------------------------------------------------------
+/** Opens the cache file and checks that it was written by this version for
+ *  the same graph files. On success the data can be read with the read
+ *  functions.
+ *  \return True if the cache file can be used.
+ */
+bool GraphCache::load()
+{
+    m_read = m_end = NULL;
+    if (m_file_name.empty() || !m_file.open(m_file_name))
+        return false;
+
+    const char *data = m_file.getData();
+    const char *end  = data + m_file.getSize();
+    uint32_t version, little_endian, key_size;
+    if (end - data < 16 || memcmp(data, "STKG", 4) != 0)
+    {
+        m_file.close();
+        return false;
+    }
+    memcpy(&version,       data +  4, sizeof(uint32_t));
+    memcpy(&little_endian, data +  8, sizeof(uint32_t));
+    memcpy(&key_size,      data + 12, sizeof(uint32_t));
+    data += 16;
+    if (version != CACHE_VERSION ||
+        little_endian != (IS_LITTLE_ENDIAN ? 1u : 0u) ||
+        key_size != m_key.size() || (size_t)(end - data) < key_size ||
+        memcmp(data, m_key.data(), key_size) != 0)
+    {
+        m_file.close();
+        return false;
+    }
+    m_read = data + key_size;
+    m_end  = end;
+    file_manager->getGraphCache()->touchFile(m_file_name);
+    return true;
+}   // load
+
+// ----------------------------------------------------------------------------
+/** Reads raw data from a loaded cache file.
+ *  \param out Where to store the data.
+ *  \param size Number of bytes to read.
+ *  \return False if not enough data is left.
+ */
+bool GraphCache::readData(void *out, size_t size)
+{
+    if (!m_read || (size_t)(m_end - m_read) < size)
+        return false;
+    memcpy(out, m_read, size);
+    m_read += size;
+    return true;
+}   // readData
+
+// ----------------------------------------------------------------------------
+/** Writes all data added with the write functions to the cache file. Nothing
+ *  is written if caching is disabled.
+ */
+void GraphCache::save()
+{
+    if (m_file_name.empty())
+        return;
+    // A (rejected) cache file might still be mapped
+    m_file.close();
+    m_read = m_end = NULL;
+
+    std::string data = "STKG";
+    const uint32_t values[3] = { CACHE_VERSION, IS_LITTLE_ENDIAN ? 1u : 0u,
+                                 (uint32_t)m_key.size() };
+    data.append((const char*)values, sizeof(values));
+    data += m_key;
+    data += m_data;
+    file_manager->getGraphCache()->writeFile(m_file_name, data);
+}   // save
@@ -0,0 +1,109 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_GRAPH_CACHE_HPP
+#define HEADER_GRAPH_CACHE_HPP
+
+#include "utils/mapped_file.hpp"
+#include "utils/no_copy.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+  * \ingroup tracks
+  * An on-disk cache of the data that is derived from a drive graph or a
+  * navmesh when a track is loaded, e.g. the shortest paths between all
+  * nodes of an arena. Computing this data is redone on every track load,
+  * which is especially noticeable on servers that load a new track for
+  * each race.
+  *
+  * The cache file is identified by a key that contains the hashes of the
+  * content of the graph files, so any change to them invalidates the
+  * cache. The graph classes write their data with the write functions and
+  * then call save(); after a successful load() they read the data back in
+  * the same order. The read functions fail instead of reading past the end
+  * of the data, but the caller has to validate the values it reads.
+  */
+class GraphCache : public NoCopy
+{
+private:
+    /** Name of the cache file, or empty if caching is disabled. */
+    std::string m_file_name;
+
+    /** The key, which is stored in the file to detect hash collisions. */
+    std::string m_key;
+
+    /** The content of the cache file after a successful load. */
+    MappedFile m_file;
+
+    /** The current read position in m_file, and the end of its data. */
+    const char *m_read, *m_end;
+
+    /** The data to be written by save(). */
+    std::string m_data;
+
+public:
+         GraphCache(const std::string &type,
+                    const std::vector<std::string> &files);
+    bool load();
+    void save();
+    bool readData(void *out, size_t size);
+    // ------------------------------------------------------------------------
+    /** Appends raw data to be saved. */
+    void writeData(const void *data, size_t size)
+    {
+        m_data.append((const char*)data, size);
+    }   // writeData
+    // ------------------------------------------------------------------------
+    /** Reads a single value of a plain data type. */
+    template<typename T> bool read(T *value)
+    {
+        return readData(value, sizeof(T));
+    }   // read
+    // ------------------------------------------------------------------------
+    /** Appends a single value of a plain data type. */
+    template<typename T> void write(const T &value)
+    {
+        writeData(&value, sizeof(T));
+    }   // write
+    // ------------------------------------------------------------------------
+    /** Reads a vector of a plain data type written by writeVector(). */
+    template<typename T> bool readVector(std::vector<T> *v)
+    {
+        uint32_t size;
+        if (!read(&size) || (size_t)(m_end - m_read) / sizeof(T) < size)
+            return false;
+        v->resize(size);
+        return size == 0 || readData(v->data(), size * sizeof(T));
+    }   // readVector
+    // ------------------------------------------------------------------------
+    /** Appends a vector of a plain data type, including its size. */
+    template<typename T> void writeVector(const std::vector<T> &v)
+    {
+        write((uint32_t)v.size());
+        if (!v.empty())
+            writeData(v.data(), v.size() * sizeof(T));
+    }   // writeVector
+    // ------------------------------------------------------------------------
+    /** Returns true if all data of a loaded cache file was read. */
+    bool isAtEnd() const                          { return m_read == m_end; }
+};   // GraphCache
+
+#endif
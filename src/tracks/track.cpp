@@ -48,6 +48,7 @@
 #include "graphics/sp/sp_mesh_node.hpp"
 #include "graphics/sp/sp_shader_manager.hpp"
 #include "graphics/sp/sp_texture_manager.hpp"
+#include "io/disk_cache.hpp"
 #include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
 #include "items/item.hpp"
@@ -62,6 +63,7 @@
 #include "modes/profile_world.hpp"
 #include "network/network_config.hpp"
 #include "network/protocols/server_lobby.hpp"
+#include "physics/collision_cache.hpp"
 #include "physics/physical_object.hpp"
 #include "physics/physics.hpp"
 #include "physics/triangle_mesh.hpp"
@@ -76,6 +78,7 @@
 #include "tracks/track_manager.hpp"
 #include "tracks/track_object_manager.hpp"
 #include "utils/constants.hpp"
+#include "utils/file_utils.hpp"
 #include "utils/log.hpp"
 #include "utils/mini_glm.hpp"
 #include "utils/string_utils.hpp"
@@ -90,8 +93,13 @@
 #include <SMeshBuffer.h>
 
 #include <iostream>
+#include <set>
 #include <stdexcept>
 #include <sstream>
+#include <sys/stat.h>
+#ifdef __linux__
+#  include <unistd.h>
+#endif
 #include <wchar.h>
 
 using namespace irr;
@@ -345,6 +353,7 @@ void Track::cleanup()
         m_static_physics_only_nodes[i]->remove();
     }
     m_static_physics_only_nodes.clear();
+    m_static_physics_only_models.clear();
 
     m_all_emitters.clearAndDeleteAll();
 
@@ -798,7 +807,6 @@ void Track::loadDriveGraph(unsigned int mode_id, const bool reverse)
 
     // setGraph is done in DriveGraph constructor
     assert(DriveGraph::get());
-    DriveGraph::get()->setupPaths();
 #ifdef DEBUG
     for(unsigned int i=0; i<DriveGraph::get()->getNumNodes(); i++)
     {
@@ -861,6 +869,11 @@ void Track::createPhysicsModel(unsigned int main_track_count)
         return;
     }
 
+    // If the collision data of this track was cached, the objects do not
+    // need to be converted into triangles, and the BVHs can be loaded.
+    std::vector<TriangleMesh*> meshes = { m_track_mesh, m_gfx_effect_mesh };
+    CollisionCache cache(getCollisionCacheKey(main_track_count));
+    const bool cached = cache.load(meshes);
 
     // Now convert all objects that are only used for the physics
     // (like invisible walls).
@@ -868,7 +881,8 @@ void Track::createPhysicsModel(unsigned int main_track_count)
     {
         main_loop->renderGUI(5550, i, m_static_physics_only_nodes.size());
 
-        convertTrackToBullet(m_static_physics_only_nodes[i]);
+        if (!cached)
+            convertTrackToBullet(m_static_physics_only_nodes[i]);
         if (UserConfigParams::m_physics_debug &&
             m_static_physics_only_nodes[i]->getType() == scene::ESNT_MESH)
         {
@@ -887,6 +901,26 @@ void Track::createPhysicsModel(unsigned int main_track_count)
         else
             irr_driver->removeNode(m_static_physics_only_nodes[i]);
     }
+    for (unsigned int i = 0; i < m_static_physics_only_models.size(); i++)
+    {
+        if (cached)
+            break;
+        const std::string &full_path = m_static_physics_only_models[i].first;
+        scene::IMesh *mesh = irr_driver->getMesh(full_path);
+        if (!mesh)
+        {
+            Log::error("track", "Object model '%s' not found, ignored.",
+                       full_path.c_str());
+            continue;
+        }
+        // Keep track of the mesh like all other meshes loaded by the track,
+        // so that it is removed from the mesh cache in cleanup.
+        m_all_cached_meshes.push_back(mesh);
+        irr_driver->grabAllTextures(mesh);
+        mesh->grab();
+        convertMeshToBullet(mesh, m_static_physics_only_models[i].second);
+    }
+    m_static_physics_only_models.clear();
     main_loop->renderGUI(5560);
     if (!UserConfigParams::m_physics_debug)
         m_static_physics_only_nodes.clear();
@@ -894,7 +928,8 @@ void Track::createPhysicsModel(unsigned int main_track_count)
     for (unsigned int i = 0; i<m_object_physics_only_nodes.size(); i++)
     {
         main_loop->renderGUI(5565, i, m_static_physics_only_nodes.size());
-        convertTrackToBullet(m_object_physics_only_nodes[i]);
+        if (!cached)
+            convertTrackToBullet(m_object_physics_only_nodes[i]);
         m_object_physics_only_nodes[i]->setVisible(false);
         m_object_physics_only_nodes[i]->grab();
         irr_driver->removeNode(m_object_physics_only_nodes[i]);
@@ -905,70 +940,219 @@ void Track::createPhysicsModel(unsigned int main_track_count)
     for(unsigned int i=main_track_count; i<m_all_nodes.size(); i++)
     {
         main_loop->renderGUI(5570, i, m_all_nodes.size());
-        convertTrackToBullet(m_all_nodes[i]);
+        if (!cached)
+            convertTrackToBullet(m_all_nodes[i]);
         uploadNodeVertexBuffer(m_all_nodes[i]);
     }
     main_loop->renderGUI(5580);
-    m_track_mesh->createPhysicalBody(m_friction);
+    m_track_mesh->createPhysicalBody(m_friction,
+                                     (btCollisionObject::CollisionFlags)0,
+                                     cache.getBvh(0), cache.getBvhSize(0));
     main_loop->renderGUI(5585);
-    m_gfx_effect_mesh->createCollisionShape();
+    m_gfx_effect_mesh->createCollisionShape(true, cache.getBvh(1),
+                                            cache.getBvhSize(1));
+    if (!cached)
+        cache.save(meshes);
     main_loop->renderGUI(5590);
 
 }   // createPhysicsModel
 
 // -----------------------------------------------------------------------------
-
-
-/** Convert the graohics track into its physics equivalents.
- *  \param mesh The mesh to convert.
- *  \param node The scene node.
+/** Returns the mesh of a scene node that is converted into physics, and
+ *  updates the absolute transformation of the node. LOD nodes are replaced
+ *  by their first node.
+ *  \param node The scene node, replaced by the node whose mesh is returned.
+ *  \param log_problems Print a message for empty LOD groups and unknown
+ *         types of scene nodes.
+ *  \return The mesh, or NULL if the node is not physical.
  */
-void Track::convertTrackToBullet(scene::ISceneNode *node)
+static scene::IMesh *getPhysicsMesh(scene::ISceneNode **node,
+                                    bool log_problems)
 {
-    if (node->getType() == scene::ESNT_TEXT)
-        return;
+    if ((*node)->getType() == scene::ESNT_TEXT)
+        return NULL;
 
-    if (node->getType() == scene::ESNT_LOD_NODE)
+    if ((*node)->getType() == scene::ESNT_LOD_NODE)
     {
-        node = ((LODNode*)node)->getFirstNode();
-        if (node == NULL)
+        *node = ((LODNode*)*node)->getFirstNode();
+        if (*node == NULL)
         {
-            Log::warn("track",
-                      "This track contains an empty LOD group.");
-            return;
+            if (log_problems)
+                Log::warn("track",
+                          "This track contains an empty LOD group.");
+            return NULL;
         }
     }
-    node->updateAbsolutePosition();
+    (*node)->updateAbsolutePosition();
 
-    std::vector<core::matrix4> matrices;
-    matrices.push_back(node->getAbsoluteTransformation());
-
-    scene::IMesh *mesh;
-    switch(node->getType())
+    switch((*node)->getType())
     {
         case scene::ESNT_MESH          :
         case scene::ESNT_WATER_SURFACE :
         case scene::ESNT_OCTREE        :
-             mesh = ((scene::IMeshSceneNode*)node)->getMesh();
-             break;
+             return ((scene::IMeshSceneNode*)*node)->getMesh();
         case scene::ESNT_ANIMATED_MESH :
-             mesh = ((scene::IAnimatedMeshSceneNode*)node)->getMesh();
-             break;
+             return ((scene::IAnimatedMeshSceneNode*)*node)->getMesh();
         case scene::ESNT_SKY_BOX :
         case scene::ESNT_SKY_DOME:
         case scene::ESNT_PARTICLE_SYSTEM :
         case scene::ESNT_TEXT:
             // These are non-physical
-            return;
-            break;
+            return NULL;
         default:
-            int type_as_int = node->getType();
-            char* type = (char*)&type_as_int;
-            Log::debug("track",
-                "[convertTrackToBullet] Unknown scene node type : %c%c%c%c.\n",
-                   type[0], type[1], type[2], type[3]);
-            return;
+            if (log_problems)
+            {
+                int type_as_int = (*node)->getType();
+                char* type = (char*)&type_as_int;
+                Log::debug("track",
+                    "[convertTrackToBullet] Unknown scene node type : "
+                    "%c%c%c%c.\n", type[0], type[1], type[2], type[3]);
+            }
+            return NULL;
     }   // switch node->getType()
+}   // getPhysicsMesh
+
+// ----------------------------------------------------------------------------
+/** Hashes everything convertMeshToBullet uses from a mesh: the vertices,
+ *  the indices and the textures that select the material of the triangles.
+ *  \param mesh The mesh.
+ *  \param transform The transformation applied to the vertices.
+ *  \param hash The hash to continue.
+ */
+static uint64_t hashPhysicsMesh(scene::IMesh *mesh,
+                                const core::matrix4 &transform, uint64_t hash)
+{
+    hash = DiskCache::hash(transform.pointer(), 16 * sizeof(f32), hash);
+    for (unsigned int i = 0; i < mesh->getMeshBufferCount(); i++)
+    {
+        scene::IMeshBuffer *mb = mesh->getMeshBuffer(i);
+        const uint32_t counts[3] = { (uint32_t)mb->getVertexType(),
+                                     mb->getVertexCount(),
+                                     mb->getIndexCount() };
+        hash = DiskCache::hash(counts, sizeof(counts), hash);
+        hash = DiskCache::hash(mb->getVertices(), mb->getVertexCount() *
+                       video::getVertexPitchFromType(mb->getVertexType()),
+                               hash);
+        hash = DiskCache::hash(mb->getIndices(), mb->getIndexCount() *
+                               (mb->getIndexType() == video::EIT_16BIT ? 2 : 4),
+                               hash);
+#ifndef SERVER_ONLY
+        SP::SPMeshBuffer *spmb = dynamic_cast<SP::SPMeshBuffer*>(mb);
+        if (spmb)
+        {
+            const Material *last = NULL;
+            for (unsigned int j = 0; j < mb->getIndexCount(); j += 3)
+            {
+                const Material *material = spmb->getSTKMaterial(j);
+                if (material == last)
+                    continue;
+                last = material;
+                const std::string name = StringUtils::toString(j) + " " +
+                                         (material ? material->getTexFname()
+                                                   : std::string());
+                hash = DiskCache::hash(name.data(), name.size(), hash);
+            }
+            continue;
+        }
+#endif
+        for (unsigned int layer = 0; layer < 2; layer++)
+        {
+            video::ITexture *t = mb->getMaterial().getTexture(layer);
+            const std::string name = t ? t->getName().getPtr() : "";
+            hash = DiskCache::hash(name.c_str(), name.size() + 1, hash);
+        }
+    }
+    return hash;
+}   // hashPhysicsMesh
+
+// -----------------------------------------------------------------------------
+/** Returns a description of everything the collision data of this track
+ *  depends on, which is used to find the cached collision data (see
+ *  CollisionCache). This includes the names, sizes and modification times
+ *  of all files of the track, the race settings that influence which
+ *  objects are loaded, and a hash of the meshes of all loaded objects that
+ *  are converted into triangles (which includes library objects and models
+ *  outside of the track directory). Models that are only loaded if the
+ *  collision data is not cached are identified by their file.
+ *  \param main_track_count The number of nodes of the main track.
+ */
+std::string Track::getCollisionCacheKey(unsigned int main_track_count) const
+{
+    std::ostringstream key;
+    key << STK_VERSION << "\n" << m_root << "\n"
+        << stk_config->m_smooth_angle_limit << " "
+        << race_manager->getMinorMode() << " "
+        << race_manager->getReverseTrack() << " "
+        << main_track_count << " " << m_all_nodes.size() << " "
+        << m_static_physics_only_nodes.size() << " "
+        << m_static_physics_only_models.size() << " "
+        << m_object_physics_only_nodes.size() << "\n";
+
+    std::set<std::string> files;
+    file_manager->listFiles(files, m_root);
+    for (const std::string &file : files)
+    {
+        struct stat st;
+        if (FileUtils::statU8Path(m_root + "/" + file, &st) != 0 ||
+            !S_ISREG(st.st_mode))
+            continue;
+        key << file << " " << (uint64_t)st.st_size << " "
+            << (uint64_t)st.st_mtime << "\n";
+    }
+
+    uint64_t hash = DiskCache::HASH_START;
+    std::vector<scene::ISceneNode*> nodes = m_all_nodes;
+    nodes.insert(nodes.end(), m_static_physics_only_nodes.begin(),
+                 m_static_physics_only_nodes.end());
+    nodes.insert(nodes.end(), m_object_physics_only_nodes.begin(),
+                 m_object_physics_only_nodes.end());
+    for (scene::ISceneNode *node : nodes)
+    {
+        scene::IMesh *mesh = getPhysicsMesh(&node, /*log_problems*/false);
+        if (mesh)
+            hash = hashPhysicsMesh(mesh, node->getAbsoluteTransformation(),
+                                   hash);
+    }
+    key << std::hex << hash << std::dec << "\n";
+
+    for (const auto &model : m_static_physics_only_models)
+    {
+        struct stat st;
+        if (FileUtils::statU8Path(model.first, &st) != 0)
+            st.st_size = st.st_mtime = 0;
+        key << model.first << " " << (uint64_t)st.st_size << " "
+            << (uint64_t)st.st_mtime;
+        for (unsigned int i = 0; i < 16; i++)
+            key << " " << model.second[i];
+        key << "\n";
+    }
+    return key.str();
+}   // getCollisionCacheKey
+
+// -----------------------------------------------------------------------------
+
+
+/** Convert the graohics track into its physics equivalents.
+ *  \param node The scene node.
+ */
+void Track::convertTrackToBullet(scene::ISceneNode *node)
+{
+    scene::IMesh *mesh = getPhysicsMesh(&node, /*log_problems*/true);
+    if (mesh)
+        convertMeshToBullet(mesh, node->getAbsoluteTransformation());
+}   // convertTrackToBullet
+
+// ----------------------------------------------------------------------------
+/** Converts a mesh into its physics equivalent, i.e. adds its triangles to
+ *  the track mesh or the gfx effect mesh (depending on the material).
+ *  \param mesh The mesh to convert.
+ *  \param transform The transformation to apply to all vertices.
+ */
+void Track::convertMeshToBullet(scene::IMesh *mesh,
+                                const core::matrix4 &transform)
+{
+    std::vector<core::matrix4> matrices;
+    matrices.push_back(transform);
 
     //core::matrix4 mat;
     //mat.setRotationDegrees(hpr);
@@ -1147,7 +1331,7 @@ void Track::convertTrackToBullet(scene::ISceneNode *node)
         }
     }   // for i<getMeshBufferCount
 
-}   // convertTrackToBullet
+}   // convertMeshToBullet
 
 // ----------------------------------------------------------------------------
 
@@ -1338,6 +1522,24 @@ bool Track::loadMainTrack(const XMLNode &root)
         bool lod_instance = false;
         n->get("lod_instance", &lod_instance);
 
+        // Without graphics a physics-only model is only needed for its
+        // triangles, so no scene node is created. The model is only loaded
+        // when the physics model is created, and not at all if the
+        // collision data of the track is cached.
+        if (interaction == "physics-only" && challenge.empty() &&
+            !lod_instance && ProfileWorld::isNoGraphics())
+        {
+            core::matrix4 transform;
+            transform.setRotationDegrees(hpr);
+            transform.setTranslation(xyz);
+            core::matrix4 scale_matrix;
+            scale_matrix.setScale(scale);
+            transform *= scale_matrix;
+            m_static_physics_only_models.push_back(
+                std::make_pair(full_path, transform));
+            continue;
+        }
+
         if (lod_instance)
         {
             LODNode* node = lodLoader.instanciateAsLOD(n, NULL, NULL);
@@ -1731,6 +1933,28 @@ void Track::createWater(const XMLNode &node)
     scene_node->getMaterial(0).setFlag(video::EMF_GOURAUD_SHADING, true);
 }   // createWater
 
+// ----------------------------------------------------------------------------
+/** Returns the resident memory of this process in MB, or -1 if this is not
+ *  supported on this platform. Used to log the memory used by a track.
+ */
+static int getResidentMemoryMB()
+{
+#ifdef __linux__
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return -1;
+    unsigned long size = 0, resident = 0;
+    const int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+    if (n != 2)
+        return -1;
+    return (int)(resident * (unsigned long)sysconf(_SC_PAGESIZE) /
+                 (1024 * 1024));
+#else
+    return -1;
+#endif
+}   // getResidentMemoryMB
+
 // ----------------------------------------------------------------------------
 static void recursiveUpdatePosition(scene::ISceneNode *node)
 {
@@ -1777,6 +2001,7 @@ static void recursiveUpdatePhysics(std::vector<TrackObject*>& tos)
 void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
 {
     assert(!m_current_track);
+    const uint64_t start_time = StkTime::getMonoTimeMs();
 
     // Use m_filename to also get the path, not only the identifier
     STKTexManager::getInstance()
@@ -2253,6 +2478,14 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
     main_loop->renderGUI(6100);
 
     STKTexManager::getInstance()->unsetTextureErrorMessage();
+    // Servers load a track for each race, so log the cost of doing so
+    if (NetworkConfig::get()->isServer())
+    {
+        Log::info("Track", "Loaded '%s' in %d ms, resident memory %d MB.",
+                  m_ident.c_str(),
+                  (int)(StkTime::getMonoTimeMs() - start_time),
+                  getResidentMemoryMB());
+    }
 #ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
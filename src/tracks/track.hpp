@@ -150,6 +150,12 @@ private:
       */
     std::vector<scene::ISceneNode*> m_object_physics_only_nodes;
 
+    /** Without graphics, the file name and transformation of the models
+     *  that would be in m_static_physics_only_nodes. They are only loaded
+     *  in createPhysicsModel if the collision data is not cached. */
+    std::vector<std::pair<std::string, core::matrix4> >
+                                    m_static_physics_only_models;
+
     /** The list of all meshes that are loaded from disk, which means
      *  that those meshes are being cached by irrlicht, and need to be freed. */
     std::vector<scene::IMesh*>      m_all_cached_meshes;
@@ -396,6 +402,7 @@ private:
     btQuaternion getArenaStartRotation(const Vec3& xyz, float heading);
     bool loadMainTrack(const XMLNode &node);
     void loadMinimap();
+    std::string getCollisionCacheKey(unsigned int main_track_count) const;
     void createWater(const XMLNode &node);
     void getMusicInformation(std::vector<std::string>&  filenames,
                              std::vector<MusicInformation*>& m_music   );
@@ -706,6 +713,8 @@ public:
     bool isAddon() const                                 { return m_is_addon; }
     // ------------------------------------------------------------------------
     void convertTrackToBullet(scene::ISceneNode *node);
+    void convertMeshToBullet(scene::IMesh *mesh,
+                             const core::matrix4 &transform);
 };   // class Track
 
 #endif
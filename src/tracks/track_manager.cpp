@@ -22,6 +22,7 @@
 #include "graphics/irr_driver.hpp"
 #include "io/file_manager.hpp"
 #include "tracks/track.hpp"
+#include "utils/string_utils.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -177,6 +178,39 @@ void TrackManager::loadTrackList()
     }   // for i <m_track_search_path.size()
 }  // loadTrackList
 
+// ----------------------------------------------------------------------------
+/** Appends the names of the XML files read when loading the track list
+ *  (using the same directory search as loadTrackList), so that they can be
+ *  parsed in advance, see FileManager::preloadXMLTrees.
+ *  \param files The file names are appended to this vector.
+ */
+void TrackManager::getXMLFiles(std::vector<std::string> *files) const
+{
+    for (const std::string &dir : m_track_search_path)
+    {
+        std::vector<std::string> track_dirs;
+        if (file_manager->fileExists(dir + "track.xml"))
+            track_dirs.push_back(dir);
+        else
+        {
+            std::set<std::string> dirs;
+            file_manager->listFiles(dirs, dir);
+            for (const std::string &subdir : dirs)
+            {
+                if (subdir != "." && subdir != "..")
+                    track_dirs.push_back(dir + subdir + "/");
+            }
+        }
+        for (const std::string &track_dir : track_dirs)
+        {
+            files->push_back(track_dir + "track.xml");
+            // Track::loadTrackInfo uses the path without the trailing '/'
+            files->push_back(StringUtils::getPath(track_dir + "track.xml") +
+                             "/easter_eggs.xml");
+        }
+    }
+}   // getXMLFiles
+
 // ----------------------------------------------------------------------------
 /** Tries to load a track from a single directory. Returns true if a track was
  *  successfully loaded.
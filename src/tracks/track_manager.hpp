@@ -79,6 +79,7 @@ public:
 
     /** Load all .track files from all directories */
     void  loadTrackList();
+    void  getXMLFiles(std::vector<std::string> *files) const;
     void  removeTrack(const std::string &ident);
     bool  loadTrack(const std::string& dirname);
     void  removeAllCachedData();
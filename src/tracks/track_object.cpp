@@ -553,6 +553,42 @@ void TrackObject::update(float dt)
     if (m_animator) m_animator->updateWithWorldTicks(true/*has_physics*/);
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Returns true if update() has any effect for this object, i.e. if it has
+ *  a scripted library node, a dynamic physical object, or an animation that
+ *  moves its physical body. The type of an object does not change after it
+ *  is created.
+ */
+bool TrackObject::needsUpdate() const
+{
+    return (m_presentation && m_presentation->needsUpdate()) ||
+           (m_physical_object && m_physical_object->isDynamic()) ||
+           (m_animator && m_physical_object);
+}   // needsUpdate
+
+// ----------------------------------------------------------------------------
+/** Returns true if updateGraphics() has any effect for this object.
+ */
+bool TrackObject::needsUpdateGraphics() const
+{
+    return (m_presentation && m_presentation->needsUpdateGraphics()) ||
+           (m_physical_object && m_physical_object->isDynamic()) ||
+           (m_animator && !m_physical_object);
+}   // needsUpdateGraphics
+
+// ----------------------------------------------------------------------------
+/** Returns true if updateGraphics() only plays an animation that has no
+ *  influence on the physics or any other object. Since the animation is
+ *  computed from the world time, such objects can be updated less often.
+ *  Cutscene cameras are excluded, since the camera follows them.
+ */
+bool TrackObject::hasOnlyCosmeticAnimation() const
+{
+    return m_animator && !m_physical_object && m_children.empty() &&
+           m_movable_children.empty() && m_type != "cutscene_camera" &&
+           !(m_presentation && m_presentation->needsUpdateGraphics());
+}   // hasOnlyCosmeticAnimation
+
 
 // ----------------------------------------------------------------------------
 /** This reset all physical object moved by 3d animation back to current ticks
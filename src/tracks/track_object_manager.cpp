@@ -24,6 +24,7 @@
 #include "graphics/lod_node.hpp"
 #include "graphics/material_manager.hpp"
 #include "io/xml_node.hpp"
+#include "graphics/camera.hpp"
 #include "network/network_config.hpp"
 #include "physics/physical_object.hpp"
 #include "tracks/track_object.hpp"
@@ -32,8 +33,16 @@
 #include <IMeshSceneNode.h>
 #include <ISceneManager.h>
 
+/** Far away cosmetic animations are only updated every that many frames. */
+static const unsigned int COSMETIC_UPDATE_INTERVAL = 4;
+/** Cosmetic animations closer than this to a camera are updated every
+ *  frame. */
+static const float COSMETIC_UPDATE_DISTANCE = 100.0f;
+
 TrackObjectManager::TrackObjectManager()
 {
+    m_update_lists_dirty = true;
+    m_graphics_frame     = 0;
 }   // TrackObjectManager
 
 // ----------------------------------------------------------------------------
@@ -55,6 +64,7 @@ void TrackObjectManager::add(const XMLNode &xml_node, scene::ISceneNode* parent,
         m_all_objects.push_back(obj);
         if(obj->isDriveable())
             m_driveable_objects.push_back(obj);
+        m_update_lists_dirty = true;
     }
     catch (std::exception& e)
     {
@@ -170,26 +180,74 @@ void TrackObjectManager::handleExplosion(const Vec3 &pos, const PhysicalObject *
 }   // handleExplosion
 
 // ----------------------------------------------------------------------------
-/** Updates all track objects.
+/** Sorts all track objects into the lists of objects that need to be
+ *  updated. This is done lazily, since library objects get their children
+ *  only after they were added.
+ */
+void TrackObjectManager::buildUpdateLists()
+{
+    m_update_objects.clearWithoutDeleting();
+    m_graphics_objects.clearWithoutDeleting();
+    m_cosmetic_objects.clearWithoutDeleting();
+    for (TrackObject* curr : m_all_objects)
+    {
+        if (curr->needsUpdate())
+            m_update_objects.push_back(curr);
+        if (curr->hasOnlyCosmeticAnimation())
+            m_cosmetic_objects.push_back(curr);
+        else if (curr->needsUpdateGraphics())
+            m_graphics_objects.push_back(curr);
+    }
+    m_update_lists_dirty = false;
+}   // buildUpdateLists
+
+// ----------------------------------------------------------------------------
+/** Updates the graphics of all track objects that need it. Objects that
+ *  only have a cosmetic animation are updated every frame if they are
+ *  close to a camera, otherwise only every COSMETIC_UPDATE_INTERVAL frames
+ *  (at a different frame for each object to spread the work).
  *  \param dt Time step size.
  */
 void TrackObjectManager::updateGraphics(float dt)
 {
+    if (m_update_lists_dirty)
+        buildUpdateLists();
+
     TrackObject* curr;
-    for_in(curr, m_all_objects)
+    for_in(curr, m_graphics_objects)
     {
         curr->updateGraphics(dt);
     }
+
+    m_graphics_frame++;
+    const float max_distance2 = COSMETIC_UPDATE_DISTANCE
+                              * COSMETIC_UPDATE_DISTANCE;
+    for (unsigned int i = 0; i < m_cosmetic_objects.size(); i++)
+    {
+        curr = m_cosmetic_objects.get(i);
+        bool update = (m_graphics_frame + i) % COSMETIC_UPDATE_INTERVAL == 0;
+        for (unsigned int j = 0; !update && j < Camera::getNumCameras(); j++)
+        {
+            Vec3 xyz(curr->getAbsolutePosition());
+            update = (xyz - Camera::getCamera(j)->getXYZ()).length2()
+                   < max_distance2;
+        }
+        if (update)
+            curr->updateGraphics(dt);
+    }
 }   // updateGraphics
 
 // ----------------------------------------------------------------------------
-/** Updates all track objects.
+/** Updates all track objects that need to be updated every time step.
  *  \param dt Time step size.
  */
 void TrackObjectManager::update(float dt)
 {
+    if (m_update_lists_dirty)
+        buildUpdateLists();
+
     TrackObject* curr;
-    for_in (curr, m_all_objects)
+    for_in (curr, m_update_objects)
     {
         curr->update(dt);
     }
@@ -271,6 +329,7 @@ bool TrackObjectManager::castRay(const btVector3 &from,
 void TrackObjectManager::insertObject(TrackObject* object)
 {
     m_all_objects.push_back(object);
+    m_update_lists_dirty = true;
 }
 
 // ----------------------------------------------------------------------------
@@ -281,5 +340,9 @@ void TrackObjectManager::insertObject(TrackObject* object)
 void TrackObjectManager::removeObject(TrackObject* obj)
 {
     m_all_objects.remove(obj);
+    // Remove it now, the lists might not be rebuilt before the next update
+    m_update_objects.remove(obj);
+    m_graphics_objects.remove(obj);
+    m_cosmetic_objects.remove(obj);
     delete obj;
 }   // removeObject
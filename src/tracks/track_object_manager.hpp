@@ -51,6 +51,28 @@ protected:
     /** A second list which holds all objects that karts can drive on. */
     PtrVector<TrackObject, REF> m_driveable_objects;
 
+    /** All objects for which update() must be called every time step
+     *  (scripted, physical or with a physics-driven animation). Static
+     *  meshes and triggers are not in any of the update lists. */
+    PtrVector<TrackObject, REF> m_update_objects;
+
+    /** All objects for which updateGraphics() must be called every frame. */
+    PtrVector<TrackObject, REF> m_graphics_objects;
+
+    /** Objects with a purely cosmetic animation, which are only updated
+     *  every few frames when far away from all cameras. */
+    PtrVector<TrackObject, REF> m_cosmetic_objects;
+
+    /** True if objects were added or removed since the update lists were
+     *  created. */
+    bool m_update_lists_dirty;
+
+    /** Counts the calls to updateGraphics, used to distribute the updates
+     *  of far away cosmetic objects over several frames. */
+    unsigned int m_graphics_frame;
+
+    void buildUpdateLists();
+
 public:
          TrackObjectManager();
         ~TrackObjectManager();
@@ -91,6 +91,13 @@ public:
     }
     virtual void updateGraphics(float dt) {}
     virtual void update(float dt) {}
+    // ------------------------------------------------------------------------
+    /** Returns true if this presentation implements update(), i.e. it must
+     *  be called every time step. */
+    virtual bool needsUpdate() const { return false; }
+    // ------------------------------------------------------------------------
+    /** Returns true if this presentation implements updateGraphics(). */
+    virtual bool needsUpdateGraphics() const { return false; }
     virtual void move(const core::vector3df& xyz, const core::vector3df& hpr,
         const core::vector3df& scale, bool isAbsoluteCoord) {}
 
@@ -201,6 +208,7 @@ public:
         ModelDefinitionLoader& model_def_loader);
     virtual ~TrackObjectPresentationLibraryNode();
     virtual void update(float dt) OVERRIDE;
+    virtual bool needsUpdate() const OVERRIDE { return true; }
     virtual void reset() OVERRIDE
     {
         m_reset_executed = false;
@@ -296,6 +304,7 @@ public:
     virtual ~TrackObjectPresentationSound();
     void onTriggerItemApproached(int kart_id);
     virtual void updateGraphics(float dt) OVERRIDE;
+    virtual bool needsUpdateGraphics() const OVERRIDE { return true; }
     virtual void move(const core::vector3df& xyz, const core::vector3df& hpr,
         const core::vector3df& scale, bool isAbsoluteCoord) OVERRIDE;
     void triggerSound(bool loop);
@@ -326,6 +335,7 @@ public:
                                      scene::ISceneNode* parent);
     virtual ~TrackObjectPresentationBillboard();
     virtual void updateGraphics(float dt) OVERRIDE;
+    virtual bool needsUpdateGraphics() const OVERRIDE { return true; }
 };   // TrackObjectPresentationBillboard
 
 
@@ -348,6 +358,7 @@ public:
     virtual ~TrackObjectPresentationParticles();
 
     virtual void updateGraphics(float dt) OVERRIDE;
+    virtual bool needsUpdateGraphics() const OVERRIDE { return true; }
     void triggerParticles();
     void stop();
     void stopIn(double delay);
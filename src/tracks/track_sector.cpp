@@ -125,13 +125,23 @@ void TrackSector::update(const Vec3 &xyz, bool ignore_vertical)
     DriveGraph::get()->spatialToTrack(&m_current_track_coords, xyz,
         m_current_graph_node);
 
-    if (m_last_valid_graph_node != Graph::UNKNOWN_SECTOR)
+    // Usually the last valid and estimated valid node are the current
+    // node, in which case the coordinates just computed can be reused.
+    if (m_last_valid_graph_node == m_current_graph_node)
+    {
+        m_latest_valid_track_coords = m_current_track_coords;
+    }
+    else if (m_last_valid_graph_node != Graph::UNKNOWN_SECTOR)
     {
         DriveGraph::get()->spatialToTrack(&m_latest_valid_track_coords, xyz,
             m_last_valid_graph_node);
     }
 
-    if (m_estimated_valid_graph_node != Graph::UNKNOWN_SECTOR)
+    if (m_estimated_valid_graph_node == m_current_graph_node)
+    {
+        m_estimated_valid_track_coords = m_current_track_coords;
+    }
+    else if (m_estimated_valid_graph_node != Graph::UNKNOWN_SECTOR)
     {
         DriveGraph::get()->spatialToTrack(&m_estimated_valid_track_coords, xyz,
             m_estimated_valid_graph_node);
@@ -19,9 +19,18 @@
 #include "utils/log.hpp"
 #include "utils/string_utils.hpp"
 
+#include <chrono>
+#include <functional>
 #include <stdio.h>
 #include <string>
 #include <sys/stat.h>
+#include <thread>
+#if defined(WIN32)
+#include <sys/utime.h>
+#else
+#include <unistd.h>
+#include <utime.h>
+#endif
 
 // ----------------------------------------------------------------------------
 #if defined(WIN32)
@@ -166,3 +175,51 @@ int FileUtils::renameU8Path(const std::string& u8_path_old,
     return rename(u8_path_old.c_str(), u8_path_new.c_str());
 #endif
 }   // renameU8Path
+
+// ----------------------------------------------------------------------------
+/** Like renameU8Path, but an existing file u8_path_new is replaced in one
+ *  step on all systems, so readers either see the old or the new file.
+ */
+int FileUtils::replaceU8Path(const std::string& u8_path_old,
+                             const std::string& u8_path_new)
+{
+#if defined(WIN32)
+    return MoveFileExW(StringUtils::utf8ToWide(u8_path_old).c_str(),
+        StringUtils::utf8ToWide(u8_path_new).c_str(),
+        MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+    return rename(u8_path_old.c_str(), u8_path_new.c_str());
+#endif
+}   // replaceU8Path
+
+// ----------------------------------------------------------------------------
+/** Sets the access and modification time of a file to the current time,
+ *  with unicode path capability.
+ */
+int FileUtils::touchU8Path(const std::string& u8_path)
+{
+#if defined(WIN32)
+    return _wutime(StringUtils::utf8ToWide(u8_path).c_str(), NULL);
+#else
+    return utime(u8_path.c_str(), NULL);
+#endif
+}   // touchU8Path
+
+// ----------------------------------------------------------------------------
+/** Returns the name of a temporary file next to u8_path, which is unique
+ *  for the calling process and thread. A file is written to this name
+ *  and then moved to u8_path with replaceU8Path, so no other thread or
+ *  process reads a partially written file.
+ */
+std::string FileUtils::getUniqueTmpPath(const std::string& u8_path)
+{
+#if defined(WIN32)
+    const size_t pid = (size_t)GetCurrentProcessId();
+#else
+    const size_t pid = (size_t)getpid();
+#endif
+    const size_t unique = pid * 31 ^
+        std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+        (size_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    return u8_path + "." + StringUtils::toString(unique) + ".tmp";
+}   // getUniqueTmpPath
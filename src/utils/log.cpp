@@ -22,9 +22,15 @@
 #include "network/network_config.hpp"
 #include "utils/file_utils.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <ctime>
+#include <mutex>
 #include <stdio.h>
+#include <string.h>
+#include <thread>
 
 #ifdef ANDROID
 #  include <android/log.h>
@@ -41,8 +47,124 @@ FILE*         Log::m_file_stdout   = NULL;
 std::string   Log::m_prefix        = "";
 size_t        Log::m_buffer_size = 1;
 bool          Log::m_console_log = true;
+unsigned int  Log::m_rate_limit  = 1000;
 Synchronised<std::vector<struct Log::LineInfo> > Log::m_line_buffer;
 
+namespace
+{
+    // ------------------------------------------------------------------------
+    /** A bounded multi-producer queue of log lines (see Dmitry Vyukov's
+     *  bounded MPMC queue). Adding a line only needs an atomic compare and
+     *  exchange, so logging threads never wait for each other or for the
+     *  writer thread. */
+    class LineQueue
+    {
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> m_sequence;
+            std::string         m_line;
+            int                 m_level;
+        };
+        static const size_t SIZE = 4096;
+        Cell m_cells[SIZE];
+        std::atomic<size_t> m_enqueue_pos;
+        std::atomic<size_t> m_dequeue_pos;
+
+    public:
+        LineQueue() : m_enqueue_pos(0), m_dequeue_pos(0)
+        {
+            for (size_t i = 0; i < SIZE; i++)
+                m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        }   // LineQueue
+        // --------------------------------------------------------------------
+        /** Adds a line, returns false if the queue is full. */
+        bool push(const char *line, int level)
+        {
+            size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            Cell *cell;
+            while (true)
+            {
+                cell = &m_cells[pos & (SIZE - 1)];
+                size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+                if (dif == 0)
+                {
+                    if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                        std::memory_order_relaxed))
+                        break;
+                }
+                else if (dif < 0)
+                    return false;
+                else
+                    pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+            cell->m_line  = line;
+            cell->m_level = level;
+            cell->m_sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }   // push
+        // --------------------------------------------------------------------
+        /** Removes the oldest line, returns false if the queue is empty. */
+        bool pop(std::string *line, int *level)
+        {
+            size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            Cell *cell;
+            while (true)
+            {
+                cell = &m_cells[pos & (SIZE - 1)];
+                size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+                if (dif == 0)
+                {
+                    if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                        std::memory_order_relaxed))
+                        break;
+                }
+                else if (dif < 0)
+                    return false;
+                else
+                    pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+            line->swap(cell->m_line);
+            *level = cell->m_level;
+            cell->m_sequence.store(pos + SIZE, std::memory_order_release);
+            return true;
+        }   // pop
+        // --------------------------------------------------------------------
+        /** Returns true if the queue is more than half full. */
+        bool isHalfFull() const
+        {
+            return m_enqueue_pos.load(std::memory_order_relaxed) -
+                   m_dequeue_pos.load(std::memory_order_relaxed) > SIZE / 2;
+        }   // isHalfFull
+    };   // LineQueue
+
+    // ------------------------------------------------------------------------
+    /** Per-component counters for the rate limit. Components are mapped to
+     *  slots by a hash of their name, so components sharing a slot share
+     *  their limit. */
+    struct RateSlot
+    {
+        std::atomic<int64_t>  m_second;
+        std::atomic<uint32_t> m_count;
+        std::atomic<uint32_t> m_suppressed;
+    };
+    const unsigned int NUM_RATE_SLOTS = 64;
+    RateSlot g_rate_slots[NUM_RATE_SLOTS];
+
+    /** The queue and writer thread used when logging asynchronously. */
+    LineQueue*              g_line_queue = NULL;
+    std::atomic<bool>       g_async(false);
+    std::atomic<bool>       g_stop_writer(false);
+    std::atomic<uint32_t>   g_dropped_lines(0);
+    std::thread             g_writer_thread;
+    std::mutex              g_writer_mutex;
+    std::condition_variable g_writer_cv;
+    /** Makes sure that only one thread writes queued lines at a time. */
+    std::mutex              g_output_mutex;
+}   // anonymous namespace
+
 // ----------------------------------------------------------------------------
 /** Selects background/foreground colors for the message depending on
  *  log level. It is only called if messages are not redirected to a file.
@@ -144,6 +266,10 @@ void Log::printMessage(int level, const char *component, const char *format,
 
     if (level < m_min_log_level) return;
 
+    if (m_rate_limit > 0 && level < LL_WARN &&
+        isRateLimited(level, component))
+        return;
+
     static const char *names[] = { "debug", "verbose  ", "info   ",
                                   "warn   ", "error  ", "fatal  " };
     const int MAX_LENGTH = 4096;
@@ -161,10 +287,18 @@ void Log::printMessage(int level, const char *component, const char *format,
     if (NetworkConfig::get()->isNetworking() &&
         NetworkConfig::get()->isServer())
     {
+        // Formatting the time is slow, so do it only once per second
+        static thread_local std::time_t last_time = 0;
+        static thread_local char time_string[32] = "";
         std::time_t result = std::time(nullptr);
+        if (result != last_time)
+        {
+            last_time = result;
+            snprintf(time_string, sizeof(time_string), "%.24s",
+                     std::asctime(std::localtime(&result)));
+        }
         index += snprintf (line + index, remaining,
-            "%.24s [%s] %s: ", std::asctime(std::localtime(&result)),
-            names[level], component);
+            "%.24s [%s] %s: ", time_string, names[level], component);
     }
     else
 #endif
@@ -180,6 +314,17 @@ void Log::printMessage(int level, const char *component, const char *format,
     index = index > MAX_LENGTH - 1 ? MAX_LENGTH - 1 : index;
     sprintf(line + index, "\n");
 
+    // With the asynchronous writer, only add the line to the queue. If the
+    // queue is full, the line is dropped (and the writer reports that).
+    if (g_async.load(std::memory_order_acquire))
+    {
+        if (!g_line_queue->push(line, level))
+            g_dropped_lines.fetch_add(1, std::memory_order_relaxed);
+        else if (g_line_queue->isHalfFull())
+            g_writer_cv.notify_one();
+        return;
+    }
+
     // If the data is not buffered, immediately print it:
     if (m_buffer_size <= 1)
     {
@@ -209,6 +354,41 @@ void Log::printMessage(int level, const char *component, const char *format,
     flushBuffers();
 }   // printMessage
 
+// ----------------------------------------------------------------------------
+/** Checks if a message exceeds the maximum number of messages per second
+ *  of its component. When a new second starts, the number of messages
+ *  suppressed in the previous second is reported.
+ *  \param level Log level of the message.
+ *  \param component The component of the message.
+ *  \return True if the message must not be printed.
+ */
+bool Log::isRateLimited(int level, const char *component)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *c = component; *c; c++)
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    RateSlot &slot = g_rate_slots[hash % NUM_RATE_SLOTS];
+
+    const int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t old_second = slot.m_second.load(std::memory_order_relaxed);
+    if (old_second != second &&
+        slot.m_second.compare_exchange_strong(old_second, second))
+    {
+        slot.m_count.store(0, std::memory_order_relaxed);
+        const uint32_t suppressed = slot.m_suppressed.exchange(0);
+        if (suppressed > 0)
+        {
+            warn("Log", "%u messages of '%s' were suppressed.", suppressed,
+                 component);
+        }
+    }
+    if (slot.m_count.fetch_add(1, std::memory_order_relaxed) < m_rate_limit)
+        return false;
+    slot.m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}   // isRateLimited
+
 // ----------------------------------------------------------------------------
 /** Writes the specified line to the various output devices, e.g. terminal,
  *  log file etc. If log messages are not redirected to a file, it tries to
@@ -277,6 +457,9 @@ void Log::toggleConsoleLog(bool val)
  */
 void Log::flushBuffers()
 {
+    if (g_line_queue)
+        writeQueuedLines();
+
     m_line_buffer.lock();
     for (unsigned int i = 0; i < m_line_buffer.getData().size(); i++)
     {
@@ -287,6 +470,75 @@ void Log::flushBuffers()
     m_line_buffer.unlock();
 }   // flushBuffers
 
+// ----------------------------------------------------------------------------
+/** Writes all lines in the queue of the asynchronous writer. */
+void Log::writeQueuedLines()
+{
+    std::lock_guard<std::mutex> lock(g_output_mutex);
+    std::string line;
+    int level;
+    while (g_line_queue->pop(&line, &level))
+        writeLine(line.c_str(), level);
+
+    const uint32_t dropped = g_dropped_lines.exchange(0);
+    if (dropped > 0)
+    {
+        char message[128];
+        snprintf(message, sizeof(message),
+                 "[warn   ] Log: %u messages were dropped.\n", dropped);
+        writeLine(message, LL_WARN);
+    }
+}   // writeQueuedLines
+
+// ----------------------------------------------------------------------------
+/** The loop of the writer thread: it writes the queued lines, and waits for
+ *  new lines (or until the queue is half full).
+ */
+void Log::asyncWriterLoop()
+{
+    while (!g_stop_writer.load())
+    {
+        writeQueuedLines();
+        std::unique_lock<std::mutex> lock(g_writer_mutex);
+        g_writer_cv.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    writeQueuedLines();
+}   // asyncWriterLoop
+
+// ----------------------------------------------------------------------------
+/** Starts a thread that writes all log messages. From then on logging only
+ *  adds the message to a queue, so the calling thread is never blocked by
+ *  writing to the terminal or log file.
+ */
+void Log::startAsyncWriter()
+{
+    if (g_async.load())
+        return;
+    if (!g_line_queue)
+    {
+        g_line_queue = new LineQueue();
+        // Make sure the thread is stopped if STK exits early
+        atexit(stopAsyncWriter);
+    }
+    g_stop_writer.store(false);
+    g_writer_thread = std::thread(asyncWriterLoop);
+    g_async.store(true, std::memory_order_release);
+}   // startAsyncWriter
+
+// ----------------------------------------------------------------------------
+/** Stops the writer thread after writing all queued messages. Messages
+ *  are written immediately again afterwards.
+ */
+void Log::stopAsyncWriter()
+{
+    if (!g_async.load())
+        return;
+    g_async.store(false);
+    g_stop_writer.store(true);
+    g_writer_cv.notify_one();
+    g_writer_thread.join();
+}   // stopAsyncWriter
+
 // ----------------------------------------------------------------------------
 /** This function opens the files that will contain the output.
  *  \param logout : name of the file that will contain stdout output
@@ -81,9 +81,16 @@ private:
     /** An optional prefix to be printed. */
     static std::string m_prefix;
 
+    /** Maximum number of messages per second and component for messages
+     *  below LL_WARN, 0 if there is no limit. */
+    static unsigned int m_rate_limit;
+
     static void setTerminalColor(LogLevel level);
     static void resetTerminalColor();
     static void writeLine(const char *line, int level);
+    static bool isRateLimited(int level, const char *component);
+    static void writeQueuedLines();
+    static void asyncWriterLoop();
 
     static void printMessage(int level, const char *component,
                              const char *format, VALIST va_list);
@@ -105,6 +112,7 @@ public:
                                                                      \
         if (LEVEL == LL_FATAL)                                       \
         {                                                            \
+            flushBuffers();                                          \
             assert(false);                                           \
             exit(1);                                                 \
         }                                                            \
@@ -121,12 +129,18 @@ public:
     static void closeOutputFiles();
     static void flushBuffers();
     static void toggleConsoleLog(bool val);
+    static void startAsyncWriter();
+    static void stopAsyncWriter();
 
     // ------------------------------------------------------------------------
     /** Sets the number of lines to buffer. Setting the buffer size to a 
      *  a value <=1 means no buffering, lines will be immediately printed. */
     static void setBufferSize(size_t n) { m_buffer_size = n;  }
     // ------------------------------------------------------------------------
+    /** Sets the maximum number of messages per second of each component
+     *  (only for messages below LL_WARN). 0 disables the limit. */
+    static void setRateLimit(unsigned int n) { m_rate_limit = n; }
+    // ------------------------------------------------------------------------
     /** Defines the minimum log level to be displayed. */
     static void setLogLevel(int n)
     {
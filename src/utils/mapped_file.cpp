@@ -0,0 +1,147 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/mapped_file.hpp"
+
+#include "utils/file_utils.hpp"
+#include "utils/string_utils.hpp"
+
+#ifdef WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------
+MappedFile::MappedFile()
+{
+    m_data   = NULL;
+    m_size   = 0;
+    m_mapped = false;
+#ifdef WIN32
+    m_file_handle    = INVALID_HANDLE_VALUE;
+    m_mapping_handle = NULL;
+#endif
+}   // MappedFile
+
+// ----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+    close();
+}   // ~MappedFile
+
+// ----------------------------------------------------------------------------
+/** Opens a file. Any previously opened file is closed first.
+ *  \param u8_path Full path of the file (utf8 encoded).
+ *  \return True if the file could be opened.
+ */
+bool MappedFile::open(const std::string &u8_path)
+{
+    close();
+
+#ifdef WIN32
+    HANDLE file = CreateFileW(StringUtils::utf8ToWide(u8_path).c_str(),
+                              GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY,
+                                                0, 0, NULL);
+            const void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ,
+                                                       0, 0, 0)
+                                       : NULL;
+            if (view)
+            {
+                m_file_handle    = file;
+                m_mapping_handle = mapping;
+                m_data           = (const char*)view;
+                m_size           = (size_t)size.QuadPart;
+                m_mapped         = true;
+                return true;
+            }
+            if (mapping)
+                CloseHandle(mapping);
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(u8_path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *view = mmap(NULL, (size_t)st.st_size, PROT_READ,
+                              MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                // The mapping stays valid after closing the descriptor
+                ::close(fd);
+                m_data   = (const char*)view;
+                m_size   = (size_t)st.st_size;
+                m_mapped = true;
+                return true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    // Mapping failed (or the file is empty): read the file into memory
+    FILE *f = FileUtils::fopenU8Path(u8_path, "rb");
+    if (!f)
+        return false;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        m_buffer.insert(m_buffer.end(), buffer, buffer + n);
+    fclose(f);
+    // Make sure that m_data is not NULL even for an empty file
+    m_buffer.push_back(0);
+    m_data = m_buffer.data();
+    m_size = m_buffer.size() - 1;
+    return true;
+}   // open
+
+// ----------------------------------------------------------------------------
+/** Closes the file (if one is open). */
+void MappedFile::close()
+{
+    if (m_mapped)
+    {
+#ifdef WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle((HANDLE)m_mapping_handle);
+        CloseHandle((HANDLE)m_file_handle);
+        m_file_handle    = INVALID_HANDLE_VALUE;
+        m_mapping_handle = NULL;
+#else
+        munmap((void*)m_data, m_size);
+#endif
+    }
+    m_buffer.clear();
+    m_data   = NULL;
+    m_size   = 0;
+    m_mapped = false;
+}   // close
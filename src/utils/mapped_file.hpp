@@ -0,0 +1,74 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_MAPPED_FILE_HPP
+#define HEADER_MAPPED_FILE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+  * \ingroup utils
+  * A read-only view of the content of a file. On systems that support it
+  * the file is memory-mapped, so only the pages that are actually accessed
+  * are read from disk (and the pages can be shared between processes
+  * reading the same file). If the file can not be mapped, its content is
+  * read into memory instead.
+  */
+class MappedFile : public NoCopy
+{
+private:
+    /** Pointer to the start of the data, NULL if no file is open. */
+    const char *m_data;
+
+    /** Size of the file. */
+    size_t m_size;
+
+    /** True if m_data points to a memory mapped area. */
+    bool m_mapped;
+
+    /** Used if the file could not be mapped. */
+    std::vector<char> m_buffer;
+
+#ifdef WIN32
+    void *m_file_handle;
+    void *m_mapping_handle;
+#endif
+
+public:
+          MappedFile();
+         ~MappedFile();
+    bool  open(const std::string &u8_path);
+    void  close();
+    // ------------------------------------------------------------------------
+    /** Returns true if a file is open. */
+    bool isOpen() const { return m_data != NULL; }
+    // ------------------------------------------------------------------------
+    /** Returns a pointer to the content of the file. */
+    const char *getData() const { return m_data; }
+    // ------------------------------------------------------------------------
+    /** Returns the size of the file. */
+    size_t getSize() const { return m_size; }
+    // ------------------------------------------------------------------------
+    /** Returns true if the file is memory mapped (and not copied). */
+    bool isMapped() const { return m_mapped; }
+};   // MappedFile
+
+#endif
@@ -0,0 +1,217 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/object_pool.hpp"
+
+#include "utils/string_utils.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <new>
+
+// ----------------------------------------------------------------------------
+/** Returns the list of all pools. */
+std::vector<ObjectPool*>& ObjectPool::getAllPools()
+{
+    static std::vector<ObjectPool*> all_pools;
+    return all_pools;
+}   // getAllPools
+
+// ----------------------------------------------------------------------------
+/** Creates a pool and registers it in the list of all pools.
+ *  \param name Name of the class using this pool.
+ *  \param object_size Size of an object of this class.
+ *  \param objects_per_kart How many objects are reserved per kart at race
+ *         start (see reserveAll).
+ */
+ObjectPool::ObjectPool(const char *name, size_t object_size,
+                       unsigned int objects_per_kart)
+          : m_name(name), m_object_size(object_size),
+            m_objects_per_kart(objects_per_kart)
+{
+    m_num_in_use           = 0;
+    m_peak_in_use          = 0;
+    m_num_allocations      = 0;
+    m_num_heap_allocations = 0;
+    getAllPools().push_back(this);
+}   // ObjectPool
+
+// ----------------------------------------------------------------------------
+/** Allocates memory for one object, reusing the memory of a previously
+ *  deleted object if possible.
+ *  \param size Size of the object to allocate, which can be larger than
+ *         the object size of this pool for a derived class.
+ */
+void* ObjectPool::allocate(size_t size)
+{
+    if (size != m_object_size)
+        return ::operator new(size);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_num_allocations++;
+    m_num_in_use++;
+    if (m_num_in_use > m_peak_in_use)
+        m_peak_in_use = m_num_in_use;
+    if (m_free_blocks.empty())
+    {
+        m_num_heap_allocations++;
+        return ::operator new(m_object_size);
+    }
+    void *p = m_free_blocks.back();
+    m_free_blocks.pop_back();
+    return p;
+}   // allocate
+
+// ----------------------------------------------------------------------------
+/** Returns the memory of a deleted object to the pool.
+ *  \param p The memory to free.
+ *  \param size Size of the deleted object.
+ */
+void ObjectPool::deallocate(void *p, size_t size)
+{
+    if (!p)
+        return;
+    if (size != m_object_size)
+    {
+        ::operator delete(p);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(m_num_in_use > 0);
+    m_num_in_use--;
+    m_free_blocks.push_back(p);
+}   // deallocate
+
+// ----------------------------------------------------------------------------
+/** Makes sure that at least the specified number of objects can be
+ *  allocated (in addition to the objects already in use) without a heap
+ *  allocation.
+ *  \param num_objects Number of objects.
+ */
+void ObjectPool::reserve(unsigned int num_objects)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free_blocks.reserve(num_objects);
+    while (m_free_blocks.size() < num_objects)
+        m_free_blocks.push_back(::operator new(m_object_size));
+}   // reserve
+
+// ----------------------------------------------------------------------------
+/** Returns the allocation counters of this pool.
+ *  \param num_in_use Number of objects currently in use.
+ *  \param peak_in_use Maximum number of objects that were in use at the
+ *         same time.
+ *  \param num_allocations Total number of objects allocated.
+ *  \param num_heap_allocations Number of allocations that needed a heap
+ *         allocation because the pool was empty.
+ */
+void ObjectPool::getStatistics(unsigned int *num_in_use,
+                               unsigned int *peak_in_use,
+                               uint64_t *num_allocations,
+                               uint64_t *num_heap_allocations) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *num_in_use           = m_num_in_use;
+    *peak_in_use          = m_peak_in_use;
+    *num_allocations      = m_num_allocations;
+    *num_heap_allocations = m_num_heap_allocations;
+}   // getStatistics
+
+// ----------------------------------------------------------------------------
+/** Called at race start to pre-allocate the objects of all pools, based on
+ *  the number of objects each pool expects per kart.
+ *  \param num_karts Number of karts in the race.
+ */
+void ObjectPool::reserveAll(unsigned int num_karts)
+{
+    for (ObjectPool *pool : getAllPools())
+        pool->reserve(pool->m_objects_per_kart * num_karts);
+}   // reserveAll
+
+// ----------------------------------------------------------------------------
+/** Returns all pools, e.g. to display their statistics. */
+std::vector<const ObjectPool*> ObjectPool::getPools()
+{
+    return std::vector<const ObjectPool*>(getAllPools().begin(),
+                                          getAllPools().end());
+}   // getPools
+
+// ----------------------------------------------------------------------------
+/** Returns a human readable report of the counters of all pools, one line
+ *  per pool. */
+std::string ObjectPool::getReport()
+{
+    std::string report;
+    for (const ObjectPool *pool : getAllPools())
+    {
+        unsigned int in_use, peak;
+        uint64_t allocations, heap_allocations;
+        pool->getStatistics(&in_use, &peak, &allocations, &heap_allocations);
+        report += StringUtils::insertValues(
+            "%s: %d in use, peak %d, %d allocations, %d from heap\n",
+            pool->getName(), in_use, peak, allocations, heap_allocations);
+    }
+    return report;
+}   // getReport
+
+// ----------------------------------------------------------------------------
+/** Tests that memory is reused, that reserving avoids heap allocations and
+ *  that objects of a different size bypass the pool.
+ */
+void ObjectPool::unitTesting()
+{
+    ObjectPool pool("Test", 64, 2);
+    unsigned int in_use, peak;
+    uint64_t allocations, heap_allocations;
+
+    void *a = pool.allocate(64);
+    pool.deallocate(a, 64);
+    void *b = pool.allocate(64);
+    assert(a == b);
+    pool.getStatistics(&in_use, &peak, &allocations, &heap_allocations);
+    assert(in_use == 1 && peak == 1);
+    assert(allocations == 2 && heap_allocations == 1);
+
+    // One object is still in use, the next four must not use the heap
+    pool.reserve(4);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 4; i++)
+        blocks.push_back(pool.allocate(64));
+    pool.getStatistics(&in_use, &peak, &allocations, &heap_allocations);
+    assert(in_use == 5 && peak == 5);
+    assert(allocations == 6 && heap_allocations == 1);
+
+    // A different size (e.g. a derived class) must not use the pool
+    void *large = pool.allocate(128);
+    pool.getStatistics(&in_use, &peak, &allocations, &heap_allocations);
+    assert(in_use == 5 && allocations == 6);
+    pool.deallocate(large, 128);
+
+    for (void *p : blocks)
+        pool.deallocate(p, 64);
+    pool.deallocate(b, 64);
+    pool.getStatistics(&in_use, &peak, &allocations, &heap_allocations);
+    assert(in_use == 0 && peak == 5);
+
+    // Remove the test pool again, and free its memory
+    std::vector<ObjectPool*> &all_pools = getAllPools();
+    all_pools.erase(std::find(all_pools.begin(), all_pools.end(), &pool));
+    for (void *p : pool.m_free_blocks)
+        ::operator delete(p);
+    pool.m_free_blocks.clear();
+}   // unitTesting
@@ -0,0 +1,121 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_OBJECT_POOL_HPP
+#define HEADER_OBJECT_POOL_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+  * \ingroup utils
+  * A free list of memory blocks for objects of one class, which are created
+  * and destroyed frequently during a race (e.g. flyables, items and kart
+  * animations). Memory of deleted objects is kept and reused for the next
+  * object, so that after the pool is warmed up (see reserveAll) no heap
+  * allocations are done for these objects. The pool never shrinks, i.e. it
+  * uses as much memory as the peak number of objects needed.
+  * A class uses a pool by adding DECLARE_OBJECT_POOL() to its declaration
+  * and DEFINE_OBJECT_POOL(...) to its implementation file, which overload
+  * operator new and delete of this class. Objects of derived classes that
+  * don't have their own pool (i.e. have a different size) are allocated
+  * from the heap as usual.
+  */
+class ObjectPool : public NoCopy
+{
+private:
+    /** Name of the class, used for statistics. */
+    std::string m_name;
+
+    /** Size of one object. */
+    size_t m_object_size;
+
+    /** How many objects should be reserved per kart at race start. */
+    unsigned int m_objects_per_kart;
+
+    /** The currently unused memory blocks. */
+    std::vector<void*> m_free_blocks;
+
+    /** Number of objects currently allocated from this pool. */
+    unsigned int m_num_in_use;
+
+    /** Maximum value of m_num_in_use. */
+    unsigned int m_peak_in_use;
+
+    /** Total number of allocations. */
+    uint64_t m_num_allocations;
+
+    /** Number of allocations that could not be served from the free
+     *  blocks and needed a heap allocation. */
+    uint64_t m_num_heap_allocations;
+
+    /** Protects the free list and the counters. */
+    mutable std::mutex m_mutex;
+
+    static std::vector<ObjectPool*>& getAllPools();
+
+public:
+    ObjectPool(const char *name, size_t object_size,
+               unsigned int objects_per_kart);
+    void* allocate(size_t size);
+    void  deallocate(void *p, size_t size);
+    void  reserve(unsigned int num_objects);
+    void  getStatistics(unsigned int *num_in_use, unsigned int *peak_in_use,
+                        uint64_t *num_allocations,
+                        uint64_t *num_heap_allocations) const;
+
+    static void        reserveAll(unsigned int num_karts);
+    static std::string getReport();
+    static std::vector<const ObjectPool*> getPools();
+    static void        unitTesting();
+    // ------------------------------------------------------------------------
+    /** Returns the name of the class using this pool. */
+    const std::string& getName() const { return m_name; }
+};   // ObjectPool
+
+/** Overloads operator new and delete of a class to use an object pool.
+ *  This must be placed at the start of the class declaration, since it
+ *  leaves the access in the private state. */
+#define DECLARE_OBJECT_POOL()                                               \
+public:                                                                     \
+    static void* operator new(size_t size)                                  \
+    {                                                                       \
+        return m_object_pool->allocate(size);                               \
+    }                                                                       \
+    static void operator delete(void *p, size_t size)                       \
+    {                                                                       \
+        m_object_pool->deallocate(p, size);                                 \
+    }                                                                       \
+private:                                                                    \
+    static ObjectPool *m_object_pool;
+
+/** Creates the object pool of a class. The pool is never freed, so that
+ *  objects which are only deleted during static destruction still find it.
+ *  \param CLASS The class name.
+ *  \param OBJECTS_PER_KART Number of objects reserved per kart at race
+ *         start. */
+#define DEFINE_OBJECT_POOL(CLASS, OBJECTS_PER_KART)                         \
+    ObjectPool *CLASS::m_object_pool =                                      \
+        new ObjectPool(#CLASS, sizeof(CLASS), OBJECTS_PER_KART);
+
+#endif
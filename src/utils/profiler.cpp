@@ -27,10 +27,13 @@
 #include "guiengine/scalable_font.hpp"
 #include "io/file_manager.hpp"
 #include "utils/file_utils.hpp"
+#include "utils/log.hpp"
+#include "utils/object_pool.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/vs.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <ostream>
 #include <stack>
@@ -45,36 +48,57 @@ Profiler profiler;
 
 #define MARKERS_NAMES_POS     core::rect<s32>(50,100,150,600)
 #define GPU_MARKERS_NAMES_POS core::rect<s32>(50,165,150,300)
+#define POOL_STATS_POS        core::rect<s32>(300,100,700,300)
 
 // The width of the profiler corresponds to TIME_DRAWN_MS milliseconds
 #define TIME_DRAWN_MS 30.0f 
 
-// --- Begin portable precise timer ---
-#ifdef WIN32
-    #define WIN32_LEAN_AND_MEAN
-    #include <windows.h>
+/** Returns a monotonic time in milliseconds with (at least) microsecond
+ *  precision. */
+double getTimeMilliseconds()
+{
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+    return std::chrono::duration_cast<Milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}   // getTimeMilliseconds
 
-    double getTimeMilliseconds()
+namespace
+{
+    /** Index of the calling thread in m_all_threads_data, -1 if the thread
+     *  has not used the profiler yet, -2 if there are too many threads. */
+    thread_local int g_profiler_thread_id = -1;
+
+    /** Name of the calling thread, and frees its profiler data when the
+     *  thread exits. This is only accessed when a thread gets its profiler
+     *  data or sets its name, so pushing and popping markers only needs
+     *  the cheap integer index above. */
+    struct ThreadSlot
     {
-        LARGE_INTEGER freq;
-        QueryPerformanceFrequency(&freq);
-        double perFreq = double(freq.QuadPart) / 1000.0;
-
-        LARGE_INTEGER timer;
-        QueryPerformanceCounter(&timer);
-        return double(timer.QuadPart) / perFreq;
-    }   // getTimeMilliseconds
-
-#else
-    #include <sys/time.h>
-    double getTimeMilliseconds()
+        std::string m_name;
+        ~ThreadSlot()
+        {
+            if (g_profiler_thread_id >= 0)
+                profiler.releaseThreadData();
+        }
+    };   // ThreadSlot
+    thread_local ThreadSlot g_thread_slot;
+
+    /** Escapes a string so that it can be used in a JSON string. */
+    std::string jsonEscape(const std::string &s)
     {
-        struct timeval tv;
-        gettimeofday(&tv, NULL);
-        return double(tv.tv_sec * 1000) + (double(tv.tv_usec) / 1000.0);
-    }   // getTimeMilliseconds
-#endif
-// --- End portable precise timer ---
+        std::string result;
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                result += std::string("\\") + c;
+            else if ((unsigned char)c < 0x20)
+                result += ' ';
+            else
+                result += c;
+        }
+        return result;
+    }   // jsonEscape
+}   // anonymous namespace
 
 //-----------------------------------------------------------------------------
 Profiler::Profiler()
@@ -89,7 +113,7 @@ Profiler::Profiler()
     m_max_frames          = 20 * 120;
     m_current_frame       = 0;
     m_has_wrapped_around  = false;
-    m_threads_used = 1;
+    m_threads_used        = 0;
 }   // Profile
 
 //-----------------------------------------------------------------------------
@@ -100,79 +124,156 @@ Profiler::~Profiler()
 //-----------------------------------------------------------------------------
 /** It is split from the constructor so that it can be avoided allocating
  *  unnecessary memory when the profiler is never used (for example in no
- *  graphics). */
+ *  graphics). Must be called from the main thread. */
 void Profiler::init()
 {
-    const int MAX_THREADS = 10;
-    m_all_threads_data.resize(MAX_THREADS);
-    m_thread_mapping.resize(MAX_THREADS);
-
-    // Add this thread to the thread mapping
-    m_thread_mapping[0] = pthread_self();
+    // Make sure the main thread gets thread id 0
+    setThreadName("main");
     m_gpu_times.resize(Q_LAST * m_max_frames);
 }   // init
 
 //-----------------------------------------------------------------------------
-/** Returns a unique index for a thread. If the calling thread is not yet in
- *  the mapping, it will assign a new unique id to this thread. This function
- *  is NOT thread-safe and must be called from a properly protected code
- *  section. */
-int Profiler::getThreadID()
+/** Returns the data of the calling thread. If the calling thread has not
+ *  used the profiler before, it will get an unused slot (which might have
+ *  been freed by a thread that has exited). Returns NULL if too many
+ *  threads are used. */
+Profiler::ThreadData* Profiler::getThreadData()
 {
-    pthread_t thread = pthread_self();
-    int i = 0;
-    while(i < m_threads_used)
+    if (g_profiler_thread_id >= 0)
+        return &m_all_threads_data[g_profiler_thread_id];
+    if (g_profiler_thread_id == -2)
+        return NULL;
+
+    m_marker_lock.lock();
+    const int n = m_threads_used.load();
+    int id = 0;
+    while (id < n && m_all_threads_data[id].m_in_use)
+        id++;
+    if (id >= MAX_THREADS)
     {
-        if (memcmp( &m_thread_mapping[i],
-                    &thread,
-                    sizeof(thread)) ==0 )
-        {
-            return i;
-        }
-        i++;
-    }   // for i <m_threads_used
+        m_marker_lock.unlock();
+        Log::warn("Profiler", "Too many threads, ignoring markers.");
+        g_profiler_thread_id = -2;
+        return NULL;
+    }
+    ThreadData &td = m_all_threads_data[id];
+    if (id == n)
+    {
+        td.m_events.resize(EVENT_BUFFER_SIZE);
+        m_threads_used.store(n + 1);
+    }
+    // A thread that exited might have left markers on its stack
+    td.m_stack_size = 0;
+    td.m_in_use     = true;
+    td.m_name       = g_thread_slot.m_name;
+    g_profiler_thread_id = id;
+    m_marker_lock.unlock();
+    return &td;
+}   // getThreadData
 
-    assert(m_threads_used < (int)m_thread_mapping.size());
-    m_thread_mapping[m_threads_used] = thread;
-    m_threads_used++;
+//-----------------------------------------------------------------------------
+/** Frees the profiler data of the calling thread, so that it can be used
+ *  by another thread. Markers already completed by this thread are still
+ *  collected. This is called automatically when a thread exits.
+ */
+void Profiler::releaseThreadData()
+{
+    if (g_profiler_thread_id < 0)
+        return;
+    m_marker_lock.lock();
+    m_all_threads_data[g_profiler_thread_id].m_in_use = false;
+    m_marker_lock.unlock();
+    g_profiler_thread_id = -1;
+}   // releaseThreadData
 
-    return m_threads_used - 1;
-}   // getThreadID
+//-----------------------------------------------------------------------------
+/** Sets the name of the calling thread, which is used when exporting a
+ *  trace. This does not use one of the MAX_THREADS slots unless the
+ *  profiler is enabled: otherwise the name is only stored, and used once
+ *  the thread pushes its first marker.
+ *  \param name Name of the thread.
+ */
+void Profiler::setThreadName(const char *name)
+{
+    g_thread_slot.m_name = name;
+    if (g_profiler_thread_id < 0)
+    {
+        // getThreadData copies the name into the new slot
+        if (UserConfigParams::m_profiler_enabled)
+            getThreadData();
+        return;
+    }
+    m_marker_lock.lock();
+    m_all_threads_data[g_profiler_thread_id].m_name = name;
+    m_marker_lock.unlock();
+}   // setThreadName
 
 //-----------------------------------------------------------------------------
-/// Push a new marker that starts now
+/** Returns the id of a marker with the given name. If no such marker
+ *  exists, a new id is created.
+ *  \param name Name of the marker.
+ *  \param colour Colour used to display the marker (only used when a new
+ *         marker is created).
+ */
+int Profiler::getMarkerID(const char *name, const video::SColor &colour)
+{
+    m_marker_lock.lock();
+    std::map<std::string, int>::iterator i = m_marker_ids.find(name);
+    int id;
+    if (i != m_marker_ids.end())
+    {
+        id = i->second;
+    }
+    else
+    {
+        id = (int)m_marker_names.size();
+        m_marker_names.push_back(name);
+        m_marker_colours.push_back(colour);
+        m_marker_ids[name] = id;
+    }
+    m_marker_lock.unlock();
+    return id;
+}   // getMarkerID
+
+//-----------------------------------------------------------------------------
+/** Returns the name of the marker with the given id. */
+std::string Profiler::getMarkerName(int id)
+{
+    m_marker_lock.lock();
+    std::string name = m_marker_names[id];
+    m_marker_lock.unlock();
+    return name;
+}   // getMarkerName
+
+//-----------------------------------------------------------------------------
+/// Push a new marker that starts now, looking up the marker by name
 void Profiler::pushCPUMarker(const char* name, const video::SColor& colour)
 {
     // Don't do anything when disabled or frozen
     if (!UserConfigParams::m_profiler_enabled ||
          m_freeze_state == FROZEN || m_freeze_state == WAITING_FOR_UNFREEZE )
         return;
+    pushCPUMarker(getMarkerID(name, colour));
+}   // pushCPUMarker(name)
 
-    // We need to look before getting the thread id (since this might
-    // be a new thread which changes the structure).
-    m_lock.lock();
-    int thread_id = getThreadID();
+//-----------------------------------------------------------------------------
+/// Push a new marker that starts now
+void Profiler::pushCPUMarker(int id)
+{
+    // Don't do anything when disabled or frozen
+    if (!UserConfigParams::m_profiler_enabled ||
+         m_freeze_state == FROZEN || m_freeze_state == WAITING_FOR_UNFREEZE )
+        return;
 
-    ThreadData &td = m_all_threads_data[thread_id];
-    AllEventData::iterator i = td.m_all_event_data.find(name);
-    double  start = getTimeMilliseconds() - m_time_last_sync;
-    if (i != td.m_all_event_data.end())
-    {
-        i->second.setStart(m_current_frame, start, (int)td.m_event_stack.size());
-    }
-    else
+    ThreadData *td = getThreadData();
+    if (!td)
+        return;
+    if (td->m_stack_size < MAX_STACK_DEPTH)
     {
-        EventData ed(colour, m_max_frames);
-        ed.setStart(m_current_frame, start, (int)td.m_event_stack.size());
-        td.m_all_event_data[name] = ed;
-        // Ordered headings is used to determine the order in which the
-        // bar graph is drawn. Outer profiling events will be added first,
-        // so they will be drawn first, which gives the proper nested
-        // displayed of events.
-        td.m_ordered_headings.push_back(name);
+        td->m_stack_id[td->m_stack_size]    = id;
+        td->m_stack_start[td->m_stack_size] = getTimeMilliseconds();
     }
-    td.m_event_stack.push_back(name);
-    m_lock.unlock();
+    td->m_stack_size++;
 }   // pushCPUMarker
 
 //-----------------------------------------------------------------------------
@@ -185,28 +286,107 @@ void Profiler::popCPUMarker()
         return;
     double now = getTimeMilliseconds();
 
-    m_lock.lock();
-    int thread_id = getThreadID();
-    ThreadData &td = m_all_threads_data[thread_id];
-
+    ThreadData *td = getThreadData();
     // When the profiler gets enabled (which happens in the middle of the
     // main loop), there can be some pops without matching pushes (for one
     // frame) - ignore those events.
-    if (td.m_event_stack.size() == 0)
-    {
-        m_lock.unlock();
+    if (!td || td->m_stack_size == 0)
         return;
-    }
-
-    assert(td.m_event_stack.size() > 0);
 
-    const std::string &name = td.m_event_stack.back();
-    td.m_all_event_data[name].setEnd(m_current_frame, now - m_time_last_sync);
+    td->m_stack_size--;
+    if (td->m_stack_size >= MAX_STACK_DEPTH)
+        return;
 
-    td.m_event_stack.pop_back();
-    m_lock.unlock();
+    // Only this thread writes into its event buffer. The buffer index is
+    // published after the event is written, so that synchronizeFrame
+    // never sees an incomplete event.
+    const uint64_t n = td->m_num_events.load(std::memory_order_relaxed);
+    MarkerEvent &e = td->m_events[n & (EVENT_BUFFER_SIZE - 1)];
+    e.m_start = td->m_stack_start[td->m_stack_size];
+    e.m_end   = now;
+    e.m_id    = td->m_stack_id[td->m_stack_size];
+    e.m_layer = td->m_stack_size;
+    td->m_num_events.store(n + 1, std::memory_order_release);
 }   // popCPUMarker
 
+//-----------------------------------------------------------------------------
+/** Copies the completed markers of a thread from its ring buffer. This can
+ *  be called from any thread, while the thread continues to add markers.
+ *  \param td The data of the thread.
+ *  \param start Index of the first marker to copy. If this marker has
+ *         already been overwritten, copying starts with the oldest marker
+ *         still in the buffer.
+ *  \param events The markers are appended to this vector.
+ *  \return The index after the last marker copied.
+ */
+uint64_t Profiler::readEvents(ThreadData *td, uint64_t start,
+                              std::vector<MarkerEvent> *events)
+{
+    const uint64_t end = td->m_num_events.load(std::memory_order_acquire);
+    if (end - start > (uint64_t)EVENT_BUFFER_SIZE)
+        start = end - EVENT_BUFFER_SIZE;
+    const size_t first = events->size();
+    for (uint64_t i = start; i < end; i++)
+        events->push_back(td->m_events[i & (EVENT_BUFFER_SIZE - 1)]);
+
+    // The thread might have overwritten some of the oldest markers while
+    // they were copied, remove those.
+    const uint64_t now_written =
+        td->m_num_events.load(std::memory_order_acquire);
+    if (now_written - start > (uint64_t)EVENT_BUFFER_SIZE)
+    {
+        const uint64_t overwritten = std::min<uint64_t>(
+            now_written - EVENT_BUFFER_SIZE - start, end - start);
+        events->erase(events->begin() + first,
+                      events->begin() + first + (size_t)overwritten);
+    }
+    return end;
+}   // readEvents
+
+//-----------------------------------------------------------------------------
+/** Copies all markers completed since the last call from the event buffer
+ *  of a thread into the per-frame data of the current frame. Must be called
+ *  with m_lock held.
+ */
+void Profiler::collectEvents(ThreadData *td)
+{
+    m_collected_events.clear();
+    td->m_num_collected = readEvents(td, td->m_num_collected,
+                                     &m_collected_events);
+
+    for (unsigned int i = 0; i < m_collected_events.size(); i++)
+    {
+        const MarkerEvent &e = m_collected_events[i];
+        if (e.m_id >= (int)td->m_all_event_data.size())
+            td->m_all_event_data.resize(e.m_id + 1);
+        EventData &ed = td->m_all_event_data[e.m_id];
+        if (!ed.isUsed())
+        {
+            m_marker_lock.lock();
+            ed = EventData(m_marker_colours[e.m_id], m_max_frames);
+            m_marker_lock.unlock();
+            // Ordered headings is used to determine the order in which the
+            // bar graph is drawn. Outer profiling events end after their
+            // children, so keep the headings sorted by layer to make sure
+            // that outer events are drawn first, which gives the proper
+            // nested display of events.
+            unsigned int pos = 0;
+            while (pos < td->m_heading_layers.size() &&
+                   td->m_heading_layers[pos] <= e.m_layer)
+                pos++;
+            td->m_ordered_headings.insert(td->m_ordered_headings.begin()+pos,
+                                          e.m_id);
+            td->m_heading_layers.insert(td->m_heading_layers.begin() + pos,
+                                        e.m_layer);
+        }
+        // Markers that were started in the previous frame are only counted
+        // from the beginning of this frame.
+        const double start_time = std::max(e.m_start - m_time_last_sync, 0.0);
+        ed.setStart(m_current_frame, start_time, e.m_layer);
+        ed.setEnd(m_current_frame, e.m_end - m_time_last_sync);
+    }
+}   // collectEvents
+
 //-----------------------------------------------------------------------------
 /** Switches the profiler either on or off.
  */
@@ -225,8 +405,7 @@ void Profiler::toggleStatus()
 //-----------------------------------------------------------------------------
 /** Saves all data for the current frame, and starts the next frame in the
  *  circular buffer. Any events that are currently active (e.g. in a separate
- *  thread) will be split in two parts: the beginning (till now) in the current
- *  frame, the rest will be added to the next frame.
+ *  thread) will be added to the frame in which they end.
  */
 void Profiler::synchronizeFrame()
 {
@@ -247,33 +426,26 @@ void Profiler::synchronizeFrame()
         m_has_wrapped_around = true;
     }
 
-    // First finish all markers that are currently in progress, and add
-    // a new start marker for the next frame. So e.g. if a thread is busy in
-    // one event while the main thread syncs the frame, this event will get
-    // split into two parts in two consecutive frames
-    for (int i = 0; i < m_threads_used; i++)
-    {
-        ThreadData &td = m_all_threads_data[i];
-        for(unsigned int j=0; j<td.m_event_stack.size(); j++)
-        {
-            EventData &ed = td.m_all_event_data[td.m_event_stack[j]];
-            ed.setEnd(m_current_frame, now-m_time_last_sync);
-            ed.setStart(next_frame, 0, j);
-        }   // for j in event stack
-    }   // for i in threads
+    // Collect all markers that were completed in this frame. Markers that
+    // are still in progress (e.g. in a separate thread) will be added to
+    // the frame in which they end.
+    const int threads_used = m_threads_used.load();
+    for (int i = 0; i < threads_used; i++)
+        collectEvents(&m_all_threads_data[i]);
 
     if (m_has_wrapped_around)
     {
         // The new entries for the circular buffer need to be cleared
         // to make sure the new values are not accumulated on top of
         // the data from a previous frame.
-        for (int i = 0; i < m_threads_used; i++)
+        for (int i = 0; i < threads_used; i++)
         {
-            ThreadData &td = m_all_threads_data[i];
-            AllEventData &aed = td.m_all_event_data;
-            AllEventData::iterator k;
-            for (k = aed.begin(); k != aed.end(); ++k)
-                k->second.getMarker(next_frame).clear();
+            AllEventData &aed = m_all_threads_data[i].m_all_event_data;
+            for (unsigned int k = 0; k < aed.size(); k++)
+            {
+                if (aed[k].isUsed())
+                    aed[k].getMarker(next_frame).clear();
+            }
         }
     }   // is has wrapped around
 
@@ -328,12 +500,20 @@ void Profiler::draw()
     // Use this thread to compute start and end time. All other
     // threads might have 'unfinished' events, or multiple identical events
     // in this frame (i.e. start time would be incorrect).
-    int thread_id = getThreadID();
-    AllEventData &aed = m_all_threads_data[thread_id].m_all_event_data;
-    AllEventData::iterator j;
-    for (j = aed.begin(); j != aed.end(); ++j)
+    ThreadData *this_td = getThreadData();
+    // All thread slots can be in use by other threads
+    if (!this_td)
     {
-        const Marker &marker = j->second.getMarker(indx);
+        PROFILER_POP_CPU_MARKER();
+        return;
+    }
+    const int thread_id = (int)(this_td - m_all_threads_data);
+    AllEventData &aed = this_td->m_all_event_data;
+    for (unsigned int j = 0; j < aed.size(); j++)
+    {
+        if (!aed[j].isUsed())
+            continue;
+        const Marker &marker = aed[j].getMarker(indx);
         start = std::min(start, marker.getStart());
         end = std::max(end, marker.getEnd());
     }   // for j in events
@@ -345,8 +525,9 @@ void Profiler::draw()
     // Get the mouse pos
     core::vector2di mouse_pos = GUIEngine::EventHandler::get()->getMousePos();
 
-    std::stack<AllEventData::iterator> hovered_markers;
-    for (int i = 0; i < m_threads_used; i++)
+    std::stack<std::pair<const EventData*, int> > hovered_markers;
+    const int threads_used = m_threads_used.load();
+    for (int i = 0; i < threads_used; i++)
     {
         ThreadData &td = m_all_threads_data[i];
         AllEventData &aed = td.m_all_event_data;
@@ -358,8 +539,9 @@ void Profiler::draw()
         double start_xpos = 0;
         for(int k=0; k<(int)td.m_ordered_headings.size(); k++)
         {
-            AllEventData::iterator j = aed.find(td.m_ordered_headings[k]);
-            const Marker &marker = j->second.getMarker(indx);
+            const int id = td.m_ordered_headings[k];
+            const EventData &ed = aed[id];
+            const Marker &marker = ed.getMarker(indx);
             if (i == thread_id)
                 start_xpos = factor*marker.getStart();
             core::rect<s32> pos((s32)(x_offset + start_xpos),
@@ -374,11 +556,11 @@ void Profiler::draw()
             pos.UpperLeftCorner.Y  += 2 * (int)marker.getLayer();
             pos.LowerRightCorner.Y -= 2 * (int)marker.getLayer();
 
-            GL32_draw2DRectangle(j->second.getColour(), pos);
+            GL32_draw2DRectangle(ed.getColour(), pos);
             // If the mouse cursor is over the marker, get its information
             if (pos.isPointInside(mouse_pos))
             {
-                hovered_markers.push(j);
+                hovered_markers.push(std::make_pair(&ed, id));
             }
 
         }   // for j in AllEventdata
@@ -388,7 +570,7 @@ void Profiler::draw()
     // GPU profiler
     QueryPerf hovered_gpu_marker = Q_LAST;
     long hovered_gpu_marker_elapsed = 0;
-    int gpu_y = int(y_offset + m_threads_used*line_height + line_height/2);
+    int gpu_y = int(y_offset + threads_used*line_height + line_height/2);
     float total = 0;
     for (unsigned i = 0; i < Q_LAST; i++)
     {
@@ -439,7 +621,7 @@ void Profiler::draw()
     {
         s32 x_sync = (s32)(x_offset + factor*m_time_between_sync);
         s32 y_up_sync = (s32)(MARGIN_Y*screen_size.Height);
-        s32 y_down_sync = (s32)( (MARGIN_Y + (2+m_threads_used)*LINE_HEIGHT)
+        s32 y_down_sync = (s32)( (MARGIN_Y + (2+threads_used)*LINE_HEIGHT)
                                 * screen_size.Height                         );
 
         GL32_draw2DRectangle(video::SColor(0xFF, 0x00, 0x00, 0x00),
@@ -454,11 +636,11 @@ void Profiler::draw()
         core::stringw text;
         while(!hovered_markers.empty())
         {
-            AllEventData::iterator j = hovered_markers.top();
-            const Marker &marker = j->second.getMarker(indx);
+            const EventData *ed = hovered_markers.top().first;
+            const Marker &marker = ed->getMarker(indx);
             std::ostringstream oss;
             oss.precision(4);
-            oss << j->first << " [" << (marker.getDuration()) << " ms / ";
+            oss << getMarkerName(hovered_markers.top().second) << " [" << (marker.getDuration()) << " ms / ";
             oss.precision(3);
             oss << marker.getDuration()*100.0 / duration << "%]" << std::endl;
             text += oss.str().c_str();
@@ -474,6 +656,10 @@ void Profiler::draw()
             font->drawQuick(oss.str().c_str(), GPU_MARKERS_NAMES_POS,
                        video::SColor(0xFF, 0xFF, 0x00, 0x00));
         }
+
+        // Allocation counters of the object pools
+        font->drawQuick(core::stringw(ObjectPool::getReport().c_str()),
+                        POOL_STATS_POS, video::SColor(0xFF, 0x00, 0x00, 0x00));
     }
 
     PROFILER_POP_CPU_MARKER();
@@ -544,14 +730,17 @@ void Profiler::writeToFile()
     std::string base_name =
                file_manager->getUserConfigFile(file_manager->getStdoutName());
     // First CPU data
-    for (int thread_id = 0; thread_id < m_threads_used; thread_id++)
+    for (int thread_id = 0; thread_id < m_threads_used.load(); thread_id++)
     {
         std::ofstream f(FileUtils::getPortableWritingPath(
             base_name + ".profile-cpu-" + StringUtils::toString(thread_id)));
         ThreadData &td = m_all_threads_data[thread_id];
         f << "#  ";
         for (unsigned int i = 0; i < td.m_ordered_headings.size(); i++)
-            f << "\"" << td.m_ordered_headings[i] << "(" << i+1 <<")\"   ";
+        {
+            f << "\"" << getMarkerName(td.m_ordered_headings[i]) << "("
+              << i+1 <<")\"   ";
+        }
         f << std::endl;
         int start = m_has_wrapped_around ? m_current_frame + 1 : 0;
         if (start > m_max_frames) start -= m_max_frames;
@@ -589,6 +778,101 @@ void Profiler::writeToFile()
         start = (start + 1) % m_max_frames;
     }
     f_gpu.close();
+
+    std::ofstream f_pools(FileUtils::getPortableWritingPath(base_name +
+                                                            ".profile-pools"));
+    f_pools << ObjectPool::getReport();
+    f_pools.close();
     m_lock.unlock();
 
 }   // writeFile
+
+//-----------------------------------------------------------------------------
+/** Returns all markers still in the event buffers of all threads in the
+ *  Chrome trace event format (JSON), which can be loaded in chrome://tracing
+ *  or Perfetto. Timestamps are in microseconds. This can be called from any
+ *  thread.
+ */
+std::string Profiler::getChromeTrace()
+{
+    // Read the events first: a marker name is added before any event uses
+    // its id, so all ids are valid indices of the names copied afterwards.
+    const int threads_used = m_threads_used.load();
+    std::vector<std::vector<MarkerEvent> > events(threads_used);
+    for (int i = 0; i < threads_used; i++)
+        readEvents(&m_all_threads_data[i], 0, &events[i]);
+
+    m_marker_lock.lock();
+    std::vector<std::string> names = m_marker_names;
+    std::vector<std::string> thread_names;
+    for (int i = 0; i < threads_used; i++)
+        thread_names.push_back(m_all_threads_data[i].m_name);
+    m_marker_lock.unlock();
+
+    std::ostringstream trace;
+    trace << std::fixed;
+    trace.precision(3);
+    trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (int i = 0; i < threads_used; i++)
+    {
+        const std::string name = thread_names[i].empty()
+                               ? "thread " + StringUtils::toString(i)
+                               : thread_names[i];
+        trace << (first ? "" : ",") << "\n{\"ph\":\"M\",\"pid\":0,\"tid\":"
+              << i << ",\"name\":\"thread_name\",\"args\":{\"name\":\""
+              << jsonEscape(name) << "\"}}";
+        first = false;
+
+        for (const MarkerEvent &e : events[i])
+        {
+            const std::string marker = (size_t)e.m_id < names.size()
+                                     ? jsonEscape(names[e.m_id]) : "unknown";
+            trace << ",\n{\"ph\":\"X\",\"pid\":0,\"tid\":" << i
+                  << ",\"ts\":" << e.m_start * 1000.0
+                  << ",\"dur\":" << (e.m_end - e.m_start) * 1000.0
+                  << ",\"name\":\"" << marker << "\"}";
+        }
+    }   // for i < threads_used
+
+    // Add the current allocation counters of the object pools
+    const double now = getTimeMilliseconds() * 1000.0;
+    for (const ObjectPool *pool : ObjectPool::getPools())
+    {
+        unsigned int in_use, peak;
+        uint64_t allocations, heap_allocations;
+        pool->getStatistics(&in_use, &peak, &allocations, &heap_allocations);
+        trace << (first ? "" : ",") << "\n{\"ph\":\"C\",\"pid\":0,\"ts\":"
+              << now << ",\"name\":\"pool " << jsonEscape(pool->getName())
+              << "\",\"args\":{\"in_use\":" << in_use << ",\"peak\":" << peak
+              << ",\"allocations\":" << allocations
+              << ",\"heap_allocations\":" << heap_allocations << "}}";
+        first = false;
+    }
+    trace << "\n]}\n";
+    return trace.str();
+}   // getChromeTrace
+
+//-----------------------------------------------------------------------------
+/** Writes all buffered markers as a Chrome trace into a file in the config
+ *  directory. The name is based on the stdout name (with .trace.json
+ *  appended).
+ *  \return The name of the file, or an empty string if it could not be
+ *          written.
+ */
+std::string Profiler::writeChromeTrace()
+{
+    std::string filename = FileUtils::getPortableWritingPath(
+        file_manager->getUserConfigFile(file_manager->getStdoutName())
+        + ".trace.json");
+    std::ofstream f(filename);
+    if (!f.is_open())
+    {
+        Log::error("Profiler", "Can't write '%s'.", filename.c_str());
+        return "";
+    }
+    f << getChromeTrace();
+    f.close();
+    Log::info("Profiler", "Trace written to '%s'.", filename.c_str());
+    return filename;
+}   // writeChromeTrace
@@ -24,6 +24,7 @@
 #include <pthread.h>
 
 #include <assert.h>
+#include <atomic>
 #include <iostream>
 #include <list>
 #include <map>
@@ -69,7 +70,21 @@ double getTimeMilliseconds();
 #define ENABLE_PROFILER
 
 #ifdef ENABLE_PROFILER
-    #define PROFILER_PUSH_CPU_MARKER(name, r, g, b) \
+    /** Pushes a marker. The name must not change between calls (e.g. a
+     *  string literal), since it is converted into a marker id only the
+     *  first time this marker is pushed. */
+    #define PROFILER_PUSH_CPU_MARKER(name, r, g, b)                         \
+        do                                                                  \
+        {                                                                   \
+            static const int profiler_marker_id =                           \
+                profiler.getMarkerID(name, video::SColor(0xFF, r, g, b));   \
+            profiler.pushCPUMarker(profiler_marker_id);                     \
+        } while(0)
+
+    /** Pushes a marker with a name that is computed at runtime. This
+     *  has to look up the name on each call, so it is slower than
+     *  PROFILER_PUSH_CPU_MARKER. */
+    #define PROFILER_PUSH_CPU_MARKER_NAME(name, r, g, b) \
         profiler.pushCPUMarker(name, video::SColor(0xFF, r, g, b))
 
     #define PROFILER_POP_CPU_MARKER()  \
@@ -82,6 +97,7 @@ double getTimeMilliseconds();
         profiler.draw()
 #else
     #define PROFILER_PUSH_CPU_MARKER(name, r, g, b)
+    #define PROFILER_PUSH_CPU_MARKER_NAME(name, r, g, b)
     #define PROFILER_POP_CPU_MARKER()
     #define PROFILER_SYNC_FRAME()
     #define PROFILER_DRAW()
@@ -97,6 +113,15 @@ using namespace irr;
 class Profiler
 {
 private:
+    /** Maximum number of threads that can use the profiler. */
+    static const int MAX_THREADS = 10;
+
+    /** Maximum nesting depth of markers. */
+    static const int MAX_STACK_DEPTH = 32;
+
+    /** Number of completed markers buffered per thread (a power of 2). */
+    static const int EVENT_BUFFER_SIZE = 16384;
+
     // ------------------------------------------------------------------------
     class Marker
     {
@@ -198,41 +223,102 @@ private:
         /** Returns the colour for this event. */
         video::SColor getColour() const { return m_colour;  }
         // --------------------------------------------------------------------
+        /** Returns true if this event was used in a thread. */
+        bool isUsed() const { return !m_all_markers.empty(); }
+        // --------------------------------------------------------------------
     };   // EventData
 
     // ========================================================================
-    /** The mapping of event names to the corresponding EventData. */
-    typedef std::map<std::string, EventData> AllEventData;
+    /** A completed marker, as stored in the event buffer of a thread. */
+    struct MarkerEvent
+    {
+        /** Start and end time (in ms, see getTimeMilliseconds()). */
+        double m_start, m_end;
+        /** The marker id. */
+        int    m_id;
+        /** Nesting depth of the marker. */
+        int    m_layer;
+    };   // MarkerEvent
+
+    // ========================================================================
+    /** The EventData of a thread, indexed by marker id. */
+    typedef std::vector<EventData> AllEventData;
     // ========================================================================
+    /** All data of one thread. Push and pop only access the stack and the
+     *  event buffer of the calling thread and don't need any locking: the
+     *  completed markers are written into a ring buffer, from which they
+     *  are collected into the per-frame data in synchronizeFrame(). */
     struct ThreadData
     {
-        /** Stack of events to detect nesting. */
-        std::vector< std::string > m_event_stack;
+        /** Ids and start times of the currently pushed markers. */
+        int    m_stack_id[MAX_STACK_DEPTH];
+        double m_stack_start[MAX_STACK_DEPTH];
+
+        /** Number of currently pushed markers, which can be larger than
+         *  MAX_STACK_DEPTH (the markers above are ignored). */
+        int    m_stack_size;
+
+        /** Ring buffer of completed markers. */
+        std::vector<MarkerEvent> m_events;
 
-        /** This stores the event names in the order in which they occur.
+        /** Number of markers written into m_events so far (only changed
+         *  by the thread itself). */
+        std::atomic<uint64_t> m_num_events;
+
+        /** Number of markers collected into m_all_event_data. */
+        uint64_t m_num_collected;
+
+        /** This stores the event ids in the order in which they occur.
         *  This means that 'outer' events occur here before any child
         *  events. This list is then used to determine the order in which the
         *  bar graphs are drawn, which results in the proper nesting of events.*/
-        std::vector<std::string> m_ordered_headings;
+        std::vector<int> m_ordered_headings;
+
+        /** The layer of each entry in m_ordered_headings. */
+        std::vector<int> m_heading_layers;
 
         AllEventData m_all_event_data;
+
+        /** Name of the thread (used when exporting a trace). */
+        std::string m_name;
+
+        /** True while a running thread uses this data, false after the
+         *  thread exited (then the data can be used by a new thread). */
+        bool m_in_use;
+
+        ThreadData() : m_stack_size(0), m_num_events(0), m_num_collected(0),
+                       m_in_use(false)
+        {
+        }
     };   // class ThreadData
 
     // ========================================================================
 
     /** Data structure containing all currently buffered markers. The index
      *  is the thread id. */
-    std::vector< ThreadData> m_all_threads_data;
+    ThreadData m_all_threads_data[MAX_THREADS];
+
+    /** Number of entries of m_all_threads_data that have been used by
+     *  a thread (some of these threads might have exited). */
+    std::atomic<int> m_threads_used;
 
-    /** A mapping of thread_t pointers to a unique integer (starting from 0).*/
-    std::vector<pthread_t> m_thread_mapping;
+    /** Names and colours of all markers, indexed by marker id. */
+    std::vector<std::string>   m_marker_names;
+    std::vector<video::SColor> m_marker_colours;
+
+    /** Maps marker names to marker ids. */
+    std::map<std::string, int> m_marker_ids;
+
+    /** Protects the marker names and ids, and the creation of new
+     *  thread ids. */
+    Synchronised<bool> m_marker_lock;
+
+    /** Used in synchronizeFrame() to copy markers out of the ring buffers. */
+    std::vector<MarkerEvent> m_collected_events;
 
     /** Buffer for the GPU times (in ms). */
     std::vector<int> m_gpu_times;
 
-    /** Counts the threads used, i.e. registered in m_thread_mapping. */
-    int m_threads_used;
-
     /** Index of the current frame in the buffer. */
     int m_current_frame;
 
@@ -256,11 +342,6 @@ private:
     /** Time between now and last sync, used to scale the GUI bar. */
     double m_time_between_sync;
 
-    /** List of all event names. This list is sorted to make sure
-     *  if the circular buffer is dumped more than once the order
-     *  of events remains the same. */
-    std::vector<std::string> m_all_event_names;
-
     // Handling freeze/unfreeze by clicking on the display
     enum FreezeState
     {
@@ -273,13 +354,21 @@ private:
     FreezeState     m_freeze_state;
 
 private:
-    int  getThreadID();
-    void drawBackground();
+    ThreadData* getThreadData();
+    uint64_t    readEvents(ThreadData *td, uint64_t start,
+                           std::vector<MarkerEvent> *events);
+    void        collectEvents(ThreadData *td);
+    std::string getMarkerName(int id);
+    void        drawBackground();
 
 public:
              Profiler();
     virtual ~Profiler();
     void     init();
+    void     setThreadName(const char *name);
+    void     releaseThreadData();
+    int      getMarkerID(const char *name, const video::SColor &colour);
+    void     pushCPUMarker(int id);
     void     pushCPUMarker(const char* name="N/A",
                            const video::SColor& color=video::SColor());
     void     popCPUMarker();
@@ -288,6 +377,8 @@ public:
     void     draw();
     void     onClick(const core::vector2di& mouse_pos);
     void     writeToFile();
+    std::string getChromeTrace();
+    std::string writeChromeTrace();
 
     // ------------------------------------------------------------------------
     bool isFrozen() const { return m_freeze_state == FROZEN; }
@@ -0,0 +1,185 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/spatial_hash.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+
+// ----------------------------------------------------------------------------
+/** Creates an empty hash.
+ *  \param cell_size Size of a grid cell. This should be about the radius
+ *         used in most queries.
+ */
+SpatialHash::SpatialHash(float cell_size)
+{
+    assert(cell_size > 0);
+    m_cell_size = cell_size;
+    clear();
+}   // SpatialHash
+
+// ----------------------------------------------------------------------------
+/** Removes all points. The memory is kept for the next build. */
+void SpatialHash::clear()
+{
+    m_entries.clear();
+    m_min_x = m_min_z =  FLT_MAX;
+    m_max_x = m_max_z = -FLT_MAX;
+}   // clear
+
+// ----------------------------------------------------------------------------
+/** Adds a point. build() must be called before the point can be found.
+ *  \param xyz Position of the point.
+ *  \param id An arbitrary id returned by the queries.
+ */
+void SpatialHash::add(const Vec3 &xyz, int id)
+{
+    Entry e;
+    e.m_x   = xyz.getX();
+    e.m_y   = xyz.getY();
+    e.m_z   = xyz.getZ();
+    e.m_id  = id;
+    e.m_key = getKey(getCell(e.m_x), getCell(e.m_z));
+    m_entries.push_back(e);
+    m_min_x = std::min(m_min_x, e.m_x);
+    m_max_x = std::max(m_max_x, e.m_x);
+    m_min_z = std::min(m_min_z, e.m_z);
+    m_max_z = std::max(m_max_z, e.m_z);
+}   // add
+
+// ----------------------------------------------------------------------------
+/** Sorts all points into their cells. The points of a cell keep the order
+ *  in which they were added (counting sort), so the queries are
+ *  deterministic.
+ */
+void SpatialHash::build()
+{
+    const unsigned int n = (unsigned int)m_entries.size();
+    unsigned int table_size = 16;
+    while (table_size < 2 * n)
+        table_size *= 2;
+    Cell empty;
+    empty.m_key   = 0;
+    empty.m_first = 0;
+    empty.m_count = 0;
+    empty.m_next  = UNASSIGNED;
+    m_cells.assign(table_size, empty);
+
+    // Count the points in each cell
+    m_slots.resize(n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        const unsigned int slot = findSlot(m_entries[i].m_key);
+        m_cells[slot].m_key = m_entries[i].m_key;
+        m_cells[slot].m_count++;
+        m_slots[i] = slot;
+    }
+
+    // Assign the range of each cell in the order in which the cells are
+    // first used, and copy the points into their cell
+    m_sorted.resize(n);
+    unsigned int first = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        Cell &cell = m_cells[m_slots[i]];
+        if (cell.m_next == UNASSIGNED)
+        {
+            cell.m_first = first;
+            cell.m_next  = first;
+            first       += cell.m_count;
+        }
+        m_sorted[cell.m_next++] = m_entries[i];
+    }
+    m_entries.swap(m_sorted);
+}   // build
+
+// ----------------------------------------------------------------------------
+/** Compares the results of the queries with a brute force search.
+ */
+void SpatialHash::unitTesting()
+{
+    SpatialHash hash(5.0f);
+    std::vector<Vec3> points;
+    // The second round tests rebuilding the hash with moved points, which
+    // reuses the memory of the first round
+    for (int round = 0; round < 2; round++)
+    {
+        points.clear();
+        hash.clear();
+        for (int i = 0; i < 200; i++)
+        {
+            // A deterministic spread of points, including negative
+            // coordinates
+            Vec3 p((float)((i * 37) % 101) - 50.0f + 3.0f * round,
+                   (float)(i % 7),
+                   (float)((i * 53) % 97) - 48.0f - 7.0f * round);
+            points.push_back(p);
+            hash.add(p, i);
+        }
+        hash.build();
+        assert(hash.size() == 200);
+
+        const Vec3 queries[] = { Vec3(0, 0, 0), Vec3(-50, 3, -48),
+                                 Vec3(100, 0, 100), Vec3(12.5f, 1, -7.5f) };
+        const float radii[] = { 0.5f, 4.0f, 13.0f, 1000.0f };
+        for (const Vec3 &q : queries)
+        {
+            for (float r : radii)
+            {
+                std::vector<int> found;
+                hash.forEachWithinRadius(q, r, [&found](int id)
+                    {
+                        found.push_back(id);
+                        return true;
+                    });
+                std::sort(found.begin(), found.end());
+                std::vector<int> expected;
+                for (unsigned int i = 0; i < points.size(); i++)
+                {
+                    if ((points[i] - q).length2() < r*r)
+                        expected.push_back(i);
+                }
+                assert(found == expected);
+
+                // Stopping early must only visit points within the radius
+                int count = 0;
+                bool completed = hash.forEachWithinRadius(q, r, [&](int id)
+                    {
+                        assert((points[id] - q).length2() < r*r);
+                        count++;
+                        return count < 2;
+                    });
+                assert(completed == (expected.size() < 2));
+                assert(count == (int)std::min(expected.size(), (size_t)2));
+                (void)completed;
+            }
+        }
+    }
+
+    hash.clear();
+    hash.build();
+    bool found = false;
+    hash.forEachWithinRadius(Vec3(0, 0, 0), 10.0f, [&found](int id)
+        {
+            found = true;
+            return true;
+        });
+    assert(!found);
+    (void)found;
+}   // unitTesting
@@ -0,0 +1,184 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_SPATIAL_HASH_HPP
+#define HEADER_SPATIAL_HASH_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+#include "utils/vec3.hpp"
+
+#include <algorithm>
+#include <vector>
+
+/**
+  * \ingroup utils
+  * A simple spatial hash for point queries: points are sorted into the
+  * cells of a uniform grid in the XZ plane, so that a radius query only
+  * has to test the points in the cells overlapping the query circle.
+  * Distances are computed in 3d. The hash is meant to be rebuilt whenever
+  * the points have moved (i.e. once per time step): call clear(), add all
+  * points, then build() before doing any queries. All memory is kept when
+  * the hash is cleared, so rebuilding it does not allocate once the
+  * number of points stops growing.
+  */
+class SpatialHash : public NoCopy
+{
+private:
+    struct Entry
+    {
+        float    m_x, m_y, m_z;
+        int      m_id;
+        uint64_t m_key;
+    };   // Entry
+
+    /** A cell of the grid in the open addressing cell table. */
+    struct Cell
+    {
+        uint64_t     m_key;
+        /** Index of the first entry of this cell in m_entries. */
+        unsigned int m_first;
+        /** Number of entries in this cell, 0 for an unused slot. */
+        unsigned int m_count;
+        /** Used by build(): the index for the next entry of this cell. */
+        unsigned int m_next;
+    };   // Cell
+
+    /** Value of Cell::m_next before the range of the cell is assigned. */
+    static const unsigned int UNASSIGNED = 0xffffffff;
+
+    /** Size of a grid cell. */
+    float m_cell_size;
+
+    /** All points, sorted by their cell after build(). */
+    std::vector<Entry> m_entries;
+
+    /** Scratch space used by build() to sort the entries. */
+    std::vector<Entry> m_sorted;
+
+    /** Scratch space used by build(): the slot in m_cells of each entry. */
+    std::vector<unsigned int> m_slots;
+
+    /** Open addressing hash table of all non empty cells. Its size is a
+     *  power of two and at least twice the number of points. */
+    std::vector<Cell> m_cells;
+
+    /** Bounding box (in XZ) of all points, used to limit the queries. */
+    float m_min_x, m_min_z, m_max_x, m_max_z;
+
+    // ------------------------------------------------------------------------
+    int getCell(float f) const { return (int)floorf(f / m_cell_size); }
+    // ------------------------------------------------------------------------
+    static uint64_t getKey(int cx, int cz)
+    {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint64_t)(uint32_t)cz;
+    }   // getKey
+    // ------------------------------------------------------------------------
+    /** Returns the slot of a cell in m_cells: either the slot used by this
+     *  cell, or the unused slot where it would be inserted. */
+    unsigned int findSlot(uint64_t key) const
+    {
+        const unsigned int mask = (unsigned int)m_cells.size() - 1;
+        unsigned int slot =
+            (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+        while (m_cells[slot].m_count > 0 && m_cells[slot].m_key != key)
+            slot = (slot + 1) & mask;
+        return slot;
+    }   // findSlot
+    // ------------------------------------------------------------------------
+    /** Calls f with the index (into m_entries) of each point with a
+     *  distance less than radius to the given point, until f returns
+     *  false. Returns false if f stopped the search.
+     */
+    template<typename F>
+    bool visitWithinRadius(const Vec3 &xyz, float radius, F f) const
+    {
+        if (m_entries.empty())
+            return true;
+        const float x = xyz.getX(), y = xyz.getY(), z = xyz.getZ();
+        const float r2 = radius * radius;
+
+        // Clamp the query area to the bounding box of all points, so that
+        // a huge radius does not result in testing many empty cells.
+        const int min_cx = getCell(std::max(x - radius, m_min_x));
+        const int max_cx = getCell(std::min(x + radius, m_max_x));
+        const int min_cz = getCell(std::max(z - radius, m_min_z));
+        const int max_cz = getCell(std::min(z + radius, m_max_z));
+        if (min_cx > max_cx || min_cz > max_cz)
+            return true;
+
+        // If more cells than points would have to be tested, just test
+        // all points.
+        if ((float)(max_cx - min_cx + 1) * (float)(max_cz - min_cz + 1) >
+            (float)m_entries.size())
+        {
+            for (unsigned int i = 0; i < m_entries.size(); i++)
+            {
+                const Entry &e = m_entries[i];
+                const float dx = e.m_x - x, dy = e.m_y - y, dz = e.m_z - z;
+                if (dx*dx + dy*dy + dz*dz < r2 && !f(i))
+                    return false;
+            }
+            return true;
+        }
+
+        for (int cx = min_cx; cx <= max_cx; cx++)
+        {
+            for (int cz = min_cz; cz <= max_cz; cz++)
+            {
+                const Cell &cell = m_cells[findSlot(getKey(cx, cz))];
+                const unsigned int end = cell.m_first + cell.m_count;
+                for (unsigned int i = cell.m_first; i < end; i++)
+                {
+                    const Entry &e = m_entries[i];
+                    const float dx = e.m_x - x, dy = e.m_y - y,
+                                dz = e.m_z - z;
+                    if (dx*dx + dy*dy + dz*dz < r2 && !f(i))
+                        return false;
+                }
+            }
+        }
+        return true;
+    }   // visitWithinRadius
+
+public:
+         SpatialHash(float cell_size);
+    void clear();
+    void add(const Vec3 &xyz, int id);
+    void build();
+    static void unitTesting();
+    // ------------------------------------------------------------------------
+    /** Calls f with the id of each point with a distance less than radius
+     *  to the given point, in no particular order, until f returns false.
+     *  This does not allocate any memory. Returns false if f stopped the
+     *  search.
+     */
+    template<typename F>
+    bool forEachWithinRadius(const Vec3 &xyz, float radius, F f) const
+    {
+        return visitWithinRadius(xyz, radius, [this, &f](unsigned int i)
+            {
+                return f(m_entries[i].m_id);
+            });
+    }   // forEachWithinRadius
+    // ------------------------------------------------------------------------
+    /** Returns the number of points in this hash. */
+    unsigned int size() const { return (unsigned int)m_entries.size(); }
+};   // SpatialHash
+
+#endif
@@ -0,0 +1,73 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/tick_stats.hpp"
+
+#include <stdio.h>
+
+TimeHistogram TickStats::m_histograms[TickStats::TS_COUNT];
+
+// ----------------------------------------------------------------------------
+/** Returns the name of a phase as used in reports. */
+const char* TickStats::getName(Phase phase)
+{
+    switch (phase)
+    {
+    case TS_WORLD_STATUS:    return "world-status";
+    case TS_REWIND_MANAGER:  return "rewind-manager";
+    case TS_TRACK_OBJECTS:   return "track-objects";
+    case TS_KARTS:           return "karts";
+    case TS_PHYSICS:         return "physics";
+    case TS_WORLD_UPDATE:    return "world-update";
+    case TS_NETWORK_SEND:    return "network-send";
+    case TS_NETWORK_RECEIVE: return "network-receive";
+    case TS_COUNT:           break;
+    }
+    return "unknown";
+}   // getName
+
+// ----------------------------------------------------------------------------
+/** Returns a table with the number of measurements, the median, the 99th
+ *  percentile and the maximum (in milliseconds) of each phase.
+ */
+std::string TickStats::getReport()
+{
+    std::string report;
+    char line[128];
+    snprintf(line, sizeof(line), "%-16s %10s %9s %9s %9s\n", "phase (ms)",
+             "count", "p50", "p99", "max");
+    report += line;
+    for (int i = 0; i < TS_COUNT; i++)
+    {
+        const TimeHistogram &h = m_histograms[i];
+        snprintf(line, sizeof(line), "%-16s %10llu %9.3f %9.3f %9.3f\n",
+                 getName((Phase)i), (unsigned long long)h.getCount(),
+                 h.getPercentile(50.0f) / 1000.0,
+                 h.getPercentile(99.0f) / 1000.0, h.getMax() / 1000.0);
+        report += line;
+    }
+    return report;
+}   // getReport
+
+// ----------------------------------------------------------------------------
+/** Removes all measurements. */
+void TickStats::reset()
+{
+    for (int i = 0; i < TS_COUNT; i++)
+        m_histograms[i].reset();
+}   // reset
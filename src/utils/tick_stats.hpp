@@ -0,0 +1,107 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_TICK_STATS_HPP
+#define HEADER_TICK_STATS_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/time_histogram.hpp"
+
+#include <chrono>
+#include <string>
+
+/**
+  * \ingroup utils
+  * Always-on timing statistics for the major phases of a time step and of
+  * the network thread. Each phase has a histogram of its durations, which
+  * is used to report percentiles (e.g. with the 'stats' command of the
+  * network console), so that spikes on a dedicated server can be seen
+  * without enabling the profiler or verbose logging. The statistics are
+  * reset at the start of each race (see World::reset).
+  */
+class TickStats
+{
+public:
+    /** The phases that are measured. */
+    enum Phase
+    {
+        TS_WORLD_STATUS = 0,
+        TS_REWIND_MANAGER,
+        TS_TRACK_OBJECTS,
+        TS_KARTS,
+        TS_PHYSICS,
+        TS_WORLD_UPDATE,
+        TS_NETWORK_SEND,
+        TS_NETWORK_RECEIVE,
+        TS_COUNT
+    };
+
+    // ------------------------------------------------------------------------
+    /** Measures the time from its creation to its destruction (or to the
+     *  call of stop()) and adds it to the histogram of a phase. */
+    class Timer : public NoCopy
+    {
+    private:
+        Phase m_phase;
+        bool  m_running;
+        std::chrono::steady_clock::time_point m_start;
+    public:
+        Timer(Phase phase, bool enabled = true)
+            : m_phase(phase), m_running(enabled)
+        {
+            if (enabled)
+                m_start = std::chrono::steady_clock::now();
+        }   // Timer
+        // --------------------------------------------------------------------
+        ~Timer() { stop(); }
+        // --------------------------------------------------------------------
+        /** Adds the time since the creation of this timer (only once). */
+        void stop()
+        {
+            if (!m_running)
+                return;
+            m_running = false;
+            TickStats::add(m_phase,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - m_start).count());
+        }   // stop
+    };   // Timer
+
+private:
+    /** One histogram for each phase. */
+    static TimeHistogram m_histograms[TS_COUNT];
+
+public:
+    static const char* getName(Phase phase);
+    static std::string getReport();
+    static void        reset();
+    // ------------------------------------------------------------------------
+    /** Adds the duration of a phase (in microseconds). */
+    static void add(Phase phase, uint64_t us)
+    {
+        m_histograms[phase].add(us);
+    }   // add
+    // ------------------------------------------------------------------------
+    /** Returns the histogram of a phase. */
+    static const TimeHistogram& getHistogram(Phase phase)
+    {
+        return m_histograms[phase];
+    }   // getHistogram
+};   // TickStats
+
+#endif
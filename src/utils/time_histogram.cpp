@@ -0,0 +1,150 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/time_histogram.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// ----------------------------------------------------------------------------
+TimeHistogram::TimeHistogram()
+{
+    reset();
+}   // TimeHistogram
+
+// ----------------------------------------------------------------------------
+/** Removes all values. */
+void TimeHistogram::reset()
+{
+    for (int i = 0; i < NUM_BUCKETS; i++)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    m_count.store(0);
+    m_sum.store(0);
+    m_max.store(0);
+}   // reset
+
+// ----------------------------------------------------------------------------
+/** Returns the index of the bucket for a value. Values less than
+ *  SUB_BUCKETS have their own bucket, larger values are grouped by their
+ *  highest bit and the SUB_BUCKET_BITS-1 bits below it.
+ */
+int TimeHistogram::getBucket(uint64_t value)
+{
+    if (value < (uint64_t)SUB_BUCKETS)
+        return (int)value;
+    int msb = SUB_BUCKET_BITS;
+    while (msb < 63 && (value >> (msb + 1)) != 0)
+        msb++;
+    const int top = (int)(value >> (msb - SUB_BUCKET_BITS + 1));
+    return SUB_BUCKETS + (msb - SUB_BUCKET_BITS) * HALF_BUCKETS +
+           (top - HALF_BUCKETS);
+}   // getBucket
+
+// ----------------------------------------------------------------------------
+/** Returns the largest value that is stored in the given bucket. */
+uint64_t TimeHistogram::getBucketMax(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    const int msb   = (bucket - SUB_BUCKETS) / HALF_BUCKETS + SUB_BUCKET_BITS;
+    const int top   = (bucket - SUB_BUCKETS) % HALF_BUCKETS + HALF_BUCKETS;
+    const int shift = msb - SUB_BUCKET_BITS + 1;
+    return (((uint64_t)top + 1) << shift) - 1;
+}   // getBucketMax
+
+// ----------------------------------------------------------------------------
+/** Adds a value.
+ *  \param us The duration in microseconds.
+ */
+void TimeHistogram::add(uint64_t us)
+{
+    m_buckets[getBucket(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(us, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (us > max &&
+           !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed))
+    {
+    }
+}   // add
+
+// ----------------------------------------------------------------------------
+/** Returns the value below or at which the given percentage of all values
+ *  are. The result is the largest value of the bucket found, but never more
+ *  than the largest value added.
+ *  \param percentile The percentage (0 to 100).
+ */
+uint64_t TimeHistogram::getPercentile(float percentile) const
+{
+    const uint64_t count = m_count.load();
+    if (count == 0)
+        return 0;
+    uint64_t target = (uint64_t)ceil(percentile / 100.0 * (double)count);
+    target = std::max<uint64_t>(1, std::min(target, count));
+    uint64_t sum = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        sum += m_buckets[i].load(std::memory_order_relaxed);
+        if (sum >= target)
+            return std::min(getBucketMax(i), m_max.load());
+    }
+    return m_max.load();
+}   // getPercentile
+
+// ----------------------------------------------------------------------------
+/** Tests the bucket mapping and the percentiles.
+ */
+void TimeHistogram::unitTesting()
+{
+    // Each value must be in a bucket whose maximum is at least the value,
+    // and less than 1/16 larger than the value.
+    const uint64_t values[] = { 0, 1, 31, 32, 33, 63, 64, 100, 1000, 4095,
+                                4096, 123456789, 0xFFFFFFFFFFFFFFFFull };
+    for (uint64_t v : values)
+    {
+        const int bucket = getBucket(v);
+        assert(bucket >= 0 && bucket < NUM_BUCKETS);
+        assert(getBucketMax(bucket) >= v);
+        assert(getBucketMax(bucket) - v <= v / 16);
+        if (bucket > 0)
+            assert(getBucketMax(bucket - 1) < v);
+    }
+    // The buckets must be contiguous
+    for (int i = 1; i < NUM_BUCKETS; i++)
+        assert(getBucket(getBucketMax(i - 1) + 1) == i);
+
+    TimeHistogram h;
+    assert(h.getPercentile(50) == 0);
+    for (uint64_t i = 1; i <= 1000; i++)
+        h.add(i);
+    assert(h.getCount() == 1000);
+    assert(h.getMax() == 1000);
+    assert(h.getMean() == 500);
+    const uint64_t p50 = h.getPercentile(50);
+    assert(p50 >= 500 && p50 <= 500 + 500 / 16);
+    const uint64_t p99 = h.getPercentile(99);
+    assert(p99 >= 990 && p99 <= 1000);
+    (void)p50;
+    (void)p99;
+    assert(h.getPercentile(100) == 1000);
+    assert(h.getPercentile(0) == 1);
+
+    h.reset();
+    assert(h.getCount() == 0 && h.getMax() == 0);
+}   // unitTesting
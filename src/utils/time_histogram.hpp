@@ -0,0 +1,83 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2020 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_TIME_HISTOGRAM_HPP
+#define HEADER_TIME_HISTOGRAM_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+  * \ingroup utils
+  * A histogram of durations (in microseconds) with logarithmic buckets,
+  * similar to an HDR histogram: each power of two is split into
+  * SUB_BUCKETS / 2 buckets, so a percentile is reported with a relative
+  * error of less than 1/16, independent of the size of the value. Adding a
+  * value takes constant time and no locks, so a histogram can be filled
+  * all the time in one thread while another thread reads it.
+  */
+class TimeHistogram : public NoCopy
+{
+private:
+    /** Number of bits of a value that are used to select the bucket
+     *  within a power of two. */
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS     = 1 << SUB_BUCKET_BITS;
+    static const int HALF_BUCKETS    = SUB_BUCKETS / 2;
+    static const int NUM_BUCKETS     = SUB_BUCKETS +
+                                       (64 - SUB_BUCKET_BITS) * HALF_BUCKETS;
+
+    /** Number of values in each bucket. */
+    std::atomic<uint32_t> m_buckets[NUM_BUCKETS];
+
+    /** Number of values added. */
+    std::atomic<uint64_t> m_count;
+
+    /** Sum of all values added. */
+    std::atomic<uint64_t> m_sum;
+
+    /** Largest value added. */
+    std::atomic<uint64_t> m_max;
+
+    static int      getBucket(uint64_t value);
+    static uint64_t getBucketMax(int bucket);
+
+public:
+             TimeHistogram();
+    void     reset();
+    void     add(uint64_t us);
+    uint64_t getPercentile(float percentile) const;
+    static void unitTesting();
+    // ------------------------------------------------------------------------
+    /** Returns the number of values added. */
+    uint64_t getCount() const { return m_count.load(); }
+    // ------------------------------------------------------------------------
+    /** Returns the largest value added. */
+    uint64_t getMax() const { return m_max.load(); }
+    // ------------------------------------------------------------------------
+    /** Returns the average of all values added. */
+    uint64_t getMean() const
+    {
+        const uint64_t count = m_count.load();
+        return count > 0 ? m_sum.load() / count : 0;
+    }   // getMean
+};   // TimeHistogram
+
+#endif
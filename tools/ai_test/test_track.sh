@@ -5,5 +5,5 @@ for track in abyss candela_city cocoa_temple cornfield_crossing fortmagma gran_p
    $1 --log=0 -R     \
        --aiNP=nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok,nolok \
        --track=$track --difficulty=3 --type=1 --test-ai=2   \
-       --profile-laps=10  --no-graphics > stdout.$track
+       --profile-laps=10  --fast-simulation > stdout.$track
 done